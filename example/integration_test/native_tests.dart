@@ -1,14 +1,29 @@
 import 'dart:async';
+import 'dart:ffi' show Pointer, UnsignedChar;
+import 'dart:io' show Directory;
+import 'dart:isolate';
 import 'dart:math' show Point;
 
 import 'package:flutter/material.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:game_tools_lib/core/config/mutable_config.dart';
+import 'package:game_tools_lib/core/enums/native_frame_source.dart';
 import 'package:game_tools_lib/core/enums/native_image_type.dart';
 import 'package:game_tools_lib/core/exceptions/exceptions.dart';
 import 'package:game_tools_lib/core/utils/utils.dart';
 import 'package:game_tools_lib/data/native/native_image.dart';
 import 'package:game_tools_lib/data/native/native_overlay_window.dart';
+import 'package:game_tools_lib/data/native/native_recording.dart';
+import 'package:game_tools_lib/data/native/native_shared_frames.dart';
+import 'package:game_tools_lib/data/native/native_watch.dart';
+import 'package:game_tools_lib/data/native/native_window.dart'
+    show
+        NativeBufferPoolStats,
+        NativeRecordedFrame,
+        NativeRecordingStats,
+        NativeSharedFrame,
+        NativeWindow,
+        NativeWindowState;
 import 'package:game_tools_lib/domain/game/game_window.dart';
 import 'package:game_tools_lib/game_tools_lib.dart';
 import 'helper/test_widgets.dart';
@@ -63,12 +78,35 @@ void _testBaseWindow() {
     expect(second.updateAndGetOpen(), false, reason: "second window should not be open");
     await second.rename("tools");
     expect(second.updateAndGetOpen(), true, reason: "after rename second should also be open");
+    final List<NativeWindowState> states = GameWindow.queryStates(<GameWindow>[mWindow, second]);
+    expect(states.length, 2, reason: "one state per window");
+    expect(states[0].open && states[1].open, true, reason: "both windows open in the batched states");
+    expect(states[0].size, mWindow.updateAndGetSize(), reason: "batched size is the same");
+    expect(states[0].bounds, mWindow.getWindowBounds(), reason: "batched bounds are the same");
+    expect(states[0].focus, mWindow.updateAndGetFocus(), reason: "batched focus is the same");
     await GameToolsLib.close();
     await TestHelper.initGameToolsLib("game_tools_lib_exa");
     await MutableConfig.mutableConfig.alwaysMatchGameWindowNamesEqual.setValue(true);
     expect(mWindow.updateAndGetOpen(), false, reason: "but not anymore when checking for equal");
   });
 
+  testO("native window events", () async {
+    final ReceivePort port = ReceivePort();
+    final List<int> events = <int>[];
+    port.listen((dynamic message) => events.add(message as int));
+    expect(NativeWindow.instance.startWindowEvents(port.sendPort.nativePort), true, reason: "events available");
+    await Utils.delayMS(100);
+    final bool known = events.every(
+      (int event) => event >= NativeWindow.windowEventFocus && event <= NativeWindow.windowEventBounds,
+    );
+    expect(known, true, reason: "only known events are posted");
+    NativeWindow.instance.stopWindowEvents();
+    events.clear();
+    await Utils.delayMS(100);
+    port.close();
+    expect(events, isEmpty, reason: "nothing posted after stop");
+  });
+
   testO("color and pos test", () async {
     Logger.warn("this test can fail if you un focus the window");
     mWindow.updateOpen(); // also needed for size to be cached without loop
@@ -107,6 +145,19 @@ void _testBaseWindow() {
     expect(mWindow.getPixelOfWindow(_width - 1, _height - 1)?.equals(Colors.purple), null, reason: "still no color");
     expect(mWindow.getPixelOfWindow(_width, _height), null, reason: "out window null");
     expect(mWindow.getPixelOfWindow(-1, -1), null, reason: "also -1 is null");
+    final List<Color?> colors = mWindow.getPixelsOfWindow(<Point<int>>[
+      const Point<int>(0, 0),
+      const Point<int>(99, 99),
+      const Point<int>(100, 100),
+      const Point<int>(1164, 581),
+      const Point<int>(-1, -1),
+      Point<int>(appWidth, appHeight),
+    ]);
+    expect(colors[0]?.equals(Colors.blue), true, reason: "batched top left blue");
+    expect(colors[1]?.equals(Colors.blue), true, reason: "batched max size still blue");
+    expect(colors[2]?.equals(Colors.white), true, reason: "batched outer white");
+    expect(colors[3]?.equals(Colors.purple), true, reason: "batched bottom right purple");
+    expect(colors[4] == null && colors[5] == null, true, reason: "batched outside of window null");
 
     expect(overlayBounds.size, size, reason: "overlay size should be same as normal");
     expect(
@@ -326,6 +377,506 @@ void _testImages() {
     expect(part == NativeImage.readSync(path: testFile("correct_crop.png")), true, reason: "sub image comp equals");
     expect(part == NativeImage.readSync(path: testFile("wrong_crop.png")), false, reason: "wrong not equal");
   });
+
+  testO("reusing image memory for the same window area", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage first = await mWindow.getImage(582, 290, 100, 100);
+    final int cleanups = NativeImage.cleanupCounter; // other tests could change this static val
+    final NativeImage second = await mWindow.getImage(582, 290, 100, 100, NativeImageType.RGBA, first);
+    expect(identical(first, second), true, reason: "same image is reused");
+    expect(NativeImage.cleanupCounter, cleanups, reason: "nothing cleaned up for reuse");
+    expect(second.colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "reused crop tl");
+    expect(second.colorAtPixel(48, 48)?.equals(Colors.red), true, reason: "reused crop mi");
+    final NativeImage smaller = await mWindow.getImage(582, 290, 50, 50, NativeImageType.RGBA, first);
+    expect(identical(first, smaller), false, reason: "different size is not reused");
+    final NativeImage rgb = await mWindow.getImage(582, 290, 100, 100, NativeImageType.RGB, first);
+    expect(identical(first, rgb), false, reason: "only rgba is reused");
+    expect(rgb.colorAtPixel(48, 48)?.equals(Colors.red), true, reason: "new rgb crop mi");
+  });
+
+  testO("asynchronous captures on the native task threads", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final List<NativeImage> images = await Future.wait(
+      List<Future<NativeImage>>.generate(6, (int index) => mWindow.getImage(582, 290, 100, 100)),
+    );
+    for (final NativeImage image in images) {
+      expect(image.colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "async crop tl");
+      expect(image.colorAtPixel(48, 48)?.equals(Colors.red), true, reason: "async crop mi");
+    }
+    final Pointer<UnsignedChar> invalid = await NativeWindow.instance.captureAsync(0, 0, 0, 0, 10);
+    expect(invalid.address, 0, reason: "empty areas are not captured");
+  });
+
+  testO("pooled native image buffers", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    final NativeWindow native = NativeWindow.instance;
+    final Pointer<UnsignedChar> first = await native.captureAsync(0, 0, 0, 640, 480);
+    expect(first.address != 0, true, reason: "captured");
+    expect(first.address % 64, 0, reason: "aligned");
+    final NativeBufferPoolStats before = native.getBufferPoolStats();
+    expect(before.liveBuffers > 0, true, reason: "buffer is live");
+    native.cleanupMemory(first);
+    expect(native.getBufferPoolStats().pooledBuffers > before.pooledBuffers, true, reason: "buffer is pooled");
+    final Pointer<UnsignedChar> second = await native.captureAsync(0, 0, 0, 640, 480);
+    expect(native.getBufferPoolStats().hits, before.hits + 1, reason: "pooled buffer is reused");
+    native.cleanupMemory(second);
+    native.trimBufferPool();
+    final NativeBufferPoolStats trimmed = native.getBufferPoolStats();
+    expect(trimmed.pooledBuffers, 0, reason: "trimmed");
+    expect(trimmed.pooledBytes, 0, reason: "trimmed bytes");
+  });
+
+  testO("color conversion while capturing", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage rgba = await mWindow.getImage(582, 290, 100, 100);
+    final List<NativeImageType> types = <NativeImageType>[
+      NativeImageType.GRAY,
+      NativeImageType.RGB,
+      NativeImageType.HSV,
+    ];
+    for (final NativeImageType type in types) {
+      final NativeImage converted = await rgba.clone();
+      await converted.changeTypeAsync(type);
+      final NativeImage captured = await mWindow.getImage(582, 290, 100, 100, type);
+      expect(captured.type, type, reason: "captured as $type");
+      final bool equal = captured.equals(converted, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0);
+      expect(equal, true, reason: "same pixel as the opencv conversion to $type");
+    }
+  });
+
+  testO("downscaled captures", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage half = await mWindow.getImage(582, 290, 100, 100, NativeImageType.RGBA, null, 2);
+    expect(half.width, 50, reason: "half width");
+    expect(half.height, 50, reason: "half height");
+    expect(half.colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "half crop tl");
+    expect(half.colorAtPixel(24, 24)?.equals(Colors.red), true, reason: "half crop mi");
+    final NativeImage quarter = await mWindow.getImage(582, 290, 101, 103, NativeImageType.GRAY, null, 4);
+    expect(quarter.width, 25, reason: "quarter width cuts off the rest");
+    expect(quarter.height, 25, reason: "quarter height cuts off the rest");
+    expect(quarter.type, NativeImageType.GRAY, reason: "also converted");
+    expect(() async {
+      await mWindow.getImage(0, 0, 10, 10, NativeImageType.RGBA, null, 0); // invalid factor
+    }, throwsA(predicate((Object e) => e is ConfigException)));
+  });
+
+  testO("synthetic frame sources", () async {
+    final NativeWindow native = NativeWindow.instance;
+    final String realName = mWindow.name;
+    const String title = "Synthetic Test Window";
+    expect(
+      await native.setFrameSource(NativeFrameSource.PROCEDURAL, windowTitle: title, width: 640, height: 360),
+      true,
+      reason: "procedural source",
+    );
+    expect(mWindow.updateAndGetOpen(), false, reason: "real windows are replaced");
+    await mWindow.rename(title);
+    expect(mWindow.updateAndGetOpen(), true, reason: "synthetic window found by its title");
+    expect(mWindow.updateAndGetSize(), const Point<int>(640, 360), reason: "synthetic size");
+    native.setSourceFrame(3);
+    final NativeImage first = await mWindow.getImage(0, 0, 640, 360);
+    final NativeImage same = await mWindow.getImage(0, 0, 640, 360);
+    native.setSourceFrame(4);
+    final NativeImage next = await mWindow.getImage(0, 0, 640, 360);
+    expect(first.equals(same, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0), true, reason: "same frame");
+    expect(first.equals(next, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0), false, reason: "next frame");
+
+    final Directory directory = Directory.systemTemp.createTempSync("synthetic_frames");
+    await first.saveAsync("${directory.path}/frame0.png");
+    await next.saveAsync("${directory.path}/frame1.png");
+    expect(
+      await native.setFrameSource(NativeFrameSource.FILES, windowTitle: title, directory: directory.path),
+      true,
+      reason: "file source",
+    );
+    expect(native.getSourceFrameCount(), 2, reason: "both png files loaded");
+    expect(mWindow.updateAndGetSize(), const Point<int>(640, 360), reason: "size of the first frame");
+    native.setSourceFrame(3); // wraps around to frame1.png
+    final NativeImage loaded = await mWindow.getImage(0, 0, 640, 360);
+    expect(loaded.equals(next, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0), true, reason: "png frame");
+
+    await native.setFrameSource(NativeFrameSource.SCREEN);
+    directory.deleteSync(recursive: true);
+    expect(native.getFrameSource(), NativeFrameSource.SCREEN, reason: "back to the screen");
+    await mWindow.rename(realName);
+    expect(mWindow.updateAndGetOpen(), true, reason: "real window found again");
+  });
+
+  testO("session recording", () async {
+    final NativeWindow native = NativeWindow.instance;
+    final String realName = mWindow.name;
+    const String title = "Recorded Test Window";
+    await native.setFrameSource(NativeFrameSource.PROCEDURAL, windowTitle: title, width: 320, height: 200);
+    await mWindow.rename(title);
+    native.setSourceFrame(0);
+    mWindow.startCaptureThread(framesPerSecond: 100);
+    final Directory directory = Directory.systemTemp.createTempSync("session_recording");
+    final String path = "${directory.path}/session.rec";
+    expect(mWindow.startRecording(path, keyframeInterval: 4), true, reason: "recording started");
+    final List<NativeImage> shown = <NativeImage>[];
+    for (int frame = 0; frame < 5; ++frame) {
+      native.setSourceFrame(frame);
+      shown.add(await native.getFullMainDisplay(NativeImageType.RGBA));
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+    }
+    final NativeRecordingStats? stats = mWindow.stopRecording();
+    mWindow.stopCaptureThread();
+    expect(stats != null && stats.records >= 5 && stats.keyframes >= 2, true, reason: "frames recorded: $stats");
+
+    final NativeRecording recording = NativeRecording(path);
+    expect(recording.info.frames, stats!.records, reason: "all records readable");
+    int next = 0;
+    for (final (NativeImage image, NativeRecordedFrame frame) in recording.frames()) {
+      expect(frame.bounds.size, const Point<int>(320, 200), reason: "recorded bounds");
+      while (next < shown.length && !image.equals(shown[next], pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0)) {
+        ++next; // frames are recorded in the order in which they were shown
+      }
+      expect(next < shown.length, true, reason: "frame ${frame.frameNumber} was shown");
+    }
+    expect(next, shown.length - 1, reason: "last shown frame recorded");
+    final (NativeImage, NativeRecordedFrame)? first = recording.frameAt(Duration.zero);
+    expect(first?.$1.equals(shown.first, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0), true, reason: "seek");
+    recording.close();
+    expect(recording.frameAt(Duration.zero), null, reason: "closed");
+
+    await native.setFrameSource(NativeFrameSource.SCREEN);
+    directory.deleteSync(recursive: true);
+    await mWindow.rename(realName);
+    expect(mWindow.updateAndGetOpen(), true, reason: "real window found again");
+  });
+
+  testO("session replay", () async {
+    final NativeWindow native = NativeWindow.instance;
+    final String realName = mWindow.name;
+    const String title = "Replayed Test Window";
+    await native.setFrameSource(NativeFrameSource.PROCEDURAL, windowTitle: title, width: 320, height: 200);
+    await mWindow.rename(title);
+    native.setSourceFrame(0);
+    mWindow.startCaptureThread(framesPerSecond: 100);
+    final Directory directory = Directory.systemTemp.createTempSync("session_replay");
+    final String path = "${directory.path}/replay.rec";
+    expect(mWindow.startRecording(path), true, reason: "recording started");
+    for (int frame = 0; frame < 4; ++frame) {
+      native.setSourceFrame(frame);
+      await Future<void>.delayed(const Duration(milliseconds: 100));
+    }
+    mWindow.stopRecording();
+    mWindow.stopCaptureThread();
+
+    expect(await native.setFrameSource(NativeFrameSource.REPLAY, windowTitle: title, recording: path), true);
+    expect(native.setReplaySpeed(0), true, reason: "stepped replay");
+    final NativeRecording recording = NativeRecording(path);
+    int index = 0;
+    for (final (NativeImage image, NativeRecordedFrame frame) in recording.frames()) {
+      native.setSourceFrame(index);
+      expect(mWindow.updateAndGetOpen(), true, reason: "replayed window open at $index");
+      expect(mWindow.getWindowBounds(), frame.bounds, reason: "recorded bounds at $index");
+      final NativeImage replayed = await mWindow.getFullImage();
+      final bool same = replayed.equals(image, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0);
+      expect(same, true, reason: "replayed frame $index");
+      ++index;
+    }
+    expect(index, native.getSourceFrameCount(), reason: "all frames replayed");
+    native.setSourceFrame(index);
+    expect(native.getSourceFrame(), index, reason: "replay ended");
+    expect(mWindow.updateAndGetOpen(), false, reason: "replayed window closed after the last frame");
+    recording.close();
+
+    await native.setFrameSource(NativeFrameSource.SCREEN);
+    directory.deleteSync(recursive: true);
+    await mWindow.rename(realName);
+    expect(mWindow.updateAndGetOpen(), true, reason: "real window found again");
+  });
+
+  testO("shared frame publishing", () async {
+    final NativeWindow native = NativeWindow.instance;
+    final String realName = mWindow.name;
+    const String title = "Published Test Window";
+    await native.setFrameSource(NativeFrameSource.PROCEDURAL, windowTitle: title, width: 320, height: 200);
+    await mWindow.rename(title);
+    native.setSourceFrame(3);
+    expect(mWindow.updateAndGetOpen(), true, reason: "procedural window open");
+    final String name = "game_tools_test_${DateTime.now().microsecondsSinceEpoch}";
+    expect(() => NativeSharedFrames(name), throwsA(isA<FileNotFoundException>()), reason: "nothing published yet");
+    expect(mWindow.startFramePublishing("invalid/name"), false, reason: "invalid name");
+    expect(mWindow.startFramePublishing(name, maxWidth: 320, maxHeight: 200), true, reason: "publishing started");
+    final NativeSharedFrames shared = NativeSharedFrames(name);
+    expect(shared.latest(), null, reason: "no frame before the capture thread");
+    mWindow.startCaptureThread(framesPerSecond: 100);
+    await Future<void>.delayed(const Duration(milliseconds: 200));
+    final (NativeImage, NativeSharedFrame)? frame = shared.latest();
+    expect(frame, isNotNull, reason: "published frame");
+    expect(frame!.$2.bounds, mWindow.getWindowBounds(), reason: "published bounds");
+    expect(frame.$2.frameNumber > 0, true, reason: "published frame number");
+    final NativeImage captured = await mWindow.getFullImage();
+    final bool same = frame.$1.equals(captured, pixelValueThreshold: 0, maxAmountOfPixelsNotEqual: 0);
+    expect(same, true, reason: "published frame equals the capture");
+    mWindow.stopCaptureThread();
+    expect(mWindow.stopFramePublishing()! > 0, true, reason: "frames were published");
+    expect(shared.latest(), null, reason: "publisher stopped");
+    shared.close();
+    expect(shared.isOpen, false, reason: "reader closed");
+
+    await native.setFrameSource(NativeFrameSource.SCREEN);
+    await mWindow.rename(realName);
+    expect(mWindow.updateAndGetOpen(), true, reason: "real window found again");
+  });
+
+  testO("native pixel compare against the dart compare", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage full = await mWindow.getFullImage();
+    final NativeImage fullRgb = await mWindow.getFullImage(type: NativeImageType.RGB);
+    final NativeImage middle = await mWindow.getImage(582, 290, 100, 100);
+    final NativeImage other = await mWindow.getImage(583, 290, 100, 100, NativeImageType.RGB);
+    final List<(NativeImage, NativeImage)> pairs = <(NativeImage, NativeImage)>[
+      (full, full),
+      (full, fullRgb),
+      (fullRgb, full),
+      (middle, other),
+      (other, middle),
+    ];
+    final Stopwatch dartTime = Stopwatch();
+    final Stopwatch nativeTime = Stopwatch();
+    for (final (NativeImage, NativeImage) pair in pairs) {
+      for (final int threshold in <int>[0, 1, 75]) {
+        for (final int maxBad in <int>[0, 40, 10000]) {
+          NativeImage.useNativeCompare = false;
+          dartTime.start();
+          final bool dartResult = pair.$1.equals(
+            pair.$2,
+            pixelValueThreshold: threshold,
+            maxAmountOfPixelsNotEqual: maxBad,
+          );
+          dartTime.stop();
+          NativeImage.useNativeCompare = true;
+          nativeTime.start();
+          final bool nativeResult = pair.$1.equals(
+            pair.$2,
+            pixelValueThreshold: threshold,
+            maxAmountOfPixelsNotEqual: maxBad,
+          );
+          nativeTime.stop();
+          expect(nativeResult, dartResult, reason: "same result for ${pair.$1} and ${pair.$2}, $threshold, $maxBad");
+        }
+      }
+    }
+    Logger.info(
+      "Pixel compare took ${dartTime.elapsedMicroseconds}us in dart and ${nativeTime.elapsedMicroseconds}us natively",
+    );
+    expect(nativeTime.elapsedMicroseconds < dartTime.elapsedMicroseconds, true, reason: "native is faster");
+  });
+
+  testO("native shifted compare against the dart compare", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage middle = await mWindow.getImage(570, 280, 120, 120);
+    final List<NativeImage> others = <NativeImage>[
+      await mWindow.getImage(570, 280, 120, 120, NativeImageType.RGB),
+      await mWindow.getImage(571, 280, 120, 120),
+      await mWindow.getImage(569, 281, 120, 120),
+      await mWindow.getImage(572, 278, 120, 120),
+    ];
+    final Stopwatch dartTime = Stopwatch();
+    final Stopwatch nativeTime = Stopwatch();
+    for (final NativeImage other in others) {
+      for (final int shift in <int>[0, 1, 2]) {
+        NativeImage.useNativeCompare = false;
+        dartTime.start();
+        final bool dartResult = middle.shiftedEquals(other, maxAmountOfPixelsNotEqual: 0, imagePixelShift: shift);
+        dartTime.stop();
+        NativeImage.useNativeCompare = true;
+        nativeTime.start();
+        final bool nativeResult = middle.shiftedEquals(other, maxAmountOfPixelsNotEqual: 0, imagePixelShift: shift);
+        nativeTime.stop();
+        expect(nativeResult, dartResult, reason: "same shifted result for $other with shift $shift");
+      }
+    }
+    expect(middle.shiftedEquals(others[2], maxAmountOfPixelsNotEqual: 0), true, reason: "1 pixel shifted is equal");
+    expect(middle.shiftedEquals(others[3], maxAmountOfPixelsNotEqual: 0), false, reason: "2 pixels are not equal");
+    Logger.info(
+      "Shifted compare took ${dartTime.elapsedMicroseconds}us in dart and ${nativeTime.elapsedMicroseconds}us natively",
+    );
+  });
+
+  testO("shifted compare checks diagonal offsets", () async {
+    final NativeImage full = NativeImage.readSync(path: testFile("full_crop.png"));
+    final NativeImage base = full.getSubImage(30, 30, 40, 40);
+    // (x, y) offset of the other crop, the imagePixelShift and if they are equal. A diagonal offset is only found,
+    // because all (2 * shift + 1)^2 offsets are compared and not just the shifts along one axis
+    final List<(int, int, int, bool)> cases = <(int, int, int, bool)>[
+      (0, 0, 0, true),
+      (1, 1, 0, false),
+      (1, 1, 1, true),
+      (-1, 1, 1, true),
+      (1, 0, 1, true),
+      (2, 1, 1, false),
+      (2, 1, 2, true),
+    ];
+    for (final (int x, int y, int shift, bool expected) in cases) {
+      final NativeImage other = full.getSubImage(30 + x, 30 + y, 40, 40);
+      for (final bool native in <bool>[false, true]) {
+        NativeImage.useNativeCompare = native;
+        final bool result = base.shiftedEquals(
+          other,
+          pixelValueThreshold: 0,
+          maxAmountOfPixelsNotEqual: 0,
+          imagePixelShift: shift,
+        );
+        expect(result, expected, reason: "offset $x, $y with shift $shift (native: $native)");
+      }
+    }
+    NativeImage.useNativeCompare = true;
+  });
+
+  testO("native batch compare against the dart compare", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage full = await mWindow.getFullImage();
+    final NativeImage middle = await mWindow.getImage(570, 280, 120, 120, NativeImageType.RGB);
+    final List<(Bounds<int>, NativeImage)> images = <(Bounds<int>, NativeImage)>[
+      (Bounds<int>(x: 570, y: 280, width: 120, height: 120), middle),
+      (Bounds<int>(x: 571, y: 279, width: 120, height: 120), middle),
+      (Bounds<int>(x: 573, y: 280, width: 120, height: 120), middle),
+      (Bounds<int>(x: 10, y: 10, width: 120, height: 120), middle),
+      (Bounds<int>(x: -60, y: 280, width: 120, height: 120), middle),
+      (Bounds<int>(x: full.width + 5, y: 0, width: 120, height: 120), middle),
+    ];
+    NativeImage.useNativeCompare = false;
+    final List<bool> dartResults = full.shiftedEqualsBatch(images, maxAmountOfPixelsNotEqual: 0);
+    NativeImage.useNativeCompare = true;
+    final Stopwatch time = Stopwatch()..start();
+    final List<bool> nativeResults = full.shiftedEqualsBatch(images, maxAmountOfPixelsNotEqual: 0);
+    time.stop();
+    expect(nativeResults, dartResults, reason: "same batch results");
+    expect(nativeResults.sublist(0, 4), <bool>[true, true, false, false], reason: "shifted results");
+    expect(nativeResults[5], false, reason: "outside of the frame is not equal");
+    Logger.info("Batch compare took ${time.elapsedMicroseconds}us");
+  });
+
+  testO("native template search", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final NativeImage full = await mWindow.getFullImage();
+    final NativeImage template = await mWindow.getImage(560, 270, 140, 140, NativeImageType.RGB);
+    final Stopwatch time = Stopwatch()..start();
+    final (Bounds<int>, double)? match = await full.findTemplate(template);
+    time.stop();
+    expect(match?.$1, Bounds<int>(x: 560, y: 270, width: 140, height: 140), reason: "found at the crop position");
+    expect(match!.$2 > 0.99, true, reason: "confident match");
+    final Bounds<int> area = Bounds<int>(x: 500, y: 200, width: 300, height: 300);
+    final (Bounds<int>, double)? inArea = await full.findTemplate(template, searchArea: area);
+    expect(inArea?.$1, match.$1, reason: "same match inside of the search area");
+    final NativeImage subImage = full.getSubImage(500, 200, 300, 300, onlyReference: true);
+    final (Bounds<int>, double)? inSubImage = await subImage.findTemplate(template);
+    expect(inSubImage?.$1, match.$1.move(-500, -200), reason: "sub image references work as well");
+    expect(await template.findTemplate(full), null, reason: "bigger template is not found");
+    Logger.info("Template search took ${time.elapsedMicroseconds}us for ${full.width}x${full.height}");
+  });
+
+  testO("capturing multiple regions at once", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final List<NativeImage> images = await mWindow.getImages(<Bounds<int>>[
+      Bounds<int>(x: 582, y: 290, width: 100, height: 100),
+      Bounds<int>(x: 630, y: 338, width: 4, height: 4),
+      Bounds<int>(x: 582, y: 290, width: 1, height: 1),
+    ]);
+    expect(images.length, 3, reason: "one image per region");
+    expect(images[0].width == 100 && images[0].height == 100, true, reason: "first region size");
+    expect(images[0].colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "first region tl");
+    expect(images[0].colorAtPixel(48, 48)?.equals(Colors.red), true, reason: "first region mi");
+    expect(images[1].width == 4 && images[1].height == 4, true, reason: "second region size");
+    expect(images[1].colorAtPixel(0, 0)?.equals(Colors.red), true, reason: "second region inside first");
+    expect(images[2].colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "third region tl");
+    final NativeImage single = await mWindow.getImage(582, 290, 100, 100);
+    expect(single.equals(images[0]), true, reason: "same as single capture");
+  });
+
+  testO("background capture thread with latest frames", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    expect(mWindow.getLatestFrame(), null, reason: "no frame without capture thread");
+    mWindow.startCaptureThread(framesPerSecond: 60);
+    expect(mWindow.isCaptureThreadRunning, true, reason: "capture thread started");
+    await Utils.delayMS(200);
+    final NativeImage? frame = mWindow.getLatestFrame();
+    expect(frame, isNotNull, reason: "frame captured");
+    expect(frame!.width == appWidth && frame.height == appHeight, true, reason: "frame has inner window size");
+    final Point<int> mid = mWindow.getMiddle();
+    expect(frame.colorAtPixel(mid.x, mid.y)?.equals(Colors.red), true, reason: "frame mid");
+    final int firstFrame = mWindow.latestFrameNumber;
+    await Utils.delayMS(100);
+    mWindow.getLatestFrame();
+    expect(mWindow.latestFrameNumber > firstFrame, true, reason: "newer frame after a delay");
+    final NativeImage cropMiddle = await mWindow.getImage(582, 290, 100, 100);
+    expect(cropMiddle.colorAtPixel(48, 48)?.equals(Colors.red), true, reason: "crop from frame mi");
+    expect(cropMiddle.colorAtPixel(0, 0)?.equals(Colors.yellow), true, reason: "crop from frame tl");
+    final int cropFrame = mWindow.imageFrameNumber;
+    expect(cropFrame > 0, true, reason: "crop copied from a frame");
+    await Utils.delayMS(100);
+    final Bounds<int> cropBounds = Bounds<int>(x: 582, y: 290, width: 100, height: 100);
+    expect(mWindow.changedTiles(cropBounds, cropFrame), 0, reason: "static area has no changed tiles");
+    expect(mWindow.changedTiles(Bounds<int>(x: -5, y: 0, width: 10, height: 10), cropFrame), null, reason: "outside");
+    mWindow.stopCaptureThread();
+    expect(mWindow.changedTiles(cropBounds, cropFrame), null, reason: "no tiles without capture thread");
+    expect(mWindow.isCaptureThreadRunning, false, reason: "capture thread stopped");
+    expect(mWindow.getLatestFrame(), null, reason: "no frame after stop");
+  });
+
+  testO("capturing from background isolates at the same time", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    final Bounds<int> bounds = mWindow.getWindowBounds();
+    final List<Point<int>> points = <Point<int>>[
+      Point<int>(bounds.x + bounds.width ~/ 2, bounds.y + bounds.height ~/ 2),
+      Point<int>(bounds.x + 5, bounds.y + bounds.height - 5),
+    ];
+    final List<Color?> expected = NativeWindow.instance.getPixelsOfWindow(0, points);
+    final List<bool> results = await Future.wait(
+      List<Future<bool>>.generate(8, (int index) {
+        return Isolate.run(() {
+          NativeWindow.initForBackgroundIsolate();
+          for (int i = 0; i < 50; ++i) {
+            final List<Color?> colors = NativeWindow.instance.getPixelsOfWindow(i % 2, points);
+            if (colors[0] != expected[0] || colors[1] != expected[1]) {
+              return false;
+            }
+          }
+          return true;
+        });
+      }),
+    );
+    expect(results.every((bool same) => same), true, reason: "all isolates captured the same pixels");
+  });
+
+  testO("native pixel and region watches", () async {
+    expect(mWindow.updateAndGetOpen(), true, reason: "windows open");
+    mWindow.updateAndGetSize();
+    final Point<int> mid = mWindow.getMiddle();
+    final NativeWatch redWatch = mWindow.watchPixels(<Point<int>>[mid, const Point<int>(0, 0)], <Color>[
+      Colors.red,
+      Colors.blue,
+    ], interval: const Duration(milliseconds: 10));
+    final NativeWatch greenWatch = mWindow.watchPixels(<Point<int>>[mid], <Color>[Colors.green]);
+    final NativeWatch regionWatch = mWindow.watchRegion(Bounds<int>(x: 582, y: 290, width: 100, height: 100));
+    await redWatch.waitFor(state: true, timeout: const Duration(seconds: 2));
+    await greenWatch.waitFor(state: false, timeout: const Duration(seconds: 2));
+    await regionWatch.waitFor(state: true, timeout: const Duration(seconds: 2));
+    expect(redWatch.matches, true, reason: "mid is red and top left blue");
+    expect(greenWatch.matches, false, reason: "mid is not green");
+    expect(regionWatch.matches, true, reason: "static region unchanged");
+    greenWatch.cancel();
+    expect(greenWatch.isActive, false, reason: "cancelled");
+    expect(() => mWindow.watchPixels(<Point<int>>[mid], <Color>[]), throwsA(isA<ConfigException>()));
+    await Utils.delayMS(100);
+    expect(redWatch.matches, true, reason: "nothing flipped");
+    NativeWatch.cancelAll();
+    expect(redWatch.isActive || regionWatch.isActive, false, reason: "all cancelled");
+  });
 }
 
 void _testInput() {
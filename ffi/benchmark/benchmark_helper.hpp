@@ -0,0 +1,37 @@
+#ifndef BENCHMARK_HELPER_H
+#define BENCHMARK_HELPER_H
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Calls [function] once to warm up and then [iterations] times and returns the average time in microseconds
+template<typename Function>
+double _measureMicroseconds(int iterations, Function function)
+{
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < iterations; ++i )
+    {
+        function();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+/// Prints one result line with the time of both variants and how much faster the second one is
+inline void _printComparison(const char *name, const char *first, double firstMicroseconds, const char *second,
+                             double secondMicroseconds)
+{
+    printf("%-28s %s: %10.1f us   %s: %10.1f us   (x%.2f)\n", name, first, firstMicroseconds, second,
+           secondMicroseconds, secondMicroseconds > 0 ? firstMicroseconds / secondMicroseconds : 0.0);
+}
+
+/// Iterations from the first command line argument or the [defaultIterations]
+inline int _parseIterations(int argc, char **argv, int defaultIterations)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 0;
+    return iterations > 0 ? iterations : defaultIterations;
+}
+
+#endif //BENCHMARK_HELPER_H
@@ -0,0 +1,75 @@
+#include "benchmark_helper.hpp"
+#include "memory/buffer_pool.hpp"
+#include <string.h>
+#include <vector>
+
+/// Called through pointers, because the compiler removes a malloc and free pair whose memory is not read otherwise
+void *(*volatile _malloc)(size_t) = malloc;
+
+void (*volatile _free)(void *) = free;
+
+/// Writes every page of the [buffer] once like a capture does (new memory page faults on the first write)
+inline void _touchPages(unsigned char *buffer, size_t bytes)
+{
+    for ( size_t i = 0; i < bytes; i += 4096 )
+    {
+        buffer[i] = (unsigned char) i;
+    }
+}
+
+/// Compares allocating, writing and freeing image buffers with malloc / free against the size class buffer pool that
+/// is behind cleanupMemory, for typical capture sizes (small compare images up to full 1440p windows).
+/// Usage: buffer_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 200);
+    printf("Buffer pool benchmark with %d iterations\n", iterations);
+    const int sizes[][2] = {{64, 64}, {256, 256}, {1280, 720}, {1920, 1080}, {2560, 1440}};
+    for ( const int *size : sizes )
+    {
+        size_t bytes = (size_t) size[0] * size[1] * 4;
+        double plain = _measureMicroseconds(iterations, [&]() {
+            unsigned char *buffer = (unsigned char *) _malloc(bytes);
+            _touchPages(buffer, bytes);
+            _free(buffer);
+        });
+        double pooled = _measureMicroseconds(iterations, [&]() {
+            unsigned char *buffer = _allocateBuffer(bytes);
+            _touchPages(buffer, bytes);
+            _releaseBuffer(buffer);
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "%dx%d", size[0], size[1]);
+        _printComparison(name, "malloc", plain, "pool", pooled);
+    }
+
+    // a tick with multiple images alive at the same time that are released in a different order
+    std::vector<unsigned char *> buffers(8);
+    auto tick = [&](bool usePool) {
+        for ( size_t i = 0; i < buffers.size(); ++i )
+        {
+            size_t bytes = (size_t) (100 + i * 37) * (100 + i * 23) * 4;
+            buffers[i] = usePool ? _allocateBuffer(bytes) : (unsigned char *) _malloc(bytes);
+            _touchPages(buffers[i], bytes);
+        }
+        for ( size_t i = buffers.size(); i-- > 0; )
+        {
+            usePool ? _releaseBuffer(buffers[i]) : _free(buffers[i]);
+        }
+    };
+    double plain = _measureMicroseconds(iterations, [&]() { tick(false); });
+    double pooled = _measureMicroseconds(iterations, [&]() { tick(true); });
+    _printComparison("8 mixed images per tick", "malloc", plain, "pool", pooled);
+
+    BufferPoolStats stats = getBufferPoolStats();
+    printf("live %lld (%lld bytes), pooled %lld (%lld bytes), hits %lld, misses %lld\n", stats.liveBuffers,
+           stats.liveBytes, stats.pooledBuffers, stats.pooledBytes, stats.hits, stats.misses);
+    unsigned char *aligned = _allocateBuffer(1000);
+    bool isAligned = ((size_t) aligned % _BUFFER_ALIGNMENT) == 0;
+    _releaseBuffer(aligned);
+    trimBufferPool();
+    stats = getBufferPoolStats();
+    printf("aligned: %s, after trim: live %lld, pooled %lld\n", isAligned ? "yes" : "no", stats.liveBuffers,
+           stats.pooledBuffers);
+    return isAligned && stats.liveBuffers == 0 && stats.pooledBuffers == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include "benchmark_helper.hpp"
+#include "platform/platform.hpp"
+#include "capture/capture_session.hpp"
+#include "source/frame_source.hpp"
+#include <string.h>
+#include <vector>
+
+/// Compares the capture latency of creating all platform resources per call (_platformCaptureScreen) with the
+/// persistent PlatformCapture for different area sizes. Needs a display (skipped otherwise), or "synthetic" as second
+/// argument to capture a procedural 1920x1080 frame source instead (then only the copies are measured).
+/// Usage: capture_benchmark [iterations] [synthetic]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 200);
+    if ( argc > 2 && strcmp(argv[2], "synthetic") == 0 )
+    {
+        setFrameSource(FRAME_SOURCE_PROCEDURAL, "Synthetic Capture Benchmark", 1920, 1080, 0);
+    }
+    int displayWidth = (int) _platformGetDisplayWidth();
+    int displayHeight = (int) _platformGetDisplayHeight();
+    if ( displayWidth <= 0 || displayHeight <= 0 )
+    {
+        printf("No display available, skipping the capture benchmark\n");
+        return 0;
+    }
+    printf("Capture benchmark on %dx%d display with %d iterations\n", displayWidth, displayHeight, iterations);
+
+    const int sizes[][2] = {{16, 16}, {64, 64}, {256, 256}, {1280, 720}, {displayWidth, displayHeight}};
+    std::vector<unsigned char> buffer((size_t) displayWidth * displayHeight * 4);
+    PlatformCapture *capture = _platformCreateCapture();
+    for ( const int *size : sizes )
+    {
+        int width = size[0] < displayWidth ? size[0] : displayWidth;
+        int height = size[1] < displayHeight ? size[1] : displayHeight;
+        double perCall = _measureMicroseconds(iterations, [&]() {
+            _platformCaptureScreen(0, 0, width, height, buffer.data());
+        });
+        double persistent = _measureMicroseconds(iterations, [&]() {
+            _platformCaptureWith(capture, 0, 0, width, height, buffer.data(), width * 4);
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "%dx%d", width, height);
+        _printComparison(name, "per call", perCall, "persistent", persistent);
+    }
+
+    // typical tick: multiple small compare images of one window with different sizes
+    int index = 0;
+    auto nextSize = [&](int *width, int *height) {
+        const int *size = sizes[index++ % 3];
+        *width = size[0];
+        *height = size[1];
+    };
+    double perCall = _measureMicroseconds(iterations, [&]() {
+        int width, height;
+        nextSize(&width, &height);
+        _platformCaptureScreen(0, 0, width, height, buffer.data());
+    });
+    index = 0;
+    double persistent = _measureMicroseconds(iterations, [&]() {
+        int width, height;
+        nextSize(&width, &height);
+        _platformCaptureWith(capture, 0, 0, width, height, buffer.data(), width * 4);
+    });
+    _printComparison("alternating small sizes", "per call", perCall, "persistent", persistent);
+    _platformDestroyCapture(capture);
+
+    // pixel probes of a module: a few close points (like a health orb) and some far apart ones (like buff icons)
+    std::vector<POINT> points;
+    for ( int i = 0; i < 16; ++i )
+    {
+        points.push_back(POINT{100 + i % 4 * 5, displayHeight - 100 + i / 4 * 5});
+    }
+    for ( int i = 0; i < 8; ++i )
+    {
+        points.push_back(POINT{displayWidth - 400 + i * 40, 50});
+    }
+    std::vector<unsigned long> singleColors(points.size()), colors(points.size());
+    double single = _measureMicroseconds(iterations, [&]() {
+        for ( size_t i = 0; i < points.size(); ++i )
+        {
+            singleColors[i] = _platformGetScreenPixel(points[i].x, points[i].y);
+        }
+    });
+    double batched = _measureMicroseconds(iterations, [&]() {
+        _capturePixels(_MAIN_DISPLAY_SESSION, points.data(), (int) points.size(), colors.data());
+    });
+    _printComparison("24 pixels", "single pixels", single, "batched", batched);
+    _releaseCaptureSession(_MAIN_DISPLAY_SESSION);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "benchmark_helper.hpp"
+#include "native_window/native_window.hpp"
+#include "capture/capture_session.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// Amount of threads that capture at the same time (like multiple dart background isolates)
+#define _STRESS_THREADS 8
+
+/// Mixes all capture functions of one thread (the even threads capture window 0 and the odd ones window 1, so
+/// multiple threads always share the same window id). Returns the amount of failed captures
+int _stressCaptures(int thread, int iterations, bool hasDisplay)
+{
+    int windowID = thread % 2;
+    int x = thread * 40;
+    std::vector<unsigned char> buffer(64 * 64 * 4);
+    RECT rects[2] = {{x, 0, x + 16, 16}, {x + 20, 20, x + 52, 52}};
+    POINT points[3] = {{x, 0}, {x + 5, 5}, {x + 600, 400}};
+    unsigned long colors[3];
+    int windowIDs[2] = {0, 1};
+    WindowState states[2];
+    int failed = 0;
+    for ( int i = 0; i < iterations; ++i )
+    {
+        if ( !captureInto(windowID, x, 0, 64, 64, buffer.data(), 64 * 4))
+        {
+            ++failed;
+        }
+        unsigned char *image = getImageOfWindow(windowID, x, 10, 32, 32);
+        if ( image == 0 )
+        {
+            ++failed;
+        }
+        cleanupMemory(image);
+        unsigned char *regions[2] = {0, 0};
+        if ( captureRegions(windowID, rects, 2, regions) != 2 )
+        {
+            ++failed;
+        }
+        cleanupMemory(regions[0]);
+        cleanupMemory(regions[1]);
+        if ( getPixelsOfWindow(windowID, points, 3, colors) == 0 )
+        {
+            ++failed;
+        }
+        isWindowOpen(windowID); // the lookups of all threads use the same window cache
+        queryWindowStates(windowIDs, 2, states);
+    }
+    return hasDisplay ? failed : 0;
+}
+
+/// Runs _stressCaptures on [threads] threads at the same time while the main thread keeps re-initializing the windows
+/// and releasing their capture sessions. Returns the amount of failed captures
+int _runStress(int threads, int iterations, bool hasDisplay)
+{
+    std::atomic<int> failed{0};
+    std::atomic<int> running{threads};
+    std::vector<std::thread> workers;
+    for ( int thread = 0; thread < threads; ++thread )
+    {
+        workers.emplace_back([&, thread]() {
+            failed.fetch_add(_stressCaptures(thread, iterations, hasDisplay));
+            running.fetch_sub(1);
+        });
+    }
+    while ( running.load() > 0 )
+    {
+        initWindow(0, "Capture Stress Window That Does Not Exist");
+        _releaseCaptureSession(1);
+        _releaseCaptureSession(_MAIN_DISPLAY_SESSION);
+        std::this_thread::yield();
+    }
+    for ( std::thread &worker : workers )
+    {
+        worker.join();
+    }
+    return failed.load();
+}
+
+/// Captures with all capture functions from 8 threads at the same time (sharing window ids and the window cache) while
+/// the sessions are released concurrently, and compares the time with the same amount of work on one thread. Without
+/// a display only the locking is stressed (then the captures fail and are not counted). Build it with
+/// "-fsanitize=thread" to also check for data races. Returns 1 if any capture failed.
+/// Usage: capture_stress [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 200);
+    bool hasDisplay = _platformGetDisplayWidth() > 0;
+    initConfig(false, 0);
+    initWindow(0, "Capture Stress Window That Does Not Exist");
+    initWindow(1, "Another Capture Stress Window");
+    printf("Capture stress with %d threads and %d iterations%s\n", _STRESS_THREADS, iterations,
+           hasDisplay ? "" : " (no display available, so only the locking is stressed)");
+
+    int failed = 0;
+    double serial = _measureMicroseconds(1, [&]() {
+        failed += _runStress(1, iterations * _STRESS_THREADS, hasDisplay);
+    });
+    double parallel = _measureMicroseconds(1, [&]() {
+        failed += _runStress(_STRESS_THREADS, iterations, hasDisplay);
+    });
+    _printComparison("same work", "1 thread", serial, "8 threads", parallel);
+    printf("%d failed captures\n", failed);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,320 @@
+#include "benchmark_helper.hpp"
+#include "image/image_compare.hpp"
+#include "image/compare_batch.hpp"
+#include "capture/tile_hashes.hpp"
+#include <functional>
+#include <vector>
+
+/// Per pixel callback like the closures of BaseNativeImage._minPixChange in dart (one call per pixel)
+typedef std::function<int(int row, int col)> _PixelCallback;
+
+/// Same loop as BaseNativeImage._compareValsOfMats in dart to compare against the kernel
+int _compareWithCallback(int width, int height, int threshold, int maxBad, const _PixelCallback &callback)
+{
+    int count = 0;
+    for ( int r = 0; r < height; ++r )
+    {
+        for ( int c = 0; c < width; ++c )
+        {
+            if ( callback(r, c) > threshold && ++count > maxBad )
+            {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+/// Fills the image with a pattern and makes every [every] pixel of the second one a bit different
+void _fillImages(std::vector<unsigned char> &first, std::vector<unsigned char> &second, int seed)
+{
+    for ( size_t i = 0; i < first.size(); ++i )
+    {
+        first[i] = (unsigned char) ((i * 7 + seed) & 0xFF);
+        second[i] = (unsigned char) (first[i] + (i % 97 == 0 ? 3 : i % 13 == 0 ? 1 : 0));
+    }
+}
+
+/// Compares the simd kernel against the scalar reference for all channel combinations and some thresholds and
+/// returns false if any result differs
+bool _verify()
+{
+    const int channels[][2] = {{1, 1}, {3, 3}, {3, 4}, {4, 3}, {4, 4}};
+    const int thresholds[] = {-1, 0, 1, 2, 5, 254, 300, 1020};
+    const int width = 53; // odd width to also test the rest of the rows
+    const int height = 17;
+    for ( const int *channel : channels )
+    {
+        int strideA = width * channel[0] + 5; // padding like a sub image reference
+        int strideB = width * channel[1] + 3;
+        std::vector<unsigned char> a((size_t) strideA * height), b((size_t) strideB * height);
+        std::vector<unsigned char> unusedA(a.size()), unusedB(b.size());
+        _fillImages(a, unusedA, 11);
+        _fillImages(b, unusedB, 13);
+        for ( size_t i = 0; i < b.size(); i += 3 )
+        {
+            b[i] = a[i % a.size()]; // some equal values
+        }
+        for ( int threshold : thresholds )
+        {
+            for ( int ignoreAlpha = 0; ignoreAlpha < 2; ++ignoreAlpha )
+            {
+                for ( int maxBad : {-1, 0, 10, width * height} )
+                {
+                    int simd = compareTolerance(a.data(), strideA, channel[0], b.data(), strideB, channel[1], width,
+                                                height, threshold, maxBad, ignoreAlpha);
+                    int scalar = _compareToleranceScalar(a.data(), strideA, channel[0], b.data(), strideB,
+                                                         channel[1], width, height, threshold, maxBad, ignoreAlpha);
+                    if ( simd != scalar )
+                    {
+                        printf("Mismatch for %d/%d channels, threshold %d, maxBad %d, ignoreAlpha %d: %d != %d\n",
+                               channel[0], channel[1], threshold, maxBad, ignoreAlpha, simd, scalar);
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/// Like the dart shiftedEquals: one compare of the overlap for every offset. Returns 1 if any offset was equal
+int _compareEachShift(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                      int channelsB, int width, int height, int maxShift, int threshold, int maxBad, bool simd)
+{
+    for ( int y = -maxShift; y <= maxShift; ++y )
+    {
+        for ( int x = -maxShift; x <= maxShift; ++x )
+        {
+            int shiftWidth = width - (x < 0 ? -x : x);
+            int shiftHeight = height - (y < 0 ? -y : y);
+            if ( shiftWidth <= 0 || shiftHeight <= 0 )
+            {
+                continue;
+            }
+            const unsigned char *first = a + (y > 0 ? y : 0) * strideA + (x > 0 ? x : 0) * channelsA;
+            const unsigned char *second = b + (y < 0 ? -y : 0) * strideB + (x < 0 ? -x : 0) * channelsB;
+            int count = simd ? compareTolerance(first, strideA, channelsA, second, strideB, channelsB, shiftWidth,
+                                                shiftHeight, threshold, maxBad, false)
+                             : _compareToleranceScalar(first, strideA, channelsA, second, strideB, channelsB,
+                                                       shiftWidth, shiftHeight, threshold, maxBad, false);
+            if ( count == 0 || count <= maxBad )
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/// Compares the single pass shifted compare against comparing each offset on its own with images that are shifted
+/// by ([shiftX], [shiftY]) and returns false if any result differs
+bool _verifyShifted()
+{
+    const int width = 41;
+    const int height = 23;
+    for ( int channels : {1, 3, 4} )
+    {
+        std::vector<unsigned char> a((size_t) width * height * channels), b(a.size());
+        std::vector<unsigned char> unused(a.size());
+        _fillImages(a, unused, 5);
+        for ( int shiftX = -2; shiftX <= 2; ++shiftX )
+        {
+            for ( int shiftY = -2; shiftY <= 2; ++shiftY )
+            {
+                // b is a moved by the shift with some noise
+                for ( int y = 0; y < height; ++y )
+                {
+                    for ( int x = 0; x < width; ++x )
+                    {
+                        int sourceX = (x + shiftX + width) % width;
+                        int sourceY = (y + shiftY + height) % height;
+                        for ( int c = 0; c < channels; ++c )
+                        {
+                            b[(y * width + x) * channels + c] = (unsigned char) (
+                                    a[(sourceY * width + sourceX) * channels + c] + ((x * y) % 31 == 0 ? 9 : 0));
+                        }
+                    }
+                }
+                for ( int maxShift : {0, 1, 2, 3} )
+                {
+                    for ( int maxBad : {0, 30, 200} )
+                    {
+                        int stride = width * channels;
+                        int expected = _compareEachShift(a.data(), stride, channels, b.data(), stride, channels, width,
+                                                         height, maxShift, 5, maxBad, false);
+                        int scalar = _shiftedCompareScalar(a.data(), stride, channels, b.data(), stride, channels,
+                                                           width, height, maxShift, 5, maxBad, false, 0, 0);
+                        int simd = shiftedCompare(a.data(), stride, channels, b.data(), stride, channels, width,
+                                                  height, maxShift, 5, maxBad, false, 0, 0);
+                        if ( expected != scalar || expected != simd )
+                        {
+                            printf("Shifted mismatch for %d channels, shift %d/%d, maxShift %d, maxBad %d: %d %d %d\n",
+                                   channels, shiftX, shiftY, maxShift, maxBad, expected, scalar, simd);
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/// Compares the per pixel callback loop (like the current dart path), the scalar loop and the simd kernel for
+/// different image sizes with no early exit (all pixels are compared). Needs no display.
+/// Usage: compare_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 50);
+    if ( !_verify() || !_verifyShifted())
+    {
+        return 1;
+    }
+    printf("Compare benchmark with %d iterations (results of simd and scalar are equal)\n", iterations);
+    const int sizes[][2] = {{64, 64}, {256, 256}, {1280, 720}, {2560, 1440}};
+    for ( int channels : {4, 3} )
+    {
+        for ( const int *size : sizes )
+        {
+            int width = size[0];
+            int height = size[1];
+            int stride = width * channels;
+            std::vector<unsigned char> a((size_t) stride * height), b(a.size());
+            _fillImages(a, b, 0);
+            int maxBad = width * height; // never exits early
+            _PixelCallback callback = [&](int r, int c) {
+                const unsigned char *first = a.data() + r * stride + c * channels;
+                const unsigned char *second = b.data() + r * stride + c * channels;
+                int change = 0;
+                for ( int i = 0; i < channels; ++i )
+                {
+                    change += first[i] > second[i] ? first[i] - second[i] : second[i] - first[i];
+                }
+                return change;
+            };
+            volatile int result = 0;
+            double perPixel = _measureMicroseconds(iterations, [&]() {
+                result = _compareWithCallback(width, height, 1, maxBad, callback);
+            });
+            double scalar = _measureMicroseconds(iterations, [&]() {
+                result = _compareToleranceScalar(a.data(), stride, channels, b.data(), stride, channels, width,
+                                                 height, 1, maxBad, false);
+            });
+            double simd = _measureMicroseconds(iterations, [&]() {
+                result = compareTolerance(a.data(), stride, channels, b.data(), stride, channels, width, height, 1,
+                                          maxBad, false);
+            });
+            char name[64];
+            snprintf(name, sizeof(name), "%dx%d %d channels", width, height, channels);
+            _printComparison(name, "per pixel", perPixel, "kernel", simd);
+            _printComparison("", "scalar", scalar, "kernel", simd);
+        }
+    }
+
+    // shifted compare of a smooth image against itself moved by 1 pixel with a different bottom, so that all offsets
+    // fail only at the end (like a CompareImage that is almost shown). This is the worst case for both variants
+    for ( const int *size : sizes )
+    {
+        int width = size[0];
+        int height = size[1];
+        int stride = width * 4;
+        std::vector<unsigned char> a((size_t) stride * height), b(a.size());
+        for ( int y = 0; y < height; ++y )
+        {
+            for ( int x = 0; x < stride; ++x )
+            {
+                a[y * stride + x] = (unsigned char) ((x / 32 + y / 8) & 0xFF);
+                bool different = y >= height - 4;
+                b[y * stride + x] = different ? 255 : (unsigned char) (((x + 4) / 32 + (y + 1) / 8) & 0xFF);
+            }
+        }
+        volatile int result = 0;
+        double eachShift = _measureMicroseconds(iterations, [&]() {
+            result = _compareEachShift(a.data(), stride, 4, b.data(), stride, 4, width, height, 1, 16, 4, true);
+        });
+        double singlePass = _measureMicroseconds(iterations, [&]() {
+            result = shiftedCompare(a.data(), stride, 4, b.data(), stride, 4, width, height, 1, 16, 4, false, 0, 0);
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "%dx%d shifted by 1", width, height);
+        _printComparison(name, "each shift", eachShift, "single pass", singlePass);
+    }
+
+    // many compare images of a 2560x1440 frame where every second one is shown (copied out of the frame)
+    const int frameWidth = 2560;
+    const int frameHeight = 1440;
+    std::vector<unsigned char> frame((size_t) frameWidth * frameHeight * 4), unused(frame.size());
+    _fillImages(frame, unused, 7);
+    for ( int jobCount : {8, 32, 128} )
+    {
+        std::vector<std::vector<unsigned char>> images((size_t) jobCount);
+        std::vector<CompareJob> jobs((size_t) jobCount);
+        for ( int i = 0; i < jobCount; ++i )
+        {
+            CompareJob &job = jobs[(size_t) i];
+            job = CompareJob{0, 120 * 3, 3, 120, 120, (i * 211) % (frameWidth - 120), (i * 97) % (frameHeight - 120),
+                             75, 40, 1, false};
+            std::vector<unsigned char> &image = images[(size_t) i];
+            image.resize((size_t) job.stride * job.height);
+            for ( int y = 0; y < job.height; ++y )
+            {
+                for ( int x = 0; x < job.width; ++x )
+                {
+                    const unsigned char *pixel = frame.data() + ((size_t) (job.y + y) * frameWidth + job.x + x) * 4;
+                    for ( int c = 0; c < 3; ++c )
+                    {
+                        image[(size_t) y * job.stride + x * 3 + c] = i % 2 == 0 ? pixel[c] : (unsigned char) ~pixel[c];
+                    }
+                }
+            }
+            job.data = image.data();
+        }
+        std::vector<unsigned char> serialResults((size_t) (jobCount + 7) / 8), batchResults(serialResults.size());
+        int serialEqual = 0, batchEqual = 0;
+        double serial = _measureMicroseconds(iterations, [&]() {
+            serialEqual = _compareBatchSerial(frame.data(), frameWidth * 4, 4, frameWidth, frameHeight, jobs.data(),
+                                              jobCount, serialResults.data());
+        });
+        double batch = _measureMicroseconds(iterations, [&]() {
+            batchEqual = compareBatch(frame.data(), frameWidth * 4, 4, frameWidth, frameHeight, jobs.data(), jobCount,
+                                      batchResults.data());
+        });
+        if ( serialEqual != jobCount / 2 || batchEqual != serialEqual || serialResults != batchResults )
+        {
+            printf("Batch compare of %d jobs returned %d and %d instead of %d equal\n", jobCount, serialEqual,
+                   batchEqual, jobCount / 2);
+            return 1;
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "%d jobs of 120x120", jobCount);
+        _printComparison(name, "serial", serial, "batch", batch);
+    }
+
+    // the capture thread hashes all tiles of every frame instead of comparing the frame against the previous one
+    std::vector<unsigned char> previous(frame);
+    previous[(size_t) 700 * frameWidth * 4 + 1000 * 4] ^= 1;
+    std::vector<uint64_t> hashes, previousHashes;
+    _hashTiles(previous.data(), frameWidth, frameHeight, frameWidth * 4, previousHashes);
+    volatile int result = 0;
+    double compareFrames = _measureMicroseconds(iterations, [&]() {
+        result = compareTolerance(frame.data(), frameWidth * 4, 4, previous.data(), frameWidth * 4, 4, frameWidth,
+                                  frameHeight, 0, frameWidth * frameHeight, false);
+    });
+    double hashFrame = _measureMicroseconds(iterations, [&]() {
+        _hashTiles(frame.data(), frameWidth, frameHeight, frameWidth * 4, hashes);
+    });
+    int changedTiles = 0;
+    for ( size_t i = 0; i < hashes.size(); ++i )
+    {
+        changedTiles += hashes[i] != previousHashes[i] ? 1 : 0;
+    }
+    if ( changedTiles != 1 || hashes[(size_t) (700 / _TILE_SIZE) * _tileCount(frameWidth) + 1000 / _TILE_SIZE] ==
+                              previousHashes[(size_t) (700 / _TILE_SIZE) * _tileCount(frameWidth) + 1000 / _TILE_SIZE] )
+    {
+        printf("Tile hashes found %d changed tiles instead of the one changed pixel\n", changedTiles);
+        return 1;
+    }
+    _printComparison("2560x1440 tile hashes", "compare frames", compareFrames, "hash tiles", hashFrame);
+    return 0;
+}
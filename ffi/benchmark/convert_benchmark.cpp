@@ -0,0 +1,109 @@
+#include "benchmark_helper.hpp"
+#include "image/color_convert.hpp"
+#include "memory/buffer_pool.hpp"
+#include <string.h>
+#include <vector>
+
+/// Compares the simd converters against the scalar reference for all widths up to 70 (to also test the rest of the
+/// rows) and checks some known hsv values of opencv. Returns false if any result differs
+bool _verify()
+{
+    const int formats[] = {PIXEL_FORMAT_GRAY, PIXEL_FORMAT_BGR, PIXEL_FORMAT_HSV};
+    std::vector<unsigned char> bgra(70 * 4);
+    for ( size_t i = 0; i < bgra.size(); ++i )
+    {
+        bgra[i] = (unsigned char) ((i * 89 + i / 7) & 0xFF);
+    }
+    for ( int format : formats )
+    {
+        CaptureRowConverter convert = _bgraRowConverter(format);
+        int channels = _pixelFormatChannels(format);
+        for ( int width = 0; width <= 70; ++width )
+        {
+            std::vector<unsigned char> expected((size_t) width * channels + 1, 7), actual(expected.size(), 7);
+            _convertRowScalar(bgra.data(), width, expected.data(), format);
+            convert(bgra.data(), width, actual.data());
+            if ( expected != actual ) // also checks that nothing is written after the row
+            {
+                printf("format %d differs for width %d\n", format, width);
+                return false;
+            }
+        }
+    }
+    // blue, green, red, yellow, gray, white with the results of cv::cvtColor(COLOR_BGR2HSV)
+    const unsigned char colors[] = {255, 0, 0, 0, 0, 255, 0, 0, 0, 0, 255, 0, 0, 255, 255, 0, 128, 128, 128, 0, 255,
+                                    255, 255, 0};
+    const unsigned char hsv[] = {120, 255, 255, 60, 255, 255, 0, 255, 255, 30, 255, 255, 0, 0, 128, 0, 0, 255};
+    unsigned char converted[sizeof(hsv)];
+    _bgraRowConverter(PIXEL_FORMAT_HSV)(colors, 6, converted);
+    if ( memcmp(converted, hsv, sizeof(hsv)) != 0 )
+    {
+        printf("hsv values differ from opencv\n");
+        return false;
+    }
+    unsigned char gray[6];
+    _bgraRowConverter(PIXEL_FORMAT_GRAY)(colors, 6, gray);
+    const unsigned char expectedGray[] = {29, 150, 76, 226, 128, 255}; // cv::cvtColor(COLOR_BGRA2GRAY)
+    if ( memcmp(gray, expectedGray, sizeof(gray)) != 0 )
+    {
+        printf("gray values differ from opencv\n");
+        return false;
+    }
+    return true;
+}
+
+/// Compares the old way of getting a converted capture (copy the BGRA capture out of the platform buffer into a new
+/// image and then convert that into a second new image like cvtColor in dart) against converting the rows while
+/// they are copied out of the platform buffer into one pooled image (what _captureImage does now). Both use the same
+/// simd converters, so only the extra pass and allocation are measured.
+/// Usage: convert_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 100);
+    bool verified = _verify();
+    printf("Color conversion benchmark with %d iterations (simd results %s)\n", iterations,
+           verified ? "verified" : "DIFFERENT");
+    const int sizes[][2] = {{256, 256}, {1280, 720}, {1920, 1080}};
+    const int formats[] = {PIXEL_FORMAT_GRAY, PIXEL_FORMAT_BGR, PIXEL_FORMAT_HSV};
+    const char *names[] = {"gray", "bgr", "hsv"};
+    for ( const int *size : sizes )
+    {
+        int width = size[0];
+        int height = size[1];
+        std::vector<unsigned char> platformBuffer((size_t) width * height * 4); // the DIB section / XShm segment
+        for ( size_t i = 0; i < platformBuffer.size(); ++i )
+        {
+            platformBuffer[i] = (unsigned char) (i * 31);
+        }
+        for ( int f = 0; f < 3; ++f )
+        {
+            int format = formats[f];
+            int channels = _pixelFormatChannels(format);
+            CaptureRowConverter convert = _bgraRowConverter(format);
+            double separate = _measureMicroseconds(iterations, [&]() {
+                unsigned char *bgra = (unsigned char *) malloc((size_t) width * height * 4);
+                memcpy(bgra, platformBuffer.data(), platformBuffer.size());
+                unsigned char *converted = (unsigned char *) malloc((size_t) width * height * channels);
+                for ( int row = 0; row < height; ++row )
+                {
+                    convert(bgra + (size_t) row * width * 4, width, converted + (size_t) row * width * channels);
+                }
+                free(bgra);
+                free(converted);
+            });
+            double fused = _measureMicroseconds(iterations, [&]() {
+                unsigned char *converted = _allocateBuffer((size_t) width * height * channels);
+                for ( int row = 0; row < height; ++row )
+                {
+                    convert(platformBuffer.data() + (size_t) row * width * 4, width,
+                            converted + (size_t) row * width * channels);
+                }
+                _releaseBuffer(converted);
+            });
+            char name[64];
+            snprintf(name, sizeof(name), "%dx%d %s", width, height, names[f]);
+            _printComparison(name, "separate", separate, "fused", fused);
+        }
+    }
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "benchmark_helper.hpp"
+#include "image/downscale.hpp"
+#include "memory/buffer_pool.hpp"
+#include <string.h>
+#include <vector>
+
+/// Compares the simd rows against the scalar reference for the factors 1 to 5 and all output widths up to 37 (to also
+/// test the rest of the rows) with padded source rows. Returns false if any result differs
+bool _verify()
+{
+    for ( int factor = 1; factor <= 5; ++factor )
+    {
+        for ( int outWidth = 0; outWidth <= 37; ++outWidth )
+        {
+            int sourceStride = outWidth * factor * 4 + 12;
+            std::vector<unsigned char> source((size_t) sourceStride * factor);
+            for ( size_t i = 0; i < source.size(); ++i )
+            {
+                source[i] = (unsigned char) ((i * 113 + i / 5) & 0xFF);
+            }
+            std::vector<unsigned char> expected((size_t) outWidth * 4 + 1, 7), actual(expected.size(), 7);
+            _downscaleRowScalar(source.data(), sourceStride, outWidth, factor, expected.data());
+            _downscaleRow(source.data(), sourceStride, outWidth, factor, actual.data());
+            if ( expected != actual ) // also checks that nothing is written after the row
+            {
+                printf("factor %d differs for width %d\n", factor, outWidth);
+                return false;
+            }
+        }
+    }
+    // rounding half up: (1 + 2 + 2 + 2) / 4 = 1.75 and (1 + 2 + 1 + 2) / 4 = 1.5 are both 2
+    const unsigned char block[] = {1, 1, 1, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 2, 2, 2};
+    unsigned char averaged[4];
+    _downscaleRow(block, 8, 1, 2, averaged);
+    return averaged[0] == 2 && averaged[1] == 2 && averaged[2] == 2 && averaged[3] == 2;
+}
+
+/// Compares copying a full resolution BGRA capture out of the staging buffer into a new image against averaging it
+/// down by 2 and 4 in the same pass (what _captureImage does with a downscale factor). The smaller image is also what
+/// every following compare or conversion has to read.
+/// Usage: downscale_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 100);
+    bool verified = _verify();
+    printf("Downscale benchmark with %d iterations (simd results %s)\n", iterations,
+           verified ? "verified" : "DIFFERENT");
+    const int sizes[][2] = {{1280, 720}, {1920, 1080}, {2560, 1440}};
+    for ( const int *size : sizes )
+    {
+        int width = size[0];
+        int height = size[1];
+        std::vector<unsigned char> staging((size_t) width * height * 4);
+        for ( size_t i = 0; i < staging.size(); ++i )
+        {
+            staging[i] = (unsigned char) (i * 31);
+        }
+        double full = _measureMicroseconds(iterations, [&]() {
+            unsigned char *image = _allocateBuffer(staging.size());
+            memcpy(image, staging.data(), staging.size());
+            _releaseBuffer(image);
+        });
+        for ( int factor : {2, 4} )
+        {
+            int outWidth = width / factor;
+            int outHeight = height / factor;
+            double simd = _measureMicroseconds(iterations, [&]() {
+                unsigned char *image = _allocateBuffer((size_t) outWidth * outHeight * 4);
+                for ( int row = 0; row < outHeight; ++row )
+                {
+                    _downscaleRow(staging.data() + (size_t) row * factor * width * 4, width * 4, outWidth, factor,
+                                  image + (size_t) row * outWidth * 4);
+                }
+                _releaseBuffer(image);
+            });
+            double scalar = _measureMicroseconds(iterations, [&]() {
+                unsigned char *image = _allocateBuffer((size_t) outWidth * outHeight * 4);
+                for ( int row = 0; row < outHeight; ++row )
+                {
+                    _downscaleRowScalar(staging.data() + (size_t) row * factor * width * 4, width * 4, outWidth,
+                                        factor, image + (size_t) row * outWidth * 4);
+                }
+                _releaseBuffer(image);
+            });
+            char name[64];
+            snprintf(name, sizeof(name), "%dx%d / %d scalar", width, height, factor);
+            _printComparison(name, "scalar", scalar, "simd", simd);
+            snprintf(name, sizeof(name), "%dx%d / %d copy", width, height, factor);
+            _printComparison(name, "full copy", full, "averaged", simd);
+        }
+    }
+    return verified ? 0 : 1;
+}
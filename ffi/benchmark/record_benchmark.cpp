@@ -0,0 +1,222 @@
+#include "benchmark_helper.hpp"
+#include "capture/frame_grabber.hpp"
+#include "native_window/native_window.hpp"
+#include "record/lz4_block.hpp"
+#include "record/recording_reader.hpp"
+#include "record/session_recorder.hpp"
+#include "source/frame_source.hpp"
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif // #ifndef _WIN32
+
+#define _RECORD_WIDTH 1280
+#define _RECORD_HEIGHT 720
+#define _RECORD_FRAMES 24
+#define _RECORD_PATH "record_benchmark.rec"
+
+/// Frame [index] of the recorded window: a static noisy background (so the keyframes do not compress to nothing) with
+/// a square that moves 40 pixels per frame, so most tiles stay the same between the frames
+std::vector<unsigned char> _sourceFrame(int index)
+{
+    std::vector<unsigned char> frame((size_t) _RECORD_WIDTH * _RECORD_HEIGHT * 4);
+    for ( int y = 0; y < _RECORD_HEIGHT; ++y )
+    {
+        for ( int x = 0; x < _RECORD_WIDTH; ++x )
+        {
+            unsigned char *pixel = frame.data() + ((size_t) y * _RECORD_WIDTH + x) * 4;
+            pixel[0] = (unsigned char) (x / 8 * 16);
+            pixel[1] = (unsigned char) (y / 4 * 8 + (x * y % 7));
+            pixel[2] = (unsigned char) ((x / 64 + y / 64) * 40);
+            pixel[3] = 255;
+        }
+    }
+    for ( int y = 300; y < 380; ++y )
+    {
+        memset(frame.data() + ((size_t) y * _RECORD_WIDTH + 40 * index) * 4, 255, 80 * 4);
+    }
+    return frame;
+}
+
+/// Compresses and decompresses a frame and incompressible data with the lz4 block codec of the records
+bool _verifyCodec(const std::vector<unsigned char> &frame)
+{
+    std::vector<unsigned char> noise(100000);
+    unsigned int state = 12345;
+    for ( unsigned char &value : noise )
+    {
+        state = state * 1103515245u + 12345u;
+        value = (unsigned char) (state >> 16);
+    }
+    const std::vector<unsigned char> *inputs[] = {&frame, &noise};
+    for ( const std::vector<unsigned char> *data : inputs )
+    {
+        int size = (int) data->size();
+        std::vector<unsigned char> packed((size_t) _lz4CompressBound(size));
+        std::vector<unsigned char> unpacked(data->size());
+        int packedSize = _lz4Compress(data->data(), size, packed.data(), (int) packed.size());
+        if ( packedSize <= 0 || _lz4Decompress(packed.data(), packedSize, unpacked.data(), size) != size ||
+             unpacked != *data || _lz4Decompress(packed.data(), packedSize, unpacked.data(), size - 1) != -1 )
+        {
+            printf("lz4 round trip failed\n");
+            return false;
+        }
+    }
+    // the recorder stores incompressible payloads raw, which is detected with a smaller capacity
+    std::vector<unsigned char> packed(noise.size());
+    return _lz4Compress(noise.data(), (int) noise.size(), packed.data(), (int) noise.size() - 1) == 0;
+}
+
+/// Waits until the capture thread of the window 0 captured [frames] new frames (so the first one of them was surely
+/// started after the current source frame was set), at most for 5 seconds
+void _waitForCaptures(long long frames)
+{
+    long long target = acquireLatestFrame(0).frameNumber + frames;
+    for ( int wait = 0; wait < 1000 && acquireLatestFrame(0).frameNumber < target; ++wait )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+/// Records the synthetic window with a capture thread while its frames are changed and returns the statistics
+RecordingStats _recordFrames(const std::vector<std::vector<unsigned char>> &frames)
+{
+    setFrameSource(FRAME_SOURCE_FILES, "Recorded Source Window", _RECORD_WIDTH, _RECORD_HEIGHT, 0);
+    for ( const std::vector<unsigned char> &frame : frames )
+    {
+        addSourceFrame(frame.data(), _RECORD_WIDTH, _RECORD_HEIGHT);
+    }
+    initWindow(0, "Recorded Source");
+    setSourceFrame(0);
+    startCaptureThread(0, 200);
+    if ( !startRecording(0, _RECORD_PATH, 8))
+    {
+        printf("could not create %s\n", _RECORD_PATH);
+        return RecordingStats{0, 0, 0, 0, 0};
+    }
+    for ( int index = 0; index < (int) frames.size(); ++index )
+    {
+        setSourceFrame(index);
+        _waitForCaptures(2);
+    }
+    RecordingStats stats = stopRecording(0);
+    stopCaptureThread(0);
+    return stats;
+}
+
+/// Reads every frame of the recording in order by its timestamp and checks that it is exactly one of the source
+/// [frames] in the same order in which they were shown. Stores the timestamps of the frames in [timestamps]
+bool _verifyRecording(int reader, const std::vector<std::vector<unsigned char>> &frames,
+                      std::vector<long long> *timestamps)
+{
+    RecordingInfo info = getRecordingInfo(reader);
+    long long timestamp = info.firstTimestamp;
+    int shown = 0;
+    RecordedFrame details;
+    while ( timestamp >= 0 )
+    {
+        unsigned char *data = readRecordedFrame(reader, timestamp, &details);
+        if ( data == 0 || details.width != _RECORD_WIDTH || details.height != _RECORD_HEIGHT ||
+             details.timestamp != timestamp || details.bounds.right - details.bounds.left != _RECORD_WIDTH )
+        {
+            cleanupMemory(data);
+            printf("frame at %lld could not be read\n", timestamp);
+            return false;
+        }
+        while ( shown < (int) frames.size() && memcmp(data, frames[shown].data(), frames[shown].size()) != 0 )
+        {
+            ++shown;
+        }
+        cleanupMemory(data);
+        if ( shown == (int) frames.size())
+        {
+            printf("frame %lld at %lld is not one of the recorded frames\n", details.frameNumber, timestamp);
+            return false;
+        }
+        timestamps->push_back(details.timestamp);
+        timestamp = details.nextTimestamp;
+    }
+    // reading backwards reconstructs the first frame from its keyframe again
+    unsigned char *first = readRecordedFrame(reader, 0, 0);
+    bool same = first != 0 && memcmp(first, frames[0].data(), frames[0].size()) == 0;
+    cleanupMemory(first);
+    if ( !same || shown != (int) frames.size() - 1 || (long long) timestamps->size() != info.frames )
+    {
+        printf("recording does not contain all frames in order\n");
+        return false;
+    }
+    return true;
+}
+
+/// Cuts off the last byte of the recording and checks that only its last record is lost
+bool _verifyTruncated(long long frames)
+{
+#ifdef _WIN32
+    return true;
+#else
+    FILE *file = fopen(_RECORD_PATH, "rb");
+    if ( file == 0 || fseek(file, 0, SEEK_END) != 0 )
+    {
+        return false;
+    }
+    long size = ftell(file);
+    fclose(file);
+    int reader = truncate(_RECORD_PATH, size - 1) == 0 ? openRecording(_RECORD_PATH) : -1;
+    bool truncated = reader >= 0 && getRecordingInfo(reader).frames == frames - 1;
+    closeRecording(reader);
+    if ( !truncated )
+    {
+        printf("truncated recording could not be read\n");
+    }
+    return truncated;
+#endif // #ifdef _WIN32
+}
+
+/// Records a synthetic window with a capture thread and verifies that every frame is read back exactly (also after
+/// the file was cut off). Then compares reading all frames in order (only the deltas are applied) with reading them in
+/// a random order (reconstructed from the previous keyframe). Returns 1 if any check failed.
+/// Usage: record_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 200);
+    initConfig(false, 0);
+    std::vector<std::vector<unsigned char>> frames;
+    for ( int index = 0; index < _RECORD_FRAMES; ++index )
+    {
+        frames.push_back(_sourceFrame(index));
+    }
+    bool verified = _verifyCodec(frames[0]);
+    RecordingStats stats = _recordFrames(frames);
+    int reader = openRecording(_RECORD_PATH);
+    std::vector<long long> timestamps;
+    verified = verified && stats.records > 0 && reader >= 0 &&
+               getRecordingInfo(reader).keyframes == stats.keyframes && stats.keyframes >= 2 &&
+               _verifyRecording(reader, frames, &timestamps);
+    printf("Session recording benchmark with %d iterations (recording %s)\n", iterations,
+           verified ? "verified" : "DIFFERENT");
+    printf("%lld records (%lld keyframes, %lld dropped): %.1f MB frames, %.1f MB deltas, %.2f MB written\n",
+           stats.records, stats.keyframes, stats.droppedFrames,
+           stats.records * (double) _RECORD_WIDTH * _RECORD_HEIGHT * 4 / 1e6, stats.rawBytes / 1e6,
+           stats.writtenBytes / 1e6);
+    if ( !timestamps.empty())
+    {
+        size_t next = 0;
+        double ordered = _measureMicroseconds(iterations, [&]() {
+            cleanupMemory(readRecordedFrame(reader, timestamps[next++ % timestamps.size()], 0));
+        });
+        double random = _measureMicroseconds(iterations, [&]() {
+            next = (next * 7919 + 13) % timestamps.size();
+            cleanupMemory(readRecordedFrame(reader, timestamps[next], 0));
+        });
+        _printComparison("1280x720 recorded frames", "random", random, "in order", ordered);
+    }
+    closeRecording(reader);
+    verified = verified && _verifyTruncated(stats.records);
+    setFrameSource(FRAME_SOURCE_SCREEN, 0, 0, 0, 0);
+    remove(_RECORD_PATH);
+    return verified ? 0 : 1;
+}
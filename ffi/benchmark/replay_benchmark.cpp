@@ -0,0 +1,208 @@
+#include "benchmark_helper.hpp"
+#include "capture/frame_grabber.hpp"
+#include "capture/tile_hashes.hpp"
+#include "image/image_compare.hpp"
+#include "native_window/native_window.hpp"
+#include "record/recording_reader.hpp"
+#include "record/session_recorder.hpp"
+#include "source/frame_source.hpp"
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define _REPLAY_FRAMES 40
+#define _REPLAY_RESIZED 25
+#define _REPLAY_INTERVAL_MS 10
+#define _REPLAY_PATH "replay_benchmark.rec"
+
+/// A recorded frame with the window bounds at that time
+struct _ReplayFrame
+{
+    std::vector<unsigned char> pixels;
+    int width;
+    int height;
+    RECT bounds;
+};
+
+/// Frame [index] of the recorded window: 640x360 until the window is resized to 800x450 at _REPLAY_RESIZED. The window
+/// has borders (8 pixels on the sides and a 31 pixel title bar) and moves 6 pixels to the right with every frame
+_ReplayFrame _replayFrame(int index)
+{
+    _ReplayFrame frame;
+    frame.width = index < _REPLAY_RESIZED ? 640 : 800;
+    frame.height = index < _REPLAY_RESIZED ? 360 : 450;
+    frame.bounds = RECT{100 + 6 * index, 50, 100 + 6 * index + frame.width + 16, 50 + frame.height + 39};
+    frame.pixels.resize((size_t) frame.width * frame.height * 4);
+    for ( int y = 0; y < frame.height; ++y )
+    {
+        for ( int x = 0; x < frame.width; ++x )
+        {
+            unsigned char *pixel = frame.pixels.data() + ((size_t) y * frame.width + x) * 4;
+            bool square = x >= 10 * index && x < 10 * index + 48 && y >= 100 && y < 148;
+            pixel[0] = square ? 255 : (unsigned char) (x / 4);
+            pixel[1] = square ? 255 : (unsigned char) (y / 2);
+            pixel[2] = square ? 255 : (unsigned char) (x ^ y);
+            pixel[3] = 255;
+        }
+    }
+    return frame;
+}
+
+/// Records all [frames] directly like a capture thread with the window id 1 would, one every _REPLAY_INTERVAL_MS
+bool _writeRecording(const std::vector<_ReplayFrame> &frames)
+{
+    if ( !startRecording(1, _REPLAY_PATH, 10))
+    {
+        printf("could not create %s\n", _REPLAY_PATH);
+        return false;
+    }
+    std::vector<uint64_t> tileHashes;
+    for ( int index = 0; index < (int) frames.size(); ++index )
+    {
+        const _ReplayFrame &frame = frames[index];
+        _hashTiles(frame.pixels.data(), frame.width, frame.height, frame.width * 4, tileHashes);
+        _recordFrame(1, frame.pixels.data(), frame.width, frame.height, index + 1, frame.bounds, tileHashes);
+        std::this_thread::sleep_for(std::chrono::milliseconds(_REPLAY_INTERVAL_MS));
+    }
+    RecordingStats stats = stopRecording(1);
+    return stats.records == (long long) frames.size() && stats.droppedFrames == 0;
+}
+
+/// Captures the inner window like GameWindow.getImage in dart into [image]. Returns false if the window is not open
+bool _captureWindow(std::vector<unsigned char> *image, POINT *size)
+{
+    RECT bounds = getWindowBounds(0);
+    *size = getWindowSize(0);
+    if ( !isWindowOpen(0) || size->x <= 0 || size->y <= 0 )
+    {
+        return false;
+    }
+    POINT pos = _innerWindowPos(bounds, *size);
+    image->resize((size_t) size->x * size->y * 4);
+    return captureInto(0, pos.x, pos.y, size->x, size->y, image->data(), size->x * 4);
+}
+
+/// Steps through the replay at full speed and checks that every frame, the window bounds and the pixels are the
+/// recorded ones and that the window is closed after the last frame
+bool _verifyFullSpeed(const std::vector<_ReplayFrame> &frames)
+{
+    initWindow(0, "Replayed Window");
+    if ( !setReplaySpeed(0) || getSourceFrameCount() != (int) frames.size() || getMainDisplayWidth() != 100 +
+         6 * (_REPLAY_FRAMES - 1) + 816 || getMainDisplayHeight() != 50 + 450 + 39 )
+    {
+        printf("replay not loaded\n");
+        return false;
+    }
+    std::vector<unsigned char> image;
+    POINT size;
+    for ( int index = 0; index < (int) frames.size(); ++index )
+    {
+        const _ReplayFrame &frame = frames[index];
+        setSourceFrame(index);
+        RECT bounds = getWindowBounds(0);
+        POINT pos = _innerWindowPos(bounds, POINT{frame.width, frame.height});
+        // pixel (3, 5) of the inner window: blue x / 4, green y / 2, red x ^ y as 0x00bbggrr
+        unsigned long pixel = getPixelOfWindow(pos.x + 3, pos.y + 5);
+        if ( getSourceFrame() != index || !_captureWindow(&image, &size) || size.x != frame.width ||
+             memcmp(&bounds, &frame.bounds, sizeof(RECT)) != 0 || image != frame.pixels ||
+             pixel != (2ul << 8 | (3 ^ 5)))
+        {
+            printf("replayed frame %d is different\n", index);
+            return false;
+        }
+    }
+    setSourceFrame((long long) frames.size());
+    if ( isWindowOpen(0) || getSourceFrame() != (long long) frames.size())
+    {
+        printf("replayed window was not closed at the end\n");
+        return false;
+    }
+    setSourceFrame(3); // reopens the window
+    return isWindowOpen(0) && _captureWindow(&image, &size) && image == frames[3].pixels;
+}
+
+/// Replays at 4 times the wall clock speed and checks that the frames only move forward and that the window closes
+/// after the recorded duration (frames may be skipped if the polling here is slow)
+bool _verifyWallClock(long long duration)
+{
+    setSourceFrame(0);
+    setReplaySpeed(4);
+    auto start = std::chrono::steady_clock::now();
+    long long previous = 0;
+    long long seen = 0;
+    while ( isWindowOpen(0))
+    {
+        long long frame = getSourceFrame();
+        if ( frame < previous )
+        {
+            printf("replay moved backwards from %lld to %lld\n", previous, frame);
+            return false;
+        }
+        seen += frame != previous ? 1 : 0;
+        previous = frame;
+        if ( std::chrono::steady_clock::now() - start > std::chrono::seconds(5))
+        {
+            printf("replay did not end\n");
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    printf("replayed %lld us of recording at x4 in %.0f us (%lld frame changes seen)\n", duration, elapsed, seen);
+    setReplaySpeed(0);
+    return elapsed >= duration / 4.0 * 0.9 && seen > 0;
+}
+
+/// Records a moving and resized window and replays it through the normal window and capture functions: at full speed
+/// every frame has to match the recording exactly and at a wall clock speed the frames have to move forward in time
+/// until the window is closed. Then the frames per second of a capture and compare pipeline at full speed are compared
+/// with the recorded frame rate. Returns 1 if any check failed.
+/// Usage: replay_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 5);
+    initConfig(false, 0);
+    std::vector<_ReplayFrame> frames;
+    for ( int index = 0; index < _REPLAY_FRAMES; ++index )
+    {
+        frames.push_back(_replayFrame(index));
+    }
+    bool verified = _writeRecording(frames);
+    int reader = openRecording(_REPLAY_PATH);
+    RecordingInfo info = getRecordingInfo(reader);
+    closeRecording(reader);
+    verified = verified && setFrameSource(FRAME_SOURCE_REPLAY, "Replayed Window Title", 0, 0, _REPLAY_PATH) &&
+               !setFrameSource(FRAME_SOURCE_REPLAY, "Missing", 0, 0, "missing_replay.rec") &&
+               getFrameSource() == FRAME_SOURCE_REPLAY && _verifyFullSpeed(frames);
+    long long duration = info.lastTimestamp - info.firstTimestamp;
+    verified = verified && _verifyWallClock(duration);
+    printf("Replay benchmark with %d iterations (replay %s)\n", iterations, verified ? "verified" : "DIFFERENT");
+    if ( verified )
+    {
+        // every frame is captured and compared with the previous one like a module would analyse it
+        std::vector<unsigned char> image, previous;
+        POINT size, previousSize = POINT{0, 0};
+        long long changed = 0;
+        double replayed = _measureMicroseconds(iterations, [&]() {
+            for ( int index = 0; index < _REPLAY_FRAMES; ++index )
+            {
+                setSourceFrame(index);
+                if ( _captureWindow(&image, &size) && size.x == previousSize.x && size.y == previousSize.y )
+                {
+                    changed += compareTolerance(image.data(), size.x * 4, 4, previous.data(), size.x * 4, 4, size.x,
+                                                size.y, 0, size.x * size.y, false);
+                }
+                image.swap(previous);
+                previousSize = size;
+            }
+        }) / _REPLAY_FRAMES;
+        double recorded = (double) duration / (_REPLAY_FRAMES - 1);
+        _printComparison("replayed frame analysis", "recorded", recorded, "full speed", replayed);
+        printf("%.0f frames analysed per second (%lld changed pixels)\n", replayed > 0 ? 1e6 / replayed : 0.0,
+               changed);
+    }
+    setFrameSource(FRAME_SOURCE_SCREEN, 0, 0, 0, 0);
+    remove(_REPLAY_PATH);
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include "benchmark_helper.hpp"
+#include "capture/frame_grabber.hpp"
+#include "native_window/native_window.hpp"
+#include "share/frame_publisher.hpp"
+#include "share/shared_frame_reader.hpp"
+#include "source/frame_source.hpp"
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // #ifndef _WIN32
+
+#define _SHARE_WIDTH 1280
+#define _SHARE_HEIGHT 720
+#define _SHARE_FRAMES 16
+
+/// Frame [index] of the published window has the same color in every pixel, so a frame that was partly overwritten
+/// while it was read is detected
+std::vector<unsigned char> _sharedSourceFrame(int index)
+{
+    std::vector<unsigned char> frame((size_t) _SHARE_WIDTH * _SHARE_HEIGHT * 4);
+    for ( size_t i = 0; i < frame.size(); i += 4 )
+    {
+        frame[i] = (unsigned char) (index * 7 + 1);
+        frame[i + 1] = (unsigned char) (index * 13 + 2);
+        frame[i + 2] = (unsigned char) (index * 29 + 3);
+        frame[i + 3] = 255;
+    }
+    return frame;
+}
+
+/// Returns true if all pixels of the [data] are the same as the first one
+bool _isUniform(const unsigned char *data, int width, int height)
+{
+    size_t bytes = (size_t) width * height * 4;
+    for ( size_t i = 4; i < bytes; i += 4 )
+    {
+        if ( memcmp(data, data + i, 4) != 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Consumer process: waits for the publisher of [name] and reads its frames (copied and in place) until it stopped.
+/// Returns the exit code (0 if frames were read and all complete ones had exactly the pixels of one source frame, slow
+/// consumers may see every frame overwritten while they read it in place)
+int _runConsumer(const std::string &name)
+{
+    int reader = -1;
+    for ( int wait = 0; wait < 2000 && reader < 0; ++wait )
+    {
+        reader = openSharedFrames(name.c_str());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    long long copied = 0, inPlace = 0, overwritten = 0, lastFrame = 0;
+    auto start = std::chrono::steady_clock::now();
+    while ( reader >= 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(20))
+    {
+        SharedFrame frame;
+        unsigned char *data = readSharedFrame(reader, &frame);
+        if ( data == 0 )
+        {
+            if ( !acquireSharedFrame(reader, &frame) && openSharedFrames(name.c_str()) < 0 && copied > 0 )
+            {
+                break; // the publisher stopped
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        bool uniform = _isUniform(data, frame.width, frame.height);
+        cleanupMemory(data);
+        if ( !uniform || frame.width != _SHARE_WIDTH || frame.bounds.right != _SHARE_WIDTH ||
+             frame.frameNumber < lastFrame )
+        {
+            printf("consumer read a wrong frame %lld\n", frame.frameNumber);
+            return 1;
+        }
+        lastFrame = frame.frameNumber;
+        ++copied;
+        if ( acquireSharedFrame(reader, &frame))
+        {
+            uniform = _isUniform(frame.data, frame.width, frame.height);
+            if ( !isSharedFrameValid(reader, &frame))
+            {
+                ++overwritten; // pixels that were read in place were overwritten, so they are not checked
+            } else if ( !uniform )
+            {
+                printf("consumer read a torn frame %lld in place\n", frame.frameNumber);
+                return 1;
+            } else
+            {
+                ++inPlace;
+            }
+        }
+    }
+    printf("consumer process read %lld copied and %lld in place frames (%lld overwritten while reading)\n", copied,
+           inPlace, overwritten);
+    closeSharedFrames(reader);
+    return copied > 0 ? 0 : 1;
+}
+
+/// Publishes the frames of a synthetic window with a capture thread while they change (until [stop] returns true)
+template<typename Stop>
+void _changeFrames(Stop stop)
+{
+    for ( long long frame = 0; !stop(); ++frame )
+    {
+        setSourceFrame(frame % _SHARE_FRAMES);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+/// Publishes the frames of a synthetic window with a capture thread into shared memory and reads them from a second
+/// process that is forked before any thread is started. Then compares capturing the window on its own with reading
+/// the published frame (copied and in place) in the same process. Returns 1 if any check failed.
+/// Usage: share_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 200);
+    std::string name = "game_tools_share_benchmark";
+    bool verified = true;
+#ifndef _WIN32
+    name += "_" + std::to_string((long long) getpid());
+    pid_t consumer = fork();
+    if ( consumer == 0 )
+    {
+        return _runConsumer(name);
+    }
+#endif // #ifndef _WIN32
+    initConfig(false, 0);
+    setFrameSource(FRAME_SOURCE_FILES, "Shared Source Window", _SHARE_WIDTH, _SHARE_HEIGHT, 0);
+    for ( int index = 0; index < _SHARE_FRAMES; ++index )
+    {
+        std::vector<unsigned char> frame = _sharedSourceFrame(index);
+        addSourceFrame(frame.data(), _SHARE_WIDTH, _SHARE_HEIGHT);
+    }
+    initWindow(0, "Shared Source");
+    setSourceFrame(0);
+    verified = startFramePublishing(0, name.c_str(), 3, 0, 0) && !startFramePublishing(1, name.c_str(), 3, 0, 0) &&
+               !startFramePublishing(0, "invalid/name", 3, 0, 0) && startFramePublishing(0, name.c_str(), 3, 0, 0);
+    startCaptureThread(0, 500);
+#ifndef _WIN32
+    int status = 1;
+    auto start = std::chrono::steady_clock::now();
+    _changeFrames([&]() {
+        return std::chrono::steady_clock::now() - start > std::chrono::milliseconds(1500);
+    });
+#endif // #ifndef _WIN32
+    int reader = openSharedFrames(name.c_str());
+    SharedFrame frame;
+    unsigned char *own = getImageOfWindow(0, 0, 0, _SHARE_WIDTH, _SHARE_HEIGHT);
+    unsigned char *copy = readSharedFrame(reader, &frame);
+    verified = verified && reader >= 0 && own != 0 && copy != 0 && frame.height == _SHARE_HEIGHT &&
+               _isUniform(copy, frame.width, frame.height);
+    cleanupMemory(own);
+    cleanupMemory(copy);
+    printf("Shared frames benchmark with %d iterations (shared frames %s)\n", iterations,
+           verified ? "verified" : "DIFFERENT");
+    if ( verified )
+    {
+        std::vector<unsigned char> target((size_t) _SHARE_WIDTH * _SHARE_HEIGHT * 4);
+        double captured = _measureMicroseconds(iterations, [&]() {
+            captureInto(0, 0, 0, _SHARE_WIDTH, _SHARE_HEIGHT, target.data(), _SHARE_WIDTH * 4);
+        });
+        double copied = _measureMicroseconds(iterations, [&]() {
+            cleanupMemory(readSharedFrame(reader, 0));
+        });
+        long long sum = 0;
+        double inPlace = _measureMicroseconds(iterations, [&]() {
+            // a consumer that only reads a few pixels of the frame where it is
+            if ( acquireSharedFrame(reader, &frame))
+            {
+                sum += frame.data[0] + frame.data[(size_t) frame.width * frame.height * 4 - 4];
+                sum += isSharedFrameValid(reader, &frame) ? 1 : 0;
+            }
+        });
+        _printComparison("1280x720 frame per consumer", "own capture", captured, "shared copy", copied);
+        _printComparison("1280x720 frame per consumer", "own capture", captured, "in place", inPlace);
+    }
+    closeSharedFrames(reader);
+    long long published = stopFramePublishing(0);
+    stopCaptureThread(0);
+    printf("%lld frames published\n", published);
+    verified = verified && published > 0 && openSharedFrames(name.c_str()) < 0;
+#ifndef _WIN32
+    waitpid(consumer, &status, 0);
+    verified = verified && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif // #ifndef _WIN32
+    setFrameSource(FRAME_SOURCE_SCREEN, 0, 0, 0, 0);
+    return verified ? 0 : 1;
+}
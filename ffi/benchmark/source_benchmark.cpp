@@ -0,0 +1,137 @@
+#include "benchmark_helper.hpp"
+#include "native_window/native_window.hpp"
+#include "source/frame_source.hpp"
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif // #ifndef _WIN32
+
+#define _SOURCE_WIDTH 1280
+#define _SOURCE_HEIGHT 720
+
+/// Captures the full synthetic window into [image] and returns false if it failed
+bool _captureFull(std::vector<unsigned char> *image)
+{
+    image->resize((size_t) _SOURCE_WIDTH * _SOURCE_HEIGHT * 4);
+    return captureInto(0, 0, 0, _SOURCE_WIDTH, _SOURCE_HEIGHT, image->data(), _SOURCE_WIDTH * 4);
+}
+
+/// Checks that the procedural window is found by its title like a real window and that the same frame number always
+/// produces the same captures
+bool _verifyProcedural()
+{
+    if ( !setFrameSource(FRAME_SOURCE_PROCEDURAL, "Synthetic Source Window", _SOURCE_WIDTH, _SOURCE_HEIGHT, 0))
+    {
+        return false;
+    }
+    initWindow(0, "Synthetic Source");
+    POINT size = getWindowSize(0);
+    if ( !isWindowOpen(0) || !hasWindowFocus(0) || size.x != _SOURCE_WIDTH || size.y != _SOURCE_HEIGHT ||
+         getMainDisplayWidth() != _SOURCE_WIDTH )
+    {
+        printf("procedural window not found\n");
+        return false;
+    }
+    std::vector<unsigned char> first, second, next;
+    setSourceFrame(3);
+    bool captured = _captureFull(&first) && _captureFull(&second);
+    setSourceFrame(4);
+    captured = captured && _captureFull(&next);
+    setSourceFrame(3);
+    unsigned char *image = getImageOfWindow(0, 0, 0, _SOURCE_WIDTH, _SOURCE_HEIGHT);
+    bool same = image != 0 && memcmp(image, first.data(), first.size()) == 0;
+    cleanupMemory(image);
+    // pixel (100, 200) of frame 3 is outside of the square: blue x + 3, green y + 3, red x ^ y as 0x00bbggrr
+    unsigned long pixel = getPixelOfWindow(100, 200);
+    if ( !captured || first != second || first == next || !same || pixel != (103ul << 16 | 203ul << 8 | (100 ^ 200)))
+    {
+        printf("procedural frames are not deterministic\n");
+        return false;
+    }
+    return true;
+}
+
+/// Writes 2 ppm frames into a temporary directory and checks that they are served in order (with wrap around) next to
+/// a frame that is added directly. Only on linux, because the temporary directory is created with mkdtemp
+bool _verifyFiles()
+{
+#ifdef _WIN32
+    return true;
+#else
+    char directory[] = "/tmp/synthetic_source_XXXXXX";
+    if ( mkdtemp(directory) == 0 )
+    {
+        return false;
+    }
+    const unsigned char colors[2][3] = {{10, 20, 30}, {200, 100, 50}};
+    for ( int i = 0; i < 2; ++i )
+    {
+        std::string path = std::string(directory) + "/frame" + std::to_string(i) + ".ppm";
+        FILE *file = fopen(path.c_str(), "wb");
+        fprintf(file, "P6\n# frame %d\n%d %d\n255\n", i, _SOURCE_WIDTH, _SOURCE_HEIGHT);
+        for ( int p = 0; p < _SOURCE_WIDTH * _SOURCE_HEIGHT; ++p )
+        {
+            fwrite(colors[i], 1, 3, file);
+        }
+        fclose(file);
+    }
+    bool loaded = setFrameSource(FRAME_SOURCE_FILES, "Synthetic File Window", 0, 0, directory);
+    std::vector<unsigned char> added((size_t) _SOURCE_WIDTH * _SOURCE_HEIGHT * 4, 77);
+    loaded = loaded && addSourceFrame(added.data(), _SOURCE_WIDTH, _SOURCE_HEIGHT) &&
+             !addSourceFrame(added.data(), 16, 16) && getSourceFrameCount() == 3;
+    initWindow(0, "Synthetic File");
+    const unsigned long expected[] = {30ul << 16 | 20ul << 8 | 10ul, 50ul << 16 | 100ul << 8 | 200ul,
+                                      77ul << 16 | 77ul << 8 | 77ul, 30ul << 16 | 20ul << 8 | 10ul};
+    bool served = loaded && isWindowOpen(0);
+    for ( int frame = 0; frame < 4 && served; ++frame )
+    {
+        setSourceFrame(frame);
+        served = getPixelOfWindow(640, 360) == expected[frame];
+    }
+    for ( int i = 0; i < 2; ++i )
+    {
+        unlink((std::string(directory) + "/frame" + std::to_string(i) + ".ppm").c_str());
+    }
+    rmdir(directory);
+    if ( !served )
+    {
+        printf("file frames are not served in order\n");
+    }
+    return served;
+#endif // #ifdef _WIN32
+}
+
+/// Runs the window and capture functions on the synthetic frame sources without any display and verifies that they
+/// are deterministic. Then compares capturing the same frame with generating a new procedural frame for every
+/// capture (like a game that changes every frame). Returns 1 if any check failed.
+/// Usage: source_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 100);
+    initConfig(false, 0);
+    bool verified = _verifyProcedural() && _verifyFiles();
+    printf("Synthetic frame source benchmark with %d iterations (sources %s)\n", iterations,
+           verified ? "verified" : "DIFFERENT");
+    setFrameSource(FRAME_SOURCE_PROCEDURAL, "Synthetic Source Window", _SOURCE_WIDTH, _SOURCE_HEIGHT, 0);
+    initWindow(0, "Synthetic Source");
+    std::vector<unsigned char> image;
+    long long frame = 0;
+    double same = _measureMicroseconds(iterations, [&]() {
+        _captureFull(&image);
+    });
+    double changing = _measureMicroseconds(iterations, [&]() {
+        setSourceFrame(++frame);
+        _captureFull(&image);
+    });
+    _printComparison("1280x720 window", "new frame", changing, "same frame", same);
+    setFrameSource(FRAME_SOURCE_SCREEN, 0, 0, 0, 0);
+    if ( isWindowOpen(0))
+    {
+        printf("synthetic window still open after switching back to the screen\n");
+        verified = false;
+    }
+    return verified ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "benchmark_helper.hpp"
+#include "image/template_match.hpp"
+#include <vector>
+
+/// Average time of the search in a full 2560x1440 frame that is accepted (only checked in optimized builds, because
+/// the time of a debug build says nothing)
+#define _FULL_FRAME_BUDGET_MICROSECONDS 8000
+
+/// Fills a BGRA image with a random texture of small blocks (similar to a busy game screen)
+void _fillTexture(std::vector<unsigned char> &image, int width, int height, unsigned int seed)
+{
+    for ( int y = 0; y < height; ++y )
+    {
+        for ( int x = 0; x < width; ++x )
+        {
+            unsigned int block = (unsigned int) ((y / 9) * 7919 + (x / 7)) * 2654435761u + seed;
+            block ^= block >> 13;
+            unsigned char *pixel = image.data() + ((size_t) y * width + x) * 4;
+            pixel[0] = (unsigned char) (block & 0xFF);
+            pixel[1] = (unsigned char) ((block >> 8) & 0xFF);
+            pixel[2] = (unsigned char) ((block >> 16) & 0xFF);
+            pixel[3] = 255;
+        }
+    }
+}
+
+/// Copies the area [x], [y] with the size of the template out of the image as BGR (like a compare image file) and
+/// adds some noise to it
+std::vector<unsigned char> _cutTemplate(const std::vector<unsigned char> &image, int width, int x, int y,
+                                        int templWidth, int templHeight)
+{
+    std::vector<unsigned char> templ((size_t) templWidth * templHeight * 3);
+    for ( int row = 0; row < templHeight; ++row )
+    {
+        for ( int col = 0; col < templWidth; ++col )
+        {
+            const unsigned char *source = image.data() + ((size_t) (y + row) * width + x + col) * 4;
+            unsigned char *target = templ.data() + ((size_t) row * templWidth + col) * 3;
+            for ( int c = 0; c < 3; ++c )
+            {
+                int noise = ((row * 31 + col * 17 + c) % 7) - 3;
+                int value = source[c] + noise;
+                target[c] = (unsigned char) (value < 0 ? 0 : value > 255 ? 255 : value);
+            }
+        }
+    }
+    return templ;
+}
+
+/// Measures the coarse to fine template search on a full 2560x1440 frame for a 64x64 icon and compares it with an
+/// exhaustive full resolution search on a smaller frame. Fails if a wrong position is found or if the full frame
+/// search is slower than [_FULL_FRAME_BUDGET_MICROSECONDS]. Needs no display.
+/// Usage: template_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 20);
+    const int templSize = 64;
+    const int targetX = 1733;
+    const int targetY = 911;
+    printf("Template benchmark with %d iterations\n", iterations);
+    const int sizes[][2] = {{640, 360}, {1280, 720}, {2560, 1440}};
+    for ( const int *size : sizes )
+    {
+        int width = size[0];
+        int height = size[1];
+        std::vector<unsigned char> image((size_t) width * height * 4);
+        _fillTexture(image, width, height, 12345);
+        int x = targetX * width / 2560;
+        int y = targetY * height / 1440;
+        std::vector<unsigned char> templ = _cutTemplate(image, width, x, y, templSize, templSize);
+        TemplateMatch match{};
+        double pyramid = _measureMicroseconds(iterations, [&]() {
+            match = findTemplate(image.data(), width * 4, 4, width, height, templ.data(), templSize * 3, 3, templSize,
+                                 templSize, 0);
+        });
+        if ( match.x != x || match.y != y )
+        {
+            printf("Wrong match at %d, %d instead of %d, %d (confidence %.3f)\n", match.x, match.y, x, y,
+                   match.confidence);
+            return 1;
+        }
+        RECT area{x - 100, y - 50, x + 200, y + 150};
+        double withArea = _measureMicroseconds(iterations, [&]() {
+            match = findTemplate(image.data(), width * 4, 4, width, height, templ.data(), templSize * 3, 3, templSize,
+                                 templSize, &area);
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "%dx%d (%.3f)", width, height, match.confidence);
+        if ( width <= 640 )
+        {
+            double exhaustive = _measureMicroseconds(1, [&]() {
+                match = _findTemplateExhaustive(image.data(), width * 4, 4, width, height, templ.data(),
+                                                templSize * 3, 3, templSize, templSize);
+            });
+            _printComparison(name, "exhaustive", exhaustive, "pyramid", pyramid);
+        } else
+        {
+            _printComparison(name, "pyramid", pyramid, "search area", withArea);
+        }
+#ifdef NDEBUG
+        if ( width == 2560 && pyramid > _FULL_FRAME_BUDGET_MICROSECONDS )
+        {
+            printf("The full frame search is over the budget of %d us\n", _FULL_FRAME_BUDGET_MICROSECONDS);
+            return 1;
+        }
+#endif
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "benchmark_helper.hpp"
+#include "native_window/title_matcher.hpp"
+#include <string.h>
+#include <string>
+#include <vector>
+
+/// Same matching as before the names were compiled (rescans the name and the title for every pair). Only the ascii
+/// "-" is a delimiter here, because the titles were not utf8 before
+bool _matchesUncompiled(const char *title, const char *name, bool exact)
+{
+    size_t titleLength = strlen(title);
+    size_t nameLength = strlen(name);
+    if ( title[1] == ':' && title[2] == '\\' )
+    {
+        return strcmp(title, name) == 0;
+    }
+    bool nameDelimiter = false;
+    for ( size_t i = 1; i + 1 < nameLength; ++i )
+    {
+        nameDelimiter = nameDelimiter || (name[i - 1] == ' ' && name[i] == '-' && name[i + 1] == ' ');
+    }
+    bool titleDelimiter = false;
+    for ( size_t i = 1; i + 1 < titleLength; ++i )
+    {
+        titleDelimiter = titleDelimiter || (title[i - 1] == ' ' && title[i] == '-' && title[i + 1] == ' ');
+    }
+    if ( !nameDelimiter && titleDelimiter )
+    {
+        if ( strncmp(title, name, nameLength) == 0 && title[nameLength] == ' ' && title[nameLength + 1] == '-' )
+        {
+            return true;
+        }
+        size_t start = 0;
+        for ( size_t i = 0; i + 1 < titleLength; ++i )
+        {
+            if ( title[i] == '-' && title[i + 1] == ' ' )
+            {
+                start = i + 2;
+            }
+        }
+        return start > 0 && titleLength - start == nameLength && strcmp(title + start, name) == 0;
+    }
+    return exact ? strcmp(title, name) == 0 : strstr(title, name) != 0;
+}
+
+struct _MatchCase
+{
+    const char *title;
+    const char *name;
+    bool exact;
+    bool expected;
+};
+
+bool _verify()
+{
+    const _MatchCase cases[] = {
+            {"Path of Exile", "Path of Exile", false, true},
+            {"Path of Exile 2", "Path of Exile", false, true},
+            {"Path of Exile 2", "Path of Exile", true, false},
+            {"#general - Server - Discord", "Discord", false, true},
+            {"#general - Server - Discord", "Server", false, false},
+            {"Command Prompt - ping localhost", "Command Prompt", false, true},
+            {"Some Page \xE2\x80\x93 Mozilla Firefox", "Mozilla Firefox", false, true},
+            {"Some Page \xE2\x80\x94 Mozilla Firefox", "Mozilla Firefox", false, true},
+            {"Some Page \xE2\x80\x94 Mozilla Firefox", "Firefox", false, false},
+            {"\xE5\x8E\x9F\xE7\xA5\x9E", "\xE5\x8E\x9F\xE7\xA5\x9E", true, true},
+            {"\xE5\x8E\x9F\xE7\xA5\x9E - \xE5\x8E\x9F", "\xE5\x8E\x9F", false, true},
+            {"C:\\Games\\Tools", "C:\\Games\\Tools", false, true},
+            {"C:\\Games\\Tools", "Games", false, false},
+            {"game_tools_lib_example", "tools", false, true},
+            {"A - B", "A - B", true, true},
+            {"x - A - B", "A - B", false, true},
+    };
+    for ( const _MatchCase &test : cases )
+    {
+        bool matches = _matchesTitle(_compileTitleMatcher(test.name, test.exact), _scanTitle(test.title));
+        if ( matches != test.expected )
+        {
+            printf("WRONG MATCH of \"%s\" for \"%s\": %d\n", test.name, test.title, matches);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Matches 8 window names against 300 typical window titles like one window enumeration without any found window.
+/// Needs no display.
+/// Usage: title_benchmark [iterations]
+int main(int argc, char **argv)
+{
+    int iterations = _parseIterations(argc, argv, 2000);
+    if ( !_verify())
+    {
+        return 1;
+    }
+    std::vector<std::string> titles;
+    for ( int i = 0; i < 300; ++i )
+    {
+        switch ( i % 4 )
+        {
+            case 0:
+                titles.push_back("Some document " + std::to_string(i) + ".txt - Editor");
+                break;
+            case 1:
+                titles.push_back("#channel-" + std::to_string(i) + " - Some Server - Discord");
+                break;
+            case 2:
+                titles.push_back("A long page title of a browser tab number " + std::to_string(i) + " - Browser");
+                break;
+            default:
+                titles.push_back("Settings " + std::to_string(i));
+                break;
+        }
+    }
+    const char *names[] = {"Path of Exile", "League of Legends", "TL", "Diablo IV", "Game A", "Game B", "Game C",
+                           "Game D"};
+    std::vector<_TitleMatcher> matchers;
+    for ( const char *name : names )
+    {
+        matchers.push_back(_compileTitleMatcher(name, false));
+    }
+    volatile int found = 0;
+    double uncompiled = _measureMicroseconds(iterations, [&]() {
+        for ( const std::string &title : titles )
+        {
+            for ( const char *name : names )
+            {
+                found += _matchesUncompiled(title.c_str(), name, false);
+            }
+        }
+    });
+    double compiled = _measureMicroseconds(iterations, [&]() {
+        for ( const std::string &title : titles )
+        {
+            _TitleInfo info = _scanTitle(title.c_str());
+            for ( const _TitleMatcher &matcher : matchers )
+            {
+                found += _matchesTitle(matcher, info);
+            }
+        }
+    });
+    printf("Title benchmark with %d iterations (all matches are correct)\n", iterations);
+    _printComparison("300 titles x 8 names", "uncompiled", uncompiled, "compiled", compiled);
+    return 0;
+}
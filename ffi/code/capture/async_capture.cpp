@@ -0,0 +1,26 @@
+#include "async_capture.hpp"
+#include "capture_session.hpp"
+#include "../image/color_convert.hpp"
+#include "../image/downscale.hpp"
+#include "../memory/buffer_pool.hpp"
+#include "../threading/task_queue.hpp"
+
+EXPORT bool captureAsync(int windowID, int x, int y, int width, int height, int format, int downscale,
+                         int64_t requestID, DartPort port)
+{
+    if ( downscale < 1 || downscale > _MAX_DOWNSCALE || width / downscale <= 0 || height / downscale <= 0 ||
+         _pixelFormatChannels(format) == 0 || port == 0 )
+    {
+        return false;
+    }
+    _runTask([=]() {
+        // the window id only selects the capture session (the area is always in screen coordinates)
+        unsigned char *image = _captureImage(windowID, x, y, width, height, format, downscale);
+        int64_t message[2] = {requestID, (int64_t) (intptr_t) image};
+        if ( !_postInt64ArrayToDart(port, message, 2))
+        {
+            _releaseBuffer(image);
+        }
+    });
+    return true;
+}
@@ -0,0 +1,20 @@
+#include "../platform/platform.hpp"
+#include "../watch/dart_port.hpp"
+#include "../exports.h"
+
+#ifndef ASYNC_CAPTURE_H
+#define ASYNC_CAPTURE_H
+
+/// Same as getImageOfWindow, but the capture is done on one of the native task threads and this returns directly.
+/// Afterwards [requestID, address] is posted into the dart [port] where address is the new image (which has to be
+/// freed with cleanupMemory like the result of getImageOfWindow) or 0 if the capture failed. If the port is already
+/// closed when the capture is done, then the image is freed here.
+/// [format] is one of the PIXEL_FORMAT_ of color_convert.hpp (the index of the dart NativeImageType). Formats other
+/// than PIXEL_FORMAT_BGRA are converted while the capture is copied out of the platform buffer, so dart does not have
+/// to convert the image again. With a [downscale] factor bigger than 1 the image is averaged down to width / downscale
+/// x height / downscale pixel (see _captureImage). initDartApi must be called first. Returns false for invalid
+/// arguments (then nothing will be posted). Can be called from any thread.
+EXPORT bool captureAsync(int windowID, int x, int y, int width, int height, int format, int downscale,
+                         int64_t requestID, DartPort port);
+
+#endif //ASYNC_CAPTURE_H
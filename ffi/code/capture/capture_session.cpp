@@ -0,0 +1,387 @@
+#include "capture_session.hpp"
+#include "../image/color_convert.hpp"
+#include "../image/downscale.hpp"
+#include "../memory/buffer_pool.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+/// Bounding boxes of _capturePixels that are bigger than this are split, because capturing the empty space between
+/// far apart points takes longer than another capture
+#define _MAX_PIXEL_BOX_AREA (256 * 256)
+
+/// Splits of _capturePixelGroup deeper than this always use the median instead of the biggest gap, so that evenly
+/// spaced points (where every gap is the biggest) cannot recurse once per point
+#define _MAX_GAP_SPLIT_DEPTH 32
+
+/// Most free sessions that are kept per window id. More threads can still capture at the same time, but their sessions
+/// are destroyed afterwards instead of keeping their buffers and x server connections alive while they are idle
+#define _MAX_POOLED_SESSIONS 4
+
+/// Free sessions of one window id (see _PooledSession)
+struct _SessionPool
+{
+    std::vector<_CaptureSession *> free;
+    /// Incremented by _releaseCaptureSession, so that sessions that are in use are not put back afterwards
+    unsigned long long generation = 0;
+};
+
+/// One pool per window id and the last one is used for the main display (see _MAIN_DISPLAY_SESSION)
+_SessionPool _sessionPools[_MAX_WINDOWS + 1];
+
+/// Only held while a session is taken out of, or put back into a pool (never during a capture)
+std::mutex _sessionPoolMutex;
+
+/// Reuses the staging buffer of the [session] for at least [bytes] bytes and returns false if that failed
+inline bool _reserveStaging(_CaptureSession *session, size_t bytes)
+{
+    if ( bytes > session->stagingCapacity )
+    {
+        free(session->staging);
+        session->staging = (unsigned char *) malloc(bytes);
+        session->stagingCapacity = session->staging != 0 ? bytes : 0;
+    }
+    return session->staging != 0;
+}
+
+/// Returns the index into _sessionPools, or -1 for invalid ids
+inline int _sessionIndex(int windowID)
+{
+    if ( windowID == _MAIN_DISPLAY_SESSION )
+    {
+        return _MAX_WINDOWS;
+    }
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return -1;
+    }
+    return windowID;
+}
+
+_CaptureSession *_createCaptureSession()
+{
+    _CaptureSession *session = new _CaptureSession();
+    session->capture = _platformCreateCapture();
+    return session;
+}
+
+void _destroyCaptureSession(_CaptureSession *session)
+{
+    if ( session != 0 )
+    {
+        _platformDestroyCapture(session->capture);
+        free(session->staging);
+        delete session;
+    }
+}
+
+_PooledSession::_PooledSession(int windowID)
+{
+    index = _sessionIndex(windowID);
+    if ( index < 0 )
+    {
+        index = _sessionIndex(_MAIN_DISPLAY_SESSION);
+    }
+    unsigned long long generation;
+    {
+        std::lock_guard<std::mutex> lock(_sessionPoolMutex);
+        _SessionPool &pool = _sessionPools[index];
+        generation = pool.generation;
+        if ( !pool.free.empty())
+        {
+            session = pool.free.back();
+            pool.free.pop_back();
+            return;
+        }
+    }
+    session = _createCaptureSession(); // the platform resources are created outside of the lock
+    session->generation = generation;
+}
+
+_PooledSession::~_PooledSession()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sessionPoolMutex);
+        _SessionPool &pool = _sessionPools[index];
+        if ( session->generation == pool.generation && pool.free.size() < _MAX_POOLED_SESSIONS )
+        {
+            pool.free.push_back(session);
+            return;
+        }
+    }
+    _destroyCaptureSession(session);
+}
+
+void _releaseCaptureSession(int windowID)
+{
+    int index = _sessionIndex(windowID);
+    if ( index < 0 )
+    {
+        return;
+    }
+    std::vector<_CaptureSession *> released;
+    {
+        std::lock_guard<std::mutex> lock(_sessionPoolMutex);
+        _SessionPool &pool = _sessionPools[index];
+        ++pool.generation;
+        released.swap(pool.free);
+    }
+    for ( _CaptureSession *session : released )
+    {
+        _destroyCaptureSession(session);
+    }
+}
+
+bool _captureInto(int windowID, int x, int y, int width, int height, unsigned char *target, int targetStride)
+{
+    if ( target == 0 || width <= 0 || height <= 0 || targetStride < width * 4 )
+    {
+        return false;
+    }
+    _PooledSession pooled(windowID);
+    return _platformCaptureWith(pooled.session->capture, x, y, width, height, target, targetStride);
+}
+
+/// Captures the area with the [session] into its staging buffer and then writes each averaged row of _downscaleRow
+/// (converted into the format if [convert] is not 0) into [target] with [outWidth] x [outHeight] pixel
+inline bool _captureDownscaled(_CaptureSession *session, int x, int y, int outWidth, int outHeight, int downscale,
+                               CaptureRowConverter convert, int channels, unsigned char *target)
+{
+    int sourceWidth = outWidth * downscale;
+    size_t sourceStride = (size_t) sourceWidth * 4;
+    if ( !_reserveStaging(session, sourceStride * outHeight * downscale) ||
+         !_platformCaptureWith(session->capture, x, y, sourceWidth, outHeight * downscale, session->staging,
+                               (int) sourceStride))
+    {
+        return false;
+    }
+    std::vector<unsigned char> bgraRow(convert != 0 ? (size_t) outWidth * 4 : 0); // only needed for conversions
+    for ( int row = 0; row < outHeight; ++row )
+    {
+        const unsigned char *source = session->staging + (size_t) row * downscale * sourceStride;
+        unsigned char *out = target + (size_t) row * outWidth * channels;
+        if ( convert != 0 )
+        {
+            _downscaleRow(source, (int) sourceStride, outWidth, downscale, bgraRow.data());
+            convert(bgraRow.data(), outWidth, out);
+        } else
+        {
+            _downscaleRow(source, (int) sourceStride, outWidth, downscale, out);
+        }
+    }
+    return true;
+}
+
+unsigned char *_captureImage(int windowID, int x, int y, int width, int height, int format, int downscale)
+{
+    int channels = _pixelFormatChannels(format);
+    if ( width <= 0 || height <= 0 || channels == 0 || downscale < 1 || downscale > _MAX_DOWNSCALE )
+    {
+        return 0;
+    }
+    int outWidth = width / downscale;
+    int outHeight = height / downscale;
+    if ( outWidth == 0 || outHeight == 0 )
+    {
+        return 0;
+    }
+    unsigned char *array = _allocateBuffer((size_t) outHeight * outWidth * channels); // 8 bit per channel
+    if ( array == 0 )
+    {
+        return 0;
+    }
+    bool captured;
+    {
+        _PooledSession pooled(windowID);
+        if ( downscale > 1 )
+        {
+            captured = _captureDownscaled(pooled.session, x, y, outWidth, outHeight, downscale,
+                                          _bgraRowConverter(format), channels, array);
+        } else
+        {
+            captured = _platformCaptureConverted(pooled.session->capture, x, y, width, height, array,
+                                                 width * channels, _bgraRowConverter(format), channels);
+        }
+    }
+    if ( !captured )
+    {
+        _releaseBuffer(array);
+        return 0;
+    }
+    return array;
+}
+
+int _captureRegions(int windowID, const RECT *rects, int count, unsigned char **outBuffers)
+{
+    if ( rects == 0 || outBuffers == 0 || count <= 0 )
+    {
+        return 0;
+    }
+    RECT box{0, 0, 0, 0};
+    bool hasRegion = false;
+    for ( int i = 0; i < count; ++i )
+    {
+        const RECT &rect = rects[i];
+        if ( rect.right <= rect.left || rect.bottom <= rect.top )
+        {
+            continue; // empty regions are skipped
+        }
+        if ( !hasRegion )
+        {
+            box = rect;
+            hasRegion = true;
+        } else
+        {
+            box.left = rect.left < box.left ? rect.left : box.left;
+            box.top = rect.top < box.top ? rect.top : box.top;
+            box.right = rect.right > box.right ? rect.right : box.right;
+            box.bottom = rect.bottom > box.bottom ? rect.bottom : box.bottom;
+        }
+    }
+    if ( !hasRegion )
+    {
+        return 0;
+    }
+    _PooledSession pooled(windowID);
+    _CaptureSession *session = pooled.session;
+    int boxWidth = box.right - box.left;
+    int boxHeight = box.bottom - box.top;
+    size_t boxStride = (size_t) boxWidth * 4;
+    if ( !_reserveStaging(session, boxStride * boxHeight))
+    {
+        return 0;
+    }
+    if ( !_platformCaptureWith(session->capture, box.left, box.top, boxWidth, boxHeight, session->staging,
+                               (int) boxStride))
+    {
+        return 0;
+    }
+    // now scatter the regions out of the bounding box
+    int captured = 0;
+    for ( int i = 0; i < count; ++i )
+    {
+        const RECT &rect = rects[i];
+        if ( rect.right <= rect.left || rect.bottom <= rect.top )
+        {
+            continue;
+        }
+        size_t rowBytes = (size_t) (rect.right - rect.left) * 4;
+        int height = rect.bottom - rect.top;
+        if ( outBuffers[i] == 0 )
+        {
+            outBuffers[i] = _allocateBuffer(rowBytes * height);
+            if ( outBuffers[i] == 0 )
+            {
+                continue;
+            }
+        }
+        const unsigned char *source = session->staging + (size_t) (rect.top - box.top) * boxStride +
+                                      (size_t) (rect.left - box.left) * 4;
+        for ( int row = 0; row < height; ++row )
+        {
+            memcpy(outBuffers[i] + row * rowBytes, source + row * boxStride, rowBytes);
+        }
+        ++captured;
+    }
+    return captured;
+}
+
+/// Captures the points of [indices] from [begin] to [end] of _capturePixels with one bounding box, or splits them
+/// along the longer side of the box if it is too big: at the biggest gap if it is at least twice as big as every other
+/// one, otherwise (or past the [depth] limit) at the median, so the recursion stays logarithmic
+int _capturePixelGroup(_CaptureSession *session, const POINT *points, std::vector<int> &indices, size_t begin,
+                       size_t end, unsigned long *outColors, int depth)
+{
+    RECT box{points[indices[begin]].x, points[indices[begin]].y, points[indices[begin]].x + 1,
+             points[indices[begin]].y + 1};
+    for ( size_t i = begin + 1; i < end; ++i )
+    {
+        const POINT &point = points[indices[i]];
+        box.left = std::min(box.left, point.x); // both are LONG on windows
+        box.top = std::min(box.top, point.y);
+        box.right = std::max(box.right, point.x + 1);
+        box.bottom = std::max(box.bottom, point.y + 1);
+    }
+    int boxWidth = box.right - box.left;
+    int boxHeight = box.bottom - box.top;
+    if ( (long long) boxWidth * boxHeight > _MAX_PIXEL_BOX_AREA && end - begin > 1 )
+    {
+        bool splitX = boxWidth >= boxHeight;
+        auto coordinate = [&](size_t i) { return splitX ? points[indices[i]].x : points[indices[i]].y; };
+        std::sort(indices.begin() + (long) begin, indices.begin() + (long) end, [&](int first, int second) {
+            return splitX ? points[first].x < points[second].x : points[first].y < points[second].y;
+        });
+        // split at a clearly biggest gap, so that clusters of close points stay together
+        size_t biggestAt = begin + 1;
+        long biggest = -1, second = -1;
+        for ( size_t i = begin + 1; i < end; ++i )
+        {
+            long gap = (long) coordinate(i) - (long) coordinate(i - 1);
+            if ( gap > biggest )
+            {
+                second = biggest;
+                biggest = gap;
+                biggestAt = i;
+            } else if ( gap > second )
+            {
+                second = gap;
+            }
+        }
+        size_t middle = begin + (end - begin) / 2;
+        if ( depth < _MAX_GAP_SPLIT_DEPTH && biggest > 0 && biggest >= 2 * second )
+        {
+            middle = biggestAt;
+        }
+        return _capturePixelGroup(session, points, indices, begin, middle, outColors, depth + 1) +
+               _capturePixelGroup(session, points, indices, middle, end, outColors, depth + 1);
+    }
+    size_t boxStride = (size_t) boxWidth * 4;
+    if ( !_reserveStaging(session, boxStride * boxHeight) ||
+         !_platformCaptureWith(session->capture, box.left, box.top, boxWidth, boxHeight, session->staging,
+                               (int) boxStride))
+    {
+        return 0;
+    }
+    for ( size_t i = begin; i < end; ++i )
+    {
+        const POINT &point = points[indices[i]];
+        const unsigned char *bgra = session->staging + (size_t) (point.y - box.top) * boxStride +
+                                    (size_t) (point.x - box.left) * 4;
+        outColors[indices[i]] = (unsigned long) bgra[2] | ((unsigned long) bgra[1] << 8) |
+                                ((unsigned long) bgra[0] << 16);
+    }
+    return (int) (end - begin);
+}
+
+int _capturePixels(int windowID, const POINT *points, int count, unsigned long *outColors)
+{
+    _PooledSession pooled(windowID);
+    return _capturePixelsWith(pooled.session, points, count, outColors);
+}
+
+int _capturePixelsWith(_CaptureSession *session, const POINT *points, int count, unsigned long *outColors)
+{
+    if ( session == 0 || points == 0 || outColors == 0 || count <= 0 )
+    {
+        return 0;
+    }
+    int displayWidth = (int) _platformGetDisplayWidth();
+    int displayHeight = (int) _platformGetDisplayHeight();
+    std::vector<int> indices;
+    indices.reserve((size_t) count);
+    for ( int i = 0; i < count; ++i )
+    {
+        outColors[i] = _INVALID_PIXEL;
+        if ( points[i].x >= 0 && points[i].y >= 0 && points[i].x < displayWidth && points[i].y < displayHeight )
+        {
+            indices.push_back(i);
+        }
+    }
+    if ( indices.empty())
+    {
+        return 0;
+    }
+    return _capturePixelGroup(session, points, indices, 0, indices.size(), outColors, 0);
+}
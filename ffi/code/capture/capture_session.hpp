@@ -0,0 +1,85 @@
+#include "../platform/platform.hpp"
+#include <stddef.h>
+
+#ifndef CAPTURE_SESSION_H
+#define CAPTURE_SESSION_H
+
+/// Session id that is used for captures of the main display that are not related to a window
+# define _MAIN_DISPLAY_SESSION -1
+
+/// Capture resources with a reused staging buffer. Each one may only be used by one thread at a time
+struct _CaptureSession
+{
+    PlatformCapture *capture = 0;
+    /// Reused buffer for the bounding box of _captureRegions and _capturePixels (only grows)
+    unsigned char *staging = 0;
+    size_t stagingCapacity = 0;
+    /// Generation of the pool of the window id when it was taken out of it (see _releaseCaptureSession)
+    unsigned long long generation = 0;
+};
+
+/// Creates a new session that is not related to a window id (for threads other than the dart thread)
+_CaptureSession *_createCaptureSession();
+
+/// Frees all resources of a session of _createCaptureSession (may be 0)
+void _destroyCaptureSession(_CaptureSession *session);
+
+/// Every window id (0 to 99) and the main display (_MAIN_DISPLAY_SESSION) has a pool of persistent sessions, so that
+/// the platform resources are not created and destroyed for every capture. A capture takes a session out of the pool
+/// of its window and puts it back afterwards, so captures of the same window on different threads each use their
+/// own session (the pool keeps at most _MAX_POOLED_SESSIONS of them while they are idle). Invalid ids use the pool of
+/// the main display, because images are always of the main display.
+struct _PooledSession
+{
+    int index;
+    _CaptureSession *session;
+
+    explicit _PooledSession(int windowID);
+
+    /// Puts the session back into its pool (or destroys it if the pool was released in the meantime)
+    ~_PooledSession();
+
+    _PooledSession(const _PooledSession &) = delete;
+
+    _PooledSession &operator=(const _PooledSession &) = delete;
+};
+
+/// Frees the pooled capture resources of the [windowID] (they will be recreated on the next capture). Called when the
+/// window is re-initialized or closed, so that big buffers of old windows are not kept alive. Sessions that are used
+/// by a capture right now are destroyed when that capture is done. Can be called from any thread.
+void _releaseCaptureSession(int windowID);
+
+/// Captures the main display area with the session of the [windowID] directly into [target] which must have at least
+/// [height] rows of [targetStride] bytes (and targetStride must be at least width * 4). Returns false if it failed.
+bool _captureInto(int windowID, int x, int y, int width, int height, unsigned char *target, int targetStride);
+
+/// Returns a new pooled image (see _allocateBuffer) of the main display area that was captured with the session of the
+/// [windowID] (or 0 if it failed) in the [format] (one of the PIXEL_FORMAT_ of color_convert.hpp). Other formats than
+/// BGRA are converted while the rows are copied out of the capture memory, so they cost no extra pass over the image.
+///
+/// If [downscale] is bigger than 1 (up to _MAX_DOWNSCALE), then every block of downscale x downscale pixel is averaged
+/// into one pixel (see _downscaleRow), so the image only has width / downscale x height / downscale pixel (the rest
+/// at the right and bottom is cut off). The area is then captured into the staging buffer of the session and reduced
+/// and converted from there in a single pass.
+/// The returned memory must be freed with cleanupMemory!
+unsigned char *_captureImage(int windowID, int x, int y, int width, int height, int format, int downscale);
+
+/// Captures the bounding box of all [rects] (screen coordinates, right and bottom are exclusive) with one capture of
+/// the session of the [windowID] and then copies each region into [outBuffers] at the same index as tightly packed
+/// BGRA. If a buffer is 0, it will be allocated (then it must be freed with cleanupMemory). Empty rects are skipped.
+/// Returns the amount of regions that were captured (0 if the capture failed).
+int _captureRegions(int windowID, const RECT *rects, int count, unsigned char **outBuffers);
+
+/// Color of points in _capturePixels that could not be captured (same as CLR_INVALID of _platformGetScreenPixel)
+# define _INVALID_PIXEL 0xFFFFFFFFul
+
+/// Writes the colors of all [points] (screen coordinates) into [outColors] at the same index in the format 0x00bbggrr
+/// of _platformGetScreenPixel. Close points are captured together with one capture of their bounding box with the
+/// session of the [windowID] (points that are far apart are split into multiple smaller boxes). Points outside of the
+/// display, or of a failed capture are set to _INVALID_PIXEL. Returns the amount of valid colors.
+int _capturePixels(int windowID, const POINT *points, int count, unsigned long *outColors);
+
+/// Same as _capturePixels, but with the own [session] of the calling thread (which is not pooled)
+int _capturePixelsWith(_CaptureSession *session, const POINT *points, int count, unsigned long *outColors);
+
+#endif //CAPTURE_SESSION_H
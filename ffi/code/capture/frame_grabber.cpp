@@ -0,0 +1,268 @@
+#include "frame_grabber.hpp"
+#include "tile_hashes.hpp"
+#include "../memory/buffer_pool.hpp"
+#include "../native_window/native_window.hpp"
+#include "../record/session_recorder.hpp"
+#include "../share/frame_publisher.hpp"
+#include "../watch/pixel_watcher.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// One of the three buffers of a capture thread
+struct _FrameSlot
+{
+    unsigned char *data = 0;
+    size_t capacity = 0;
+    int width = 0;
+    int height = 0;
+    long long frameNumber = 0;
+};
+
+/// Set in _FrameGrabber::latest when the capture thread published a frame that was not acquired yet
+#define _NEW_FRAME_FLAG 4
+#define _SLOT_INDEX_MASK 3
+
+/// Triple buffer: the capture thread always writes into slots[writeIndex] and acquireLatestFrame only reads
+/// slots[readIndex]. The third slot index is stored in [latest] and both sides only swap their own index with it, so
+/// neither side ever waits for the other one.
+struct _FrameGrabber
+{
+    std::thread thread;
+    std::atomic<bool> running{false};
+    /// Only used to wake up the capture thread when it should stop
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    std::chrono::microseconds interval{0};
+    int windowID = 0;
+
+    /// Current window handle (set from the dart thread in acquireLatestFrame after the capture thread lost it)
+    std::atomic<WindowHandle> handle{0};
+    std::atomic<bool> handleLost{false};
+
+    _FrameSlot slots[3];
+    std::atomic<int> latest{0};
+    int writeIndex = 1;
+    int readIndex = 2;
+    long long frameCounter = 0;
+
+    /// Own capture resources that are only used from the capture thread
+    PlatformCapture *capture = 0;
+
+    /// Tile hashes of the newest frame and the frame number in which each tile changed the last time. Guarded by
+    /// [tileMutex], because changedTiles reads them from the dart thread
+    std::mutex tileMutex;
+    std::vector<uint64_t> tileHashes;
+    std::vector<long long> tileChanges;
+    int tileFrameWidth = 0;
+    int tileFrameHeight = 0;
+    long long tileFrameNumber = 0;
+    /// Only used from the capture thread
+    std::vector<uint64_t> newTileHashes;
+};
+
+/// Capture threads for every window id (0 if not running)
+_FrameGrabber *_frameGrabbers[_MAX_WINDOWS]{};
+
+/// Last frame number of a stopped capture thread, so that a restarted thread continues counting and old frame
+/// numbers in changedTiles are never mistaken for new frames
+long long _lastFrameNumbers[_MAX_WINDOWS]{};
+
+/// Hashes the tiles of the new frame in the [slot] and marks the changed ones with its frame number
+inline void _updateTiles(_FrameGrabber *grabber, const _FrameSlot &slot)
+{
+    _hashTiles(slot.data, slot.width, slot.height, slot.width * 4, grabber->newTileHashes);
+    std::lock_guard<std::mutex> lock(grabber->tileMutex);
+    if ( slot.width != grabber->tileFrameWidth || slot.height != grabber->tileFrameHeight )
+    {
+        // everything changed with the size
+        grabber->tileChanges.assign(grabber->newTileHashes.size(), slot.frameNumber);
+        grabber->tileFrameWidth = slot.width;
+        grabber->tileFrameHeight = slot.height;
+    } else
+    {
+        for ( size_t i = 0; i < grabber->newTileHashes.size(); ++i )
+        {
+            if ( grabber->newTileHashes[i] != grabber->tileHashes[i] )
+            {
+                grabber->tileChanges[i] = slot.frameNumber;
+            }
+        }
+    }
+    grabber->tileHashes.swap(grabber->newTileHashes);
+    grabber->tileFrameNumber = slot.frameNumber;
+}
+
+/// Captures one frame into the write slot and publishes it as the newest frame
+inline void _grabFrame(_FrameGrabber *grabber)
+{
+    WindowHandle handle = grabber->handle.load(std::memory_order_acquire);
+    RECT bounds;
+    POINT innerSize;
+    if ( handle == 0 || !_platformGetCaptureWindowArea(grabber->capture, handle, &bounds, &innerSize))
+    {
+        grabber->handleLost.store(true, std::memory_order_release);
+        return;
+    }
+    if ( innerSize.x <= 0 || innerSize.y <= 0 )
+    {
+        return; // minimized
+    }
+    _FrameSlot &slot = grabber->slots[grabber->writeIndex];
+    size_t bytes = (size_t) innerSize.x * innerSize.y * 4;
+    if ( bytes > slot.capacity )
+    {
+        _releaseBuffer(slot.data);
+        slot.data = _allocateBuffer(bytes); // the buffers of a restarted capture thread are reused from the pool
+        slot.capacity = slot.data != 0 ? bytes : 0;
+        if ( slot.data == 0 )
+        {
+            return;
+        }
+    }
+    POINT pos = _innerWindowPos(bounds, innerSize);
+    if ( !_platformCaptureWith(grabber->capture, pos.x, pos.y, innerSize.x, innerSize.y, slot.data, innerSize.x * 4))
+    {
+        return;
+    }
+    slot.width = innerSize.x;
+    slot.height = innerSize.y;
+    slot.frameNumber = ++grabber->frameCounter;
+    _updateTiles(grabber, slot);
+    // the new tile hashes are only written by this thread, so they can be read without the tile mutex
+    _recordFrame(grabber->windowID, slot.data, slot.width, slot.height, slot.frameNumber, bounds, grabber->tileHashes);
+    _publishFrame(grabber->windowID, slot.data, slot.width, slot.height, slot.frameNumber, bounds);
+    _watchFrame(grabber->windowID, slot.data, slot.width, slot.height);
+    int previous = grabber->latest.exchange(grabber->writeIndex | _NEW_FRAME_FLAG, std::memory_order_acq_rel);
+    grabber->writeIndex = previous & _SLOT_INDEX_MASK;
+}
+
+void _runFrameGrabber(_FrameGrabber *grabber)
+{
+    auto nextFrame = std::chrono::steady_clock::now();
+    while ( grabber->running.load(std::memory_order_acquire))
+    {
+        _grabFrame(grabber);
+        nextFrame += grabber->interval;
+        auto now = std::chrono::steady_clock::now();
+        if ( nextFrame < now )
+        {
+            nextFrame = now; // capturing is slower than the fps, so skip the missed frames instead of catching up
+        }
+        std::unique_lock<std::mutex> lock(grabber->stopMutex);
+        grabber->stopCondition.wait_until(lock, nextFrame, [grabber]() {
+            return !grabber->running.load(std::memory_order_acquire);
+        });
+    }
+}
+
+EXPORT bool startCaptureThread(int windowID, int framesPerSecond)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || framesPerSecond <= 0 )
+    {
+        return false;
+    }
+    stopCaptureThread(windowID);
+    _FrameGrabber *grabber = new _FrameGrabber();
+    grabber->capture = _platformCreateCapture();
+    grabber->windowID = windowID;
+    WindowHandle handle = _getWindowHandle(windowID);
+    grabber->handle.store(handle);
+    grabber->handleLost.store(handle == 0);
+    grabber->interval = std::chrono::microseconds(1000000 / framesPerSecond);
+    grabber->frameCounter = _lastFrameNumbers[windowID];
+    grabber->running.store(true);
+    grabber->thread = std::thread(_runFrameGrabber, grabber);
+    _frameGrabbers[windowID] = grabber;
+    return true;
+}
+
+EXPORT void stopCaptureThread(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || _frameGrabbers[windowID] == 0 )
+    {
+        return;
+    }
+    _FrameGrabber *grabber = _frameGrabbers[windowID];
+    _frameGrabbers[windowID] = 0;
+    {
+        std::lock_guard<std::mutex> lock(grabber->stopMutex);
+        grabber->running.store(false, std::memory_order_release);
+    }
+    grabber->stopCondition.notify_all();
+    grabber->thread.join();
+    _lastFrameNumbers[windowID] = grabber->frameCounter;
+    _platformDestroyCapture(grabber->capture);
+    for ( _FrameSlot &slot : grabber->slots )
+    {
+        _releaseBuffer(slot.data);
+    }
+    delete grabber;
+}
+
+EXPORT LatestFrame acquireLatestFrame(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || _frameGrabbers[windowID] == 0 )
+    {
+        return LatestFrame{0, 0, 0, 0};
+    }
+    _FrameGrabber *grabber = _frameGrabbers[windowID];
+    if ( grabber->handleLost.load(std::memory_order_acquire))
+    {
+        WindowHandle handle = _getWindowHandle(windowID); // the window lookup is only done on this thread
+        if ( handle != 0 )
+        {
+            grabber->handle.store(handle, std::memory_order_release);
+            grabber->handleLost.store(false, std::memory_order_release);
+        }
+    }
+    if ( grabber->latest.load(std::memory_order_acquire) & _NEW_FRAME_FLAG )
+    {
+        int previous = grabber->latest.exchange(grabber->readIndex, std::memory_order_acq_rel);
+        grabber->readIndex = previous & _SLOT_INDEX_MASK;
+    }
+    const _FrameSlot &slot = grabber->slots[grabber->readIndex];
+    return LatestFrame{slot.data, slot.width, slot.height, slot.frameNumber};
+}
+
+EXPORT int changedTiles(int windowID, RECT area, long long sinceFrame)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || _frameGrabbers[windowID] == 0 )
+    {
+        return -1;
+    }
+    _FrameGrabber *grabber = _frameGrabbers[windowID];
+    std::lock_guard<std::mutex> lock(grabber->tileMutex);
+    int width = grabber->tileFrameWidth;
+    int height = grabber->tileFrameHeight;
+    if ( grabber->tileChanges.empty() || sinceFrame <= 0 || sinceFrame > grabber->tileFrameNumber ||
+         area.left < 0 || area.top < 0 || area.right > width || area.bottom > height ||
+         area.left >= area.right || area.top >= area.bottom )
+    {
+        return -1;
+    }
+    int columns = _tileCount(width);
+    int changed = 0;
+    for ( int row = area.top / _TILE_SIZE; row <= (area.bottom - 1) / _TILE_SIZE; ++row )
+    {
+        for ( int column = area.left / _TILE_SIZE; column <= (area.right - 1) / _TILE_SIZE; ++column )
+        {
+            if ( grabber->tileChanges[(size_t) row * columns + column] > sinceFrame )
+            {
+                ++changed;
+            }
+        }
+    }
+    return changed;
+}
+
+void _onFrameGrabberWindowChanged(int windowID)
+{
+    if ( windowID >= 0 && windowID < _MAX_WINDOWS && _frameGrabbers[windowID] != 0 )
+    {
+        _frameGrabbers[windowID]->handleLost.store(true, std::memory_order_release);
+    }
+}
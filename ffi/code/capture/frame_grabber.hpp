@@ -0,0 +1,57 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+
+#ifndef FRAME_GRABBER_H
+#define FRAME_GRABBER_H
+
+/// Newest frame of a capture thread returned by acquireLatestFrame
+struct LatestFrame
+{
+    /// BGRA data with width * 4 bytes per row (0 if there was no frame captured yet). This memory is owned by the
+    /// capture thread and is only valid until the next acquireLatestFrame, or stopCaptureThread for the window!
+    unsigned char *data;
+    /// Inner size of the window when the frame was captured
+    int width;
+    int height;
+    /// Incremented for every captured frame starting at 1 (0 if there is no frame yet), so the same frame that was
+    /// already returned before can be detected. A restarted capture thread of the same window continues counting
+    long long frameNumber;
+};
+
+/// Starts an opt-in background thread for the window (0 to 99) which captures the whole inner window (same area as
+/// the inner overlay area in dart) [framesPerSecond] times per second into a triple buffer. Restarts the thread if
+/// it was already running. initWindow must be called first, but the window does not have to be open yet.
+/// Returns false for invalid arguments.
+EXPORT bool startCaptureThread(int windowID, int framesPerSecond);
+
+/// Stops and joins the capture thread of the window and frees its buffers (does nothing if it was not running)
+EXPORT void stopCaptureThread(int windowID);
+
+/// Returns the newest frame of the capture thread of the window without blocking (the capture thread is never
+/// waited for). If there is no new frame since the last call, the same frame is returned again. Returns a frame
+/// with data = 0 if there is no capture thread, or no frame yet.
+/// Only one thread may call this for the same window!
+EXPORT LatestFrame acquireLatestFrame(int windowID);
+
+/// Returns how many tiles of 32 x 32 pixels that overlap the [area] (relative to the inner window like the frames)
+/// changed in any frame of the capture thread after the frame [sinceFrame], so 0 means that the area still has the
+/// same pixels as in that frame. The capture thread keeps a hash of every tile of the previous frame for this, so no
+/// pixels are compared here.
+/// Returns -1 if the capture thread is not running, if it has no frame yet, if [sinceFrame] is not one of its frames,
+/// or if the [area] is not completely inside of the frame (right and bottom are exclusive).
+EXPORT int changedTiles(int windowID, RECT area, long long sinceFrame);
+
+/// Internal: same calculation as NativeOverlayWindow.getInnerOverlayAreaForWindow in dart, so that captures of the
+/// inner window from other threads have the same positions as GameWindow.getImage
+inline POINT _innerWindowPos(const RECT &bounds, const POINT &innerSize)
+{
+    int xOffset = (bounds.right - bounds.left) - innerSize.x;
+    int yOffset = (bounds.bottom - bounds.top) - innerSize.y;
+    return POINT{xOffset == 0 ? bounds.left : bounds.left + xOffset / 2,
+                 yOffset == 0 ? bounds.top : bounds.top + yOffset - xOffset / 2};
+}
+
+/// Internal: called from initWindow so that the capture thread looks up the window handle again
+void _onFrameGrabberWindowChanged(int windowID);
+
+#endif //FRAME_GRABBER_H
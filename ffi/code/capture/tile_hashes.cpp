@@ -0,0 +1,69 @@
+#include "tile_hashes.hpp"
+#include <string.h>
+
+/// Odd 64 bit constant, so that the multiplication is a bijection (one changed input word always changes the hash)
+#define _HASH_PRIME 0x9E3779B97F4A7C15ULL
+
+/// The rows of a tile are split into 4 independent lanes so that the multiplications don't wait for each other
+struct _TileHash
+{
+    uint64_t lanes[4];
+};
+
+inline uint64_t _mix(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * _HASH_PRIME;
+}
+
+/// Adds one row of a tile with [bytes] bytes (multiple of 4) to the [hash]
+inline void _hashTileRow(_TileHash &hash, const unsigned char *row, int bytes)
+{
+    int offset = 0;
+    for ( ; offset + 32 <= bytes; offset += 32 )
+    {
+        uint64_t words[4];
+        memcpy(words, row + offset, sizeof(words));
+        hash.lanes[0] = _mix(hash.lanes[0], words[0]);
+        hash.lanes[1] = _mix(hash.lanes[1], words[1]);
+        hash.lanes[2] = _mix(hash.lanes[2], words[2]);
+        hash.lanes[3] = _mix(hash.lanes[3], words[3]);
+    }
+    for ( int lane = 0; offset < bytes; offset += 4, lane = (lane + 1) & 3 )
+    {
+        uint32_t pixel;
+        memcpy(&pixel, row + offset, sizeof(pixel));
+        hash.lanes[lane] = _mix(hash.lanes[lane], pixel);
+    }
+}
+
+void _hashTiles(const unsigned char *data, int width, int height, int stride, std::vector<uint64_t> &outHashes)
+{
+    int columns = _tileCount(width);
+    int rows = _tileCount(height);
+    outHashes.resize((size_t) columns * rows);
+    std::vector<_TileHash> hashes((size_t) columns);
+    for ( int tileRow = 0; tileRow < rows; ++tileRow )
+    {
+        for ( int column = 0; column < columns; ++column )
+        {
+            hashes[(size_t) column] = _TileHash{{1, 2, 3, 4}};
+        }
+        // the rows of the frame are read in order, so all tiles of a tile row are hashed at the same time
+        int lastRow = (tileRow + 1) * _TILE_SIZE < height ? (tileRow + 1) * _TILE_SIZE : height;
+        for ( int y = tileRow * _TILE_SIZE; y < lastRow; ++y )
+        {
+            const unsigned char *row = data + (long long) y * stride;
+            for ( int column = 0; column < columns; ++column )
+            {
+                int left = column * _TILE_SIZE;
+                int pixels = left + _TILE_SIZE < width ? _TILE_SIZE : width - left;
+                _hashTileRow(hashes[(size_t) column], row + left * 4, pixels * 4);
+            }
+        }
+        for ( int column = 0; column < columns; ++column )
+        {
+            const uint64_t *lanes = hashes[(size_t) column].lanes;
+            outHashes[(size_t) tileRow * columns + column] = _mix(_mix(_mix(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+        }
+    }
+}
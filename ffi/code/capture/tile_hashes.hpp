@@ -0,0 +1,21 @@
+#ifndef TILE_HASHES_H
+#define TILE_HASHES_H
+
+#include <stdint.h>
+#include <vector>
+
+/// Internal: the capture threads keep one hash per tile of _TILE_SIZE x _TILE_SIZE pixels of the previous frame, so
+/// that unchanged areas can be detected with changedTiles without comparing pixels (see frame_grabber.hpp)
+#define _TILE_SIZE 32
+
+/// Amount of tiles in one direction for [pixels] pixels (the last tile may be smaller)
+inline int _tileCount(int pixels)
+{
+    return (pixels + _TILE_SIZE - 1) / _TILE_SIZE;
+}
+
+/// Hashes every tile of the BGRA [data] ([width] x [height] with rows of [stride] bytes) into [outHashes] (row by
+/// row, _tileCount(width) hashes per row). Every single changed pixel always changes the hash of its tile.
+void _hashTiles(const unsigned char *data, int width, int height, int stride, std::vector<uint64_t> &outHashes);
+
+#endif //TILE_HASHES_H
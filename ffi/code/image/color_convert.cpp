@@ -0,0 +1,268 @@
+#include "color_convert.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define _CONVERT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define _TARGET_SSSE3
+#else
+#define _TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif // #ifdef _MSC_VER
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+/// Fixed point weights of the opencv rgb to gray conversion (0.114, 0.587, 0.299 with 14 bits)
+#define _GRAY_SHIFT 14
+#define _GRAY_BLUE 1868
+#define _GRAY_GREEN 9617
+#define _GRAY_RED 4899
+
+/// Fixed point shift of the opencv 8 bit hsv tables
+#define _HSV_SHIFT 12
+
+/// 255 / value and 180 / (6 * diff) with _HSV_SHIFT bits for the saturation and hue of the 8 bit hsv conversion
+int _hsvSaturationDivisors[256];
+int _hsvHueDivisors[256];
+
+bool _initHsvTables()
+{
+    _hsvSaturationDivisors[0] = _hsvHueDivisors[0] = 0;
+    for ( int i = 1; i < 256; ++i )
+    {
+        _hsvSaturationDivisors[i] = (int) ((255 << _HSV_SHIFT) / (1.0 * i) + 0.5);
+        _hsvHueDivisors[i] = (int) ((180 << _HSV_SHIFT) / (6.0 * i) + 0.5);
+    }
+    return true;
+}
+
+const bool _hsvTablesReady = _initHsvTables();
+
+inline void _bgraToGrayScalar(const unsigned char *bgra, int width, unsigned char *target)
+{
+    for ( int x = 0; x < width; ++x, bgra += 4 )
+    {
+        target[x] = (unsigned char) ((bgra[0] * _GRAY_BLUE + bgra[1] * _GRAY_GREEN + bgra[2] * _GRAY_RED +
+                                      (1 << (_GRAY_SHIFT - 1))) >> _GRAY_SHIFT);
+    }
+}
+
+inline void _bgraToBgrScalar(const unsigned char *bgra, int width, unsigned char *target)
+{
+    for ( int x = 0; x < width; ++x, bgra += 4, target += 3 )
+    {
+        target[0] = bgra[0];
+        target[1] = bgra[1];
+        target[2] = bgra[2];
+    }
+}
+
+/// Same integer math as the 8 bit RGB2HSV_b of opencv, so the results are bit exact
+void _bgraToHsvScalar(const unsigned char *bgra, int width, unsigned char *target)
+{
+    const int round = 1 << (_HSV_SHIFT - 1);
+    for ( int x = 0; x < width; ++x, bgra += 4, target += 3 )
+    {
+        int b = bgra[0], g = bgra[1], r = bgra[2];
+        int value = b > g ? b : g;
+        value = value > r ? value : r;
+        int minimum = b < g ? b : g;
+        minimum = minimum < r ? minimum : r;
+        int diff = value - minimum;
+        int saturation = (diff * _hsvSaturationDivisors[value] + round) >> _HSV_SHIFT;
+        int hue;
+        if ( value == r )
+        {
+            hue = g - b;
+        } else if ( value == g )
+        {
+            hue = b - r + 2 * diff;
+        } else
+        {
+            hue = r - g + 4 * diff;
+        }
+        hue = (hue * _hsvHueDivisors[diff] + round) >> _HSV_SHIFT;
+        if ( hue < 0 )
+        {
+            hue += 180;
+        }
+        target[0] = (unsigned char) hue;
+        target[1] = (unsigned char) saturation;
+        target[2] = (unsigned char) value;
+    }
+}
+
+void _bgraToGray(const unsigned char *bgra, int width, unsigned char *target)
+{
+    _bgraToGrayScalar(bgra, width, target);
+}
+
+void _bgraToBgr(const unsigned char *bgra, int width, unsigned char *target)
+{
+    _bgraToBgrScalar(bgra, width, target);
+}
+
+#ifdef _CONVERT_X86
+
+/// Defined in image_compare.cpp
+bool _detectSsse3();
+
+const bool _convertWithSsse3 = _detectSsse3();
+
+/// 16 pixel per step: the weighted channels of 2 pixel are summed with one madd and the halves with hadd
+_TARGET_SSSE3 void _bgraToGraySsse3(const unsigned char *bgra, int width, unsigned char *target)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weights = _mm_setr_epi16(_GRAY_BLUE, _GRAY_GREEN, _GRAY_RED, 0, _GRAY_BLUE, _GRAY_GREEN,
+                                           _GRAY_RED, 0);
+    const __m128i round = _mm_set1_epi32(1 << (_GRAY_SHIFT - 1));
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        __m128i gray[4];
+        for ( int i = 0; i < 4; ++i )
+        {
+            __m128i pixels = _mm_loadu_si128((const __m128i *) (bgra + (x + i * 4) * 4));
+            __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+            __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+            gray[i] = _mm_srai_epi32(_mm_add_epi32(_mm_hadd_epi32(low, high), round), _GRAY_SHIFT);
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(gray[0], gray[1]), _mm_packs_epi32(gray[2], gray[3]));
+        _mm_storeu_si128((__m128i *) (target + x), packed);
+    }
+    _bgraToGrayScalar(bgra + x * 4, width - x, target + x);
+}
+
+/// 16 pixel per step: each 4 pixel are packed into 12 bytes and the 4 results are merged into 3 full stores
+_TARGET_SSSE3 void _bgraToBgrSsse3(const unsigned char *bgra, int width, unsigned char *target)
+{
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        __m128i first = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (bgra + x * 4)), pack);
+        __m128i second = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (bgra + x * 4 + 16)), pack);
+        __m128i third = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (bgra + x * 4 + 32)), pack);
+        __m128i fourth = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (bgra + x * 4 + 48)), pack);
+        unsigned char *out = target + x * 3;
+        _mm_storeu_si128((__m128i *) out, _mm_or_si128(first, _mm_slli_si128(second, 12)));
+        _mm_storeu_si128((__m128i *) (out + 16), _mm_or_si128(_mm_srli_si128(second, 4), _mm_slli_si128(third, 8)));
+        _mm_storeu_si128((__m128i *) (out + 32), _mm_or_si128(_mm_srli_si128(third, 8), _mm_slli_si128(fourth, 4)));
+    }
+    _bgraToBgrScalar(bgra + x * 4, width - x, target + x * 3);
+}
+
+#endif // #ifdef _CONVERT_X86
+
+#ifdef _CONVERT_NEON
+
+/// Weighted sum of 4 pixel with rounding (the same as the scalar version)
+inline uint16x4_t _grayNeon(uint16x4_t blue, uint16x4_t green, uint16x4_t red)
+{
+    uint32x4_t sum = vmull_n_u16(blue, _GRAY_BLUE);
+    sum = vmlal_n_u16(sum, green, _GRAY_GREEN);
+    sum = vmlal_n_u16(sum, red, _GRAY_RED);
+    return vrshrn_n_u32(sum, _GRAY_SHIFT);
+}
+
+/// 16 pixel per step with the channels deinterleaved while loading
+void _bgraToGrayNeon(const unsigned char *bgra, int width, unsigned char *target)
+{
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        uint8x16x4_t pixels = vld4q_u8(bgra + x * 4);
+        uint16x8_t blueLow = vmovl_u8(vget_low_u8(pixels.val[0]));
+        uint16x8_t greenLow = vmovl_u8(vget_low_u8(pixels.val[1]));
+        uint16x8_t redLow = vmovl_u8(vget_low_u8(pixels.val[2]));
+        uint16x8_t blueHigh = vmovl_u8(vget_high_u8(pixels.val[0]));
+        uint16x8_t greenHigh = vmovl_u8(vget_high_u8(pixels.val[1]));
+        uint16x8_t redHigh = vmovl_u8(vget_high_u8(pixels.val[2]));
+        uint16x8_t low = vcombine_u16(_grayNeon(vget_low_u16(blueLow), vget_low_u16(greenLow), vget_low_u16(redLow)),
+                                      _grayNeon(vget_high_u16(blueLow), vget_high_u16(greenLow),
+                                                vget_high_u16(redLow)));
+        uint16x8_t high = vcombine_u16(_grayNeon(vget_low_u16(blueHigh), vget_low_u16(greenHigh),
+                                                 vget_low_u16(redHigh)),
+                                       _grayNeon(vget_high_u16(blueHigh), vget_high_u16(greenHigh),
+                                                 vget_high_u16(redHigh)));
+        vst1q_u8(target + x, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+    _bgraToGrayScalar(bgra + x * 4, width - x, target + x);
+}
+
+void _bgraToBgrNeon(const unsigned char *bgra, int width, unsigned char *target)
+{
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        uint8x16x4_t pixels = vld4q_u8(bgra + x * 4);
+        uint8x16x3_t bgr;
+        bgr.val[0] = pixels.val[0], bgr.val[1] = pixels.val[1], bgr.val[2] = pixels.val[2];
+        vst3q_u8(target + x * 3, bgr);
+    }
+    _bgraToBgrScalar(bgra + x * 4, width - x, target + x * 3);
+}
+
+#endif // #ifdef _CONVERT_NEON
+
+int _pixelFormatChannels(int format)
+{
+    switch ( format )
+    {
+        case PIXEL_FORMAT_GRAY:
+            return 1;
+        case PIXEL_FORMAT_BGR:
+        case PIXEL_FORMAT_HSV:
+            return 3;
+        case PIXEL_FORMAT_BGRA:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+CaptureRowConverter _bgraRowConverter(int format)
+{
+    switch ( format )
+    {
+        case PIXEL_FORMAT_GRAY:
+#if defined(_CONVERT_X86)
+            return _convertWithSsse3 ? _bgraToGraySsse3 : _bgraToGray;
+#elif defined(_CONVERT_NEON)
+            return _bgraToGrayNeon;
+#else
+            return _bgraToGray;
+#endif
+        case PIXEL_FORMAT_BGR:
+#if defined(_CONVERT_X86)
+            return _convertWithSsse3 ? _bgraToBgrSsse3 : _bgraToBgr;
+#elif defined(_CONVERT_NEON)
+            return _bgraToBgrNeon;
+#else
+            return _bgraToBgr;
+#endif
+        case PIXEL_FORMAT_HSV:
+            return _bgraToHsvScalar;
+        default:
+            return 0;
+    }
+}
+
+void _convertRowScalar(const unsigned char *bgra, int width, unsigned char *target, int format)
+{
+    switch ( format )
+    {
+        case PIXEL_FORMAT_GRAY:
+            _bgraToGrayScalar(bgra, width, target);
+            break;
+        case PIXEL_FORMAT_BGR:
+            _bgraToBgrScalar(bgra, width, target);
+            break;
+        case PIXEL_FORMAT_HSV:
+            _bgraToHsvScalar(bgra, width, target);
+            break;
+        default:
+            break;
+    }
+}
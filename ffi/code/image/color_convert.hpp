@@ -0,0 +1,28 @@
+#include "../platform/platform.hpp"
+
+#ifndef COLOR_CONVERT_H
+#define COLOR_CONVERT_H
+
+/// Pixel formats of captures. The values are the same as the indexes of NativeImageType in dart (which are also the
+/// amount of channels for all formats except HSV)
+/// 1 channel with the same weights as the opencv COLOR_BGRA2GRAY (bit exact)
+# define PIXEL_FORMAT_GRAY 1
+/// 3 channels BGR (the alpha byte is dropped like COLOR_BGRA2BGR)
+# define PIXEL_FORMAT_BGR 3
+/// 4 channels BGRA (the default capture format without any conversion)
+# define PIXEL_FORMAT_BGRA 4
+/// 3 channels with the 8 bit ranges of the opencv COLOR_BGR2HSV (hue 0 to 179, saturation and value 0 to 255)
+# define PIXEL_FORMAT_HSV 6
+
+/// Returns the bytes per pixel of the [format] (or 0 if it is invalid)
+int _pixelFormatChannels(int format);
+
+/// Returns the function that converts rows of BGRA pixel into the [format] (see CaptureRowConverter). Uses SSSE3 on
+/// x86 (chosen at runtime) and NEON on arm64 for GRAY and BGR. Returns 0 for PIXEL_FORMAT_BGRA (no conversion needed)
+/// and for invalid formats.
+CaptureRowConverter _bgraRowConverter(int format);
+
+/// Internal: same as the converters of _bgraRowConverter, but without any simd (reference for tests and benchmarks)
+void _convertRowScalar(const unsigned char *bgra, int width, unsigned char *target, int format);
+
+#endif //COLOR_CONVERT_H
@@ -0,0 +1,108 @@
+#include "compare_batch.hpp"
+#include "image_compare.hpp"
+#include "../threading/worker_pool.hpp"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+/// Below this many compared pixels (summed over all offsets of all jobs) waking the worker threads takes longer than
+/// the comparison itself
+#define _MIN_PARALLEL_WORK 200000
+
+/// Amount of compared pixels of the [job] over all offsets (0 if it is outside of the [frameWidth] x [frameHeight])
+inline long long _jobWork(const CompareJob &job, int frameWidth, int frameHeight)
+{
+    long long width = std::min(job.x + job.width, frameWidth) - std::max(job.x, 0);
+    long long height = std::min(job.y + job.height, frameHeight) - std::max(job.y, 0);
+    if ( width <= 0 || height <= 0 )
+    {
+        return 0;
+    }
+    long long offsets = (2LL * std::max(job.maxShift, 0) + 1) * (2LL * std::max(job.maxShift, 0) + 1);
+    return width * height * offsets;
+}
+
+/// Compares a single [job] against its clipped area of the frame
+inline bool _runJob(const unsigned char *frame, int frameStride, int frameChannels, int frameWidth, int frameHeight,
+                    const CompareJob &job)
+{
+    if ( job.data == 0 || _jobWork(job, frameWidth, frameHeight) == 0 )
+    {
+        return false;
+    }
+    // the image is cut at the same side as the frame, so that both still start at the same pixel
+    int left = std::max(job.x, 0);
+    int top = std::max(job.y, 0);
+    int width = std::min(job.x + job.width, frameWidth) - left;
+    int height = std::min(job.y + job.height, frameHeight) - top;
+    const unsigned char *area = frame + (long long) top * frameStride + (long long) left * frameChannels;
+    const unsigned char *image = job.data + (long long) (top - job.y) * job.stride +
+                                 (long long) (left - job.x) * job.channels;
+    return shiftedCompare(area, frameStride, frameChannels, image, job.stride, job.channels, width, height,
+                          job.maxShift, job.threshold, job.maxBad, job.ignoreAlpha, 0, 0) == 1;
+}
+
+/// Sets the bits of the [results] (one byte per job) in [outResults] and returns the amount of equal jobs
+inline int _storeResults(const std::vector<unsigned char> &results, unsigned char *outResults)
+{
+    int equal = 0;
+    memset(outResults, 0, (results.size() + 7) / 8);
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        if ( results[i] )
+        {
+            outResults[i / 8] |= (unsigned char) (1 << (i % 8));
+            ++equal;
+        }
+    }
+    return equal;
+}
+
+EXPORT int compareBatch(const unsigned char *frame, int frameStride, int frameChannels, int frameWidth,
+                        int frameHeight, const CompareJob *jobs, int count, unsigned char *outResults)
+{
+    if ( frame == 0 || jobs == 0 || outResults == 0 || count < 0 )
+    {
+        return -1;
+    }
+    long long totalWork = 0;
+    for ( int i = 0; i < count; ++i )
+    {
+        totalWork += _jobWork(jobs[i], frameWidth, frameHeight);
+    }
+    if ( totalWork < _MIN_PARALLEL_WORK )
+    {
+        return _compareBatchSerial(frame, frameStride, frameChannels, frameWidth, frameHeight, jobs, count,
+                                   outResults);
+    }
+    // biggest jobs first, so that the small ones fill up the gaps at the end
+    std::vector<int> order((size_t) count);
+    for ( int i = 0; i < count; ++i )
+    {
+        order[(size_t) i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](int first, int second) {
+        return _jobWork(jobs[first], frameWidth, frameHeight) > _jobWork(jobs[second], frameWidth, frameHeight);
+    });
+    std::vector<unsigned char> results((size_t) count);
+    _parallelFor(count, [&](int index) {
+        int job = order[(size_t) index];
+        results[(size_t) job] = _runJob(frame, frameStride, frameChannels, frameWidth, frameHeight, jobs[job]);
+    });
+    return _storeResults(results, outResults);
+}
+
+int _compareBatchSerial(const unsigned char *frame, int frameStride, int frameChannels, int frameWidth,
+                        int frameHeight, const CompareJob *jobs, int count, unsigned char *outResults)
+{
+    if ( frame == 0 || jobs == 0 || outResults == 0 || count < 0 )
+    {
+        return -1;
+    }
+    std::vector<unsigned char> results((size_t) count);
+    for ( int i = 0; i < count; ++i )
+    {
+        results[(size_t) i] = _runJob(frame, frameStride, frameChannels, frameWidth, frameHeight, jobs[i]);
+    }
+    return _storeResults(results, outResults);
+}
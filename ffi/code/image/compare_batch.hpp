@@ -0,0 +1,40 @@
+#include "../exports.h"
+
+#ifndef COMPARE_BATCH_H
+#define COMPARE_BATCH_H
+
+/// One image of compareBatch that is compared against the area of the frame at its position (like CompareImage.isShown
+/// in dart with NativeImage.shiftedEquals)
+struct CompareJob
+{
+    /// The 8 bit image data with rows of [stride] bytes
+    const unsigned char *data;
+    int stride;
+    int channels;
+    int width;
+    int height;
+    /// Top left position of the image inside of the frame
+    int x;
+    int y;
+    /// Same as the parameter of shiftedCompare
+    int threshold;
+    int maxBad;
+    int maxShift;
+    bool ignoreAlpha;
+};
+
+/// Compares all [count] [jobs] against one captured [frame] (8 bit with [frameChannels] channels and rows of
+/// [frameStride] bytes) at once with shiftedCompare. The area of a job is clipped to the frame and a job with no
+/// area inside of the frame, or with channels that can not be compared, is not equal.
+/// The jobs are split between the shared worker threads if there is enough work, so this takes about as long as the
+/// biggest job instead of the sum of all.
+/// Writes the result of job i into the bit (i % 8) of the byte [outResults][i / 8] (1 if it was equal), so
+/// [outResults] must have at least (count + 7) / 8 bytes. Returns how many jobs were equal, or -1 for invalid args.
+EXPORT int compareBatch(const unsigned char *frame, int frameStride, int frameChannels, int frameWidth,
+                        int frameHeight, const CompareJob *jobs, int count, unsigned char *outResults);
+
+/// Internal: same as compareBatch, but always on the calling thread (reference for benchmarks)
+int _compareBatchSerial(const unsigned char *frame, int frameStride, int frameChannels, int frameWidth,
+                        int frameHeight, const CompareJob *jobs, int count, unsigned char *outResults);
+
+#endif //COMPARE_BATCH_H
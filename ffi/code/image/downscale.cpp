@@ -0,0 +1,166 @@
+#include "downscale.hpp"
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define _DOWNSCALE_X86
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _DOWNSCALE_NEON
+#include <arm_neon.h>
+#endif
+
+void _downscaleRowScalar(const unsigned char *source, int sourceStride, int outWidth, int factor,
+                         unsigned char *target)
+{
+    const int area = factor * factor;
+    for ( int x = 0; x < outWidth; ++x, target += 4 )
+    {
+        int sums[4] = {0, 0, 0, 0};
+        for ( int row = 0; row < factor; ++row )
+        {
+            const unsigned char *pixel = source + (size_t) row * sourceStride + (size_t) x * factor * 4;
+            for ( int column = 0; column < factor; ++column, pixel += 4 )
+            {
+                sums[0] += pixel[0];
+                sums[1] += pixel[1];
+                sums[2] += pixel[2];
+                sums[3] += pixel[3];
+            }
+        }
+        for ( int channel = 0; channel < 4; ++channel )
+        {
+            target[channel] = (unsigned char) ((sums[channel] + area / 2) / area);
+        }
+    }
+}
+
+#ifdef _DOWNSCALE_X86
+
+/// 4 output pixel per step: the 2 rows are added as 16 bit and then the neighbour pixel of each block
+inline int _downscale2Sse2(const unsigned char *source, int sourceStride, int outWidth, unsigned char *target)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+    int x = 0;
+    for ( ; x + 4 <= outWidth; x += 4 )
+    {
+        __m128i pixels[2];
+        for ( int half = 0; half < 2; ++half )
+        {
+            const unsigned char *top = source + (size_t) (x + half * 2) * 8;
+            __m128i first = _mm_loadu_si128((const __m128i *) top);
+            __m128i second = _mm_loadu_si128((const __m128i *) (top + sourceStride));
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(first, zero), _mm_unpacklo_epi8(second, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(first, zero), _mm_unpackhi_epi8(second, zero));
+            __m128i sums = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+            pixels[half] = _mm_srli_epi16(_mm_add_epi16(sums, round), 2);
+        }
+        _mm_storeu_si128((__m128i *) (target + x * 4), _mm_packus_epi16(pixels[0], pixels[1]));
+    }
+    return x;
+}
+
+/// 4 output pixel per step: the 4 rows of a block are added as 16 bit and then the 4 pixel of the block
+inline int _downscale4Sse2(const unsigned char *source, int sourceStride, int outWidth, unsigned char *target)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(8);
+    int x = 0;
+    for ( ; x + 4 <= outWidth; x += 4 )
+    {
+        __m128i pixels[2];
+        for ( int half = 0; half < 2; ++half )
+        {
+            __m128i blocks[2];
+            for ( int block = 0; block < 2; ++block )
+            {
+                const unsigned char *top = source + (size_t) (x + half * 2 + block) * 16;
+                __m128i low = zero;
+                __m128i high = zero;
+                for ( int row = 0; row < 4; ++row )
+                {
+                    __m128i values = _mm_loadu_si128((const __m128i *) (top + (size_t) row * sourceStride));
+                    low = _mm_add_epi16(low, _mm_unpacklo_epi8(values, zero));
+                    high = _mm_add_epi16(high, _mm_unpackhi_epi8(values, zero));
+                }
+                blocks[block] = _mm_add_epi16(low, high); // still 2 pixel per block
+            }
+            __m128i sums = _mm_add_epi16(_mm_unpacklo_epi64(blocks[0], blocks[1]),
+                                         _mm_unpackhi_epi64(blocks[0], blocks[1]));
+            pixels[half] = _mm_srli_epi16(_mm_add_epi16(sums, round), 4);
+        }
+        _mm_storeu_si128((__m128i *) (target + x * 4), _mm_packus_epi16(pixels[0], pixels[1]));
+    }
+    return x;
+}
+
+#endif // #ifdef _DOWNSCALE_X86
+
+#ifdef _DOWNSCALE_NEON
+
+/// 2 output pixel per step (the rounding shift is the same as the scalar rounding)
+inline int _downscale2Neon(const unsigned char *source, int sourceStride, int outWidth, unsigned char *target)
+{
+    int x = 0;
+    for ( ; x + 2 <= outWidth; x += 2 )
+    {
+        uint8x16_t first = vld1q_u8(source + (size_t) x * 8);
+        uint8x16_t second = vld1q_u8(source + sourceStride + (size_t) x * 8);
+        uint16x8_t low = vaddl_u8(vget_low_u8(first), vget_low_u8(second));
+        uint16x8_t high = vaddl_u8(vget_high_u8(first), vget_high_u8(second));
+        uint16x8_t sums = vcombine_u16(vadd_u16(vget_low_u16(low), vget_high_u16(low)),
+                                       vadd_u16(vget_low_u16(high), vget_high_u16(high)));
+        vst1_u8(target + x * 4, vrshrn_n_u16(sums, 2));
+    }
+    return x;
+}
+
+inline int _downscale4Neon(const unsigned char *source, int sourceStride, int outWidth, unsigned char *target)
+{
+    int x = 0;
+    for ( ; x + 2 <= outWidth; x += 2 )
+    {
+        uint16x4_t pixels[2];
+        for ( int block = 0; block < 2; ++block )
+        {
+            uint16x8_t low = vdupq_n_u16(0);
+            uint16x8_t high = vdupq_n_u16(0);
+            for ( int row = 0; row < 4; ++row )
+            {
+                uint8x16_t values = vld1q_u8(source + (size_t) row * sourceStride + (size_t) (x + block) * 16);
+                low = vaddw_u8(low, vget_low_u8(values));
+                high = vaddw_u8(high, vget_high_u8(values));
+            }
+            uint16x8_t sums = vaddq_u16(low, high);
+            pixels[block] = vadd_u16(vget_low_u16(sums), vget_high_u16(sums));
+        }
+        vst1_u8(target + x * 4, vrshrn_n_u16(vcombine_u16(pixels[0], pixels[1]), 4));
+    }
+    return x;
+}
+
+#endif // #ifdef _DOWNSCALE_NEON
+
+void _downscaleRow(const unsigned char *source, int sourceStride, int outWidth, int factor, unsigned char *target)
+{
+    int handled = 0;
+#if defined(_DOWNSCALE_X86)
+    if ( factor == 2 )
+    {
+        handled = _downscale2Sse2(source, sourceStride, outWidth, target);
+    } else if ( factor == 4 )
+    {
+        handled = _downscale4Sse2(source, sourceStride, outWidth, target);
+    }
+#elif defined(_DOWNSCALE_NEON)
+    if ( factor == 2 )
+    {
+        handled = _downscale2Neon(source, sourceStride, outWidth, target);
+    } else if ( factor == 4 )
+    {
+        handled = _downscale4Neon(source, sourceStride, outWidth, target);
+    }
+#endif
+    _downscaleRowScalar(source + (size_t) handled * factor * 4, sourceStride, outWidth - handled, factor,
+                        target + (size_t) handled * 4);
+}
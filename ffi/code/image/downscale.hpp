@@ -0,0 +1,17 @@
+#ifndef DOWNSCALE_H
+#define DOWNSCALE_H
+
+/// Biggest factor of _downscaleRow (so that the sums of a block still fit into 16 bits)
+# define _MAX_DOWNSCALE 16
+
+/// Averages every [factor] x [factor] block of BGRA pixel of [source] (rows of [sourceStride] bytes) into one BGRA
+/// pixel of [target], so [factor] rows of [outWidth] * [factor] pixel are read to write one row of [outWidth] pixel.
+/// All channels are rounded half up (the same as the opencv INTER_AREA resize for a factor of 2). Uses SSE2 on x86 and
+/// NEON on arm64 for the factors 2 and 4, and every other factor from 1 to _MAX_DOWNSCALE without simd.
+void _downscaleRow(const unsigned char *source, int sourceStride, int outWidth, int factor, unsigned char *target);
+
+/// Internal: same as _downscaleRow, but without any simd (reference for tests and benchmarks)
+void _downscaleRowScalar(const unsigned char *source, int sourceStride, int outWidth, int factor,
+                         unsigned char *target);
+
+#endif //DOWNSCALE_H
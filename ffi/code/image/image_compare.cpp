@@ -0,0 +1,582 @@
+#include "image_compare.hpp"
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define _COMPARE_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define _TARGET_AVX2
+#define _TARGET_SSSE3
+#else
+#define _TARGET_AVX2 __attribute__((target("avx2")))
+#define _TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif // #ifdef _MSC_VER
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _COMPARE_NEON
+#include <arm_neon.h>
+#endif
+
+/// Amount of channels that are compared per pixel (see compareTolerance) or 0 if the channels can't be compared
+inline int _comparedChannels(int channelsA, int channelsB, bool ignoreAlpha)
+{
+    if ( channelsA == 1 || channelsB == 1 )
+    {
+        return channelsA == channelsB ? 1 : 0;
+    }
+    if ( channelsA < 3 || channelsA > 4 || channelsB < 3 || channelsB > 4 )
+    {
+        return 0;
+    }
+    return channelsA == 4 && channelsB == 4 && !ignoreAlpha ? 4 : 3;
+}
+
+inline int _absDiff(int first, int second)
+{
+    return first > second ? first - second : second - first;
+}
+
+/// Counts the pixels of one row with a change higher than [threshold] without simd
+inline int _countRowScalar(const unsigned char *a, int channelsA, const unsigned char *b, int channelsB, int compared,
+                           int width, int threshold)
+{
+    int count = 0;
+    for ( int x = 0; x < width; ++x, a += channelsA, b += channelsB )
+    {
+        int change = _absDiff(a[0], b[0]);
+        if ( compared > 1 )
+        {
+            change += _absDiff(a[1], b[1]) + _absDiff(a[2], b[2]);
+            if ( compared == 4 )
+            {
+                change += _absDiff(a[3], b[3]);
+            }
+        }
+        if ( change > threshold )
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+inline int _bitCount(unsigned int bits)
+{
+    int count = 0;
+    for ( ; bits != 0; bits &= bits - 1 )
+    {
+        ++count;
+    }
+    return count;
+}
+
+/// Counts the pixels of a row. Returns the amount of pixels that were already handled in [handled] (the rest of the
+/// row is done by the caller with _countRowScalar)
+typedef int (*_RowCounter)(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled);
+
+#ifdef _COMPARE_X86
+
+/// Counts the pixels of 4 pixels with 4 channels each that have a sum of their absolute differences [diff] higher
+/// than [limit] (all 32 bit lanes)
+inline int _countPixels4(__m128i diff, __m128i limit)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    // channel pairs of each pixel as 32 bit, then pack and add again for the sum of each pixel
+    __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(diff, zero), ones);
+    __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(diff, zero), ones);
+    __m128i sums = _mm_madd_epi16(_mm_packs_epi32(low, high), ones);
+    return _bitCount((unsigned int) _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(sums, limit))));
+}
+
+inline __m128i _absDiffSse2(__m128i first, __m128i second)
+{
+    return _mm_or_si128(_mm_subs_epu8(first, second), _mm_subs_epu8(second, first));
+}
+
+/// 4 channels with all channels (or only 3 if the alpha byte is masked out by [mask]), 4 pixels per step
+inline int _countRow4Sse2(const unsigned char *a, const unsigned char *b, int width, int threshold, __m128i mask,
+                          int *handled)
+{
+    const __m128i limit = _mm_set1_epi32(threshold);
+    int count = 0;
+    int x = 0;
+    for ( ; x + 4 <= width; x += 4 )
+    {
+        __m128i first = _mm_loadu_si128((const __m128i *) (a + x * 4));
+        __m128i second = _mm_loadu_si128((const __m128i *) (b + x * 4));
+        count += _countPixels4(_mm_and_si128(_absDiffSse2(first, second), mask), limit);
+    }
+    *handled = x;
+    return count;
+}
+
+int _countRow4Sse2All(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow4Sse2(a, b, width, threshold, _mm_set1_epi32(-1), handled);
+}
+
+int _countRow4Sse2NoAlpha(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow4Sse2(a, b, width, threshold, _mm_set1_epi32(0x00FFFFFF), handled);
+}
+
+/// 1 channel with 16 pixels per step ([threshold] must be from 0 to 254, see _compareRows)
+int _countRow1Sse2(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    const __m128i above = _mm_set1_epi8((char) (threshold + 1));
+    int count = 0;
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        __m128i first = _mm_loadu_si128((const __m128i *) (a + x));
+        __m128i second = _mm_loadu_si128((const __m128i *) (b + x));
+        __m128i diff = _absDiffSse2(first, second);
+        // diff > threshold is the same as max(diff, threshold + 1) == diff
+        count += _bitCount((unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(diff, above), diff)));
+    }
+    *handled = x;
+    return count;
+}
+
+/// Loads 4 pixels of 3 channels (reads 16 bytes) and expands them to 4 channels with a zero alpha byte
+_TARGET_SSSE3 inline __m128i _load3As4(const unsigned char *pixels)
+{
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) pixels), expand);
+}
+
+/// 3 channels against 3 or 4 channels ([channelsA], [channelsB]) with 4 pixels per step. Packed 3 channel pixels are
+/// expanded to 4 channels and then compared without the alpha byte
+_TARGET_SSSE3 inline int _countRow3Ssse3(const unsigned char *a, int channelsA, const unsigned char *b, int channelsB,
+                                         int width, int threshold, int *handled)
+{
+    const __m128i limit = _mm_set1_epi32(threshold);
+    const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    int count = 0;
+    int x = 0;
+    for ( ; x + 6 <= width; x += 4 ) // 16 bytes are read from 3 channel rows, but only 12 are used
+    {
+        __m128i first = channelsA == 3 ? _load3As4(a + x * 3) : _mm_loadu_si128((const __m128i *) (a + x * 4));
+        __m128i second = channelsB == 3 ? _load3As4(b + x * 3) : _mm_loadu_si128((const __m128i *) (b + x * 4));
+        count += _countPixels4(_mm_and_si128(_absDiffSse2(first, second), mask), limit);
+    }
+    *handled = x;
+    return count;
+}
+
+_TARGET_SSSE3 int _countRow33Ssse3(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                   int *handled)
+{
+    return _countRow3Ssse3(a, 3, b, 3, width, threshold, handled);
+}
+
+_TARGET_SSSE3 int _countRow34Ssse3(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                   int *handled)
+{
+    return _countRow3Ssse3(a, 3, b, 4, width, threshold, handled);
+}
+
+_TARGET_SSSE3 int _countRow43Ssse3(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                   int *handled)
+{
+    return _countRow3Ssse3(a, 4, b, 3, width, threshold, handled);
+}
+
+_TARGET_AVX2 inline int _countRow4Avx2(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                       __m256i mask, int *handled)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i limit = _mm256_set1_epi32(threshold);
+    int count = 0;
+    int x = 0;
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        __m256i first = _mm256_loadu_si256((const __m256i *) (a + x * 4));
+        __m256i second = _mm256_loadu_si256((const __m256i *) (b + x * 4));
+        __m256i diff = _mm256_and_si256(_mm256_sub_epi8(_mm256_max_epu8(first, second),
+                                                        _mm256_min_epu8(first, second)), mask);
+        // same as the sse2 version per 128 bit lane (the order of the pixels does not matter for counting)
+        __m256i low = _mm256_madd_epi16(_mm256_unpacklo_epi8(diff, zero), ones);
+        __m256i high = _mm256_madd_epi16(_mm256_unpackhi_epi8(diff, zero), ones);
+        __m256i sums = _mm256_madd_epi16(_mm256_packs_epi32(low, high), ones);
+        count += _bitCount((unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(sums, limit))));
+    }
+    *handled = x;
+    return count;
+}
+
+_TARGET_AVX2 int _countRow4Avx2All(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                   int *handled)
+{
+    return _countRow4Avx2(a, b, width, threshold, _mm256_set1_epi32(-1), handled);
+}
+
+_TARGET_AVX2 int _countRow4Avx2NoAlpha(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                       int *handled)
+{
+    return _countRow4Avx2(a, b, width, threshold, _mm256_set1_epi32(0x00FFFFFF), handled);
+}
+
+_TARGET_AVX2 int _countRow1Avx2(const unsigned char *a, const unsigned char *b, int width, int threshold,
+                                int *handled)
+{
+    const __m256i above = _mm256_set1_epi8((char) (threshold + 1));
+    int count = 0;
+    int x = 0;
+    for ( ; x + 32 <= width; x += 32 )
+    {
+        __m256i first = _mm256_loadu_si256((const __m256i *) (a + x));
+        __m256i second = _mm256_loadu_si256((const __m256i *) (b + x));
+        __m256i diff = _mm256_sub_epi8(_mm256_max_epu8(first, second), _mm256_min_epu8(first, second));
+        count += _bitCount((unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(diff, above), diff)));
+    }
+    *handled = x;
+    return count;
+}
+
+bool _detectSsse3()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif // #ifdef _MSC_VER
+}
+
+/// Checks the cpu and the os support (saved ymm registers) for avx2 once
+bool _detectAvx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if ( info[0] < 7 )
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSupport = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSupport && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif // #ifdef _MSC_VER
+}
+
+const bool _hasSsse3 = _detectSsse3();
+const bool _hasAvx2 = _detectAvx2();
+
+#endif // #ifdef _COMPARE_X86
+
+#ifdef _COMPARE_NEON
+
+inline int _countRow4Neon(const unsigned char *a, const unsigned char *b, int width, int threshold, uint8x16_t mask,
+                          int *handled)
+{
+    const int32x4_t limit = vdupq_n_s32(threshold);
+    uint32x4_t counts = vdupq_n_u32(0);
+    int x = 0;
+    for ( ; x + 4 <= width; x += 4 )
+    {
+        uint8x16_t diff = vandq_u8(vabdq_u8(vld1q_u8(a + x * 4), vld1q_u8(b + x * 4)), mask);
+        uint32x4_t sums = vpaddlq_u16(vpaddlq_u8(diff));
+        // compare results are all bits set (-1), so subtracting them counts
+        counts = vsubq_u32(counts, vcgtq_s32(vreinterpretq_s32_u32(sums), limit));
+    }
+    *handled = x;
+    return (int) vaddvq_u32(counts);
+}
+
+int _countRow4NeonAll(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow4Neon(a, b, width, threshold, vdupq_n_u8(0xFF), handled);
+}
+
+int _countRow4NeonNoAlpha(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow4Neon(a, b, width, threshold, vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF)), handled);
+}
+
+/// 3 channels against 3 or 4 channels with 16 pixels per step (the channels are deinterleaved while loading)
+inline int _countRow3Neon(const unsigned char *a, int channelsA, const unsigned char *b, int channelsB, int width,
+                          int threshold, int *handled)
+{
+    const uint16x8_t limit = vdupq_n_u16((uint16_t) threshold);
+    int count = 0;
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        uint8x16_t first[3], second[3];
+        if ( channelsA == 4 )
+        {
+            uint8x16x4_t pixels = vld4q_u8(a + x * 4);
+            first[0] = pixels.val[0], first[1] = pixels.val[1], first[2] = pixels.val[2];
+        } else
+        {
+            uint8x16x3_t pixels = vld3q_u8(a + x * 3);
+            first[0] = pixels.val[0], first[1] = pixels.val[1], first[2] = pixels.val[2];
+        }
+        if ( channelsB == 4 )
+        {
+            uint8x16x4_t pixels = vld4q_u8(b + x * 4);
+            second[0] = pixels.val[0], second[1] = pixels.val[1], second[2] = pixels.val[2];
+        } else
+        {
+            uint8x16x3_t pixels = vld3q_u8(b + x * 3);
+            second[0] = pixels.val[0], second[1] = pixels.val[1], second[2] = pixels.val[2];
+        }
+        uint8x16_t diff0 = vabdq_u8(first[0], second[0]);
+        uint8x16_t diff1 = vabdq_u8(first[1], second[1]);
+        uint8x16_t diff2 = vabdq_u8(first[2], second[2]);
+        uint16x8_t low = vaddq_u16(vaddl_u8(vget_low_u8(diff0), vget_low_u8(diff1)), vmovl_u8(vget_low_u8(diff2)));
+        uint16x8_t high = vaddq_u16(vaddl_u8(vget_high_u8(diff0), vget_high_u8(diff1)),
+                                    vmovl_u8(vget_high_u8(diff2)));
+        count += vaddvq_u16(vshrq_n_u16(vcgtq_u16(low, limit), 15)) +
+                 vaddvq_u16(vshrq_n_u16(vcgtq_u16(high, limit), 15));
+    }
+    *handled = x;
+    return count;
+}
+
+int _countRow33Neon(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow3Neon(a, 3, b, 3, width, threshold, handled);
+}
+
+int _countRow34Neon(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow3Neon(a, 3, b, 4, width, threshold, handled);
+}
+
+int _countRow43Neon(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    return _countRow3Neon(a, 4, b, 3, width, threshold, handled);
+}
+
+int _countRow1Neon(const unsigned char *a, const unsigned char *b, int width, int threshold, int *handled)
+{
+    const uint8x16_t limit = vdupq_n_u8((uint8_t) threshold);
+    int count = 0;
+    int x = 0;
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        uint8x16_t above = vcgtq_u8(vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x)), limit);
+        count += vaddvq_u8(vshrq_n_u8(above, 7));
+    }
+    *handled = x;
+    return count;
+}
+
+#endif // #ifdef _COMPARE_NEON
+
+/// Returns the simd row counter for the channels (or 0 if there is none and only _countRowScalar should be used)
+_RowCounter _getRowCounter(int channelsA, int channelsB, int compared)
+{
+#ifdef _COMPARE_X86
+    if ( channelsA == 3 || channelsB == 3 )
+    {
+        if ( !_hasSsse3 )
+        {
+            return 0; // packed 3 channel pixels need a shuffle
+        }
+        return channelsA == channelsB ? _countRow33Ssse3 : channelsA == 3 ? _countRow34Ssse3 : _countRow43Ssse3;
+    }
+    if ( _hasAvx2 )
+    {
+        return compared == 1 ? _countRow1Avx2 : compared == 4 ? _countRow4Avx2All : _countRow4Avx2NoAlpha;
+    }
+    return compared == 1 ? _countRow1Sse2 : compared == 4 ? _countRow4Sse2All : _countRow4Sse2NoAlpha;
+#elif defined(_COMPARE_NEON)
+    if ( channelsA == 3 || channelsB == 3 )
+    {
+        return channelsA == channelsB ? _countRow33Neon : channelsA == 3 ? _countRow34Neon : _countRow43Neon;
+    }
+    return compared == 1 ? _countRow1Neon : compared == 4 ? _countRow4NeonAll : _countRow4NeonNoAlpha;
+#else
+    return 0;
+#endif
+}
+
+/// Counts the pixels of one row with the simd [counter] (may be 0) and the rest with _countRowScalar.
+/// [threshold] must be lower than the max change of the [compared] channels (otherwise nothing can be counted)
+inline int _countRow(const unsigned char *rowA, int channelsA, const unsigned char *rowB, int channelsB, int width,
+                     int threshold, int compared, _RowCounter counter)
+{
+    if ( threshold < 0 )
+    {
+        return width; // every pixel is counted
+    }
+    int handled = 0;
+    int count = 0;
+    if ( counter != 0 )
+    {
+        count = counter(rowA, rowB, width, threshold, &handled);
+    }
+    return count + _countRowScalar(rowA + handled * channelsA, channelsA, rowB + handled * channelsB, channelsB,
+                                   compared, width - handled, threshold);
+}
+
+/// Shared loop over the rows with the early exit. [counter] may be 0 to only compare without simd
+int _compareRows(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                 int channelsB, int width, int height, int threshold, int maxBad, int compared, _RowCounter counter)
+{
+    if ( threshold >= compared * 255 )
+    {
+        return 0; // no pixel can be counted
+    }
+    int limit = maxBad > 0 ? maxBad : 0;
+    int count = 0;
+    for ( int y = 0; y < height; ++y )
+    {
+        count += _countRow(a + (long long) y * strideA, channelsA, b + (long long) y * strideB, channelsB, width,
+                           threshold, compared, counter);
+        if ( count > limit )
+        {
+            return count;
+        }
+    }
+    return count;
+}
+
+/// Rows of [a] that are compared for all offsets of shiftedCompare before the next rows are compared
+#define _SHIFT_BAND_ROWS 16
+
+/// One relative offset of shiftedCompare
+struct _Shift
+{
+    int x;
+    int y;
+    int count;
+    bool active;
+};
+
+int _shiftedRows(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                 int channelsB, int width, int height, int maxShift, int threshold, int maxBad, int compared,
+                 _RowCounter counter, int *outShiftX, int *outShiftY)
+{
+    if ( maxShift < 0 )
+    {
+        maxShift = 0;
+    }
+    std::vector<_Shift> shifts;
+    shifts.reserve((size_t) (2 * maxShift + 1) * (2 * maxShift + 1));
+    for ( int y = -maxShift; y <= maxShift; ++y )
+    {
+        for ( int x = -maxShift; x <= maxShift; ++x )
+        {
+            // shifts without any overlap can never be equal
+            bool overlaps = width - (x < 0 ? -x : x) > 0 && height - (y < 0 ? -y : y) > 0;
+            shifts.push_back({x, y, 0, overlaps});
+        }
+    }
+    int limit = maxBad > 0 ? maxBad : 0;
+    if ( threshold < compared * 255 )
+    {
+        // bands of rows of [a] for all shifts, so that the rows of both images are still cached for the next shift
+        int activeShifts = (int) shifts.size();
+        for ( int bandStart = 0; bandStart < height && activeShifts > 0; bandStart += _SHIFT_BAND_ROWS )
+        {
+            int bandEnd = bandStart + _SHIFT_BAND_ROWS < height ? bandStart + _SHIFT_BAND_ROWS : height;
+            activeShifts = 0;
+            for ( _Shift &shift : shifts )
+            {
+                int startA = shift.x > 0 ? shift.x : 0;
+                int startB = shift.x < 0 ? -shift.x : 0;
+                // pixel (xA, yA) of [a] is compared against (xA - shift.x, yA - shift.y) of [b]
+                for ( int rowA = bandStart; rowA < bandEnd && shift.active; ++rowA )
+                {
+                    int rowB = rowA - shift.y;
+                    if ( rowB < 0 || rowB >= height )
+                    {
+                        continue;
+                    }
+                    shift.count += _countRow(a + (long long) rowA * strideA + startA * channelsA, channelsA,
+                                             b + (long long) rowB * strideB + startB * channelsB, channelsB,
+                                             width - startA - startB, threshold, compared, counter);
+                    shift.active = shift.count <= limit;
+                }
+                activeShifts += shift.active ? 1 : 0;
+            }
+        }
+    }
+    // the best equal shift has the lowest count and then the smallest offset
+    const _Shift *best = 0;
+    for ( const _Shift &shift : shifts )
+    {
+        if ( !shift.active || (shift.count != 0 && shift.count > maxBad))
+        {
+            continue;
+        }
+        int distance = (shift.x < 0 ? -shift.x : shift.x) + (shift.y < 0 ? -shift.y : shift.y);
+        int bestDistance = best == 0 ? 0 : (best->x < 0 ? -best->x : best->x) + (best->y < 0 ? -best->y : best->y);
+        if ( best == 0 || shift.count < best->count || (shift.count == best->count && distance < bestDistance))
+        {
+            best = &shift;
+        }
+    }
+    if ( best == 0 )
+    {
+        return 0;
+    }
+    if ( outShiftX != 0 )
+    {
+        *outShiftX = best->x;
+    }
+    if ( outShiftY != 0 )
+    {
+        *outShiftY = best->y;
+    }
+    return 1;
+}
+
+int _compareToleranceScalar(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                            int channelsB, int width, int height, int threshold, int maxBad, bool ignoreAlpha)
+{
+    int compared = _comparedChannels(channelsA, channelsB, ignoreAlpha);
+    if ( compared == 0 || a == 0 || b == 0 )
+    {
+        return -1;
+    }
+    return _compareRows(a, strideA, channelsA, b, strideB, channelsB, width, height, threshold, maxBad, compared, 0);
+}
+
+EXPORT int compareTolerance(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                            int channelsB, int width, int height, int threshold, int maxBad, bool ignoreAlpha)
+{
+    int compared = _comparedChannels(channelsA, channelsB, ignoreAlpha);
+    if ( compared == 0 || a == 0 || b == 0 )
+    {
+        return -1;
+    }
+    return _compareRows(a, strideA, channelsA, b, strideB, channelsB, width, height, threshold, maxBad, compared,
+                        _getRowCounter(channelsA, channelsB, compared));
+}
+
+int _shiftedCompareScalar(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                          int channelsB, int width, int height, int maxShift, int threshold, int maxBad,
+                          bool ignoreAlpha, int *outShiftX, int *outShiftY)
+{
+    int compared = _comparedChannels(channelsA, channelsB, ignoreAlpha);
+    if ( compared == 0 || a == 0 || b == 0 )
+    {
+        return -1;
+    }
+    return _shiftedRows(a, strideA, channelsA, b, strideB, channelsB, width, height, maxShift, threshold, maxBad,
+                        compared, 0, outShiftX, outShiftY);
+}
+
+EXPORT int shiftedCompare(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                          int channelsB, int width, int height, int maxShift, int threshold, int maxBad,
+                          bool ignoreAlpha, int *outShiftX, int *outShiftY)
+{
+    int compared = _comparedChannels(channelsA, channelsB, ignoreAlpha);
+    if ( compared == 0 || a == 0 || b == 0 )
+    {
+        return -1;
+    }
+    return _shiftedRows(a, strideA, channelsA, b, strideB, channelsB, width, height, maxShift, threshold, maxBad,
+                        compared, _getRowCounter(channelsA, channelsB, compared), outShiftX, outShiftY);
+}
@@ -0,0 +1,39 @@
+#include "../exports.h"
+
+#ifndef IMAGE_COMPARE_H
+#define IMAGE_COMPARE_H
+
+/// Pixel per pixel comparison of two 8 bit images [a] and [b] (rows of [strideA] / [strideB] bytes with [channelsA] /
+/// [channelsB] channels) in the area [width] x [height] starting at the first pixel of both.
+/// This has the same semantics as NativeImage.equals in dart: the change of a pixel is the sum of the absolute
+/// differences of the compared channels (1 only against 1, 3 against 3 or 4 with only the first 3 channels, 4 against
+/// 4 with all channels or only the first 3 if [ignoreAlpha] is true). A pixel is counted if its change is higher than
+/// [threshold].
+/// Returns the amount of counted pixels, but stops counting after the row in which more than [maxBad] pixels were
+/// counted (so the images are equal if the result is not higher than [maxBad]). Returns -1 for invalid channels.
+/// Uses SSE2 / SSSE3 / AVX2 on x86 (chosen at runtime) and NEON on arm64.
+EXPORT int compareTolerance(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                            int channelsB, int width, int height, int threshold, int maxBad, bool ignoreAlpha);
+
+/// Internal: same as compareTolerance, but without any simd (reference for tests and benchmarks)
+int _compareToleranceScalar(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                            int channelsB, int width, int height, int threshold, int maxBad, bool ignoreAlpha);
+
+/// Same as compareTolerance, but for all relative offsets from -[maxShift] to +[maxShift] pixels in x and y direction
+/// between both images at once (so (2 * maxShift + 1)^2 offsets) like NativeImage.shiftedEquals in dart.
+/// [width] and [height] must be the minimum size of both images. For an offset (x, y) the pixel (px, py) of [a] is
+/// compared against the pixel (px - x, py - y) of [b] for the overlap of both (so x and y pixels are cut off).
+/// All offsets are counted row by row in a single pass over the images and offsets are dropped as soon as they have
+/// more than [maxBad] changed pixels.
+/// Returns 1 if any offset was equal and then writes the best one (lowest count, then smallest offset) into
+/// [outShiftX] and [outShiftY] (both may be 0). Returns 0 if no offset was equal and -1 for invalid channels.
+EXPORT int shiftedCompare(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                          int channelsB, int width, int height, int maxShift, int threshold, int maxBad,
+                          bool ignoreAlpha, int *outShiftX, int *outShiftY);
+
+/// Internal: same as shiftedCompare, but without any simd (reference for tests and benchmarks)
+int _shiftedCompareScalar(const unsigned char *a, int strideA, int channelsA, const unsigned char *b, int strideB,
+                          int channelsB, int width, int height, int maxShift, int threshold, int maxBad,
+                          bool ignoreAlpha, int *outShiftX, int *outShiftY);
+
+#endif //IMAGE_COMPARE_H
@@ -0,0 +1,525 @@
+#include "template_match.hpp"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define _MATCH_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _MATCH_NEON
+#include <arm_neon.h>
+#endif
+
+/// The template is not downsampled further if its smaller side would get below this
+#define _MIN_PYRAMID_TEMPLATE_SIZE 8
+#define _MAX_PYRAMID_LEVELS 5
+/// Best positions of the coarsest level that are refined on the finer levels
+#define _MATCH_CANDIDATES 16
+/// Positions of the coarsest level that are kept for a retry. If the best match has a lower confidence than
+/// [_RETRY_CONFIDENCE], the remaining ones are refined as well (for matches whose fine details are lost on the
+/// coarsest level) and only if that is not enough either, the search is repeated one level finer
+#define _RETRY_CANDIDATES 64
+#define _RETRY_CONFIDENCE 0.8
+/// Refined candidates with the lowest sad for which the confidence is calculated
+#define _CONFIDENCE_CANDIDATES 3
+/// Positions in each direction that are searched around a candidate on the next finer level
+#define _REFINE_RADIUS 2
+
+/// One level of the pyramid (also used for patches of the full resolution)
+struct _GrayImage
+{
+    std::vector<unsigned char> data;
+    int width = 0;
+    int height = 0;
+};
+
+struct _Candidate
+{
+    int x;
+    int y;
+    unsigned int sad;
+};
+
+/// Gray value of a pixel in BGR(A) order (or the only channel)
+inline int _grayOf(const unsigned char *pixel, int channels)
+{
+    return channels < 3 ? pixel[0] : (pixel[0] * 29 + pixel[1] * 150 + pixel[2] * 77 + 128) >> 8;
+}
+
+/// Gray copy of the area [x], [y], [width], [height] of the [image]
+void _toGray(const unsigned char *image, int stride, int channels, int x, int y, int width, int height,
+             _GrayImage &out)
+{
+    out.width = width;
+    out.height = height;
+    out.data.resize((size_t) width * height);
+    for ( int row = 0; row < height; ++row )
+    {
+        const unsigned char *source = image + (long long) (y + row) * stride + (long long) x * channels;
+        unsigned char *target = out.data.data() + (size_t) row * width;
+        for ( int col = 0; col < width; ++col, source += channels )
+        {
+            target[col] = (unsigned char) _grayOf(source, channels);
+        }
+    }
+}
+
+/// Same as _toGray, but directly with half the size (average of 2x2 pixels), so that the full resolution gray
+/// image is never needed for the pyramid
+void _toGrayHalf(const unsigned char *image, int stride, int channels, int x, int y, int width, int height,
+                 _GrayImage &out)
+{
+    out.width = width / 2;
+    out.height = height / 2;
+    out.data.resize((size_t) out.width * out.height);
+    for ( int row = 0; row < out.height; ++row )
+    {
+        const unsigned char *top = image + (long long) (y + row * 2) * stride + (long long) x * channels;
+        const unsigned char *bottom = top + stride;
+        unsigned char *target = out.data.data() + (size_t) row * out.width;
+        int col = 0;
+#ifdef _MATCH_SSE2
+        if ( channels == 4 )
+        {
+            // average the 2x2 colors first and then convert the 4 averaged pixels to gray at once
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i weights = _mm_setr_epi16(29, 150, 77, 0, 29, 150, 77, 0);
+            const __m128i round = _mm_set1_epi32(128);
+            for ( ; col + 4 <= out.width; col += 4, top += 32, bottom += 32 )
+            {
+                __m128i first = _mm_avg_epu8(_mm_loadu_si128((const __m128i *) top),
+                                             _mm_loadu_si128((const __m128i *) bottom));
+                __m128i second = _mm_avg_epu8(_mm_loadu_si128((const __m128i *) (top + 16)),
+                                              _mm_loadu_si128((const __m128i *) (bottom + 16)));
+                __m128 firstFloats = _mm_castsi128_ps(first);
+                __m128 secondFloats = _mm_castsi128_ps(second);
+                __m128i even = _mm_castps_si128(_mm_shuffle_ps(firstFloats, secondFloats, _MM_SHUFFLE(2, 0, 2, 0)));
+                __m128i odd = _mm_castps_si128(_mm_shuffle_ps(firstFloats, secondFloats, _MM_SHUFFLE(3, 1, 3, 1)));
+                __m128i pixels = _mm_avg_epu8(even, odd);
+                __m128 low = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights));
+                __m128 high = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights));
+                __m128i gray = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))),
+                                             _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))));
+                gray = _mm_srli_epi32(_mm_add_epi32(gray, round), 8);
+                gray = _mm_packus_epi16(_mm_packs_epi32(gray, zero), zero);
+                int packed = _mm_cvtsi128_si32(gray);
+                memcpy(target + col, &packed, 4);
+            }
+        }
+#endif
+        for ( ; col < out.width; ++col, top += channels * 2, bottom += channels * 2 )
+        {
+            int sum = _grayOf(top, channels) + _grayOf(top + channels, channels) + _grayOf(bottom, channels) +
+                      _grayOf(bottom + channels, channels);
+            target[col] = (unsigned char) ((sum + 2) >> 2);
+        }
+    }
+}
+
+/// Next pyramid level with half the size
+void _downsample(const _GrayImage &source, _GrayImage &out)
+{
+    out.width = source.width / 2;
+    out.height = source.height / 2;
+    out.data.resize((size_t) out.width * out.height);
+    for ( int row = 0; row < out.height; ++row )
+    {
+        const unsigned char *top = source.data.data() + (size_t) row * 2 * source.width;
+        const unsigned char *bottom = top + source.width;
+        unsigned char *target = out.data.data() + (size_t) row * out.width;
+        for ( int col = 0; col < out.width; ++col )
+        {
+            target[col] = (unsigned char) ((top[col * 2] + top[col * 2 + 1] + bottom[col * 2] + bottom[col * 2 + 1] +
+                                            2) >> 2);
+        }
+    }
+}
+
+/// Smooths the [image] with a 3x3 [1 2 1] kernel (borders are kept), so that the coarse search is less sensitive
+/// to details that are smaller than one pixel of the level (and not aligned in the same way in the template)
+void _blur(_GrayImage &image)
+{
+    if ( image.width < 3 || image.height < 3 )
+    {
+        return;
+    }
+    std::vector<unsigned short> rows((size_t) image.width * image.height);
+    for ( int y = 0; y < image.height; ++y )
+    {
+        const unsigned char *source = image.data.data() + (size_t) y * image.width;
+        unsigned short *target = rows.data() + (size_t) y * image.width;
+        target[0] = (unsigned short) (source[0] * 4);
+        target[image.width - 1] = (unsigned short) (source[image.width - 1] * 4);
+        for ( int x = 1; x + 1 < image.width; ++x )
+        {
+            target[x] = (unsigned short) (source[x - 1] + source[x] * 2 + source[x + 1]);
+        }
+    }
+    for ( int y = 0; y < image.height; ++y )
+    {
+        const unsigned short *above = rows.data() + (size_t) (y > 0 ? y - 1 : y) * image.width;
+        const unsigned short *middle = rows.data() + (size_t) y * image.width;
+        const unsigned short *below = rows.data() + (size_t) (y + 1 < image.height ? y + 1 : y) * image.width;
+        unsigned char *target = image.data.data() + (size_t) y * image.width;
+        for ( int x = 0; x < image.width; ++x )
+        {
+            target[x] = (unsigned char) ((above[x] + middle[x] * 2 + below[x] + 8) >> 4);
+        }
+    }
+}
+
+/// Sum of absolute differences of [width] bytes
+inline unsigned int _sadRow(const unsigned char *a, const unsigned char *b, int width)
+{
+    unsigned int sum = 0;
+    int x = 0;
+#ifdef _MATCH_SSE2
+    __m128i sums = _mm_setzero_si128();
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_loadu_si128((const __m128i *) (a + x)),
+                                                _mm_loadu_si128((const __m128i *) (b + x))));
+    }
+    for ( ; x + 8 <= width; x += 8 )
+    {
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(_mm_loadl_epi64((const __m128i *) (a + x)),
+                                                _mm_loadl_epi64((const __m128i *) (b + x))));
+    }
+    sum = (unsigned int) (_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#elif defined(_MATCH_NEON)
+    uint32x4_t sums = vdupq_n_u32(0);
+    for ( ; x + 16 <= width; x += 16 )
+    {
+        sums = vpadalq_u16(sums, vpaddlq_u8(vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x))));
+    }
+    sum = vaddvq_u32(sums);
+#endif
+    for ( ; x < width; ++x )
+    {
+        sum += a[x] > b[x] ? a[x] - b[x] : b[x] - a[x];
+    }
+    return sum;
+}
+
+/// Sum of absolute differences of the [templ] at [x], [y] of the [image]. Stops early if it gets higher than [limit]
+inline unsigned int _sadAt(const _GrayImage &image, int x, int y, const _GrayImage &templ, unsigned int limit)
+{
+    unsigned int sum = 0;
+    const unsigned char *source = image.data.data() + (size_t) y * image.width + x;
+    const unsigned char *pattern = templ.data.data();
+    for ( int row = 0; row < templ.height && sum <= limit; ++row )
+    {
+        sum += _sadRow(source, pattern, templ.width);
+        source += image.width;
+        pattern += templ.width;
+    }
+    return sum;
+}
+
+/// Searches all positions of the [image] and keeps the best [count] positions that are not too close to each other
+/// (sorted by their sad)
+void _findCandidates(const _GrayImage &image, const _GrayImage &templ, size_t count,
+                     std::vector<_Candidate> &candidates)
+{
+    candidates.clear();
+    int minDistanceX = templ.width / 2 > 1 ? templ.width / 2 : 1;
+    int minDistanceY = templ.height / 2 > 1 ? templ.height / 2 : 1;
+    for ( int y = 0; y + templ.height <= image.height; ++y )
+    {
+        for ( int x = 0; x + templ.width <= image.width; ++x )
+        {
+            unsigned int limit = candidates.size() < count ? 0xFFFFFFFF : candidates.back().sad;
+            unsigned int sad = _sadAt(image, x, y, templ, limit);
+            if ( sad >= limit )
+            {
+                continue;
+            }
+            // a close candidate is replaced if this one is better, so that one match does not take all places
+            size_t close = candidates.size();
+            for ( size_t i = 0; i < candidates.size(); ++i )
+            {
+                int dx = candidates[i].x - x;
+                int dy = candidates[i].y - y;
+                if ( dx < minDistanceX && dx > -minDistanceX && dy < minDistanceY && dy > -minDistanceY )
+                {
+                    close = i;
+                    break;
+                }
+            }
+            if ( close < candidates.size())
+            {
+                if ( candidates[close].sad <= sad )
+                {
+                    continue;
+                }
+                candidates.erase(candidates.begin() + (long) close);
+            } else if ( candidates.size() >= count )
+            {
+                candidates.pop_back();
+            }
+            size_t insert = 0;
+            while ( insert < candidates.size() && candidates[insert].sad <= sad )
+            {
+                ++insert;
+            }
+            candidates.insert(candidates.begin() + (long) insert, _Candidate{x, y, sad});
+        }
+    }
+}
+
+/// Moves [x], [y] to the best position within [_REFINE_RADIUS] of the [image] (whose top left corner is at
+/// [offsetX], [offsetY] of the whole level) and returns its sad
+unsigned int _refine(const _GrayImage &image, int offsetX, int offsetY, const _GrayImage &templ, int *x, int *y)
+{
+    unsigned int best = 0xFFFFFFFF;
+    int bestX = *x;
+    int bestY = *y;
+    for ( int y1 = *y - _REFINE_RADIUS; y1 <= *y + _REFINE_RADIUS; ++y1 )
+    {
+        for ( int x1 = *x - _REFINE_RADIUS; x1 <= *x + _REFINE_RADIUS; ++x1 )
+        {
+            int localX = x1 - offsetX;
+            int localY = y1 - offsetY;
+            if ( localX < 0 || localY < 0 || localX + templ.width > image.width ||
+                 localY + templ.height > image.height )
+            {
+                continue;
+            }
+            unsigned int sad = _sadAt(image, localX, localY, templ, best);
+            if ( sad < best )
+            {
+                best = sad;
+                bestX = x1;
+                bestY = y1;
+            }
+        }
+    }
+    *x = bestX;
+    *y = bestY;
+    return best;
+}
+
+/// Zero mean normalized cross correlation of the [templ] at [x], [y] of the [image] clamped to 0 to 1.
+/// Uses the first 3 channels if both have colors and otherwise the gray values
+double _correlationAt(const unsigned char *image, int imageStride, int imageChannels, int x, int y,
+                      const unsigned char *templ, int templStride, int templChannels, int templWidth, int templHeight)
+{
+    bool colors = imageChannels >= 3 && templChannels >= 3;
+    int compared = colors ? 3 : 1;
+    long long sumA = 0, sumB = 0, sumAA = 0, sumBB = 0, sumAB = 0;
+    for ( int row = 0; row < templHeight; ++row )
+    {
+        const unsigned char *a = image + (long long) (y + row) * imageStride + (long long) x * imageChannels;
+        const unsigned char *b = templ + (long long) row * templStride;
+        // 32 bit sums per row are enough (255 * 255 * 3 for each pixel)
+        unsigned int rowA = 0, rowB = 0, rowAA = 0, rowBB = 0, rowAB = 0;
+        for ( int col = 0; col < templWidth; ++col, a += imageChannels, b += templChannels )
+        {
+            if ( colors )
+            {
+                rowA += a[0] + a[1] + a[2];
+                rowB += b[0] + b[1] + b[2];
+                rowAA += a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+                rowBB += b[0] * b[0] + b[1] * b[1] + b[2] * b[2];
+                rowAB += a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+            } else
+            {
+                unsigned int valueA = (unsigned int) _grayOf(a, imageChannels);
+                unsigned int valueB = (unsigned int) _grayOf(b, templChannels);
+                rowA += valueA;
+                rowB += valueB;
+                rowAA += valueA * valueA;
+                rowBB += valueB * valueB;
+                rowAB += valueA * valueB;
+            }
+        }
+        sumA += rowA;
+        sumB += rowB;
+        sumAA += rowAA;
+        sumBB += rowBB;
+        sumAB += rowAB;
+    }
+    double count = (double) templWidth * templHeight * compared;
+    double varianceA = (double) sumAA - (double) sumA * (double) sumA / count;
+    double varianceB = (double) sumBB - (double) sumB * (double) sumB / count;
+    if ( varianceA < 1.0 || varianceB < 1.0 )
+    {
+        // flat areas have no correlation, so only their mean value is compared
+        if ( varianceA >= 1.0 || varianceB >= 1.0 )
+        {
+            return 0.0;
+        }
+        double meanDiff = fabs((double) sumA - (double) sumB) / count;
+        return 1.0 - meanDiff / 255.0;
+    }
+    double correlation = ((double) sumAB - (double) sumA * (double) sumB / count) / sqrt(varianceA * varianceB);
+    return correlation < 0.0 ? 0.0 : correlation > 1.0 ? 1.0 : correlation;
+}
+
+inline bool _validChannels(int channels)
+{
+    return channels == 1 || channels == 3 || channels == 4;
+}
+
+EXPORT TemplateMatch findTemplate(const unsigned char *image, int imageStride, int imageChannels, int imageWidth,
+                                  int imageHeight, const unsigned char *templ, int templStride, int templChannels,
+                                  int templWidth, int templHeight, const RECT *searchArea)
+{
+    TemplateMatch result{-1, -1, -1.0};
+    if ( image == 0 || templ == 0 || !_validChannels(imageChannels) || !_validChannels(templChannels) ||
+         templWidth <= 0 || templHeight <= 0 )
+    {
+        return result;
+    }
+    RECT area{0, 0, imageWidth, imageHeight};
+    if ( searchArea != 0 )
+    {
+        area.left = searchArea->left > 0 ? searchArea->left : 0;
+        area.top = searchArea->top > 0 ? searchArea->top : 0;
+        area.right = searchArea->right < imageWidth ? searchArea->right : imageWidth;
+        area.bottom = searchArea->bottom < imageHeight ? searchArea->bottom : imageHeight;
+    }
+    int areaWidth = area.right - area.left;
+    int areaHeight = area.bottom - area.top;
+    if ( areaWidth < templWidth || areaHeight < templHeight )
+    {
+        return result;
+    }
+    int levels = 0;
+    int smallerSide = templWidth < templHeight ? templWidth : templHeight;
+    while ( levels < _MAX_PYRAMID_LEVELS && (smallerSide >> (levels + 1)) >= _MIN_PYRAMID_TEMPLATE_SIZE )
+    {
+        ++levels;
+    }
+
+    // level 0 of the image is only converted to gray around the candidates (and completely if it is searched)
+    // and level 1 of both is created with the same conversion, so that their rounding is the same
+    std::vector<_GrayImage> templates((size_t) levels + 1);
+    std::vector<_GrayImage> images((size_t) levels + 1);
+    _toGray(templ, templStride, templChannels, 0, 0, templWidth, templHeight, templates[0]);
+    if ( levels > 0 )
+    {
+        _toGrayHalf(templ, templStride, templChannels, 0, 0, templWidth, templHeight, templates[1]);
+        _toGrayHalf(image, imageStride, imageChannels, area.left, area.top, areaWidth, areaHeight, images[1]);
+    }
+    for ( int level = 2; level <= levels; ++level )
+    {
+        _downsample(templates[level - 1], templates[level]);
+        _downsample(images[level - 1], images[level]);
+    }
+
+    std::vector<_Candidate> candidates;
+    std::vector<_Candidate> refined;
+    _GrayImage patch;
+    // searches the whole [startLevel] for up to [count] candidates
+    auto findCandidates = [&](int startLevel, size_t count) {
+        if ( startLevel == 0 && images[0].data.empty())
+        {
+            _toGray(image, imageStride, imageChannels, area.left, area.top, areaWidth, areaHeight, images[0]);
+        }
+        _GrayImage coarse = images[startLevel];
+        _GrayImage coarseTemplate = templates[startLevel];
+        _blur(coarse);
+        _blur(coarseTemplate);
+        _findCandidates(coarse, coarseTemplate, count, candidates);
+    };
+    // refines the candidates [first] to [last] of the [startLevel] down to level 0 and takes the best of them as
+    // result if its confidence is higher
+    auto refine = [&](int startLevel, size_t first, size_t last) {
+        refined.clear();
+        for ( size_t index = first; index < last && index < candidates.size(); ++index )
+        {
+            const _Candidate &candidate = candidates[index];
+            int x = candidate.x;
+            int y = candidate.y;
+            unsigned int sad = 0xFFFFFFFF;
+            for ( int level = startLevel - 1; level >= 0; --level )
+            {
+                x *= 2;
+                y *= 2;
+                if ( !images[level].data.empty())
+                {
+                    sad = _refine(images[level], 0, 0, templates[level], &x, &y);
+                    continue;
+                }
+                // only the gray area around the candidate that is needed for the refinement
+                int left = x - _REFINE_RADIUS > 0 ? x - _REFINE_RADIUS : 0;
+                int top = y - _REFINE_RADIUS > 0 ? y - _REFINE_RADIUS : 0;
+                int right = x + _REFINE_RADIUS + templWidth < areaWidth ? x + _REFINE_RADIUS + templWidth : areaWidth;
+                int bottom = y + _REFINE_RADIUS + templHeight < areaHeight ? y + _REFINE_RADIUS + templHeight
+                                                                           : areaHeight;
+                _toGray(image, imageStride, imageChannels, area.left + left, area.top + top, right - left,
+                        bottom - top, patch);
+                sad = _refine(patch, left, top, templates[0], &x, &y);
+            }
+            if ( startLevel == 0 )
+            {
+                sad = candidate.sad;
+            }
+            if ( sad == 0xFFFFFFFF || x < 0 || y < 0 || x + templWidth > areaWidth || y + templHeight > areaHeight )
+            {
+                continue; // the refinement found nothing inside of the area
+            }
+            size_t insert = 0;
+            while ( insert < refined.size() && refined[insert].sad <= sad )
+            {
+                ++insert;
+            }
+            refined.insert(refined.begin() + (long) insert, _Candidate{x, y, sad});
+        }
+        for ( size_t i = 0; i < refined.size() && i < _CONFIDENCE_CANDIDATES; ++i )
+        {
+            double confidence = _correlationAt(image, imageStride, imageChannels, area.left + refined[i].x,
+                                               area.top + refined[i].y, templ, templStride, templChannels,
+                                               templWidth, templHeight);
+            if ( confidence > result.confidence )
+            {
+                result = TemplateMatch{area.left + refined[i].x, area.top + refined[i].y, confidence};
+            }
+        }
+    };
+    findCandidates(levels, levels > 0 ? _RETRY_CANDIDATES : _MATCH_CANDIDATES);
+    refine(levels, 0, _MATCH_CANDIDATES);
+    if ( result.confidence < _RETRY_CONFIDENCE && levels > 0 )
+    {
+        refine(levels, _MATCH_CANDIDATES, _RETRY_CANDIDATES);
+    }
+    if ( result.confidence < _RETRY_CONFIDENCE && levels > 0 )
+    {
+        findCandidates(levels - 1, _MATCH_CANDIDATES);
+        refine(levels - 1, 0, _MATCH_CANDIDATES);
+    }
+    return result;
+}
+
+TemplateMatch _findTemplateExhaustive(const unsigned char *image, int imageStride, int imageChannels, int imageWidth,
+                                      int imageHeight, const unsigned char *templ, int templStride, int templChannels,
+                                      int templWidth, int templHeight)
+{
+    TemplateMatch result{-1, -1, -1.0};
+    if ( imageWidth < templWidth || imageHeight < templHeight )
+    {
+        return result;
+    }
+    _GrayImage grayImage, grayTemplate;
+    _toGray(image, imageStride, imageChannels, 0, 0, imageWidth, imageHeight, grayImage);
+    _toGray(templ, templStride, templChannels, 0, 0, templWidth, templHeight, grayTemplate);
+    unsigned int best = 0xFFFFFFFF;
+    for ( int y = 0; y + templHeight <= imageHeight; ++y )
+    {
+        for ( int x = 0; x + templWidth <= imageWidth; ++x )
+        {
+            unsigned int sad = _sadAt(grayImage, x, y, grayTemplate, best);
+            if ( sad < best )
+            {
+                best = sad;
+                result.x = x;
+                result.y = y;
+            }
+        }
+    }
+    result.confidence = _correlationAt(image, imageStride, imageChannels, result.x, result.y, templ, templStride,
+                                       templChannels, templWidth, templHeight);
+    return result;
+}
@@ -0,0 +1,39 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+
+#ifndef TEMPLATE_MATCH_H
+#define TEMPLATE_MATCH_H
+
+/// Result of findTemplate
+struct TemplateMatch
+{
+    /// Top left position of the best match in the image (-1 if there was none)
+    int x;
+    int y;
+    /// Normalized cross correlation of the best match from -1 to 1 (-1 if there was none)
+    double confidence;
+};
+
+/// Searches the best position of the template [templ] inside of the [image] (both 8 bit with 1, 3 or 4 channels in
+/// BGR(A) order and rows of [imageStride] / [templStride] bytes).
+/// If [searchArea] is not 0, only positions where the template is completely inside of it are checked (right and
+/// bottom are exclusive and it is clipped to the image).
+///
+/// The search is coarse to fine: a gray image pyramid is built (until the template would get smaller than 8 pixels)
+/// and the coarsest level is searched completely with the sum of absolute differences. The best candidates are then
+/// refined on each finer level around their position and the confidence of the few final positions with the lowest
+/// difference is the normalized cross correlation with the template at full resolution (over the color channels if both have them).
+/// If that confidence is low, more candidates of the coarsest level are refined and only then the search is repeated
+/// one level finer.
+/// So the confidence does not depend on brightness differences, but small templates with only few details may match
+/// at multiple positions!
+EXPORT TemplateMatch findTemplate(const unsigned char *image, int imageStride, int imageChannels, int imageWidth,
+                                  int imageHeight, const unsigned char *templ, int templStride, int templChannels,
+                                  int templWidth, int templHeight, const RECT *searchArea);
+
+/// Internal: searches every position at full resolution (only used as a reference for benchmarks)
+TemplateMatch _findTemplateExhaustive(const unsigned char *image, int imageStride, int imageChannels, int imageWidth,
+                                      int imageHeight, const unsigned char *templ, int templStride, int templChannels,
+                                      int templWidth, int templHeight);
+
+#endif //TEMPLATE_MATCH_H
@@ -0,0 +1,182 @@
+#include "buffer_pool.hpp"
+#include <stdint.h>
+#include <stdlib.h>
+#include <mutex>
+#include <vector>
+
+/// Smallest size class is 2 ^ _MIN_CLASS_EXPONENT bytes and bigger buffers than 2 ^ _MAX_CLASS_EXPONENT are not pooled
+#define _MIN_CLASS_EXPONENT 12
+#define _MAX_CLASS_EXPONENT 28
+
+/// Each power of two is split into this many classes, so a buffer wastes at most a quarter of its size
+#define _CLASSES_PER_EXPONENT 4
+
+#define _SIZE_CLASSES ((_MAX_CLASS_EXPONENT - _MIN_CLASS_EXPONENT) * _CLASSES_PER_EXPONENT + 1)
+
+/// Released buffers are only kept while the pool stays below these limits (otherwise they are freed directly)
+#define _MAX_POOLED_PER_CLASS 8
+#define _MAX_POOLED_BYTES (256ll * 1024 * 1024)
+
+/// Marks the header of a pooled buffer
+#define _BUFFER_MAGIC 0x42504f4cu
+
+/// Stored directly in front of every buffer of _allocateBuffer
+struct _BufferHeader
+{
+    void *allocation;
+    size_t capacity;
+    /// Index into _BufferPool::free, or -1 for buffers that are too big to be pooled
+    int sizeClass;
+    unsigned int magic;
+};
+
+struct _BufferPool
+{
+    std::mutex mutex;
+    std::vector<_BufferHeader *> free[_SIZE_CLASSES];
+    BufferPoolStats stats{0, 0, 0, 0, 0, 0};
+};
+
+_BufferPool _bufferPool;
+
+/// Returns the size class of [bytes] and writes its [capacity] (or -1 if it is too big to be pooled)
+inline int _sizeClass(size_t bytes, size_t *capacity)
+{
+    if ( bytes <= ((size_t) 1 << _MIN_CLASS_EXPONENT))
+    {
+        *capacity = (size_t) 1 << _MIN_CLASS_EXPONENT;
+        return 0;
+    }
+    int exponent = 0;
+    while ( ((size_t) 2 << exponent) < bytes )
+    {
+        ++exponent;
+    }
+    // now base < bytes <= 2 * base
+    size_t base = (size_t) 1 << exponent;
+    size_t step = base / _CLASSES_PER_EXPONENT;
+    size_t steps = (bytes - base + step - 1) / step;
+    *capacity = base + steps * step;
+    if ( exponent >= _MAX_CLASS_EXPONENT )
+    {
+        *capacity = bytes;
+        return -1;
+    }
+    return (exponent - _MIN_CLASS_EXPONENT) * _CLASSES_PER_EXPONENT + (int) steps;
+}
+
+inline _BufferHeader *_headerOf(unsigned char *data)
+{
+    return (_BufferHeader *) (data - sizeof(_BufferHeader));
+}
+
+inline unsigned char *_dataOf(_BufferHeader *header)
+{
+    return (unsigned char *) header + sizeof(_BufferHeader);
+}
+
+/// Allocates a new buffer with room for the header in front of the aligned data
+inline _BufferHeader *_newBuffer(size_t capacity, int sizeClass)
+{
+    void *allocation = malloc(capacity + sizeof(_BufferHeader) + _BUFFER_ALIGNMENT);
+    if ( allocation == 0 )
+    {
+        return 0;
+    }
+    uintptr_t data = ((uintptr_t) allocation + sizeof(_BufferHeader) + _BUFFER_ALIGNMENT - 1) &
+                     ~(uintptr_t) (_BUFFER_ALIGNMENT - 1);
+    _BufferHeader *header = _headerOf((unsigned char *) data);
+    header->allocation = allocation;
+    header->capacity = capacity;
+    header->sizeClass = sizeClass;
+    header->magic = _BUFFER_MAGIC;
+    return header;
+}
+
+unsigned char *_allocateBuffer(size_t bytes)
+{
+    size_t capacity;
+    int sizeClass = _sizeClass(bytes, &capacity);
+    _BufferHeader *header = 0;
+    {
+        std::lock_guard<std::mutex> lock(_bufferPool.mutex);
+        if ( sizeClass >= 0 && !_bufferPool.free[sizeClass].empty())
+        {
+            header = _bufferPool.free[sizeClass].back();
+            _bufferPool.free[sizeClass].pop_back();
+            --_bufferPool.stats.pooledBuffers;
+            _bufferPool.stats.pooledBytes -= (long long) capacity;
+            ++_bufferPool.stats.hits;
+        } else
+        {
+            ++_bufferPool.stats.misses;
+        }
+    }
+    if ( header == 0 )
+    {
+        header = _newBuffer(capacity, sizeClass); // new memory is allocated outside of the lock
+        if ( header == 0 )
+        {
+            return 0;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_bufferPool.mutex);
+    ++_bufferPool.stats.liveBuffers;
+    _bufferPool.stats.liveBytes += (long long) capacity;
+    return _dataOf(header);
+}
+
+void _releaseBuffer(unsigned char *data)
+{
+    if ( data == 0 )
+    {
+        return;
+    }
+    _BufferHeader *header = _headerOf(data);
+    if ( header->magic != _BUFFER_MAGIC )
+    {
+        free(data); // not from the pool (should never happen)
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_bufferPool.mutex);
+        --_bufferPool.stats.liveBuffers;
+        _bufferPool.stats.liveBytes -= (long long) header->capacity;
+        if ( header->sizeClass >= 0 && _bufferPool.free[header->sizeClass].size() < _MAX_POOLED_PER_CLASS &&
+             _bufferPool.stats.pooledBytes + (long long) header->capacity <= _MAX_POOLED_BYTES )
+        {
+            _bufferPool.free[header->sizeClass].push_back(header);
+            ++_bufferPool.stats.pooledBuffers;
+            _bufferPool.stats.pooledBytes += (long long) header->capacity;
+            return;
+        }
+    }
+    header->magic = 0;
+    free(header->allocation);
+}
+
+EXPORT BufferPoolStats getBufferPoolStats()
+{
+    std::lock_guard<std::mutex> lock(_bufferPool.mutex);
+    return _bufferPool.stats;
+}
+
+EXPORT void trimBufferPool()
+{
+    std::vector<_BufferHeader *> released;
+    {
+        std::lock_guard<std::mutex> lock(_bufferPool.mutex);
+        for ( std::vector<_BufferHeader *> &buffers : _bufferPool.free )
+        {
+            released.insert(released.end(), buffers.begin(), buffers.end());
+            buffers.clear();
+        }
+        _bufferPool.stats.pooledBuffers = 0;
+        _bufferPool.stats.pooledBytes = 0;
+    }
+    for ( _BufferHeader *header : released )
+    {
+        header->magic = 0;
+        free(header->allocation);
+    }
+}
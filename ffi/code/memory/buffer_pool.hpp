@@ -0,0 +1,40 @@
+#include "../exports.h"
+#include <stddef.h>
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+/// Alignment of all pooled buffers (a cache line, so that SIMD loads of the first pixels never split)
+# define _BUFFER_ALIGNMENT 64
+
+/// Internal: returns a buffer with at least [bytes] bytes that is _BUFFER_ALIGNMENT aligned (or 0 if it failed).
+/// The buffers are kept in size classes (4 per power of two starting at 4 KB), so a freed buffer of the same class is
+/// reused instead of allocating (and page faulting) new memory for every capture. The content is not initialized.
+/// All memory that is returned to dart must come from here, because cleanupMemory puts it back into the pool!
+unsigned char *_allocateBuffer(size_t bytes);
+
+/// Internal: puts a buffer of _allocateBuffer back into the pool (or frees it if the pool is full). 0 is ignored.
+/// Can be called from any thread (also from the finalizers of dart).
+void _releaseBuffer(unsigned char *data);
+
+/// Statistics of the buffer pool returned by getBufferPoolStats
+struct BufferPoolStats
+{
+    /// Buffers that were returned by _allocateBuffer and not released yet (and their capacity in bytes)
+    long long liveBuffers;
+    long long liveBytes;
+    /// Released buffers that are kept for reuse (and their capacity in bytes)
+    long long pooledBuffers;
+    long long pooledBytes;
+    /// Allocations that reused a pooled buffer and allocations that needed new memory
+    long long hits;
+    long long misses;
+};
+
+/// Returns the current statistics of the native buffer pool (used for all images that are returned to dart)
+EXPORT BufferPoolStats getBufferPoolStats();
+
+/// Frees all pooled buffers that are currently not used (the pool fills up again with the next released buffers)
+EXPORT void trimBufferPool();
+
+#endif //BUFFER_POOL_H
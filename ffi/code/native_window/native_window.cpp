@@ -1,168 +1,174 @@
 #include "native_window.hpp"
-#include <string>
+#include "../capture/capture_session.hpp"
+#include "../capture/frame_grabber.hpp"
+#include "../image/color_convert.hpp"
+#include "../memory/buffer_pool.hpp"
+#include "title_matcher.hpp"
+#include <string.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 struct _WindowHelper
 {
-    HWND handle = 0;
+    WindowHandle handle = 0;
     const char *name = 0;
+    /// Compiled from the name in initWindow (and again in initConfig)
+    _TitleMatcher matcher;
 };
 
 /// Caches the handles and names for all used windows (set in init, handles may be reset in _getWindowHandle)
-_WindowHelper _windows[1000]{};
+_WindowHelper _windows[_MAX_WINDOWS]{};
 
 /// Used for debugging / logging into dart code and is initialized in
 void (*_printToDart)(const char *, int);
 
+/// Thread that called initConfig. Dart callbacks may only be called on the thread of their isolate, so lookups of
+/// other threads don't print anything
+std::thread::id _printThread;
+
 bool _alwaysMatchEqual = false;
-/// Caches the main display (reset in _getWindowHandle)
-HDC _mainDisplay = 0;
 
-/// If the source can be split by "- ", then it will only compare the last part to the target name and return true.
-/// otherwise false.
-inline bool _isLastPartEqualTo(const char *source, const char *targetName)
+/// Guards _windows, the lookup state, _alwaysMatchEqual and _printToDart, so that all window functions can be called
+/// from any thread. It is also held during a window enumeration, so concurrent lookups are done one after another
+std::mutex _windowsMutex;
+
+/// Copies of the handles in _windows for the background threads (only written while _windowsMutex is held)
+std::atomic<WindowHandle> _publishedHandles[_MAX_WINDOWS]{};
+
+inline bool _canPrintToDart()
+{
+    return _printToDart != 0 && std::this_thread::get_id() == _printThread;
+}
+
+/// Called with the current window handle whenever it was looked up (or lost)
+inline void _publishWindowHandle(int windowID, WindowHandle handle)
 {
-    size_t srcLength = strlen(source);
-    size_t targetLength = strlen(targetName);
-    size_t startPos = 0;
-    for ( size_t i = 0; i < srcLength - 1; ++i )
+    if ( windowID >= 0 && windowID < _MAX_WINDOWS )
     {
-        if ((source[i] == '-' || source[i] == -106) && source[i + 1] == ' ' )
-        {
-            startPos = i + 2; // start at the character after the 2 delimiters
-        }
+        _publishedHandles[windowID].store(handle, std::memory_order_release);
     }
-    // now if startPos was set and the remaining of source is same length as target, just default string compare them
-    if ( startPos > 0 && srcLength - startPos == targetLength )
+}
+
+WindowHandle _getPublishedWindowHandle(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
     {
-        for ( size_t i = 0; i < targetLength; ++i )
-        {
-            if ( targetName[i] != source[i + startPos] )
-            {
-                return false;
-            }
-        }
-        return true;
+        return 0;
     }
-    return false;
+    return _publishedHandles[windowID].load(std::memory_order_acquire);
 }
 
-/// Returns true if only the source, but not the target contains a " - " delimiter which is used for browser, etc
-inline bool _onlyCompareLastPart(const char *source, const char *targetName)
+int _findPublishedWindow(WindowHandle handle)
 {
-    size_t srcLength = strlen(source);
-    size_t targetLength = strlen(targetName);
-    for ( size_t i = 1; i < targetLength - 1; ++i )
+    for ( int windowID = 0; handle != 0 && windowID < _MAX_WINDOWS; ++windowID )
     {
-        if ( targetName[i - 1] == ' ' && (targetName[i] == '-' || targetName[i] == -106) && targetName[i + 1] == ' ' )
+        if ( _publishedHandles[windowID].load(std::memory_order_acquire) == handle )
         {
-            return false;
+            return windowID;
         }
     }
-    for ( size_t i = 1; i < srcLength - 1; ++i )
+    return -1;
+}
+
+/// Windows that are searched in one enumeration of _lookupMissingWindows
+struct _MissingWindows
+{
+    int windowIDs[_MAX_WINDOWS];
+    int amount = 0;
+    int found = 0;
+};
+
+/// Helper method that will be called with every open window handle and assigns it to the first missing window that
+/// matches (each missing window gets the first open window that matches it like in a separate enumeration)
+bool _enumWindows(WindowHandle handle, const char *windowTitle, void *userData)
+{
+    _MissingWindows *missing = (_MissingWindows *) userData;
+    if ( _canPrintToDart())
+    {
+        _printToDart(windowTitle, 1); // 1 is used for window names
+    }
+    _TitleInfo title = _scanTitle(windowTitle); // only scanned once for all missing windows
+    for ( int i = 0; i < missing->amount; ++i )
     {
-        if ( source[i - 1] == ' ' && (source[i] == '-' || source[i] == -106) && source[i + 1] == ' ' )
+        _WindowHelper *helper = &_windows[missing->windowIDs[i]];
+        if ( helper->handle == 0 && _matchesTitle(helper->matcher, title))
         {
-            return true;
+            helper->handle = handle;
+            ++missing->found;
         }
     }
-    return false;
+    return missing->found < missing->amount;
 }
 
-/// Helper method that will be called with every open window handle
-int __stdcall _enumWindows(HWND hwnd, LPARAM lParam)
+/// _platformWindowListVersion of the last enumeration. As long as it is the same, no window was opened, closed, or
+/// renamed since then, so the windows without a handle can not be found by enumerating again
+uint64_t _lookupVersion = 0;
+
+/// Reset when the names change, so that the next lookup always enumerates
+bool _lookupValid = false;
+
+/// Searches the handles of all initialized windows that don't have one in a single enumeration, but only if the
+/// open windows changed since the last enumeration. Returns false if nothing was enumerated
+bool _lookupMissingWindows()
 {
-    _WindowHelper *helper = (_WindowHelper *) lParam;
-    int length = GetWindowTextLengthA(hwnd);
-    if ( length > 2 )
+    uint64_t version = _platformWindowListVersion();
+    if ( _lookupValid && version == _lookupVersion )
     {
-        char *windowTitle = new char[length + 1];
-        bool isEqual = false;
-        int written = GetWindowTextA(hwnd, windowTitle, length + 1);
-        if ( written > 1 && IsWindowVisible(hwnd))
-        {
-            if ( _printToDart != 0 )
-            {
-                _printToDart(windowTitle, 1); // 1 is used for window names
-            }
-            if ( windowTitle[1] == ':' && windowTitle[2] == '\\' )
-            {
-                // special case: windows explorer.exe (must be equal here)
-                isEqual = strcmp(windowTitle, helper->name) == 0;
-            } else if ( _onlyCompareLastPart(windowTitle, helper->name))
-            {
-                size_t helperNameLength = strlen(helper->name);
-                if ( strncmp(windowTitle, helper->name, helperNameLength) == 0 && windowTitle[helperNameLength] == ' '
-                     && windowTitle[helperNameLength + 1] == '-' )
-                {
-                    // special case after win11 console has syntax: "Command Prompt - some command..."
-                    isEqual = true;
-                } else
-                {
-                    // todo: better use wchar to be able to compare correctly!
-                    // special case: discord, or browser like firefox, etc (must be equal to last part here)
-                    isEqual = _isLastPartEqualTo(windowTitle, helper->name);
-                }
-            } else
-            {
-                if ( _alwaysMatchEqual )
-                {
-                    // depending on bool, exact matching here!
-                    isEqual = strcmp(windowTitle, helper->name) == 0;
-                } else
-                {
-                    // default named windows: windowName only must be contained in windowTitle
-                    isEqual = strstr(windowTitle, helper->name) != 0;
-                }
-            }
-        }
-        delete[] windowTitle;
-        if ( isEqual )
+        return false;
+    }
+    _lookupVersion = version;
+    _lookupValid = true;
+    _MissingWindows missing;
+    for ( int windowID = 0; windowID < _MAX_WINDOWS; ++windowID )
+    {
+        if ( _windows[windowID].name != 0 && _windows[windowID].handle == 0 )
         {
-            helper->handle = hwnd;
-            return 0;
+            missing.windowIDs[missing.amount++] = windowID;
         }
     }
-    return 1;
+    if ( missing.amount > 0 )
+    {
+        _platformEnumWindows(_enumWindows, &missing);
+    }
+    for ( int i = 0; i < missing.amount && missing.found > 0; ++i )
+    {
+        // other windows that were found here are returned directly from their next _getWindowHandle call
+        _publishWindowHandle(missing.windowIDs[i], _windows[missing.windowIDs[i]].handle);
+    }
+    return true;
 }
 
-/// initWindow must be called first. Returns the handle related to the windowID and otherwise nullptr if the window is not open
-inline HWND _getWindowHandle(int windowID)
+/// Returns the handle of the [windowID] like _getWindowHandle, but must be called while _windowsMutex is held. Sets
+/// [lost] to true if the cached handle was invalid, so that the caller can release its capture resources afterwards
+WindowHandle _lookupWindowHandle(int windowID, bool *lost)
 {
-    if ( windowID < 0 || windowID > 999 )
-    {
-        return 0;
-    }
     _WindowHelper *helper = &_windows[windowID];
     if ( helper->handle != 0 )
     {
-        if ( IsWindow(helper->handle))
+        if ( _platformIsWindow(helper->handle))
         {
             return helper->handle;
         } else
         {
             helper->handle = 0;
-            if ( _mainDisplay != 0 )
-            {
-                ReleaseDC(0, _mainDisplay);
-                _mainDisplay = GetDC(0);
-            }
+            *lost = true;
+            _publishWindowHandle(windowID, 0);
         }
     }
     if ( helper->name == 0 )
     {
         return 0;
     }
-    EnumWindows(_enumWindows, (LPARAM) helper);
-    if ( _printToDart != 0 )
+    if ( _lookupMissingWindows() && _canPrintToDart())
     {
         if ( helper->handle != 0 )
         {
-            DWORD affinity;
-            GetWindowDisplayAffinity(helper->handle, &affinity);
             char str[20];
-            sprintf_s(str, "%d", (int) affinity);
+            snprintf(str, sizeof(str), "%d", _platformGetWindowAffinity(helper->handle));
             _printToDart(str, 2); // 2 is used for end of window names with window affinity
         } else
         {
@@ -170,96 +176,29 @@ inline HWND _getWindowHandle(int windowID)
             _printToDart(noHandle, 2); // 2 is used for end of window names with window affinity
         }
     }
+    _publishWindowHandle(windowID, helper->handle);
     return helper->handle;
 }
 
-/// Sets and returns the cached main display (only reset when handle is lost in _getWindowHandle)
-inline HDC _getMainDisplay()
+WindowHandle _getWindowHandle(int windowID)
 {
-    if ( _mainDisplay == 0 )
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
     {
-        _mainDisplay = GetDC(0);
+        return 0;
     }
-    return _mainDisplay;
-}
-
-#define _SRCCOPY 0x00CC0020ul
-#define _BI_RGB 0L
-#define _DIB_RGB_COLORS 0
-
-/// Returns an image of the main display from the top left corner
-inline unsigned char *_getImage(int x, int y, int width, int height)
-{
-    HDC deviceContext = _getMainDisplay();
-    HDC memoryDeviceContext = CreateCompatibleDC(deviceContext);
-    HBITMAP bitmap = CreateCompatibleBitmap(deviceContext, width, height);
-    HGDIOBJ oldObject = SelectObject(memoryDeviceContext, bitmap);
-    BitBlt(memoryDeviceContext, 0, 0, width, height, deviceContext, x, y, _SRCCOPY); // now image data is in bitmap
-
-    BITMAPINFOHEADER bi; // format on how the bitmap is interpreted for opencv
-    bi.biSize = sizeof(BITMAPINFOHEADER);
-    bi.biWidth = width;
-    bi.biHeight = -height;
-    bi.biPlanes = 1;
-    bi.biBitCount = 32; // RGBA
-    bi.biCompression = _BI_RGB; // no compression
-    bi.biSizeImage = 0; // because no compression
-    bi.biXPelsPerMeter = 1; // irrelevant
-    bi.biYPelsPerMeter = 1; // irrelevant
-    bi.biClrUsed = 3; // irrelevant
-    bi.biClrImportant = 4; // irrelevant
-
-    unsigned char *array = (unsigned char *) malloc(
-            height * width * 4 * sizeof(unsigned char));// RGBA: 8 uint with 4 channels, and dimensions
-    GetDIBits(memoryDeviceContext, bitmap, 0, height, array, (BITMAPINFO * ) & bi, _DIB_RGB_COLORS);
-    // copy into buffer: 0 start, height = lines, mat.data is buffer, bitmapinfo, rgba info
-
-    SelectObject(memoryDeviceContext, oldObject);
-    DeleteObject(bitmap);
-    DeleteDC(memoryDeviceContext); // delete dc
-    return array;
-}
-
-// todo: not working for directx / opengl windows
-inline unsigned char *_getFullWindowImageOld(int windowID)
-{
-    HWND handle = _getWindowHandle(windowID);
-    if ( handle == 0 )
+    bool lost = false;
+    WindowHandle handle;
     {
-        return 0;
+        std::lock_guard<std::mutex> lock(_windowsMutex);
+        handle = _lookupWindowHandle(windowID, &lost);
     }
-    RECT bounds = getWindowBounds(windowID);
-    HDC winDc = GetDC(handle);
-    int width = bounds.right - bounds.left;
-    int height = bounds.bottom - bounds.top;
-
-    BITMAPINFOHEADER bi; // format on how the bitmap is interpreted for opencv
-    bi.biSize = sizeof(BITMAPINFOHEADER);
-    bi.biWidth = width;
-    bi.biHeight = -height;
-    bi.biPlanes = 1;
-    bi.biBitCount = 32; // RGBA
-    bi.biCompression = _BI_RGB; // no compression
-    bi.biSizeImage = 0; // because no compression
-    bi.biXPelsPerMeter = 1; // irrelevant
-    bi.biYPelsPerMeter = 1; // irrelevant
-    bi.biClrUsed = 3; // irrelevant
-    bi.biClrImportant = 4; // irrelevant
-
-    HDC memoryDC = CreateCompatibleDC(winDc);
-    HBITMAP bitmap = CreateCompatibleBitmap(winDc, width, height);
-    HGDIOBJ oldObject = SelectObject(memoryDC, bitmap);
-
-    // RGBA: 8 uint with 4 channels, and dimensions
-    unsigned char *array = (unsigned char *) malloc(height * width * 4 * sizeof(unsigned char));
-    BitBlt(memoryDC, 0, 0, width, height, winDc, 0, 0, _SRCCOPY | CAPTUREBLT);
-    GetDIBits(memoryDC, bitmap, 0, height, array, (BITMAPINFO * ) & bi, _DIB_RGB_COLORS);
-
-    SelectObject(memoryDC, oldObject);
-    DeleteObject(bitmap);
-    DeleteDC(memoryDC);
-    ReleaseDC(handle, winDc);
-    return array;
+    if ( lost )
+    {
+        // destroying the capture sessions can take a while, so lookups of other threads are not blocked by it
+        _releaseCaptureSession(windowID);
+        _platformOnWindowLost();
+    }
+    return handle;
 }
 
 EXPORT int nativeCodeVersion()
@@ -269,19 +208,37 @@ EXPORT int nativeCodeVersion()
 
 EXPORT bool initWindow(int windowID, const char *windowName)
 {
-    if ( windowID < 0 || windowID > 99 )
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
     {
         return false;
     }
-    _windows[windowID].name = windowName;
-    _windows[windowID].handle = 0;
+    {
+        std::lock_guard<std::mutex> lock(_windowsMutex);
+        _windows[windowID].name = windowName;
+        _windows[windowID].matcher = _compileTitleMatcher(windowName, _alwaysMatchEqual);
+        _windows[windowID].handle = 0;
+        _lookupValid = false;
+        _publishWindowHandle(windowID, 0);
+    }
+    _releaseCaptureSession(windowID);
+    _onFrameGrabberWindowChanged(windowID);
     return true;
 }
 
 EXPORT void initConfig(bool alwaysMatchEqual, void (*printCallback)(const char *, int))
 {
+    std::lock_guard<std::mutex> lock(_windowsMutex);
     _printToDart = printCallback;
+    _printThread = std::this_thread::get_id();
     _alwaysMatchEqual = alwaysMatchEqual;
+    for ( _WindowHelper &helper : _windows )
+    {
+        if ( helper.name != 0 )
+        {
+            helper.matcher = _compileTitleMatcher(helper.name, alwaysMatchEqual);
+        }
+    }
+    _lookupValid = false; // windows that were not found before may match now
 }
 
 EXPORT bool isWindowOpen(int windowID)
@@ -291,10 +248,10 @@ EXPORT bool isWindowOpen(int windowID)
 
 EXPORT bool hasWindowFocus(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle != 0 )
     {
-        HWND focusWindow = GetForegroundWindow();
+        WindowHandle focusWindow = _platformGetForegroundWindow();
         return handle == focusWindow;
     }
     return false;
@@ -302,10 +259,10 @@ EXPORT bool hasWindowFocus(int windowID)
 
 EXPORT bool setWindowFocus(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle != 0 )
     {
-        return SetForegroundWindow(handle);
+        return _platformSetForegroundWindow(handle);
     }
     return false;
 }
@@ -315,11 +272,10 @@ EXPORT bool setWindowFocus(int windowID)
 
 EXPORT RECT getWindowBounds(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
-    if ( handle != 0 )
+    WindowHandle handle = _getWindowHandle(windowID);
+    RECT bounds;
+    if ( handle != 0 && _platformGetWindowRect(handle, &bounds))
     {
-        RECT bounds;
-        GetWindowRect(handle, &bounds);
         return bounds;
     }
     return RECT{_INVALID_VALUE, _INVALID_VALUE, _INVALID_VALUE, _INVALID_VALUE};
@@ -327,58 +283,85 @@ EXPORT RECT getWindowBounds(int windowID)
 
 EXPORT POINT getWindowSize(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
-    if ( handle != 0 )
+    WindowHandle handle = _getWindowHandle(windowID);
+    POINT size;
+    if ( handle != 0 && _platformGetClientSize(handle, &size))
     {
-        RECT bounds;
-        GetClientRect(handle, &bounds);
-        return POINT{bounds.right - bounds.left, bounds.bottom - bounds.top};
+        return size;
     }
     return POINT{_INVALID_VALUE, _INVALID_VALUE};
 }
 
-#define _HOZRES 8
+EXPORT int queryWindowStates(const int *windowIDs, int count, WindowState *outStates)
+{
+    if ( windowIDs == 0 || outStates == 0 )
+    {
+        return 0;
+    }
+    WindowHandle focusWindow = _platformGetForegroundWindow();
+    int openWindows = 0;
+    for ( int i = 0; i < count; ++i )
+    {
+        WindowState &state = outStates[i];
+        state = WindowState{0, 0, POINT{_INVALID_VALUE, _INVALID_VALUE},
+                            RECT{_INVALID_VALUE, _INVALID_VALUE, _INVALID_VALUE, _INVALID_VALUE}};
+        WindowHandle handle = _getWindowHandle(windowIDs[i]);
+        if ( handle == 0 )
+        {
+            continue;
+        }
+        ++openWindows;
+        state.open = 1;
+        state.focus = handle == focusWindow ? 1 : 0;
+        POINT size;
+        if ( _platformGetClientSize(handle, &size))
+        {
+            state.size = size;
+        }
+        RECT bounds;
+        if ( _platformGetWindowRect(handle, &bounds))
+        {
+            state.bounds = bounds;
+        }
+    }
+    return openWindows;
+}
 
 EXPORT unsigned int getMainDisplayWidth()
 {
-    return GetDeviceCaps(_getMainDisplay(), _HOZRES);
+    return _platformGetDisplayWidth();
 }
 
-#define _VERTREX 10
-
 EXPORT unsigned int getMainDisplayHeight()
 {
-    return GetDeviceCaps(_getMainDisplay(), _VERTREX);
+    return _platformGetDisplayHeight();
 }
 
-#define _WM_CLOSE 0x0010
-
 EXPORT bool closeWindow(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle != 0 )
     {
-        SendMessageA(handle, _WM_CLOSE, 0, 0);
-        return true;
+        return _platformCloseWindow(handle);
     }
     return false;
 }
 
 EXPORT void cleanupMemory(unsigned char *data)
 {
-    free(data);
+    _releaseBuffer(data);
 }
 
 EXPORT unsigned char *getFullMainDisplay()
 {
     unsigned int width = getMainDisplayWidth();
     unsigned int height = getMainDisplayHeight();
-    return _getImage(0, 0, width, height);
+    return _captureImage(_MAIN_DISPLAY_SESSION, 0, 0, width, height, PIXEL_FORMAT_BGRA, 1);
 }
 
 EXPORT unsigned char *getFullWindow(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle == 0 )
     {
         return 0;
@@ -386,153 +369,100 @@ EXPORT unsigned char *getFullWindow(int windowID)
     RECT bounds = getWindowBounds(windowID);
     POINT pos{bounds.left, bounds.top};
     POINT size{bounds.right - bounds.left, bounds.bottom - bounds.top};
-    return _getImage(pos.x, pos.y, size.x, size.y);
+    return _captureImage(windowID, pos.x, pos.y, size.x, size.y, PIXEL_FORMAT_BGRA, 1);
 }
 
 EXPORT unsigned char *getImageOfWindow(int windowID, int x, int y, int width, int height)
 {
-    return _getImage(x, y, width, height);
+    return _captureImage(windowID, x, y, width, height, PIXEL_FORMAT_BGRA, 1);
+}
+
+EXPORT bool captureInto(int windowID, int x, int y, int width, int height, unsigned char *target, int stride)
+{
+    return _captureInto(windowID, x, y, width, height, target, stride);
+}
+
+EXPORT int captureRegions(int windowID, const RECT *rects, int count, unsigned char **outBuffers)
+{
+    return _captureRegions(windowID, rects, count, outBuffers);
 }
 
 EXPORT unsigned long getPixelOfWindow(int x, int y)
 {
-    HDC hdc = _getMainDisplay();
-    COLORREF colorRef = GetPixel(hdc, x, y);
-    return (unsigned long) colorRef;
+    return _platformGetScreenPixel(x, y);
+}
+
+EXPORT int getPixelsOfWindow(int windowID, const POINT *points, int count, unsigned long *outColors)
+{
+    return _capturePixels(windowID, points, count, outColors);
 }
 
 EXPORT POINT getDisplayMousePos()
 {
-    POINT point;
-    GetCursorPos(&point);
-    return point;
+    return _platformGetCursorPos();
 }
 
 EXPORT POINT getWindowMousePos(int windowID)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle == 0 )
     {
         return POINT{_INVALID_VALUE, _INVALID_VALUE};
     }
     POINT point = getDisplayMousePos();
-    ScreenToClient(handle, &point);
+    _platformScreenToClient(handle, &point);
     return point;
 }
 
 EXPORT void setDisplayMousePos(int x, int y)
 {
-    SetCursorPos(x, y);
+    _platformSetCursorPos(x, y);
 }
 
 EXPORT bool setWindowMousePos(int windowID, int x, int y)
 {
-    HWND handle = _getWindowHandle(windowID);
+    WindowHandle handle = _getWindowHandle(windowID);
     if ( handle == 0 )
     {
         return false;
     }
     POINT point{x, y};
-    ClientToScreen(handle, &point);
+    _platformClientToScreen(handle, &point);
     setDisplayMousePos(point.x, point.y);
     return true;
 }
 
-#define _INPUT_MOUSE 0
-#define _MOUSEEVENTF_MOVE 0x0001
-
 EXPORT void moveMouse(int dx, int dy)
 {
-    INPUT input;
-    input.type = _INPUT_MOUSE;
-    input.mi.mouseData = 0;
-    input.mi.time = 0;
-    input.mi.dx = dx;
-    input.mi.dy = dy;
-    input.mi.dwFlags = _MOUSEEVENTF_MOVE;
-    SendInput(1, &input, sizeof(input));
+    _platformMoveMouse(dx, dy);
 }
 
-#define _MOUSEEVENTF_WHEEL 0x0800
-
 EXPORT void scrollMouse(int scrollClickAmount)
 {
-    INPUT input;
-    input.type = _INPUT_MOUSE;
-    input.mi.time = 0;
-    input.mi.mouseData = scrollClickAmount * 120; // may be negative (120 is one click in any direction)
-    input.mi.dwFlags = _MOUSEEVENTF_WHEEL;
-    SendInput(1, &input, sizeof(input));
+    _platformScrollMouse(scrollClickAmount);
 }
 
-#define _MOUSEEVENTF_LEFTDOWN    0x0002
-#define _MOUSEEVENTF_LEFTUP      0x0004
-#define _MOUSEEVENTF_RIGHTDOWN   0x0008
-#define _MOUSEEVENTF_RIGHTUP     0x0010
-#define _MOUSEEVENTF_MIDDLEDOWN  0x0020
-#define _MOUSEEVENTF_MIDDLEUP    0x0040
-
 EXPORT void sendMouseEvent(int mouseEvent)
 {
-    INPUT input;
-    input.type = _INPUT_MOUSE;
-    input.mi.time = 0;
-    input.mi.dwFlags = mouseEvent;
-    SendInput(1, &input, sizeof(INPUT));
+    _platformSendMouseEvent(mouseEvent);
 }
 
-#define _INPUT_KEYBOARD 1
-#define _KEYEVENTF_SCANCODE 0x0008
-#define _KEYEVENTF_KEYUP 0x0002
-#define _MAPVK_VK_TO_VSC 0
-
 EXPORT void sendKeyEvent(bool keyUp, unsigned short keyCode)
 {
-    INPUT input;
-    input.type = _INPUT_KEYBOARD;
-    input.ki.time = 0;
-    input.ki.wVk = 0;
-    input.ki.dwExtraInfo = 0;
-    if ( keyUp )
-        input.ki.dwFlags = _KEYEVENTF_SCANCODE | _KEYEVENTF_KEYUP;
-    else
-        input.ki.dwFlags = _KEYEVENTF_SCANCODE;
-    input.ki.wScan = (WORD) MapVirtualKeyA(keyCode, _MAPVK_VK_TO_VSC);
-    SendInput(1, &input, sizeof(INPUT));
+    _platformSendKeyEvents(keyUp, &keyCode, 1);
 }
 
 EXPORT void sendKeyEvents(bool keyUp, unsigned short *keyCodes, unsigned short amountOfKeys)
 {
-    INPUT *inputs = (INPUT *) malloc(amountOfKeys * sizeof(INPUT));
-    for ( unsigned short i = 0; i < amountOfKeys; ++i )
-    {
-        INPUT &input = inputs[i];
-        input.type = _INPUT_KEYBOARD;
-        input.ki.time = 0;
-        input.ki.wVk = 0;
-        input.ki.dwExtraInfo = 0;
-        if ( keyUp )
-            input.ki.dwFlags = _KEYEVENTF_SCANCODE | _KEYEVENTF_KEYUP;
-        else
-            input.ki.dwFlags = _KEYEVENTF_SCANCODE;
-        input.ki.wScan = (WORD) MapVirtualKeyA(keyCodes[i], _MAPVK_VK_TO_VSC);
-    }
-    SendInput(amountOfKeys, inputs, sizeof(INPUT));
-    free(inputs);
+    _platformSendKeyEvents(keyUp, keyCodes, amountOfKeys);
 }
 
-#define _SM_SWAPBUTTON 23
-
 EXPORT bool isKeyDown(unsigned short keyCode)
 {
-    if ( keyCode <= 0x02 && GetSystemMetrics(_SM_SWAPBUTTON))
-    {
-        return (GetAsyncKeyState(keyCode == 0x02 ? 0x01 : 0x02) & 0x8000); // left and right mouse button swapped
-    }
-    return GetAsyncKeyState(keyCode) & 0x8000;
+    return _platformIsKeyDown(keyCode);
 }
 
 EXPORT bool isKeyToggled(unsigned short keyCode)
 {
-    return GetKeyState(keyCode) & 0x01; // caps lock, num lock, etc
-}
\ No newline at end of file
+    return _platformIsKeyToggled(keyCode);
+}
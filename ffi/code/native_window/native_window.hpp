@@ -1,4 +1,4 @@
-#include <windows.h>
+#include "../platform/platform.hpp"
 #include "../exports.h"
 
 #ifndef NATIVE_WINDOW_H
@@ -6,14 +6,34 @@
 
 /// Simple integer to detect dll library mismatches. Has to be incremented when native code is modified!
 /// Also Modify the version in native_window.dart!
-# define _NATIVE_CODE_VERSION 9
+# define _NATIVE_CODE_VERSION 34
 
 /// Simple integer to detect dll library mismatches. Has to be incremented when native code is modified!
 /// Also Modify the version in native_window.dart!
 EXPORT int nativeCodeVersion();
 
+/// Threading contract of the exported functions:
+/// - The window, capture, pixel, compare and input functions can be called from any thread at the same time (so also
+///   from dart background isolates). Window lookups are serialized internally and captures of the same window on
+///   different threads each use their own capture resources (see _PooledSession).
+/// - initConfig, initWindow, and the start / stop functions of capture threads, watches and window events should only
+///   be called from the main isolate. The frame grabber functions (startCaptureThread, stopCaptureThread,
+///   acquireLatestFrame, changedTiles) must be called from the same thread.
+/// - The printCallback of initConfig is only called on the thread that called initConfig.
+
+/// Internal: initWindow must be called first. Returns the handle related to the windowID and otherwise 0 if the
+/// window is not open (looks up the window again if the handle was lost). Can be called from any thread.
+WindowHandle _getWindowHandle(int windowID);
+
+/// Internal: the handle that the dart thread found for the [windowID] in its last _getWindowHandle call (or 0). Can
+/// be called from any thread, but the window may already be closed.
+WindowHandle _getPublishedWindowHandle(int windowID);
+
+/// Internal: returns the windowID whose published handle is [handle] (or -1). Can be called from any thread.
+int _findPublishedWindow(WindowHandle handle);
+
 /// This must be called first to initialize the windowName (also resets the handle).
-/// The windowID starts at 0 and has to be used for the other functions (only numbers 0 >= windowID < 100 )
+/// The windowID starts at 0 and has to be used for the other functions (only numbers 0 <= windowID < _MAX_WINDOWS)
 /// Name Examples: "Path of Exile", "TL", "League of Legends"
 EXPORT bool initWindow(int windowID, const char *windowName);
 
@@ -42,13 +62,33 @@ EXPORT RECT getWindowBounds(int windowID);
 /// For outer bounds in screen space, use getWindowBounds instead
 EXPORT POINT getWindowSize(int windowID);
 
+/// State of one window returned by queryWindowStates
+struct WindowState
+{
+    /// 1 if the window is open (same as isWindowOpen)
+    int open;
+    /// 1 if the window has the keyboard focus (same as hasWindowFocus)
+    int focus;
+    /// Same as getWindowSize (_INVALID_VALUE if the window is not open)
+    POINT size;
+    /// Same as getWindowBounds (_INVALID_VALUE if the window is not open)
+    RECT bounds;
+};
+
+/// Writes the state of each of the [windowIDs] into [outStates] at the same index with a single call (so the event
+/// loop does not need isWindowOpen, hasWindowFocus, getWindowSize and getWindowBounds for every window). The handle of
+/// each window is only validated once and the focused window is only queried once for all of them.
+/// initWindow must be called first for every window. Returns the amount of open windows.
+EXPORT int queryWindowStates(const int *windowIDs, int count, WindowState *outStates);
+
 EXPORT unsigned int getMainDisplayWidth();
 
 EXPORT unsigned int getMainDisplayHeight();
 
 EXPORT bool closeWindow(int windowID);
 
-/// Used for data returned by getImageOfMainDisplay and getFullMainDisplay
+/// Used for data returned by getImageOfMainDisplay and getFullMainDisplay (and all other images that native code
+/// returns). The memory is put back into the native buffer pool for the next capture (see getBufferPoolStats).
 EXPORT void cleanupMemory(unsigned char *data);
 
 /// Returns a screenshot of the full main display
@@ -71,14 +111,38 @@ EXPORT unsigned char *getFullWindow(int windowID);
 /// IMPORTANT: the memory management (cleanup of the returned data) must be done on the outside!!!
 /// An Image can be created from the data with "cv::Mat(height, width, CV_8UC4, data);" but will not cleanup
 /// automatically! So it needs to be freed manually!
+/// The capture resources are kept alive per windowID between calls, so repeated captures are cheap.
 EXPORT unsigned char *getImageOfWindow(int windowID, int x, int y, int width, int height);
 
+/// Same as getImageOfWindow, but writes the BGRA pixels into memory that is owned by the caller instead of allocating
+/// new memory, so the same buffer can be reused for every capture (nothing has to be cleaned up here).
+/// [target] needs at least [height] rows of [stride] bytes and the [stride] must be at least width * 4. For an
+/// existing CV_8UC4 mat this would be "captureInto(windowID, x, y, mat.cols, mat.rows, mat.data, mat.step)".
+/// Returns false if the arguments were invalid, or if nothing could be captured.
+EXPORT bool captureInto(int windowID, int x, int y, int width, int height, unsigned char *target, int stride);
+
+/// Captures multiple regions (screen coordinates like getImageOfWindow, right and bottom are exclusive) at once by
+/// capturing their bounding box only once and then copying each region out of it into [outBuffers] at the same index
+/// (as tightly packed BGRA with width * 4 bytes per row).
+/// If a buffer in [outBuffers] is 0, then it will be allocated and has to be freed manually with cleanupMemory!
+/// Otherwise it must be big enough for the region. Empty rects are skipped and their buffers are not touched.
+/// Returns the amount of regions that were captured (0 if the capture failed).
+/// This is faster than calling getImageOfWindow for each region if they are close to each other, but the bounding box
+/// of regions that are far apart may be much bigger than the regions themselves!
+EXPORT int captureRegions(int windowID, const RECT *rects, int count, unsigned char **outBuffers);
+
 /// RGB values of pixel on display in hex format: 0x00bbggrr
 /// R: val & 0xff
 /// G: (val >> 8) & 0xff
 /// B: (val >> 16) & 0xff
 EXPORT unsigned long getPixelOfWindow(int x, int y);
 
+/// Same as getPixelOfWindow for all [points] (screen coordinates) at once, but the points are captured together with
+/// the capture session of the [windowID] instead of reading every pixel on its own (close points with one capture
+/// of their bounding box, far apart points in multiple smaller boxes). The colors are written into [outColors] at
+/// the same index and points outside of the display are 0xFFFFFFFF. Returns the amount of valid colors.
+EXPORT int getPixelsOfWindow(int windowID, const POINT *points, int count, unsigned long *outColors);
+
 /// Returns the raw screen mouse position
 EXPORT POINT getDisplayMousePos();
 
@@ -0,0 +1,85 @@
+#include "title_matcher.hpp"
+#include <string.h>
+
+/// Returns the byte length of the dash at the [text] ("-", or the utf8 en dash / em dash that browsers use) or 0
+inline size_t _dashLength(const char *text)
+{
+    if ( text[0] == '-' )
+    {
+        return 1;
+    }
+    // U+2013 and U+2014 are E2 80 93 and E2 80 94 in utf8
+    if ( (unsigned char) text[0] == 0xE2 && (unsigned char) text[1] == 0x80 &&
+         ((unsigned char) text[2] == 0x93 || (unsigned char) text[2] == 0x94))
+    {
+        return 3;
+    }
+    return 0;
+}
+
+/// Scans the [text] with [length] bytes for "- " delimiters and returns if there is at least one with a space in
+/// front of it (" - "). [lastPartStart] is set to the start of the part after the last "- " (or 0)
+inline bool _scanDelimiters(const char *text, size_t length, size_t *lastPartStart)
+{
+    bool hasDelimiter = false;
+    *lastPartStart = 0;
+    for ( size_t i = 0; i < length; ++i )
+    {
+        size_t dash = _dashLength(text + i);
+        if ( dash > 0 && i + dash < length && text[i + dash] == ' ' )
+        {
+            *lastPartStart = i + dash + 1; // start at the character after the delimiters
+            hasDelimiter = hasDelimiter || (i > 0 && text[i - 1] == ' ');
+        }
+    }
+    return hasDelimiter;
+}
+
+_TitleMatcher _compileTitleMatcher(const char *name, bool exact)
+{
+    _TitleMatcher matcher;
+    matcher.name = name;
+    matcher.length = strlen(name);
+    matcher.exact = exact;
+    size_t lastPartStart;
+    matcher.lastPart = !_scanDelimiters(name, matcher.length, &lastPartStart);
+    return matcher;
+}
+
+_TitleInfo _scanTitle(const char *title)
+{
+    _TitleInfo info;
+    info.title = title;
+    info.length = strlen(title);
+    info.explorerPath = info.length > 2 && title[1] == ':' && title[2] == '\\';
+    info.hasDelimiter = _scanDelimiters(title, info.length, &info.lastPartStart);
+    return info;
+}
+
+bool _matchesTitle(const _TitleMatcher &matcher, const _TitleInfo &title)
+{
+    if ( title.explorerPath )
+    {
+        // special case: windows explorer.exe (must be equal here)
+        return title.length == matcher.length && memcmp(title.title, matcher.name, matcher.length) == 0;
+    }
+    if ( matcher.lastPart && title.hasDelimiter )
+    {
+        if ( title.length > matcher.length + 1 && memcmp(title.title, matcher.name, matcher.length) == 0 &&
+             title.title[matcher.length] == ' ' && _dashLength(title.title + matcher.length + 1) > 0 )
+        {
+            // special case after win11 console has syntax: "Command Prompt - some command..."
+            return true;
+        }
+        // special case: discord, or browser like firefox, etc (must be equal to last part here)
+        return title.lastPartStart > 0 && title.length - title.lastPartStart == matcher.length &&
+               memcmp(title.title + title.lastPartStart, matcher.name, matcher.length) == 0;
+    }
+    if ( matcher.exact )
+    {
+        // depending on bool, exact matching here!
+        return title.length == matcher.length && memcmp(title.title, matcher.name, matcher.length) == 0;
+    }
+    // default named windows: windowName only must be contained in windowTitle
+    return matcher.length <= title.length && strstr(title.title, matcher.name) != 0;
+}
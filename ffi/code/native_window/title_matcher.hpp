@@ -0,0 +1,45 @@
+#include <stddef.h>
+
+#ifndef TITLE_MATCHER_H
+#define TITLE_MATCHER_H
+
+/// Internal: a window name of initWindow that is scanned once, so that it can be matched against many window titles
+/// without scanning it again. Names and titles are always utf8 (the platforms convert wide titles to utf8).
+struct _TitleMatcher
+{
+    const char *name = 0;
+    size_t length = 0;
+    /// The title must be equal to the name instead of only containing it (see initConfig)
+    bool exact = false;
+    /// The name does not contain a " - " delimiter itself, so it may also match only the last part of titles that do
+    /// (like "Discord" in "#channel - Server - Discord", or "Command Prompt" in "Command Prompt - command")
+    bool lastPart = false;
+};
+
+/// Internal: a window title that was scanned once for all matchers of one enumeration
+struct _TitleInfo
+{
+    const char *title = 0;
+    size_t length = 0;
+    /// Path of a windows explorer window (must always be equal to the name)
+    bool explorerPath = false;
+    /// The title contains a " - " delimiter (with a "-", en dash or em dash)
+    bool hasDelimiter = false;
+    /// Start of the part after the last "- " delimiter (0 if there is none)
+    size_t lastPartStart = 0;
+};
+
+/// Scans the [name] (which must stay valid as long as the matcher is used)
+_TitleMatcher _compileTitleMatcher(const char *name, bool exact);
+
+/// Scans the utf8 [title] (which must stay valid as long as the info is used)
+_TitleInfo _scanTitle(const char *title);
+
+/// Returns if the window with the [title] is the window of the [matcher]:
+/// - explorer paths must be equal
+/// - names without a delimiter match titles with delimiters if the title starts with the name followed by a
+///   delimiter, or if the last part of the title is equal to the name
+/// - otherwise the title has to contain the name (or be equal to it for exact matchers)
+bool _matchesTitle(const _TitleMatcher &matcher, const _TitleInfo &title);
+
+#endif //TITLE_MATCHER_H
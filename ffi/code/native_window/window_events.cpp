@@ -0,0 +1,50 @@
+#include "window_events.hpp"
+#include "native_window.hpp"
+#include <atomic>
+#include <mutex>
+
+/// Port of startWindowEvents (0 if stopped)
+std::atomic<DartPort> _windowEventPort{0};
+
+/// Held while an event is posted, so that stopWindowEvents can wait for an event that is currently being posted
+std::mutex _windowEventMutex;
+
+/// Called from the event thread of the platform
+void _onPlatformWindowEvent(WindowHandle handle, int event)
+{
+    if ( event == _WINDOW_EVENT_BOUNDS && _findPublishedWindow(handle) < 0 )
+    {
+        return; // moving other windows happens way too often
+    }
+    std::lock_guard<std::mutex> lock(_windowEventMutex);
+    DartPort port = _windowEventPort.load(std::memory_order_acquire);
+    if ( port != 0 )
+    {
+        _postInt64ToDart(port, event);
+    }
+}
+
+EXPORT bool startWindowEvents(DartPort port)
+{
+    if ( port == 0 )
+    {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_windowEventMutex);
+        _windowEventPort.store(port, std::memory_order_release);
+    }
+    if ( !_platformSetWindowEventCallback(_onPlatformWindowEvent))
+    {
+        stopWindowEvents();
+        return false;
+    }
+    return true;
+}
+
+EXPORT void stopWindowEvents()
+{
+    _platformSetWindowEventCallback(0);
+    std::lock_guard<std::mutex> lock(_windowEventMutex);
+    _windowEventPort.store(0, std::memory_order_release);
+}
@@ -0,0 +1,27 @@
+#include "../platform/platform.hpp"
+#include "../watch/dart_port.hpp"
+#include "../exports.h"
+
+#ifndef WINDOW_EVENTS_H
+#define WINDOW_EVENTS_H
+
+/// Window events that are posted as int into the dart port of startWindowEvents (same values as in platform.hpp)
+/// The foreground window changed, so the focus of all windows has to be checked again
+# define WINDOW_EVENT_FOCUS _WINDOW_EVENT_FOCUS
+/// A window was opened, closed, shown, hidden, or renamed, so the open state of all windows has to be checked again
+# define WINDOW_EVENT_OPEN _WINDOW_EVENT_OPEN
+/// One of the initialized windows was moved, resized, minimized, or restored
+# define WINDOW_EVENT_BOUNDS _WINDOW_EVENT_BOUNDS
+
+/// Posts the window events of the platform (SetWinEventHook on windows and x events on linux) into the dart [port]
+/// from the event thread of the platform, so the event loop does not have to poll the window states in every tick.
+/// Bounds events are only posted for windows that were found by initWindow / _getWindowHandle, but focus and open
+/// events are posted for all windows (because any of them might be one of the initialized windows).
+/// initDartApi must be called first. A previous port is replaced. Returns false if the platform has no window events
+/// (then the states have to be polled).
+EXPORT bool startWindowEvents(DartPort port);
+
+/// Stops posting window events (nothing is posted anymore after this returns)
+EXPORT void stopWindowEvents();
+
+#endif //WINDOW_EVENTS_H
@@ -0,0 +1,169 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // otherwise the min and max macros of windows.h break std::min and std::max
+#endif // #ifndef NOMINMAX
+#include <windows.h>
+#else
+/// Same memory layout as the windows RECT so that the exported functions and the dart structs stay the same
+struct RECT
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+/// Same memory layout as the windows POINT so that the exported functions and the dart structs stay the same
+struct POINT
+{
+    int x;
+    int y;
+};
+#endif // #ifdef _WIN32
+
+/// Internal interface that has to be implemented once for every supported platform (platform_windows.cpp,
+/// platform_linux.cpp). Only the exported functions in the other modules use these and they don't include any
+/// platform specific headers themselves!
+///
+/// All functions work with screen coordinates of the main display and images are always returned as 4 channel BGRA
+/// data (top row first) which matches "cv::Mat(height, width, CV_8UC4, data)".
+///
+/// Key codes are always windows virtual key codes and mouse events are always the windows MOUSEEVENTF flags, so
+/// other platforms have to map them internally.
+///
+/// The window, display and capture functions are implemented by the frame source (source/frame_source.cpp) which
+/// either forwards them to the live screen of the platform (_screen functions of platform_screen.hpp), or serves a
+/// synthetic window from raw frame files, or generated frames (see setFrameSource).
+
+/// Opaque handle to a native top level window (HWND on windows and the X11 Window id on linux). 0 is invalid!
+typedef uintptr_t WindowHandle;
+
+/// Window ids of the exported functions (see initWindow) are 0 to _MAX_WINDOWS - 1 in every module
+# define _MAX_WINDOWS 100
+
+/// Called for every visible top level window with its utf8 [title] in [_platformEnumWindows]. Return false to stop.
+typedef bool (*WindowEnumCallback)(WindowHandle handle, const char *title, void *userData);
+
+/// Calls the [callback] for every visible top level window that has a title
+void _platformEnumWindows(WindowEnumCallback callback, void *userData);
+
+/// Returns a number that changes whenever a top level window was created, destroyed, shown, hidden, or renamed, so
+/// the results of _platformEnumWindows only have to be refreshed after it changed. The events are tracked with
+/// SetWinEventHook on windows and with root window notifications on linux. If they can not be tracked, then this
+/// returns a different number for every call. Must be called from the same thread as _platformEnumWindows.
+uint64_t _platformWindowListVersion();
+
+/// Events of a WindowEventCallback
+/// The foreground window changed ([handle] is the new one)
+# define _WINDOW_EVENT_FOCUS 1
+/// A top level window was created, destroyed, shown, hidden, or renamed (same as a _platformWindowListVersion change)
+# define _WINDOW_EVENT_OPEN 2
+/// A top level window was moved, resized, minimized, or restored
+# define _WINDOW_EVENT_BOUNDS 3
+
+/// Called from the event thread of the platform for every window event (the [handle] may already be destroyed)
+typedef void (*WindowEventCallback)(WindowHandle handle, int event);
+
+/// Sets the [callback] for all window events (0 removes it). The events come from the same source as
+/// _platformWindowListVersion. Returns false if the events can not be tracked (then the callback is never called).
+bool _platformSetWindowEventCallback(WindowEventCallback callback);
+
+/// Returns true if the [handle] still references an existing window
+bool _platformIsWindow(WindowHandle handle);
+
+/// Called when a cached window handle became invalid, so that cached display resources can be refreshed
+void _platformOnWindowLost();
+
+/// Only used for debug logging: the display affinity of the window (always 0 on platforms without it)
+int _platformGetWindowAffinity(WindowHandle handle);
+
+/// Returns the window that currently has the keyboard focus (or 0)
+WindowHandle _platformGetForegroundWindow();
+
+/// Tries to bring the window to the foreground and give it the focus
+bool _platformSetForegroundWindow(WindowHandle handle);
+
+/// Outer bounds of the window (including title bar and borders) in screen coordinates
+bool _platformGetWindowRect(WindowHandle handle, RECT *bounds);
+
+/// Inner size of the window without title bar and borders
+bool _platformGetClientSize(WindowHandle handle, POINT *size);
+
+/// Converts a screen [point] into a point relative to the top left corner of the inner window
+bool _platformScreenToClient(WindowHandle handle, POINT *point);
+
+/// Converts a [point] relative to the top left corner of the inner window into screen coordinates
+bool _platformClientToScreen(WindowHandle handle, POINT *point);
+
+/// Sends a close request to the window
+bool _platformCloseWindow(WindowHandle handle);
+
+unsigned int _platformGetDisplayWidth();
+
+unsigned int _platformGetDisplayHeight();
+
+/// Copies the area of the main display into [target] as BGRA with [width] * 4 bytes per row. Parts of the area that
+/// are outside of the display will be black. Returns false if nothing could be captured.
+/// This creates and destroys all platform resources on every call, so for repeated captures use a PlatformCapture!
+bool _platformCaptureScreen(int x, int y, int width, int height, unsigned char *target);
+
+/// Persistent capture resources (memory DC and DIB section on windows, XShm segment on linux) that are kept alive
+/// between captures and only grow when a bigger area is requested. Each one has its own screen DC (on linux the x
+/// server connections are shared once there are too many of them), so different captures can be used on different
+/// threads at the same time. But each one may only be used by one thread at a time!
+struct PlatformCapture;
+
+PlatformCapture *_platformCreateCapture();
+
+/// Frees all resources of the [capture] (may be 0)
+void _platformDestroyCapture(PlatformCapture *capture);
+
+/// Same as _platformCaptureScreen, but reuses the resources of the [capture] and writes rows of [targetStride] bytes
+bool _platformCaptureWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                          int targetStride);
+
+/// Converts one row of [width] BGRA pixel (the alpha byte may be undefined) into another pixel format in [target].
+/// Used to write captures directly in the requested format while they are copied out of the capture memory
+typedef void (*CaptureRowConverter)(const unsigned char *bgra, int width, unsigned char *target);
+
+/// Same as _platformCaptureWith, but every row is written with [convert] into [target] which then has
+/// [targetChannels] bytes per pixel (parts outside of the display are still filled with 0). If [convert] is 0, then
+/// this is the same as _platformCaptureWith (and [targetChannels] must be 4)
+bool _platformCaptureConverted(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                               int targetStride, CaptureRowConverter convert, int targetChannels);
+
+/// Same as _platformGetWindowRect and _platformGetClientSize together, but this may be called from the thread that
+/// uses the [capture] (because it uses the resources of it). Returns false if the window does not exist anymore.
+bool _platformGetCaptureWindowArea(PlatformCapture *capture, WindowHandle handle, RECT *bounds, POINT *innerSize);
+
+/// Color of a pixel on the main display in the hex format 0x00bbggrr
+unsigned long _platformGetScreenPixel(int x, int y);
+
+POINT _platformGetCursorPos();
+
+void _platformSetCursorPos(int x, int y);
+
+/// Relative mouse movement (can be negative)
+void _platformMoveMouse(int dx, int dy);
+
+/// Scroll wheel clicks (can be negative for reverse)
+void _platformScrollMouse(int scrollClickAmount);
+
+/// [mouseEvent] is one of the windows MOUSEEVENTF_ button flags
+void _platformSendMouseEvent(int mouseEvent);
+
+/// Sends all [keyCodes] (windows virtual key codes) at the same time
+void _platformSendKeyEvents(bool keyUp, const unsigned short *keyCodes, unsigned short amountOfKeys);
+
+/// Windows virtual key code (also mouse buttons)
+bool _platformIsKeyDown(unsigned short keyCode);
+
+/// Windows virtual key code of caps lock, num lock, etc
+bool _platformIsKeyToggled(unsigned short keyCode);
+
+#endif //PLATFORM_H
@@ -0,0 +1,1346 @@
+#include "platform_screen.hpp"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <dlfcn.h>
+#include <poll.h>
+#include <string.h>
+#include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Own connection to the x server (opened on first use and never closed)
+Display *_display = 0;
+
+/// Most connections to the x server that are opened for PlatformCaptures. The x server only accepts a limited amount
+/// of clients (256 per default, shared with all other applications), so further captures share the least used one
+#define _MAX_CAPTURE_DISPLAYS 8
+
+/// If the MIT-SHM extension can be used for captures (otherwise XGetImage is used)
+bool _hasShm = false;
+
+/// Connections of this library (_display, the event connection and the capture connections). Their errors are never
+/// passed to the previous handler, because an error of a request outside of an _ErrorTrap may be read on any thread
+/// and the default handler would terminate the process. Only changed with _addOwnDisplay and _removeOwnDisplay, so the
+/// error handler can read them without a lock (closed capture connections are removed after they were closed, so
+/// there is room for some of them next to the ones that are open)
+std::atomic<Display *> _ownDisplays[_MAX_CAPTURE_DISPLAYS * 2 + 2]{};
+
+inline void _addOwnDisplay(Display *display)
+{
+    for ( std::atomic<Display *> &own : _ownDisplays )
+    {
+        Display *empty = 0;
+        if ( own.compare_exchange_strong(empty, display))
+        {
+            return;
+        }
+    }
+}
+
+/// Removes one entry of the [display] (the same pointer may be added again after it was closed)
+inline void _removeOwnDisplay(Display *display)
+{
+    for ( std::atomic<Display *> &own : _ownDisplays )
+    {
+        Display *expected = display;
+        if ( own.compare_exchange_strong(expected, 0))
+        {
+            return;
+        }
+    }
+}
+
+inline bool _isOwnDisplay(Display *display)
+{
+    for ( std::atomic<Display *> &own : _ownDisplays )
+    {
+        if ( own.load(std::memory_order_acquire) == display )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct _ErrorTrap;
+
+/// Innermost active _ErrorTrap of this thread (each one links to the one that was active before)
+thread_local _ErrorTrap *_innermostErrorTrap = 0;
+
+/// Handler that was set before (for example the one of gtk) which gets all errors of other connections
+XErrorHandler _previousErrorHandler = 0;
+
+/// X errors would terminate the process per default, so every call that may reference a window that was already
+/// destroyed has to be wrapped with this. The error handler itself is only set once (see _getDisplay) and does not
+/// have to be swapped, because the capture threads also use traps at the same time.
+/// The [display] is locked while the trap is active, so no other thread can read the errors of its requests (with
+/// XInitThreads the replies of a shared connection are otherwise read by whichever thread waits for one first). Only
+/// errors of requests from [firstRequest] on are counted, so earlier errors of requests outside of a trap are not
+/// blamed on this one
+struct _ErrorTrap
+{
+    Display *display;
+    unsigned long firstRequest;
+    int error = 0;
+    _ErrorTrap *outer;
+
+    explicit _ErrorTrap(Display *trapDisplay = _display)
+    {
+        display = trapDisplay;
+        XLockDisplay(display);
+        firstRequest = NextRequest(display);
+        outer = _innermostErrorTrap;
+        _innermostErrorTrap = this;
+    }
+
+    /// Returns true if any of the previous calls produced an error
+    bool failed()
+    {
+        XSync(display, False);
+        return error != 0;
+    }
+
+    ~_ErrorTrap()
+    {
+        XSync(display, False);
+        _innermostErrorTrap = outer;
+        if ( error != 0 && outer != 0 && outer->display == display && outer->error == 0 )
+        {
+            outer->error = error; // the requests of this trap were also made while the outer one was active
+        }
+        XUnlockDisplay(display);
+    }
+};
+
+int _onXError(Display *display, XErrorEvent *event)
+{
+    for ( _ErrorTrap *trap = _innermostErrorTrap; trap != 0; trap = trap->outer )
+    {
+        if ( trap->display == display && event->serial >= trap->firstRequest )
+        {
+            trap->error = event->error_code;
+            return 0;
+        }
+    }
+    if ( _isOwnDisplay(display))
+    {
+        return 0; // a request outside of a trap, for example a window that was destroyed before it was selected
+    }
+    return _previousErrorHandler != 0 ? _previousErrorHandler(display, event) : 0;
+}
+
+std::once_flag _displayOpened;
+
+/// Opens and returns the cached display connection (may return 0 if no x server is available). The connection is
+/// shared by all threads (XInitThreads makes every call on it thread safe)
+inline Display *_getDisplay()
+{
+    std::call_once(_displayOpened, [] {
+        XInitThreads();
+        _previousErrorHandler = XSetErrorHandler(_onXError);
+        _display = XOpenDisplay(0);
+        if ( _display != 0 )
+        {
+            _addOwnDisplay(_display);
+            int major, minor;
+            Bool pixmaps;
+            _hasShm = XShmQueryVersion(_display, &major, &minor, &pixmaps);
+        }
+    });
+    return _display;
+}
+
+inline Atom _atom(const char *name, Display *display = _display)
+{
+    return XInternAtom(display, name, False);
+}
+
+/// Returns the data of the [property] which must be freed with XFree (or 0 if the window does not have it).
+/// [items] will be set to the amount of elements of the format (for format 32 each element is a long)
+inline unsigned char *_getProperty(Window window, Atom property, Atom type, unsigned long *items,
+                                   Display *display = _display)
+{
+    Atom actualType;
+    int actualFormat;
+    unsigned long remaining;
+    unsigned char *data = 0;
+    *items = 0;
+    if ( XGetWindowProperty(display, window, property, 0, 1 << 20, False, type, &actualType, &actualFormat, items,
+                            &remaining, &data) != Success )
+    {
+        return 0;
+    }
+    if ( actualType == None || data == 0 )
+    {
+        if ( data != 0 )
+        {
+            XFree(data);
+        }
+        *items = 0;
+        return 0;
+    }
+    return data;
+}
+
+/// Writes the utf8 title of the [window] into [title] (with [size] bytes) and returns the length of it
+inline int _getWindowTitle(Window window, char *title, int size)
+{
+    unsigned long length = 0;
+    char *name = (char *) _getProperty(window, _atom("_NET_WM_NAME"), _atom("UTF8_STRING"), &length);
+    if ( name == 0 )
+    {
+        XFetchName(_display, window, &name);
+        length = name != 0 ? strlen(name) : 0;
+    }
+    if ( name == 0 )
+    {
+        title[0] = 0;
+        return 0;
+    }
+    if ( length >= (unsigned long) size )
+    {
+        length = size - 1;
+    }
+    memcpy(title, name, length);
+    title[length] = 0;
+    XFree(name);
+    return (int) length;
+}
+
+/// Returns the direct child of the root window that contains the [window] (which is the top level window without a
+/// window manager)
+inline Window _toTopLevel(Window window)
+{
+    Window root = DefaultRootWindow(_display);
+    Window current = window;
+    while ( current != 0 && current != root )
+    {
+        Window rootReturn, parent;
+        Window *children = 0;
+        unsigned int amount = 0;
+        if ( !XQueryTree(_display, current, &rootReturn, &parent, &children, &amount))
+        {
+            return 0;
+        }
+        if ( children != 0 )
+        {
+            XFree(children);
+        }
+        if ( parent == root )
+        {
+            return current;
+        }
+        current = parent;
+    }
+    return 0;
+}
+
+/// Second connection that only receives the window events of _screenWindowListVersion (so the events never have
+/// to be skipped on the main connection). Only read on the event thread which is started on first use
+std::atomic<Display *> _eventDisplay{0};
+
+/// Incremented by the event thread for every event of a top level window change
+std::atomic<uint64_t> _windowListVersion{0};
+
+/// Set with _screenSetWindowEventCallback and called from the event thread
+std::atomic<WindowEventCallback> _windowEventCallback{0};
+
+std::once_flag _eventThreadStarted;
+
+/// 0 while the event thread is starting, 1 if it receives events and -1 if there is no x server
+int _eventThreadState = 0;
+std::mutex _eventThreadMutex;
+std::condition_variable _eventThreadReady;
+
+/// Only used if there are no events (then every call returns a new version)
+std::atomic<uint64_t> _fallbackListVersion{0};
+
+inline void _sendWindowEvent(WindowHandle handle, int windowEvent)
+{
+    WindowEventCallback callback = _windowEventCallback.load(std::memory_order_acquire);
+    if ( callback != 0 )
+    {
+        callback(handle, windowEvent);
+    }
+}
+
+/// Reads the events of the event connection for the whole lifetime of the process
+void _runEventThread()
+{
+    Display *display = _getDisplay() != 0 ? XOpenDisplay(0) : 0;
+    if ( display != 0 )
+    {
+        _addOwnDisplay(display); // the errors of _watchWindowTitles are read on this thread and ignored
+        // creation, destruction and mapping of top level windows (and the client list and active window of the
+        // window manager)
+        XSelectInput(display, DefaultRootWindow(display), SubstructureNotifyMask | PropertyChangeMask);
+        XFlush(display);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_eventThreadMutex);
+        _eventDisplay = display;
+        _eventThreadState = display != 0 ? 1 : -1;
+        _eventThreadReady.notify_all(); // under the lock, because the waiting thread may exit right after it
+    }
+    if ( display == 0 )
+    {
+        return;
+    }
+    Window root = DefaultRootWindow(display);
+    Atom clientList = _atom("_NET_CLIENT_LIST", display);
+    Atom activeWindow = _atom("_NET_ACTIVE_WINDOW", display);
+    Atom netName = _atom("_NET_WM_NAME", display);
+    pollfd connection = {ConnectionNumber(display), POLLIN, 0};
+    while ( true )
+    {
+        if ( XPending(display) == 0 )
+        {
+            poll(&connection, 1, 100);
+            continue;
+        }
+        XEvent event;
+        XNextEvent(display, &event);
+        switch ( event.type )
+        {
+            case CreateNotify:
+            case DestroyNotify:
+            case MapNotify:
+            case UnmapNotify:
+            case ReparentNotify:
+                _windowListVersion.fetch_add(1, std::memory_order_release);
+                _sendWindowEvent((WindowHandle) event.xany.window, _WINDOW_EVENT_OPEN);
+                break;
+            case ConfigureNotify:
+                if ( event.xconfigure.window != root )
+                {
+                    _sendWindowEvent((WindowHandle) event.xconfigure.window, _WINDOW_EVENT_BOUNDS);
+                }
+                break;
+            case PropertyNotify:
+                if ( event.xproperty.window == root && event.xproperty.atom == activeWindow )
+                {
+                    _sendWindowEvent(0, _WINDOW_EVENT_FOCUS);
+                }
+                else if ( event.xproperty.atom == clientList || event.xproperty.atom == netName ||
+                          event.xproperty.atom == XA_WM_NAME )
+                {
+                    _windowListVersion.fetch_add(1, std::memory_order_release);
+                    _sendWindowEvent((WindowHandle) event.xproperty.window, _WINDOW_EVENT_OPEN);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/// Starts the event thread once and returns if it receives events
+inline bool _startEventThread()
+{
+    std::call_once(_eventThreadStarted, [] { std::thread(_runEventThread).detach(); });
+    std::unique_lock<std::mutex> lock(_eventThreadMutex);
+    _eventThreadReady.wait(lock, [] { return _eventThreadState != 0; });
+    return _eventThreadState == 1;
+}
+
+/// Selects the title and bounds changes of all listed client [windows] on the event connection (new windows are
+/// selected in the next enumeration which always follows their creation event)
+inline void _watchWindowTitles(const Window *windows, unsigned long amount)
+{
+    if ( _eventDisplay == 0 )
+    {
+        return;
+    }
+    for ( unsigned long i = 0; i < amount; ++i )
+    {
+        XSelectInput(_eventDisplay, windows[i], PropertyChangeMask | StructureNotifyMask);
+    }
+    XFlush(_eventDisplay); // windows might already be destroyed, but those errors are ignored (see _ownDisplays)
+}
+
+uint64_t _screenWindowListVersion()
+{
+    if ( !_startEventThread())
+    {
+        return ++_fallbackListVersion;
+    }
+    return _windowListVersion.load(std::memory_order_acquire);
+}
+
+bool _screenSetWindowEventCallback(WindowEventCallback callback)
+{
+    _windowEventCallback.store(callback, std::memory_order_release);
+    return callback == 0 || _startEventThread();
+}
+
+void _screenEnumWindows(WindowEnumCallback callback, void *userData)
+{
+    if ( _getDisplay() == 0 )
+    {
+        return;
+    }
+    _ErrorTrap trap; // windows might be destroyed while iterating
+    Window root = DefaultRootWindow(_display);
+    char title[512];
+    unsigned long amount = 0;
+    Window *windows = (Window *) _getProperty(root, _atom("_NET_CLIENT_LIST"), XA_WINDOW, &amount);
+    bool ownList = false;
+    if ( windows == 0 )
+    {
+        // no window manager (for example a plain Xvfb), so search all mapped children of the root window
+        Window rootReturn, parent;
+        unsigned int children = 0;
+        if ( !XQueryTree(_display, root, &rootReturn, &parent, &windows, &children))
+        {
+            return;
+        }
+        amount = children;
+        ownList = true;
+    }
+    _watchWindowTitles(windows, amount);
+    for ( unsigned long i = 0; i < amount; ++i )
+    {
+        if ( ownList )
+        {
+            XWindowAttributes attributes;
+            if ( !XGetWindowAttributes(_display, windows[i], &attributes) || attributes.map_state != IsViewable )
+            {
+                continue;
+            }
+        }
+        if ( _getWindowTitle(windows[i], title, sizeof(title)) > 2 )
+        {
+            if ( !callback((WindowHandle) windows[i], title, userData))
+            {
+                break;
+            }
+        }
+    }
+    if ( windows != 0 )
+    {
+        XFree(windows);
+    }
+}
+
+bool _screenIsWindow(WindowHandle handle)
+{
+    if ( _getDisplay() == 0 || handle == 0 )
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    XWindowAttributes attributes;
+    return XGetWindowAttributes(_display, (Window) handle, &attributes) && !trap.failed();
+}
+
+void _screenOnWindowLost()
+{
+    // nothing cached per window here
+}
+
+int _screenGetWindowAffinity(WindowHandle /*handle*/)
+{
+    return 0; // no display affinity on x11
+}
+
+WindowHandle _screenGetForegroundWindow()
+{
+    if ( _getDisplay() == 0 )
+    {
+        return 0;
+    }
+    _ErrorTrap trap;
+    unsigned long amount = 0;
+    Window *active = (Window *) _getProperty(DefaultRootWindow(_display), _atom("_NET_ACTIVE_WINDOW"), XA_WINDOW,
+                                             &amount);
+    if ( active != 0 )
+    {
+        Window window = amount > 0 ? active[0] : 0;
+        XFree(active);
+        return (WindowHandle) window;
+    }
+    Window focus = 0;
+    int revert;
+    XGetInputFocus(_display, &focus, &revert);
+    if ( focus == None || focus == PointerRoot )
+    {
+        return 0;
+    }
+    return (WindowHandle) _toTopLevel(focus);
+}
+
+bool _screenSetForegroundWindow(WindowHandle handle)
+{
+    if ( !_screenIsWindow(handle))
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    Window root = DefaultRootWindow(_display);
+    XEvent event;
+    memset(&event, 0, sizeof(event));
+    event.xclient.type = ClientMessage;
+    event.xclient.window = (Window) handle;
+    event.xclient.message_type = _atom("_NET_ACTIVE_WINDOW");
+    event.xclient.format = 32;
+    event.xclient.data.l[0] = 2; // source indication: pager (otherwise focus stealing prevention would ignore it)
+    event.xclient.data.l[1] = CurrentTime;
+    XSendEvent(_display, root, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+    // fallback if there is no window manager that handles the message above
+    XRaiseWindow(_display, (Window) handle);
+    XSetInputFocus(_display, (Window) handle, RevertToParent, CurrentTime);
+    return !trap.failed();
+}
+
+/// Outer bounds (with the decorations of the window manager) and the inner size of the window on the [display]
+inline bool _getWindowGeometry(Display *display, Window window, RECT *bounds, POINT *innerSize)
+{
+    _ErrorTrap trap(display);
+    XWindowAttributes attributes;
+    if ( !XGetWindowAttributes(display, window, &attributes))
+    {
+        return false;
+    }
+    int x, y;
+    Window child;
+    XTranslateCoordinates(display, window, attributes.root, 0, 0, &x, &y, &child);
+    long left = 0, right = 0, top = 0, bottom = 0; // decorations of the window manager are not part of the window
+    unsigned long amount = 0;
+    long *extents = (long *) _getProperty(window, _atom("_NET_FRAME_EXTENTS", display), XA_CARDINAL, &amount,
+                                          display);
+    if ( extents != 0 )
+    {
+        if ( amount >= 4 )
+        {
+            left = extents[0];
+            right = extents[1];
+            top = extents[2];
+            bottom = extents[3];
+        }
+        XFree(extents);
+    }
+    if ( trap.failed())
+    {
+        return false;
+    }
+    bounds->left = x - (int) left;
+    bounds->top = y - (int) top;
+    bounds->right = x + attributes.width + (int) right;
+    bounds->bottom = y + attributes.height + (int) bottom;
+    if ( innerSize != 0 )
+    {
+        innerSize->x = attributes.width;
+        innerSize->y = attributes.height;
+    }
+    return true;
+}
+
+bool _screenGetWindowRect(WindowHandle handle, RECT *bounds)
+{
+    if ( _getDisplay() == 0 || handle == 0 )
+    {
+        return false;
+    }
+    return _getWindowGeometry(_display, (Window) handle, bounds, 0);
+}
+
+bool _screenGetClientSize(WindowHandle handle, POINT *size)
+{
+    if ( _getDisplay() == 0 || handle == 0 )
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    XWindowAttributes attributes;
+    if ( !XGetWindowAttributes(_display, (Window) handle, &attributes) || trap.failed())
+    {
+        return false;
+    }
+    size->x = attributes.width;
+    size->y = attributes.height;
+    return true;
+}
+
+bool _screenScreenToClient(WindowHandle handle, POINT *point)
+{
+    if ( _getDisplay() == 0 || handle == 0 )
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    Window child;
+    int x, y;
+    if ( !XTranslateCoordinates(_display, DefaultRootWindow(_display), (Window) handle, point->x, point->y, &x, &y,
+                                &child) || trap.failed())
+    {
+        return false;
+    }
+    point->x = x;
+    point->y = y;
+    return true;
+}
+
+bool _screenClientToScreen(WindowHandle handle, POINT *point)
+{
+    if ( _getDisplay() == 0 || handle == 0 )
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    Window child;
+    int x, y;
+    if ( !XTranslateCoordinates(_display, (Window) handle, DefaultRootWindow(_display), point->x, point->y, &x, &y,
+                                &child) || trap.failed())
+    {
+        return false;
+    }
+    point->x = x;
+    point->y = y;
+    return true;
+}
+
+bool _screenCloseWindow(WindowHandle handle)
+{
+    if ( !_screenIsWindow(handle))
+    {
+        return false;
+    }
+    _ErrorTrap trap;
+    XEvent event;
+    memset(&event, 0, sizeof(event));
+    event.xclient.type = ClientMessage;
+    event.xclient.window = (Window) handle;
+    event.xclient.message_type = _atom("WM_PROTOCOLS");
+    event.xclient.format = 32;
+    event.xclient.data.l[0] = (long) _atom("WM_DELETE_WINDOW");
+    event.xclient.data.l[1] = CurrentTime;
+    XSendEvent(_display, (Window) handle, False, NoEventMask, &event);
+    return !trap.failed();
+}
+
+unsigned int _screenGetDisplayWidth()
+{
+    if ( _getDisplay() == 0 )
+    {
+        return 0;
+    }
+    return (unsigned int) DisplayWidth(_display, DefaultScreen(_display));
+}
+
+unsigned int _screenGetDisplayHeight()
+{
+    if ( _getDisplay() == 0 )
+    {
+        return 0;
+    }
+    return (unsigned int) DisplayHeight(_display, DefaultScreen(_display));
+}
+
+/// Returns the position of the lowest set bit of the color [mask]
+inline int _maskShift(unsigned long mask)
+{
+    int shift = 0;
+    while ( mask != 0 && (mask & 1) == 0 )
+    {
+        mask >>= 1;
+        ++shift;
+    }
+    return shift;
+}
+
+/// Copies the top left [width] x [height] area of the [image] into [target] as BGRA (with [targetStride] bytes per
+/// row) and sets the alpha to max. If [convert] is not 0, then every row is converted with it instead (see
+/// _screenCaptureConverted)
+inline void _copyImage(XImage *image, int width, int height, unsigned char *target, int targetStride,
+                       CaptureRowConverter convert)
+{
+    if ( image->bits_per_pixel == 32 && image->byte_order == LSBFirst && image->red_mask == 0xff0000 &&
+         image->green_mask == 0xff00 && image->blue_mask == 0xff )
+    {
+        // default case: memory is already BGRX
+        for ( int y = 0; y < height; ++y )
+        {
+            if ( convert != 0 )
+            {
+                // directly out of the shared memory (the converters ignore the undefined alpha byte)
+                convert((const unsigned char *) image->data + y * image->bytes_per_line, width,
+                        target + y * targetStride);
+                continue;
+            }
+            const uint32_t *source = (const uint32_t *) (image->data + y * image->bytes_per_line);
+            uint32_t *row = (uint32_t *) (target + y * targetStride);
+            for ( int x = 0; x < width; ++x )
+            {
+                row[x] = source[x] | 0xff000000u;
+            }
+        }
+        return;
+    }
+    int redShift = _maskShift(image->red_mask);
+    int greenShift = _maskShift(image->green_mask);
+    int blueShift = _maskShift(image->blue_mask);
+    unsigned long redMax = image->red_mask >> redShift;
+    unsigned long greenMax = image->green_mask >> greenShift;
+    unsigned long blueMax = image->blue_mask >> blueShift;
+    std::vector<unsigned char> bgraRow(convert != 0 ? (size_t) width * 4 : 0); // only needed for conversions
+    for ( int y = 0; y < height; ++y )
+    {
+        unsigned char *row = convert != 0 ? bgraRow.data() : target + y * targetStride;
+        for ( int x = 0; x < width; ++x )
+        {
+            unsigned long pixel = XGetPixel(image, x, y);
+            row[x * 4] = (unsigned char) (((pixel & image->blue_mask) >> blueShift) * 255 / (blueMax ? blueMax : 1));
+            row[x * 4 + 1] = (unsigned char) (((pixel & image->green_mask) >> greenShift) * 255 /
+                                              (greenMax ? greenMax : 1));
+            row[x * 4 + 2] = (unsigned char) (((pixel & image->red_mask) >> redShift) * 255 / (redMax ? redMax : 1));
+            row[x * 4 + 3] = 255;
+        }
+        if ( convert != 0 )
+        {
+            convert(row, width, target + y * targetStride);
+        }
+    }
+}
+
+/// Reads the area of the root window (which must be inside of the screen) into [target] with [targetStride].
+/// This creates a new shared memory segment for every call (see PlatformCapture for the persistent version)
+inline bool _readRoot(int x, int y, int width, int height, unsigned char *target, int targetStride)
+{
+    int screen = DefaultScreen(_display);
+    Window root = DefaultRootWindow(_display);
+    if ( _hasShm )
+    {
+        XShmSegmentInfo segment;
+        XImage *image = XShmCreateImage(_display, DefaultVisual(_display, screen), DefaultDepth(_display, screen),
+                                        ZPixmap, 0, &segment, width, height);
+        if ( image != 0 )
+        {
+            bool success = false;
+            segment.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+            if ( segment.shmid >= 0 )
+            {
+                segment.shmaddr = image->data = (char *) shmat(segment.shmid, 0, 0);
+                segment.readOnly = False;
+                if ( segment.shmaddr != (char *) -1 )
+                {
+                    _ErrorTrap trap;
+                    if ( XShmAttach(_display, &segment))
+                    {
+                        if ( XShmGetImage(_display, root, image, x, y, AllPlanes) && !trap.failed())
+                        {
+                            _copyImage(image, width, height, target, targetStride, 0);
+                            success = true;
+                        }
+                        XShmDetach(_display, &segment);
+                    }
+                    shmdt(segment.shmaddr);
+                }
+                shmctl(segment.shmid, IPC_RMID, 0);
+            }
+            image->data = 0; // shared memory is not owned by the image
+            XDestroyImage(image);
+            if ( success )
+            {
+                return true;
+            }
+        }
+    }
+    _ErrorTrap trap;
+    XImage *image = XGetImage(_display, root, x, y, width, height, AllPlanes, ZPixmap);
+    if ( image == 0 || trap.failed())
+    {
+        return false;
+    }
+    _copyImage(image, width, height, target, targetStride, 0);
+    XDestroyImage(image);
+    return true;
+}
+
+/// Connection to the x server that is used by [users] PlatformCaptures
+struct _CaptureDisplay
+{
+    Display *display;
+    int users;
+};
+
+/// Open capture connections (at most _MAX_CAPTURE_DISPLAYS), only used while holding the _captureDisplayMutex
+std::mutex _captureDisplayMutex;
+std::vector<_CaptureDisplay> _captureDisplays;
+
+/// Opens a new capture connection. If there are already _MAX_CAPTURE_DISPLAYS, then the one with the least users is
+/// shared instead (every call on it is thread safe, but captures on it wait for each other).
+/// Returns 0 if there is no x server
+inline Display *_acquireCaptureDisplay()
+{
+    if ( _getDisplay() == 0 )
+    {
+        return 0;
+    }
+    // connections are only opened for new capture sessions, so this is rarely held for long
+    std::lock_guard<std::mutex> lock(_captureDisplayMutex);
+    _CaptureDisplay *leastUsed = 0;
+    for ( _CaptureDisplay &captureDisplay : _captureDisplays )
+    {
+        if ( leastUsed == 0 || captureDisplay.users < leastUsed->users )
+        {
+            leastUsed = &captureDisplay;
+        }
+    }
+    if ( leastUsed != 0 && _captureDisplays.size() >= _MAX_CAPTURE_DISPLAYS )
+    {
+        ++leastUsed->users;
+        return leastUsed->display;
+    }
+    Display *display = XOpenDisplay(0);
+    if ( display != 0 )
+    {
+        _addOwnDisplay(display);
+        _captureDisplays.push_back(_CaptureDisplay{display, 1});
+    }
+    return display;
+}
+
+/// Gives the [display] of _acquireCaptureDisplay back and closes it after its last user is gone
+inline void _releaseCaptureDisplay(Display *display)
+{
+    {
+        std::lock_guard<std::mutex> lock(_captureDisplayMutex);
+        for ( size_t i = 0; i < _captureDisplays.size(); ++i )
+        {
+            if ( _captureDisplays[i].display == display )
+            {
+                if ( --_captureDisplays[i].users > 0 )
+                {
+                    return;
+                }
+                _captureDisplays.erase(_captureDisplays.begin() + (long) i);
+                break;
+            }
+        }
+    }
+    XCloseDisplay(display);
+    _removeOwnDisplay(display); // afterwards, because closing it may still read errors
+}
+
+struct PlatformCapture
+{
+    /// Connection to the x server of _acquireCaptureDisplay (not the shared _display, so captures do not block the
+    /// window functions and up to _MAX_CAPTURE_DISPLAYS captures on different threads do not block each other)
+    Display *display = 0;
+    /// Shared memory segment that is attached to the x server as long as shmid is not -1
+    XShmSegmentInfo segment;
+    /// Size of the segment in bytes
+    size_t capacity = 0;
+    /// Image header that points into the segment. Only this is recreated when the size changes (client side only)
+    XImage *image = 0;
+    /// Fallback without XShm: client image for XGetSubImage with the biggest size that was requested so far
+    XImage *fallbackImage = 0;
+};
+
+PlatformCapture *_platformCreateCapture()
+{
+    PlatformCapture *capture = new PlatformCapture();
+    capture->display = _acquireCaptureDisplay();
+    capture->segment.shmid = -1;
+    capture->segment.shmaddr = 0;
+    return capture;
+}
+
+/// Destroys the image header without freeing the shared memory that it points to
+inline void _releaseCaptureImage(PlatformCapture *capture)
+{
+    if ( capture->image != 0 )
+    {
+        capture->image->data = 0;
+        XDestroyImage(capture->image);
+        capture->image = 0;
+    }
+}
+
+/// Detaches and frees the segment of the [capture]. The image header stays, because it only references the segment
+/// info (its data is set to the new segment before every capture)
+inline void _releaseCaptureSegment(PlatformCapture *capture)
+{
+    if ( capture->segment.shmid != -1 )
+    {
+        _ErrorTrap trap(capture->display);
+        XShmDetach(capture->display, &capture->segment);
+        shmdt(capture->segment.shmaddr);
+        capture->segment.shmid = -1;
+        capture->segment.shmaddr = 0;
+        capture->capacity = 0;
+    }
+}
+
+void _platformDestroyCapture(PlatformCapture *capture)
+{
+    if ( capture == 0 )
+    {
+        return;
+    }
+    if ( capture->display != 0 )
+    {
+        _releaseCaptureImage(capture);
+        _releaseCaptureSegment(capture);
+        if ( capture->fallbackImage != 0 )
+        {
+            XDestroyImage(capture->fallbackImage); // also frees the malloc data
+        }
+        _releaseCaptureDisplay(capture->display);
+    }
+    delete capture;
+}
+
+/// Makes sure that the segment of the [capture] has at least [bytes] and is attached. Returns false if xshm failed
+inline bool _ensureCaptureSegment(PlatformCapture *capture, size_t bytes)
+{
+    if ( capture->segment.shmid != -1 && bytes <= capture->capacity )
+    {
+        return true;
+    }
+    _releaseCaptureSegment(capture);
+    int id = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+    if ( id < 0 )
+    {
+        return false;
+    }
+    char *address = (char *) shmat(id, 0, 0);
+    if ( address == (char *) -1 )
+    {
+        shmctl(id, IPC_RMID, 0);
+        return false;
+    }
+    capture->segment.shmid = id;
+    capture->segment.shmaddr = address;
+    capture->segment.readOnly = False;
+    _ErrorTrap trap(capture->display);
+    bool attached = XShmAttach(capture->display, &capture->segment) && !trap.failed();
+    shmctl(id, IPC_RMID, 0); // only marks it for deletion: it stays alive until it is detached everywhere
+    if ( !attached )
+    {
+        shmdt(address);
+        capture->segment.shmid = -1;
+        capture->segment.shmaddr = 0;
+        return false;
+    }
+    capture->capacity = bytes;
+    return true;
+}
+
+/// Persistent version of _readRoot with the same constraints
+inline bool _readRootWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                          int targetStride, CaptureRowConverter convert)
+{
+    Display *display = capture->display;
+    int screen = DefaultScreen(display);
+    Window root = DefaultRootWindow(display);
+    if ( _hasShm )
+    {
+        if ( capture->image == 0 || capture->image->width != width || capture->image->height != height )
+        {
+            _releaseCaptureImage(capture);
+            capture->image = XShmCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen),
+                                             ZPixmap, 0, &capture->segment, width, height);
+        }
+        if ( capture->image != 0 )
+        {
+            size_t bytes = (size_t) capture->image->bytes_per_line * height;
+            if ( _ensureCaptureSegment(capture, bytes))
+            {
+                capture->image->data = capture->segment.shmaddr;
+                _ErrorTrap trap(display);
+                if ( XShmGetImage(display, root, capture->image, x, y, AllPlanes) && !trap.failed())
+                {
+                    _copyImage(capture->image, width, height, target, targetStride, convert);
+                    return true;
+                }
+            }
+        }
+    }
+    XImage *image = capture->fallbackImage;
+    if ( image == 0 || image->width < width || image->height < height )
+    {
+        int newWidth = image != 0 && image->width > width ? image->width : width;
+        int newHeight = image != 0 && image->height > height ? image->height : height;
+        if ( image != 0 )
+        {
+            XDestroyImage(image);
+        }
+        image = XCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen), ZPixmap, 0, 0,
+                             newWidth, newHeight, 32, 0);
+        capture->fallbackImage = image;
+        if ( image == 0 )
+        {
+            return false;
+        }
+        image->data = (char *) malloc((size_t) image->bytes_per_line * newHeight);
+        if ( image->data == 0 )
+        {
+            XDestroyImage(image);
+            capture->fallbackImage = 0;
+            return false;
+        }
+    }
+    _ErrorTrap trap(display);
+    if ( XGetSubImage(display, root, x, y, width, height, AllPlanes, ZPixmap, image, 0, 0) == 0 || trap.failed())
+    {
+        return false;
+    }
+    _copyImage(image, width, height, target, targetStride, convert);
+    return true;
+}
+
+/// Clips the area to the screen (x11 fails for areas outside of the screen while windows just returns black pixel
+/// there) and reads it with the [capture] (or per call if it is 0). [convert] and [targetChannels] are the same as in
+/// _screenCaptureConverted (conversions are only supported with a [capture])
+inline bool _captureClipped(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                            int targetStride, CaptureRowConverter convert, int targetChannels)
+{
+    Display *display = capture != 0 ? capture->display : _getDisplay();
+    if ( display == 0 || width <= 0 || height <= 0 )
+    {
+        return false;
+    }
+    int screen = DefaultScreen(display);
+    int left = x < 0 ? 0 : x;
+    int top = y < 0 ? 0 : y;
+    int right = x + width > DisplayWidth(display, screen) ? DisplayWidth(display, screen) : x + width;
+    int bottom = y + height > DisplayHeight(display, screen) ? DisplayHeight(display, screen) : y + height;
+    if ( left != x || top != y || right != x + width || bottom != y + height )
+    {
+        for ( int row = 0; row < height; ++row )
+        {
+            memset(target + (size_t) row * targetStride, 0, (size_t) width * targetChannels);
+        }
+    }
+    if ( left >= right || top >= bottom )
+    {
+        return true;
+    }
+    unsigned char *start = target + (size_t) (top - y) * targetStride + (size_t) (left - x) * targetChannels;
+    if ( capture != 0 )
+    {
+        return _readRootWith(capture, left, top, right - left, bottom - top, start, targetStride, convert);
+    }
+    return _readRoot(left, top, right - left, bottom - top, start, targetStride);
+}
+
+bool _screenCaptureScreen(int x, int y, int width, int height, unsigned char *target)
+{
+    return _captureClipped(0, x, y, width, height, target, width * 4, 0, 4);
+}
+
+bool _screenCaptureWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                        int targetStride)
+{
+    return capture != 0 && _captureClipped(capture, x, y, width, height, target, targetStride, 0, 4);
+}
+
+bool _screenCaptureConverted(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                             int targetStride, CaptureRowConverter convert, int targetChannels)
+{
+    return capture != 0 && targetChannels > 0 && targetStride >= width * targetChannels &&
+           _captureClipped(capture, x, y, width, height, target, targetStride, convert, targetChannels);
+}
+
+bool _screenGetCaptureWindowArea(PlatformCapture *capture, WindowHandle handle, RECT *bounds, POINT *innerSize)
+{
+    if ( capture == 0 || capture->display == 0 || handle == 0 )
+    {
+        return false;
+    }
+    return _getWindowGeometry(capture->display, (Window) handle, bounds, innerSize);
+}
+
+#define _CLR_INVALID 0xFFFFFFFFul
+
+unsigned long _screenGetScreenPixel(int x, int y)
+{
+    if ( _getDisplay() == 0 || x < 0 || y < 0 || x >= (int) _screenGetDisplayWidth() ||
+         y >= (int) _screenGetDisplayHeight())
+    {
+        return _CLR_INVALID;
+    }
+    unsigned char bgra[4];
+    if ( !_readRoot(x, y, 1, 1, bgra, 4))
+    {
+        return _CLR_INVALID;
+    }
+    return (unsigned long) bgra[2] | ((unsigned long) bgra[1] << 8) | ((unsigned long) bgra[0] << 16);
+}
+
+POINT _platformGetCursorPos()
+{
+    POINT point{0, 0};
+    if ( _getDisplay() != 0 )
+    {
+        Window rootReturn, child;
+        int windowX, windowY;
+        unsigned int mask;
+        XQueryPointer(_display, DefaultRootWindow(_display), &rootReturn, &child, &point.x, &point.y, &windowX,
+                      &windowY, &mask);
+    }
+    return point;
+}
+
+void _platformSetCursorPos(int x, int y)
+{
+    if ( _getDisplay() != 0 )
+    {
+        XWarpPointer(_display, None, DefaultRootWindow(_display), 0, 0, 0, 0, x, y);
+        XFlush(_display);
+    }
+}
+
+/// XTest is loaded at runtime, so that the library does not need the development package to build and also still
+/// works without the extension (then only the mouse position can be changed, but no buttons or keys)
+typedef int (*_XTestFakeKeyEventFunc)(Display *, unsigned int, Bool, unsigned long);
+
+typedef int (*_XTestFakeButtonEventFunc)(Display *, unsigned int, Bool, unsigned long);
+
+typedef int (*_XTestFakeRelativeMotionEventFunc)(Display *, int, int, unsigned long);
+
+_XTestFakeKeyEventFunc _fakeKeyEvent = 0;
+_XTestFakeButtonEventFunc _fakeButtonEvent = 0;
+_XTestFakeRelativeMotionEventFunc _fakeRelativeMotionEvent = 0;
+std::once_flag _xTestLoaded;
+
+/// Returns if the XTest functions are available (only tries to load them once)
+inline bool _loadXTest()
+{
+    std::call_once(_xTestLoaded, [] {
+        void *library = dlopen("libXtst.so.6", RTLD_NOW | RTLD_LOCAL);
+        if ( library == 0 )
+        {
+            library = dlopen("libXtst.so", RTLD_NOW | RTLD_LOCAL);
+        }
+        if ( library != 0 )
+        {
+            _fakeKeyEvent = (_XTestFakeKeyEventFunc) dlsym(library, "XTestFakeKeyEvent");
+            _fakeButtonEvent = (_XTestFakeButtonEventFunc) dlsym(library, "XTestFakeButtonEvent");
+            _fakeRelativeMotionEvent = (_XTestFakeRelativeMotionEventFunc) dlsym(library,
+                                                                                  "XTestFakeRelativeMotionEvent");
+        }
+    });
+    return _fakeKeyEvent != 0 && _fakeButtonEvent != 0;
+}
+
+void _platformMoveMouse(int dx, int dy)
+{
+    if ( _getDisplay() == 0 )
+    {
+        return;
+    }
+    if ( _loadXTest() && _fakeRelativeMotionEvent != 0 )
+    {
+        _fakeRelativeMotionEvent(_display, dx, dy, CurrentTime);
+    } else
+    {
+        XWarpPointer(_display, None, None, 0, 0, 0, 0, dx, dy); // relative without source and destination
+    }
+    XFlush(_display);
+}
+
+#define _BUTTON_LEFT 1
+#define _BUTTON_MIDDLE 2
+#define _BUTTON_RIGHT 3
+#define _BUTTON_WHEEL_UP 4
+#define _BUTTON_WHEEL_DOWN 5
+
+void _platformScrollMouse(int scrollClickAmount)
+{
+    if ( _getDisplay() == 0 || !_loadXTest())
+    {
+        return;
+    }
+    // positive is away from the user like on windows
+    unsigned int button = scrollClickAmount > 0 ? _BUTTON_WHEEL_UP : _BUTTON_WHEEL_DOWN;
+    int clicks = scrollClickAmount > 0 ? scrollClickAmount : -scrollClickAmount;
+    for ( int i = 0; i < clicks; ++i )
+    {
+        _fakeButtonEvent(_display, button, True, CurrentTime);
+        _fakeButtonEvent(_display, button, False, CurrentTime);
+    }
+    XFlush(_display);
+}
+
+#define _MOUSEEVENTF_LEFTDOWN    0x0002
+#define _MOUSEEVENTF_LEFTUP      0x0004
+#define _MOUSEEVENTF_RIGHTDOWN   0x0008
+#define _MOUSEEVENTF_RIGHTUP     0x0010
+#define _MOUSEEVENTF_MIDDLEDOWN  0x0020
+#define _MOUSEEVENTF_MIDDLEUP    0x0040
+
+void _platformSendMouseEvent(int mouseEvent)
+{
+    if ( _getDisplay() == 0 || !_loadXTest())
+    {
+        return;
+    }
+    if ( mouseEvent & _MOUSEEVENTF_LEFTDOWN )
+        _fakeButtonEvent(_display, _BUTTON_LEFT, True, CurrentTime);
+    if ( mouseEvent & _MOUSEEVENTF_LEFTUP )
+        _fakeButtonEvent(_display, _BUTTON_LEFT, False, CurrentTime);
+    if ( mouseEvent & _MOUSEEVENTF_RIGHTDOWN )
+        _fakeButtonEvent(_display, _BUTTON_RIGHT, True, CurrentTime);
+    if ( mouseEvent & _MOUSEEVENTF_RIGHTUP )
+        _fakeButtonEvent(_display, _BUTTON_RIGHT, False, CurrentTime);
+    if ( mouseEvent & _MOUSEEVENTF_MIDDLEDOWN )
+        _fakeButtonEvent(_display, _BUTTON_MIDDLE, True, CurrentTime);
+    if ( mouseEvent & _MOUSEEVENTF_MIDDLEUP )
+        _fakeButtonEvent(_display, _BUTTON_MIDDLE, False, CurrentTime);
+    XFlush(_display);
+}
+
+/// Maps the windows virtual key codes (which are also used in the dart code) to x11 key symbols (or NoSymbol)
+inline KeySym _virtualKeyToKeySym(unsigned short keyCode)
+{
+    if ( keyCode >= 0x30 && keyCode <= 0x39 )
+        return XK_0 + (keyCode - 0x30);
+    if ( keyCode >= 0x41 && keyCode <= 0x5A )
+        return XK_a + (keyCode - 0x41);
+    if ( keyCode >= 0x60 && keyCode <= 0x69 )
+        return XK_KP_0 + (keyCode - 0x60);
+    if ( keyCode >= 0x70 && keyCode <= 0x87 )
+        return XK_F1 + (keyCode - 0x70);
+    switch ( keyCode )
+    {
+        case 0x08: return XK_BackSpace;
+        case 0x09: return XK_Tab;
+        case 0x0C: return XK_Clear;
+        case 0x0D: return XK_Return;
+        case 0x10: return XK_Shift_L;
+        case 0x11: return XK_Control_L;
+        case 0x12: return XK_Alt_L;
+        case 0x13: return XK_Pause;
+        case 0x14: return XK_Caps_Lock;
+        case 0x1B: return XK_Escape;
+        case 0x20: return XK_space;
+        case 0x21: return XK_Prior;
+        case 0x22: return XK_Next;
+        case 0x23: return XK_End;
+        case 0x24: return XK_Home;
+        case 0x25: return XK_Left;
+        case 0x26: return XK_Up;
+        case 0x27: return XK_Right;
+        case 0x28: return XK_Down;
+        case 0x2C: return XK_Print;
+        case 0x2D: return XK_Insert;
+        case 0x2E: return XK_Delete;
+        case 0x5B: return XK_Super_L;
+        case 0x5C: return XK_Super_R;
+        case 0x5D: return XK_Menu;
+        case 0x6A: return XK_KP_Multiply;
+        case 0x6B: return XK_KP_Add;
+        case 0x6C: return XK_KP_Separator;
+        case 0x6D: return XK_KP_Subtract;
+        case 0x6E: return XK_KP_Decimal;
+        case 0x6F: return XK_KP_Divide;
+        case 0x90: return XK_Num_Lock;
+        case 0x91: return XK_Scroll_Lock;
+        case 0xA0: return XK_Shift_L;
+        case 0xA1: return XK_Shift_R;
+        case 0xA2: return XK_Control_L;
+        case 0xA3: return XK_Control_R;
+        case 0xA4: return XK_Alt_L;
+        case 0xA5: return XK_Alt_R;
+        case 0xBA: return XK_semicolon;
+        case 0xBB: return XK_equal;
+        case 0xBC: return XK_comma;
+        case 0xBD: return XK_minus;
+        case 0xBE: return XK_period;
+        case 0xBF: return XK_slash;
+        case 0xC0: return XK_grave;
+        case 0xDB: return XK_bracketleft;
+        case 0xDC: return XK_backslash;
+        case 0xDD: return XK_bracketright;
+        case 0xDE: return XK_apostrophe;
+        case 0xE2: return XK_less;
+        default: return NoSymbol;
+    }
+}
+
+void _platformSendKeyEvents(bool keyUp, const unsigned short *keyCodes, unsigned short amountOfKeys)
+{
+    if ( _getDisplay() == 0 || !_loadXTest())
+    {
+        return;
+    }
+    for ( unsigned short i = 0; i < amountOfKeys; ++i )
+    {
+        KeySym symbol = _virtualKeyToKeySym(keyCodes[i]);
+        KeyCode code = symbol != NoSymbol ? XKeysymToKeycode(_display, symbol) : 0;
+        if ( code != 0 )
+        {
+            _fakeKeyEvent(_display, code, keyUp ? False : True, CurrentTime);
+        }
+    }
+    XFlush(_display);
+}
+
+/// Returns if the key with the [symbol] is currently down in the [keys] from XQueryKeymap
+inline bool _isSymbolDown(const char *keys, KeySym symbol)
+{
+    KeyCode code = XKeysymToKeycode(_display, symbol);
+    return code != 0 && (keys[code / 8] & (1 << (code % 8))) != 0;
+}
+
+bool _platformIsKeyDown(unsigned short keyCode)
+{
+    if ( _getDisplay() == 0 )
+    {
+        return false;
+    }
+    if ( keyCode == 0x01 || keyCode == 0x02 || keyCode == 0x04 )
+    {
+        // mouse buttons (swapped buttons are already handled by the x server pointer mapping)
+        Window rootReturn, child;
+        int rootX, rootY, windowX, windowY;
+        unsigned int mask = 0;
+        XQueryPointer(_display, DefaultRootWindow(_display), &rootReturn, &child, &rootX, &rootY, &windowX, &windowY,
+                      &mask);
+        unsigned int button = keyCode == 0x01 ? Button1Mask : (keyCode == 0x02 ? Button3Mask : Button2Mask);
+        return (mask & button) != 0;
+    }
+    KeySym symbol = _virtualKeyToKeySym(keyCode);
+    if ( symbol == NoSymbol )
+    {
+        return false;
+    }
+    char keys[32];
+    XQueryKeymap(_display, keys);
+    switch ( keyCode )
+    {
+        // generic modifier codes are down if either side is down
+        case 0x10: return _isSymbolDown(keys, XK_Shift_L) || _isSymbolDown(keys, XK_Shift_R);
+        case 0x11: return _isSymbolDown(keys, XK_Control_L) || _isSymbolDown(keys, XK_Control_R);
+        case 0x12: return _isSymbolDown(keys, XK_Alt_L) || _isSymbolDown(keys, XK_Alt_R);
+        default: return _isSymbolDown(keys, symbol);
+    }
+}
+
+bool _platformIsKeyToggled(unsigned short keyCode)
+{
+    if ( _getDisplay() == 0 )
+    {
+        return false;
+    }
+    const char *indicator = keyCode == 0x14 ? "Caps Lock" : (keyCode == 0x90 ? "Num Lock" : (keyCode == 0x91
+                                                                                               ? "Scroll Lock" : 0));
+    if ( indicator == 0 )
+    {
+        return false;
+    }
+    Bool state = False;
+    XkbGetNamedIndicator(_display, _atom(indicator), 0, &state, 0, 0);
+    return state;
+}
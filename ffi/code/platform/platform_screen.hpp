@@ -0,0 +1,53 @@
+#ifndef PLATFORM_SCREEN_H
+#define PLATFORM_SCREEN_H
+
+#include "platform.hpp"
+
+/// Live screen backend of the window, display and capture functions of platform.hpp. These are implemented in the
+/// platform files (platform_windows.cpp, platform_linux.cpp) with the same contract as the _platform functions of the
+/// same name. The _platform versions are implemented in source/frame_source.cpp, which forwards to these unless a
+/// synthetic frame source is active. Only the frame source and the platform files themselves may use these!
+
+void _screenEnumWindows(WindowEnumCallback callback, void *userData);
+
+uint64_t _screenWindowListVersion();
+
+bool _screenSetWindowEventCallback(WindowEventCallback callback);
+
+bool _screenIsWindow(WindowHandle handle);
+
+void _screenOnWindowLost();
+
+int _screenGetWindowAffinity(WindowHandle handle);
+
+WindowHandle _screenGetForegroundWindow();
+
+bool _screenSetForegroundWindow(WindowHandle handle);
+
+bool _screenGetWindowRect(WindowHandle handle, RECT *bounds);
+
+bool _screenGetClientSize(WindowHandle handle, POINT *size);
+
+bool _screenScreenToClient(WindowHandle handle, POINT *point);
+
+bool _screenClientToScreen(WindowHandle handle, POINT *point);
+
+bool _screenCloseWindow(WindowHandle handle);
+
+unsigned int _screenGetDisplayWidth();
+
+unsigned int _screenGetDisplayHeight();
+
+bool _screenCaptureScreen(int x, int y, int width, int height, unsigned char *target);
+
+bool _screenCaptureWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                        int targetStride);
+
+bool _screenCaptureConverted(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                             int targetStride, CaptureRowConverter convert, int targetChannels);
+
+bool _screenGetCaptureWindowArea(PlatformCapture *capture, WindowHandle handle, RECT *bounds, POINT *innerSize);
+
+unsigned long _screenGetScreenPixel(int x, int y);
+
+#endif //PLATFORM_SCREEN_H
@@ -0,0 +1,563 @@
+#include "platform_screen.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// Incremented in _screenOnWindowLost, so that every thread refreshes its own main display DC
+std::atomic<unsigned long long> _mainDisplayGeneration{0};
+
+/// DC of the main display of one thread. A DC may not be used by multiple threads at the same time, so every thread
+/// caches its own one which is released when the thread exits
+struct _ThreadDisplay
+{
+    HDC deviceContext = 0;
+    unsigned long long generation = 0;
+
+    ~_ThreadDisplay()
+    {
+        if ( deviceContext != 0 )
+        {
+            ReleaseDC(0, deviceContext);
+        }
+    }
+};
+
+thread_local _ThreadDisplay _mainDisplay;
+
+/// Sets and returns the cached main display of the calling thread (refreshed after a window handle was lost)
+inline HDC _getMainDisplay()
+{
+    unsigned long long generation = _mainDisplayGeneration.load(std::memory_order_acquire);
+    if ( _mainDisplay.deviceContext != 0 && _mainDisplay.generation != generation )
+    {
+        ReleaseDC(0, _mainDisplay.deviceContext);
+        _mainDisplay.deviceContext = 0;
+    }
+    if ( _mainDisplay.deviceContext == 0 )
+    {
+        _mainDisplay.deviceContext = GetDC(0);
+        _mainDisplay.generation = generation;
+    }
+    return _mainDisplay.deviceContext;
+}
+
+struct _EnumHelper
+{
+    WindowEnumCallback callback;
+    void *userData;
+};
+
+/// Longer titles are cut off (same limit as on linux)
+#define _MAX_TITLE_LENGTH 512
+
+/// Helper method that will be called with every open window handle. The wide title is converted to utf8 on the
+/// stack, so that non latin titles can be matched and nothing is allocated per window
+int __stdcall _enumWindows(HWND hwnd, LPARAM lParam)
+{
+    _EnumHelper *helper = (_EnumHelper *) lParam;
+    if ( GetWindowTextLengthW(hwnd) <= 2 || !IsWindowVisible(hwnd))
+    {
+        return 1;
+    }
+    wchar_t wideTitle[_MAX_TITLE_LENGTH];
+    int written = GetWindowTextW(hwnd, wideTitle, _MAX_TITLE_LENGTH);
+    if ( written <= 1 )
+    {
+        return 1;
+    }
+    char windowTitle[_MAX_TITLE_LENGTH * 3]; // every utf16 unit needs at most 3 utf8 bytes
+    int length = WideCharToMultiByte(CP_UTF8, 0, wideTitle, written, windowTitle, sizeof(windowTitle) - 1, 0, 0);
+    if ( length <= 0 )
+    {
+        return 1;
+    }
+    windowTitle[length] = 0;
+    return helper->callback((WindowHandle) hwnd, windowTitle, helper->userData) ? 1 : 0;
+}
+
+void _screenEnumWindows(WindowEnumCallback callback, void *userData)
+{
+    _EnumHelper helper{callback, userData};
+    EnumWindows(_enumWindows, (LPARAM) &helper);
+}
+
+/// Incremented by the window event hook for every change of the top level windows
+std::atomic<uint64_t> _windowListVersion{0};
+
+/// Set with _screenSetWindowEventCallback and called from the hook thread
+std::atomic<WindowEventCallback> _windowEventCallback{0};
+
+/// The hook thread is started on the first _screenWindowListVersion or _screenSetWindowEventCallback call
+std::once_flag _windowHookThreadStarted;
+
+/// 0 while the hook thread is starting, 1 if the hooks are installed and -1 if it failed
+int _windowHookState = 0;
+std::mutex _windowHookMutex;
+std::condition_variable _windowHookStarted;
+
+/// Only used if the hook could not be installed (then every call returns a new version)
+std::atomic<uint64_t> _fallbackListVersion{0};
+
+/// Called out of context on the hook thread for every window event
+void __stdcall _onWindowEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+                              DWORD eventThread, DWORD eventTime)
+{
+    if ( idObject != OBJID_WINDOW || idChild != CHILDID_SELF || hwnd == 0 )
+    {
+        return;
+    }
+    if ( IsWindow(hwnd) && GetAncestor(hwnd, GA_ROOT) != hwnd )
+    {
+        return; // child controls are never matched (destroyed windows can not be checked anymore)
+    }
+    int windowEvent;
+    switch ( event )
+    {
+        case EVENT_SYSTEM_FOREGROUND:
+            windowEvent = _WINDOW_EVENT_FOCUS;
+            break;
+        case EVENT_OBJECT_LOCATIONCHANGE:
+        case EVENT_SYSTEM_MINIMIZESTART:
+        case EVENT_SYSTEM_MINIMIZEEND:
+            windowEvent = _WINDOW_EVENT_BOUNDS;
+            break;
+        default:
+            windowEvent = _WINDOW_EVENT_OPEN;
+            _windowListVersion.fetch_add(1, std::memory_order_release);
+            break;
+    }
+    WindowEventCallback callback = _windowEventCallback.load(std::memory_order_acquire);
+    if ( callback != 0 )
+    {
+        callback((WindowHandle) hwnd, windowEvent);
+    }
+}
+
+/// Out of context hooks are delivered through the message queue of the thread that installed them, so this thread
+/// only pumps messages for the whole lifetime of the process
+void _runWindowHook()
+{
+    const DWORD ranges[][2] = {{EVENT_OBJECT_CREATE,         EVENT_OBJECT_HIDE},
+                               {EVENT_OBJECT_NAMECHANGE,     EVENT_OBJECT_NAMECHANGE},
+                               {EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE},
+                               {EVENT_SYSTEM_FOREGROUND,     EVENT_SYSTEM_FOREGROUND},
+                               {EVENT_SYSTEM_MINIMIZESTART,  EVENT_SYSTEM_MINIMIZEEND}};
+    HWINEVENTHOOK hooks[5];
+    bool installed = true;
+    for ( int i = 0; i < 5; ++i )
+    {
+        hooks[i] = SetWinEventHook(ranges[i][0], ranges[i][1], 0, _onWindowEvent, 0, 0, WINEVENT_OUTOFCONTEXT);
+        installed = installed && hooks[i] != 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_windowHookMutex);
+        _windowHookState = installed ? 1 : -1;
+        _windowHookStarted.notify_all(); // under the lock, because the waiting thread may exit right after it
+    }
+    if ( !installed )
+    {
+        for ( HWINEVENTHOOK hook : hooks )
+        {
+            if ( hook != 0 )
+            {
+                UnhookWinEvent(hook);
+            }
+        }
+        return;
+    }
+    MSG message;
+    while ( GetMessageA(&message, 0, 0, 0) > 0 )
+    {
+        TranslateMessage(&message);
+        DispatchMessageA(&message);
+    }
+}
+
+/// Starts the hook thread once and returns if the hooks are installed
+inline bool _startWindowHook()
+{
+    std::call_once(_windowHookThreadStarted, [] { std::thread(_runWindowHook).detach(); });
+    std::unique_lock<std::mutex> lock(_windowHookMutex);
+    _windowHookStarted.wait(lock, [] { return _windowHookState != 0; });
+    return _windowHookState == 1;
+}
+
+uint64_t _screenWindowListVersion()
+{
+    if ( !_startWindowHook())
+    {
+        return ++_fallbackListVersion;
+    }
+    return _windowListVersion.load(std::memory_order_acquire);
+}
+
+bool _screenSetWindowEventCallback(WindowEventCallback callback)
+{
+    _windowEventCallback.store(callback, std::memory_order_release);
+    return callback == 0 || _startWindowHook();
+}
+
+bool _screenIsWindow(WindowHandle handle)
+{
+    return IsWindow((HWND) handle);
+}
+
+void _screenOnWindowLost()
+{
+    _mainDisplayGeneration.fetch_add(1, std::memory_order_release);
+}
+
+int _screenGetWindowAffinity(WindowHandle handle)
+{
+    DWORD affinity = 0;
+    GetWindowDisplayAffinity((HWND) handle, &affinity);
+    return (int) affinity;
+}
+
+WindowHandle _screenGetForegroundWindow()
+{
+    return (WindowHandle) GetForegroundWindow();
+}
+
+bool _screenSetForegroundWindow(WindowHandle handle)
+{
+    return SetForegroundWindow((HWND) handle);
+}
+
+bool _screenGetWindowRect(WindowHandle handle, RECT *bounds)
+{
+    return GetWindowRect((HWND) handle, bounds);
+}
+
+bool _screenGetClientSize(WindowHandle handle, POINT *size)
+{
+    RECT bounds;
+    if ( !GetClientRect((HWND) handle, &bounds))
+    {
+        return false;
+    }
+    size->x = bounds.right - bounds.left;
+    size->y = bounds.bottom - bounds.top;
+    return true;
+}
+
+bool _screenScreenToClient(WindowHandle handle, POINT *point)
+{
+    return ScreenToClient((HWND) handle, point);
+}
+
+bool _screenClientToScreen(WindowHandle handle, POINT *point)
+{
+    return ClientToScreen((HWND) handle, point);
+}
+
+#define _WM_CLOSE 0x0010
+
+bool _screenCloseWindow(WindowHandle handle)
+{
+    SendMessageA((HWND) handle, _WM_CLOSE, 0, 0);
+    return true;
+}
+
+#define _HOZRES 8
+
+unsigned int _screenGetDisplayWidth()
+{
+    return GetDeviceCaps(_getMainDisplay(), _HOZRES);
+}
+
+#define _VERTREX 10
+
+unsigned int _screenGetDisplayHeight()
+{
+    return GetDeviceCaps(_getMainDisplay(), _VERTREX);
+}
+
+#define _SRCCOPY 0x00CC0020ul
+#define _BI_RGB 0L
+#define _DIB_RGB_COLORS 0
+
+bool _screenCaptureScreen(int x, int y, int width, int height, unsigned char *target)
+{
+    HDC deviceContext = _getMainDisplay();
+    HDC memoryDeviceContext = CreateCompatibleDC(deviceContext);
+    HBITMAP bitmap = CreateCompatibleBitmap(deviceContext, width, height);
+    HGDIOBJ oldObject = SelectObject(memoryDeviceContext, bitmap);
+    BitBlt(memoryDeviceContext, 0, 0, width, height, deviceContext, x, y, _SRCCOPY); // now image data is in bitmap
+
+    BITMAPINFOHEADER bi; // format on how the bitmap is interpreted for opencv
+    bi.biSize = sizeof(BITMAPINFOHEADER);
+    bi.biWidth = width;
+    bi.biHeight = -height;
+    bi.biPlanes = 1;
+    bi.biBitCount = 32; // RGBA
+    bi.biCompression = _BI_RGB; // no compression
+    bi.biSizeImage = 0; // because no compression
+    bi.biXPelsPerMeter = 1; // irrelevant
+    bi.biYPelsPerMeter = 1; // irrelevant
+    bi.biClrUsed = 3; // irrelevant
+    bi.biClrImportant = 4; // irrelevant
+
+    int lines = GetDIBits(memoryDeviceContext, bitmap, 0, height, target, (BITMAPINFO * ) & bi, _DIB_RGB_COLORS);
+    // copy into buffer: 0 start, height = lines, mat.data is buffer, bitmapinfo, rgba info
+
+    SelectObject(memoryDeviceContext, oldObject);
+    DeleteObject(bitmap);
+    DeleteDC(memoryDeviceContext); // delete dc
+    return lines > 0;
+}
+
+struct PlatformCapture
+{
+    /// Own DC of the screen instead of _mainDisplay, so that captures can be used on other threads
+    HDC screen = 0;
+    HDC memoryDeviceContext = 0;
+    HBITMAP bitmap = 0;
+    HGDIOBJ oldObject = 0;
+    /// Memory of the DIB section as top down BGRA with width * 4 bytes per row
+    unsigned char *pixels = 0;
+    /// Size of the DIB section (biggest size that was requested so far)
+    int width = 0;
+    int height = 0;
+};
+
+PlatformCapture *_platformCreateCapture()
+{
+    PlatformCapture *capture = new PlatformCapture();
+    capture->screen = GetDC(0);
+    return capture;
+}
+
+inline void _releaseCaptureBitmap(PlatformCapture *capture)
+{
+    if ( capture->bitmap != 0 )
+    {
+        SelectObject(capture->memoryDeviceContext, capture->oldObject);
+        DeleteObject(capture->bitmap);
+        capture->bitmap = 0;
+        capture->pixels = 0;
+        capture->width = 0;
+        capture->height = 0;
+    }
+}
+
+void _platformDestroyCapture(PlatformCapture *capture)
+{
+    if ( capture == 0 )
+    {
+        return;
+    }
+    _releaseCaptureBitmap(capture);
+    if ( capture->memoryDeviceContext != 0 )
+    {
+        DeleteDC(capture->memoryDeviceContext);
+    }
+    if ( capture->screen != 0 )
+    {
+        ReleaseDC(0, capture->screen);
+    }
+    delete capture;
+}
+
+/// Creates the memory DC once and only recreates the DIB section if the area does not fit into it anymore
+inline bool _ensureCaptureSize(PlatformCapture *capture, int width, int height)
+{
+    if ( capture->memoryDeviceContext == 0 )
+    {
+        capture->memoryDeviceContext = CreateCompatibleDC(capture->screen);
+        if ( capture->memoryDeviceContext == 0 )
+        {
+            return false;
+        }
+    }
+    if ( capture->bitmap != 0 && width <= capture->width && height <= capture->height )
+    {
+        return true;
+    }
+    int newWidth = width > capture->width ? width : capture->width;
+    int newHeight = height > capture->height ? height : capture->height;
+    _releaseCaptureBitmap(capture);
+
+    BITMAPINFO info; // same format as in _screenCaptureScreen, but the DIB section memory can be read directly
+    memset(&info, 0, sizeof(info));
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = newWidth;
+    info.bmiHeader.biHeight = -newHeight; // top down
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = _BI_RGB;
+    void *bits = 0;
+    capture->bitmap = CreateDIBSection(capture->memoryDeviceContext, &info, _DIB_RGB_COLORS, &bits, 0, 0);
+    if ( capture->bitmap == 0 || bits == 0 )
+    {
+        capture->bitmap = 0;
+        return false;
+    }
+    capture->oldObject = SelectObject(capture->memoryDeviceContext, capture->bitmap);
+    capture->pixels = (unsigned char *) bits;
+    capture->width = newWidth;
+    capture->height = newHeight;
+    return true;
+}
+
+#define _SM_XVIRTUALSCREEN 76
+#define _SM_YVIRTUALSCREEN 77
+#define _SM_CXVIRTUALSCREEN 78
+#define _SM_CYVIRTUALSCREEN 79
+
+/// Returns true if the area is completely inside of the virtual screen (all monitors), so BitBlt writes every pixel
+inline bool _isOnScreen(int x, int y, int width, int height)
+{
+    int left = GetSystemMetrics(_SM_XVIRTUALSCREEN);
+    int top = GetSystemMetrics(_SM_YVIRTUALSCREEN);
+    return x >= left && y >= top && x + width <= left + GetSystemMetrics(_SM_CXVIRTUALSCREEN) &&
+           y + height <= top + GetSystemMetrics(_SM_CYVIRTUALSCREEN);
+}
+
+bool _screenCaptureWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                        int targetStride)
+{
+    return _screenCaptureConverted(capture, x, y, width, height, target, targetStride, 0, 4);
+}
+
+bool _screenCaptureConverted(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                             int targetStride, CaptureRowConverter convert, int targetChannels)
+{
+    if ( capture == 0 || capture->screen == 0 || width <= 0 || height <= 0 || targetStride < width * targetChannels ||
+         !_ensureCaptureSize(capture, width, height))
+    {
+        return false;
+    }
+    size_t sourceStride = (size_t) capture->width * 4;
+    size_t rowBytes = (size_t) width * 4;
+    if ( !_isOnScreen(x, y, width, height))
+    {
+        // BitBlt does not write the parts outside of the screen, so the reused DIB section would still contain the
+        // pixels of an older capture there (they have to be black like in _screenCaptureScreen)
+        for ( int row = 0; row < height; ++row )
+        {
+            memset(capture->pixels + row * sourceStride, 0, rowBytes);
+        }
+    }
+    if ( !BitBlt(capture->memoryDeviceContext, 0, 0, width, height, capture->screen, x, y, _SRCCOPY))
+    {
+        return false;
+    }
+    GdiFlush(); // the DIB section memory is only valid after all gdi calls are done
+    for ( int row = 0; row < height; ++row )
+    {
+        // the conversion is done while the rows are copied out of the DIB section (no extra pass over the image)
+        if ( convert != 0 )
+        {
+            convert(capture->pixels + row * sourceStride, width, target + (size_t) row * targetStride);
+        } else
+        {
+            memcpy(target + (size_t) row * targetStride, capture->pixels + row * sourceStride, rowBytes);
+        }
+    }
+    return true;
+}
+
+bool _screenGetCaptureWindowArea(PlatformCapture *capture, WindowHandle handle, RECT *bounds, POINT *innerSize)
+{
+    // user32 window functions can be called from any thread
+    return capture != 0 && _screenGetWindowRect(handle, bounds) && _screenGetClientSize(handle, innerSize);
+}
+
+unsigned long _screenGetScreenPixel(int x, int y)
+{
+    COLORREF colorRef = GetPixel(_getMainDisplay(), x, y);
+    return (unsigned long) colorRef;
+}
+
+POINT _platformGetCursorPos()
+{
+    POINT point;
+    GetCursorPos(&point);
+    return point;
+}
+
+void _platformSetCursorPos(int x, int y)
+{
+    SetCursorPos(x, y);
+}
+
+#define _INPUT_MOUSE 0
+#define _MOUSEEVENTF_MOVE 0x0001
+
+void _platformMoveMouse(int dx, int dy)
+{
+    INPUT input;
+    input.type = _INPUT_MOUSE;
+    input.mi.mouseData = 0;
+    input.mi.time = 0;
+    input.mi.dx = dx;
+    input.mi.dy = dy;
+    input.mi.dwFlags = _MOUSEEVENTF_MOVE;
+    SendInput(1, &input, sizeof(input));
+}
+
+#define _MOUSEEVENTF_WHEEL 0x0800
+
+void _platformScrollMouse(int scrollClickAmount)
+{
+    INPUT input;
+    input.type = _INPUT_MOUSE;
+    input.mi.time = 0;
+    input.mi.mouseData = scrollClickAmount * 120; // may be negative (120 is one click in any direction)
+    input.mi.dwFlags = _MOUSEEVENTF_WHEEL;
+    SendInput(1, &input, sizeof(input));
+}
+
+void _platformSendMouseEvent(int mouseEvent)
+{
+    INPUT input;
+    input.type = _INPUT_MOUSE;
+    input.mi.time = 0;
+    input.mi.dwFlags = mouseEvent;
+    SendInput(1, &input, sizeof(INPUT));
+}
+
+#define _INPUT_KEYBOARD 1
+#define _KEYEVENTF_SCANCODE 0x0008
+#define _KEYEVENTF_KEYUP 0x0002
+#define _MAPVK_VK_TO_VSC 0
+
+void _platformSendKeyEvents(bool keyUp, const unsigned short *keyCodes, unsigned short amountOfKeys)
+{
+    INPUT *inputs = (INPUT *) malloc(amountOfKeys * sizeof(INPUT));
+    for ( unsigned short i = 0; i < amountOfKeys; ++i )
+    {
+        INPUT &input = inputs[i];
+        input.type = _INPUT_KEYBOARD;
+        input.ki.time = 0;
+        input.ki.wVk = 0;
+        input.ki.dwExtraInfo = 0;
+        if ( keyUp )
+            input.ki.dwFlags = _KEYEVENTF_SCANCODE | _KEYEVENTF_KEYUP;
+        else
+            input.ki.dwFlags = _KEYEVENTF_SCANCODE;
+        input.ki.wScan = (WORD) MapVirtualKeyA(keyCodes[i], _MAPVK_VK_TO_VSC);
+    }
+    SendInput(amountOfKeys, inputs, sizeof(INPUT));
+    free(inputs);
+}
+
+#define _SM_SWAPBUTTON 23
+
+bool _platformIsKeyDown(unsigned short keyCode)
+{
+    if ( keyCode <= 0x02 && GetSystemMetrics(_SM_SWAPBUTTON))
+    {
+        return (GetAsyncKeyState(keyCode == 0x02 ? 0x01 : 0x02) & 0x8000); // left and right mouse button swapped
+    }
+    return GetAsyncKeyState(keyCode) & 0x8000;
+}
+
+bool _platformIsKeyToggled(unsigned short keyCode)
+{
+    return GetKeyState(keyCode) & 0x01; // caps lock, num lock, etc
+}
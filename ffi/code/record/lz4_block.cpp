@@ -0,0 +1,228 @@
+#include "lz4_block.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/// Limits of the lz4 block format: matches have at least 4 bytes, the last 5 bytes are always literals and no match
+/// may start in the last 12 bytes
+#define _LZ4_MIN_MATCH 4
+#define _LZ4_LAST_LITERALS 5
+#define _LZ4_MATCH_LIMIT 12
+#define _LZ4_MAX_OFFSET 65535
+
+/// Size of the hash table of the compressor (positions of the last sequences of 4 bytes)
+#define _LZ4_HASH_BITS 16
+
+inline uint32_t _lz4Read32(const unsigned char *data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint64_t _lz4Read64(const unsigned char *data)
+{
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline uint32_t _lz4Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - _LZ4_HASH_BITS);
+}
+
+/// Writes the rest of a literal or match [length] that did not fit into the 4 bits of the token
+inline unsigned char *_lz4WriteLength(unsigned char *out, int length)
+{
+    for ( ; length >= 255; length -= 255 )
+    {
+        *out++ = 255;
+    }
+    *out++ = (unsigned char) length;
+    return out;
+}
+
+/// Returns the end of the match at [position] with the earlier bytes at [match] (at most up to [limit])
+inline const unsigned char *_lz4MatchEnd(const unsigned char *position, const unsigned char *match,
+                                         const unsigned char *limit)
+{
+    while ( position + 8 <= limit && _lz4Read64(position) == _lz4Read64(match))
+    {
+        position += 8;
+        match += 8;
+    }
+    while ( position < limit && *position == *match )
+    {
+        ++position;
+        ++match;
+    }
+    return position;
+}
+
+/// Writes one sequence of the [literals] bytes at [anchor] and a match of [matchLength] bytes [offset] bytes back
+/// (no match if [matchLength] is 0 for the last sequence). Returns 0 if it does not fit before [outEnd]
+inline unsigned char *_lz4WriteSequence(unsigned char *out, unsigned char *outEnd, const unsigned char *anchor,
+                                        int literals, int matchLength, int offset)
+{
+    int extraLength = matchLength > 0 ? matchLength - _LZ4_MIN_MATCH : 0;
+    if ( outEnd - out < 1 + literals / 255 + 1 + literals + 2 + extraLength / 255 + 1 )
+    {
+        return 0;
+    }
+    unsigned char *token = out++;
+    *token = (unsigned char) ((literals >= 15 ? 15 : literals) << 4);
+    if ( literals >= 15 )
+    {
+        out = _lz4WriteLength(out, literals - 15);
+    }
+    if ( literals > 0 )
+    {
+        memcpy(out, anchor, (size_t) literals);
+        out += literals;
+    }
+    if ( matchLength > 0 )
+    {
+        *out++ = (unsigned char) (offset & 0xFF);
+        *out++ = (unsigned char) (offset >> 8);
+        *token |= (unsigned char) (extraLength >= 15 ? 15 : extraLength);
+        if ( extraLength >= 15 )
+        {
+            out = _lz4WriteLength(out, extraLength - 15);
+        }
+    }
+    return out;
+}
+
+int _lz4CompressBound(int size)
+{
+    return size + size / 255 + 16;
+}
+
+int _lz4Compress(const unsigned char *source, int size, unsigned char *target, int capacity)
+{
+    if ( size < 0 || capacity <= 0 )
+    {
+        return 0;
+    }
+    thread_local std::vector<int> table;
+    table.assign((size_t) 1 << _LZ4_HASH_BITS, -1);
+    const unsigned char *end = source + size;
+    const unsigned char *anchor = source;
+    const unsigned char *position = source;
+    unsigned char *out = target;
+    unsigned char *outEnd = target + capacity;
+    if ( size > _LZ4_MATCH_LIMIT )
+    {
+        const unsigned char *matchLimit = end - _LZ4_MATCH_LIMIT;
+        const unsigned char *lengthLimit = end - _LZ4_LAST_LITERALS;
+        int misses = 0;
+        while ( position < matchLimit )
+        {
+            uint32_t sequence = _lz4Read32(position);
+            int &entry = table[_lz4Hash(sequence)];
+            const unsigned char *match = entry >= 0 ? source + entry : 0;
+            entry = (int) (position - source);
+            if ( match == 0 || position - match > _LZ4_MAX_OFFSET || _lz4Read32(match) != sequence )
+            {
+                position += 1 + (misses++ >> 6); // skips faster through data that does not compress
+                continue;
+            }
+            misses = 0;
+            while ( position > anchor && match > source && position[-1] == match[-1] )
+            {
+                --position;
+                --match;
+            }
+            const unsigned char *matchEnd = _lz4MatchEnd(position + _LZ4_MIN_MATCH, match + _LZ4_MIN_MATCH,
+                                                         lengthLimit);
+            out = _lz4WriteSequence(out, outEnd, anchor, (int) (position - anchor), (int) (matchEnd - position),
+                                    (int) (position - match));
+            if ( out == 0 )
+            {
+                return 0;
+            }
+            position = anchor = matchEnd;
+            if ( position < matchLimit )
+            {
+                table[_lz4Hash(_lz4Read32(position - 2))] = (int) (position - 2 - source);
+            }
+        }
+    }
+    out = _lz4WriteSequence(out, outEnd, anchor, (int) (end - anchor), 0, 0);
+    return out != 0 ? (int) (out - target) : 0;
+}
+
+/// Reads the rest of a length after the 4 bits of the token. Returns false if the block ends before it
+inline bool _lz4ReadLength(const unsigned char **in, const unsigned char *inEnd, int *length)
+{
+    unsigned char next;
+    do
+    {
+        if ( *in >= inEnd || *length > 0x7F000000 )
+        {
+            return false;
+        }
+        next = *(*in)++;
+        *length += next;
+    } while ( next == 255 );
+    return true;
+}
+
+int _lz4Decompress(const unsigned char *source, int size, unsigned char *target, int capacity)
+{
+    const unsigned char *in = source;
+    const unsigned char *inEnd = source + size;
+    unsigned char *out = target;
+    unsigned char *outEnd = target + capacity;
+    while ( in < inEnd )
+    {
+        int token = *in++;
+        int literals = token >> 4;
+        if ( literals == 15 && !_lz4ReadLength(&in, inEnd, &literals))
+        {
+            return -1;
+        }
+        if ( literals > inEnd - in || literals > outEnd - out )
+        {
+            return -1;
+        }
+        if ( literals > 0 )
+        {
+            memcpy(out, in, (size_t) literals);
+            in += literals;
+            out += literals;
+        }
+        if ( in == inEnd )
+        {
+            break; // the last sequence has no match
+        }
+        if ( inEnd - in < 2 )
+        {
+            return -1;
+        }
+        int offset = in[0] | (in[1] << 8);
+        in += 2;
+        int matchLength = token & 15;
+        if ( matchLength == 15 && !_lz4ReadLength(&in, inEnd, &matchLength))
+        {
+            return -1;
+        }
+        matchLength += _LZ4_MIN_MATCH;
+        if ( offset == 0 || offset > out - target || matchLength > outEnd - out )
+        {
+            return -1;
+        }
+        // the match may overlap the output (repeated patterns), so it is copied in chunks that never overlap and
+        // double with every copy (offset 4 for a uniform BGRA area)
+        const unsigned char *match = out - offset;
+        while ( matchLength > 0 )
+        {
+            int chunk = (int) (out - match) < matchLength ? (int) (out - match) : matchLength;
+            memcpy(out, match, (size_t) chunk);
+            out += chunk;
+            matchLength -= chunk;
+        }
+    }
+    return (int) (out - target);
+}
@@ -0,0 +1,19 @@
+#ifndef LZ4_BLOCK_H
+#define LZ4_BLOCK_H
+
+/// Internal: compression of the recording records in the lz4 block format (without the frame format around it), so
+/// any lz4 library can also read them (for example LZ4_decompress_safe, or lz4.block.decompress in python). This is
+/// a small greedy compressor that favours speed like the default level of lz4.
+
+/// Biggest compressed size of [size] bytes (incompressible data gets a bit bigger)
+int _lz4CompressBound(int size);
+
+/// Compresses [size] bytes of [source] into [target]. Returns the compressed size, or 0 if it does not fit into the
+/// [capacity] (so passing a smaller capacity than the [size] stops early for incompressible data)
+int _lz4Compress(const unsigned char *source, int size, unsigned char *target, int capacity);
+
+/// Decompresses an lz4 block of [size] bytes into [target]. Returns the decompressed size, or -1 if the block is
+/// invalid, or if it would not fit into the [capacity] (never reads or writes outside of both buffers)
+int _lz4Decompress(const unsigned char *source, int size, unsigned char *target, int capacity);
+
+#endif //LZ4_BLOCK_H
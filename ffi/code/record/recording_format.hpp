@@ -0,0 +1,71 @@
+#ifndef RECORDING_FORMAT_H
+#define RECORDING_FORMAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// Internal: file format of the session recordings (see session_recorder.hpp). A recording is one _RecordingHeader
+/// followed by records that are only appended, so a recording that was not stopped cleanly can still be read up to
+/// its last complete record. Each record is a _RecordHeader followed by [storedSize] bytes of payload.
+/// All values are little endian.
+///
+/// The uncompressed payload of a keyframe is the whole BGRA frame (rows of width * 4 bytes).
+/// The uncompressed payload of a delta contains the uint32 indices of the [tiles] tiles of _TILE_SIZE x _TILE_SIZE
+/// pixels (row by row like _hashTiles) that changed since the previous record, followed by the BGRA pixels of those
+/// tiles in the same order (each tile tightly packed, so the tiles at the right and bottom edge are smaller).
+/// The payload is stored raw, or as one lz4 block (readable by any lz4 library, for example LZ4_decompress_safe).
+
+# define _RECORDING_MAGIC "GTRECORD"
+# define _RECORDING_VERSION 1
+/// "RCRD" at the start of every record, to detect a corrupted file
+# define _RECORD_MAGIC 0x44524352u
+
+/// Types of the records
+# define _RECORD_KEYFRAME 0
+# define _RECORD_DELTA 1
+
+/// Compression of the payloads
+# define _RECORD_RAW 0
+# define _RECORD_LZ4 1
+
+struct _RecordingHeader
+{
+    char magic[8];
+    uint32_t version;
+    /// Always _TILE_SIZE of the recorder
+    uint32_t tileSize;
+    /// Unix time in microseconds when the recording was started
+    int64_t startTime;
+};
+
+struct _RecordHeader
+{
+    uint32_t magic;
+    uint32_t type;
+    /// Microseconds since the start of the recording when the frame was captured
+    int64_t timestamp;
+    /// Frame number of the capture thread
+    int64_t frameNumber;
+    /// Window bounds in screen coordinates when the frame was captured
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    /// Inner size of the window (size of the frame)
+    int32_t width;
+    int32_t height;
+    /// Amount of changed tiles of a delta (0 for keyframes)
+    uint32_t tiles;
+    uint32_t compression;
+    /// Size of the payload before and after the compression
+    uint32_t rawSize;
+    uint32_t storedSize;
+};
+
+static_assert(sizeof(_RecordingHeader) == 24, "the recording header is part of the file format");
+static_assert(sizeof(_RecordHeader) == 64, "the record header is part of the file format");
+
+/// Internal: opens the file at the utf8 [path] for reading, or creates it for writing (binary)
+FILE *_openRecordingFile(const char *path, bool write);
+
+#endif //RECORDING_FORMAT_H
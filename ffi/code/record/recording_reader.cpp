@@ -0,0 +1,311 @@
+#include "recording_reader.hpp"
+#include "lz4_block.hpp"
+#include "../capture/tile_hashes.hpp"
+#include "../memory/buffer_pool.hpp"
+#include <string.h>
+#include <mutex>
+
+#ifdef _WIN32
+#include <share.h>
+#endif // #ifdef _WIN32
+
+/// Biggest width and height of a recorded frame that is accepted (so that the frame size always fits into the uint32
+/// sizes of the records)
+#define _MAX_RECORDED_SIZE 16384
+
+/// Readers for every reader id (0 after they were closed, the ids are never reused)
+std::mutex _readerMutex;
+std::vector<_RecordingReader *> _readers;
+
+FILE *_openRecordingFile(const char *path, bool write)
+{
+#ifdef _WIN32
+    wchar_t widePath[MAX_PATH];
+    if ( MultiByteToWideChar(CP_UTF8, 0, path, -1, widePath, MAX_PATH) == 0 )
+    {
+        return 0;
+    }
+    return _wfsopen(widePath, write ? L"wb" : L"rb", _SH_DENYNO); // _wfopen is deprecated (an error with /WX)
+#else
+    return fopen(path, write ? "wb" : "rb");
+#endif // #ifdef _WIN32
+}
+
+/// Seeks to the [offset] from the start of the file (recordings can be bigger than 2 GB)
+inline bool _seekRecordingFile(FILE *file, long long offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t) offset, SEEK_SET) == 0;
+#endif // #ifdef _WIN32
+}
+
+/// Returns the size of the file in bytes (or -1)
+inline long long _recordingFileSize(FILE *file)
+{
+#ifdef _WIN32
+    return _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+#else
+    return fseeko(file, 0, SEEK_END) == 0 ? (long long) ftello(file) : -1;
+#endif // #ifdef _WIN32
+}
+
+/// Returns true if the [header] of a record is valid and continues the [previous] record (0 for the first one)
+inline bool _isValidRecord(const _RecordHeader &header, const _RecordHeader *previous)
+{
+    if ( header.magic != _RECORD_MAGIC || header.width <= 0 || header.height <= 0 ||
+         header.width > _MAX_RECORDED_SIZE || header.height > _MAX_RECORDED_SIZE )
+    {
+        return false;
+    }
+    if ( header.compression == _RECORD_RAW ? header.storedSize != header.rawSize :
+         header.compression != _RECORD_LZ4 || header.storedSize > (uint32_t) _lz4CompressBound((int) header.rawSize) )
+    {
+        return false;
+    }
+    if ( header.type == _RECORD_KEYFRAME )
+    {
+        return header.tiles == 0 && header.rawSize == (uint32_t) header.width * header.height * 4;
+    }
+    // a delta always needs the frame of the previous record with the same size
+    return header.type == _RECORD_DELTA && previous != 0 && previous->width == header.width &&
+           previous->height == header.height && previous->timestamp <= header.timestamp &&
+           header.tiles <= (uint32_t) (_tileCount(header.width) * _tileCount(header.height)) &&
+           header.rawSize >= header.tiles * sizeof(uint32_t);
+}
+
+_RecordingReader *_openReader(const char *path)
+{
+    FILE *file = path != 0 ? _openRecordingFile(path, false) : 0;
+    if ( file == 0 )
+    {
+        return 0;
+    }
+    _RecordingHeader fileHeader;
+    long long size = _recordingFileSize(file);
+    if ( !_seekRecordingFile(file, 0) || fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 ||
+         memcmp(fileHeader.magic, _RECORDING_MAGIC, sizeof(fileHeader.magic)) != 0 ||
+         fileHeader.version != _RECORDING_VERSION || fileHeader.tileSize != _TILE_SIZE )
+    {
+        fclose(file);
+        return 0;
+    }
+    _RecordingReader *reader = new _RecordingReader();
+    reader->file = file;
+    reader->startTime = fileHeader.startTime;
+    long long offset = sizeof(fileHeader);
+    _RecordIndex record;
+    while ( _seekRecordingFile(file, offset) && fread(&record.header, sizeof(record.header), 1, file) == 1 )
+    {
+        const _RecordHeader *previous = reader->records.empty() ? 0 : &reader->records.back().header;
+        if ( !_isValidRecord(record.header, previous) ||
+             offset + (long long) sizeof(record.header) + record.header.storedSize > size )
+        {
+            break; // a truncated record at the end (or a corrupted file), so only the records before it are read
+        }
+        record.offset = offset;
+        reader->records.push_back(record);
+        if ( record.header.type == _RECORD_KEYFRAME )
+        {
+            ++reader->keyframes;
+        }
+        offset += (long long) sizeof(record.header) + record.header.storedSize;
+    }
+    return reader;
+}
+
+void _closeReader(_RecordingReader *reader)
+{
+    fclose(reader->file);
+    delete reader;
+}
+
+long long _findRecord(const _RecordingReader *reader, long long timestamp)
+{
+    if ( reader->records.empty())
+    {
+        return -1;
+    }
+    // the timestamps of the records always increase, so this is a binary search for the last one <= timestamp
+    size_t low = 0;
+    size_t high = reader->records.size();
+    while ( low < high )
+    {
+        size_t middle = low + (high - low) / 2;
+        if ( reader->records[middle].header.timestamp <= timestamp )
+        {
+            low = middle + 1;
+        } else
+        {
+            high = middle;
+        }
+    }
+    return low > 0 ? (long long) low - 1 : 0;
+}
+
+/// Reads the payload of the [record] into reader->payload (decompressed). Returns false if it failed
+inline bool _readPayload(_RecordingReader *reader, const _RecordIndex &record)
+{
+    const _RecordHeader &header = record.header;
+    std::vector<unsigned char> &target = header.compression == _RECORD_RAW ? reader->payload : reader->stored;
+    target.resize(header.storedSize);
+    if ( !_seekRecordingFile(reader->file, record.offset + (long long) sizeof(header)) ||
+         ( header.storedSize > 0 && fread(target.data(), header.storedSize, 1, reader->file) != 1 ))
+    {
+        return false;
+    }
+    if ( header.compression == _RECORD_LZ4 )
+    {
+        reader->payload.resize(header.rawSize);
+        return _lz4Decompress(reader->stored.data(), (int) header.storedSize, reader->payload.data(),
+                              (int) header.rawSize) == (int) header.rawSize;
+    }
+    return true;
+}
+
+/// Applies the record at [index] to the frame of the previous record (or replaces it for a keyframe)
+inline bool _applyRecord(_RecordingReader *reader, long long index)
+{
+    const _RecordIndex &record = reader->records[(size_t) index];
+    const _RecordHeader &header = record.header;
+    if ( !_readPayload(reader, record))
+    {
+        return false;
+    }
+    if ( header.type == _RECORD_KEYFRAME )
+    {
+        reader->frame.swap(reader->payload);
+        return true;
+    }
+    int width = header.width;
+    int height = header.height;
+    int columns = _tileCount(width);
+    uint32_t tileCount = (uint32_t) (columns * _tileCount(height));
+    const unsigned char *indices = reader->payload.data();
+    const unsigned char *pixels = indices + (size_t) header.tiles * sizeof(uint32_t);
+    const unsigned char *end = reader->payload.data() + reader->payload.size();
+    for ( uint32_t tile = 0; tile < header.tiles; ++tile )
+    {
+        uint32_t tileIndex;
+        memcpy(&tileIndex, indices + (size_t) tile * sizeof(uint32_t), sizeof(tileIndex));
+        if ( tileIndex >= tileCount )
+        {
+            return false;
+        }
+        int left = (int) (tileIndex % columns) * _TILE_SIZE;
+        int top = (int) (tileIndex / columns) * _TILE_SIZE;
+        size_t rowBytes = (size_t) (width - left < _TILE_SIZE ? width - left : _TILE_SIZE) * 4;
+        int bottom = height - top < _TILE_SIZE ? height : top + _TILE_SIZE;
+        if ( (size_t) (end - pixels) < rowBytes * (bottom - top))
+        {
+            return false;
+        }
+        for ( int y = top; y < bottom; ++y )
+        {
+            memcpy(reader->frame.data() + ((size_t) y * width + left) * 4, pixels, rowBytes);
+            pixels += rowBytes;
+        }
+    }
+    return true;
+}
+
+bool _seekRecord(_RecordingReader *reader, long long index)
+{
+    if ( index < 0 || index >= (long long) reader->records.size())
+    {
+        return false;
+    }
+    if ( index == reader->current )
+    {
+        return true;
+    }
+    long long keyframe = index;
+    while ( reader->records[(size_t) keyframe].header.type != _RECORD_KEYFRAME )
+    {
+        --keyframe; // the first record is always a keyframe
+    }
+    // continue from the current frame if there is no keyframe in between (reading forward)
+    long long next = reader->current >= keyframe && reader->current < index ? reader->current + 1 : keyframe;
+    for ( ; next <= index; ++next )
+    {
+        if ( !_applyRecord(reader, next))
+        {
+            reader->current = -1;
+            return false;
+        }
+        reader->current = next;
+    }
+    return true;
+}
+
+/// Returns the reader with the id (or 0). Only while holding the _readerMutex
+inline _RecordingReader *_getReader(int readerID)
+{
+    return readerID >= 0 && readerID < (int) _readers.size() ? _readers[readerID] : 0;
+}
+
+EXPORT int openRecording(const char *path)
+{
+    _RecordingReader *reader = _openReader(path);
+    if ( reader == 0 )
+    {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(_readerMutex);
+    _readers.push_back(reader);
+    return (int) _readers.size() - 1;
+}
+
+EXPORT RecordingInfo getRecordingInfo(int readerID)
+{
+    std::lock_guard<std::mutex> lock(_readerMutex);
+    _RecordingReader *reader = _getReader(readerID);
+    if ( reader == 0 || reader->records.empty())
+    {
+        return RecordingInfo{0, 0, 0, 0, reader != 0 ? reader->startTime : 0};
+    }
+    return RecordingInfo{(long long) reader->records.size(), reader->keyframes,
+                         reader->records.front().header.timestamp, reader->records.back().header.timestamp,
+                         reader->startTime};
+}
+
+EXPORT unsigned char *readRecordedFrame(int readerID, long long timestamp, RecordedFrame *outFrame)
+{
+    std::lock_guard<std::mutex> lock(_readerMutex);
+    _RecordingReader *reader = _getReader(readerID);
+    long long index = reader != 0 ? _findRecord(reader, timestamp) : -1;
+    if ( index < 0 || !_seekRecord(reader, index))
+    {
+        return 0;
+    }
+    unsigned char *data = _allocateBuffer(reader->frame.size());
+    if ( data == 0 )
+    {
+        return 0;
+    }
+    memcpy(data, reader->frame.data(), reader->frame.size());
+    if ( outFrame != 0 )
+    {
+        const _RecordHeader &header = reader->records[(size_t) index].header;
+        outFrame->width = header.width;
+        outFrame->height = header.height;
+        outFrame->bounds = RECT{header.left, header.top, header.right, header.bottom};
+        outFrame->timestamp = header.timestamp;
+        outFrame->frameNumber = header.frameNumber;
+        outFrame->nextTimestamp = index + 1 < (long long) reader->records.size() ?
+                                  reader->records[(size_t) index + 1].header.timestamp : -1;
+    }
+    return data;
+}
+
+EXPORT void closeRecording(int readerID)
+{
+    std::lock_guard<std::mutex> lock(_readerMutex);
+    _RecordingReader *reader = _getReader(readerID);
+    if ( reader != 0 )
+    {
+        _closeReader(reader);
+        _readers[readerID] = 0;
+    }
+}
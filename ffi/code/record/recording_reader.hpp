@@ -0,0 +1,91 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+#include "recording_format.hpp"
+#include <stdio.h>
+#include <vector>
+
+#ifndef RECORDING_READER_H
+#define RECORDING_READER_H
+
+/// Summary of a recording returned by getRecordingInfo
+struct RecordingInfo
+{
+    /// Amount of recorded frames and how many of them are keyframes
+    long long frames;
+    long long keyframes;
+    /// Timestamps of the first and the last frame in microseconds since the start of the recording
+    long long firstTimestamp;
+    long long lastTimestamp;
+    /// Unix time in microseconds when the recording was started
+    long long startTime;
+};
+
+/// Details of a frame returned by readRecordedFrame
+struct RecordedFrame
+{
+    int width;
+    int height;
+    /// Window bounds in screen coordinates when the frame was captured
+    RECT bounds;
+    /// Microseconds since the start of the recording when the frame was captured
+    long long timestamp;
+    /// Frame number of the capture thread that recorded it
+    long long frameNumber;
+    /// Timestamp of the next recorded frame (-1 for the last frame), so all frames can be read one after another
+    long long nextTimestamp;
+};
+
+/// Opens a recording of startRecording at the utf8 [path] and indexes its records (a recording that is still written,
+/// or was not stopped cleanly can be read up to its last complete record). Returns the id of the reader for the
+/// other functions, or -1 if the file could not be read or is not a recording.
+EXPORT int openRecording(const char *path);
+
+/// Returns the summary of the recording (all 0 if the reader does not exist)
+EXPORT RecordingInfo getRecordingInfo(int readerID);
+
+/// Returns the BGRA frame (rows of width * 4 bytes) that was the newest recorded frame at the [timestamp] (in
+/// microseconds since the start of the recording), or the first frame for timestamps before it. The details of the
+/// frame are written into [outFrame] if it is not 0. The memory must be freed with cleanupMemory!
+/// Reading the frames with increasing timestamps only applies the deltas since the previous frame, otherwise the
+/// frame is reconstructed from the nearest keyframe. Returns 0 if the reader does not exist, or the file is corrupted.
+EXPORT unsigned char *readRecordedFrame(int readerID, long long timestamp, RecordedFrame *outFrame);
+
+/// Closes the reader (does nothing if it does not exist)
+EXPORT void closeRecording(int readerID);
+
+/// Internal: position of a record in the file with its header
+struct _RecordIndex
+{
+    long long offset;
+    _RecordHeader header;
+};
+
+/// Internal: an open recording with the reconstructed frame of the record at [current]. Not thread safe
+struct _RecordingReader
+{
+    FILE *file = 0;
+    long long startTime = 0;
+    long long keyframes = 0;
+    std::vector<_RecordIndex> records;
+    /// Index of the record that is currently in [frame] (or -1)
+    long long current = -1;
+    std::vector<unsigned char> frame;
+    /// Buffers for the payloads that are reused for every record
+    std::vector<unsigned char> stored;
+    std::vector<unsigned char> payload;
+};
+
+/// Internal: opens and indexes the recording at the utf8 [path] (see openRecording). Returns 0 if it failed
+_RecordingReader *_openReader(const char *path);
+
+/// Internal: closes the file and deletes the [reader]
+void _closeReader(_RecordingReader *reader);
+
+/// Internal: returns the index of the newest record at the [timestamp] (0 for timestamps before the first record, or
+/// -1 if there are no records)
+long long _findRecord(const _RecordingReader *reader, long long timestamp);
+
+/// Internal: reconstructs the frame of the record at [index] in reader->frame. Returns false if the file is corrupted
+bool _seekRecord(_RecordingReader *reader, long long index);
+
+#endif //RECORDING_READER_H
@@ -0,0 +1,341 @@
+#include "session_recorder.hpp"
+#include "lz4_block.hpp"
+#include "recording_format.hpp"
+#include "../capture/tile_hashes.hpp"
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/// Frames are dropped if the records that are waiting for the writer thread would need more memory
+#define _MAX_PENDING_BYTES ((size_t) 128 * 1024 * 1024)
+
+/// Written records that are kept to reuse their payload memory for the next frames
+#define _MAX_UNUSED_RECORDS 3
+
+/// Record that was copied by the capture thread and is waiting to be compressed and written
+struct _PendingRecord
+{
+    _RecordHeader header;
+    std::vector<unsigned char> payload;
+};
+
+struct _Recorder
+{
+    FILE *file = 0;
+    std::thread thread;
+    /// Guards everything up to [failed] between the capture thread and the writer thread
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool running = true;
+    std::deque<_PendingRecord *> pending;
+    std::vector<_PendingRecord *> unused;
+    size_t pendingBytes = 0;
+    /// Set by the writer thread if the file could not be written, then all following frames are dropped
+    bool failed = false;
+
+    /// Only used from the capture thread (always under _recorderMutex)
+    std::chrono::steady_clock::time_point start;
+    int keyframeInterval = 0;
+    long long sinceKeyframe = 0;
+    std::vector<uint64_t> recordedHashes;
+    int recordedWidth = 0;
+    int recordedHeight = 0;
+
+    std::atomic<long long> records{0};
+    std::atomic<long long> keyframes{0};
+    std::atomic<long long> droppedFrames{0};
+    std::atomic<long long> rawBytes{0};
+    std::atomic<long long> writtenBytes{0};
+};
+
+/// Recorders for every window id (0 if not recording). The mutex is held by the capture threads while they use the
+/// recorder, so stopRecording can remove it safely
+std::mutex _recorderMutex;
+_Recorder *_recorders[_MAX_WINDOWS]{};
+/// Amount of running recorders, so the capture threads skip the mutex if nothing is recorded
+std::atomic<int> _activeRecorders{0};
+
+inline RecordingStats _recorderStats(const _Recorder *recorder)
+{
+    return RecordingStats{recorder->records.load(), recorder->keyframes.load(), recorder->droppedFrames.load(),
+                          recorder->rawBytes.load(), recorder->writtenBytes.load()};
+}
+
+/// Compresses the [record] into [compressed] if that makes it smaller and appends it to the file. Returns false if
+/// the file could not be written
+inline bool _writeRecord(_Recorder *recorder, _PendingRecord *record, std::vector<unsigned char> &compressed)
+{
+    _RecordHeader &header = record->header;
+    const unsigned char *stored = record->payload.data();
+    header.compression = _RECORD_RAW;
+    header.storedSize = header.rawSize;
+    if ( header.rawSize > 0 )
+    {
+        // the capacity is smaller than the raw size, so incompressible payloads are detected early and stored raw
+        compressed.resize(header.rawSize);
+        int size = _lz4Compress(record->payload.data(), (int) header.rawSize, compressed.data(),
+                                (int) header.rawSize - 1);
+        if ( size > 0 )
+        {
+            stored = compressed.data();
+            header.compression = _RECORD_LZ4;
+            header.storedSize = (uint32_t) size;
+        }
+    }
+    if ( fwrite(&header, sizeof(header), 1, recorder->file) != 1 ||
+         ( header.storedSize > 0 && fwrite(stored, header.storedSize, 1, recorder->file) != 1 ) ||
+         fflush(recorder->file) != 0 )
+    {
+        return false;
+    }
+    recorder->records.fetch_add(1);
+    if ( header.type == _RECORD_KEYFRAME )
+    {
+        recorder->keyframes.fetch_add(1);
+    }
+    recorder->rawBytes.fetch_add(header.rawSize);
+    recorder->writtenBytes.fetch_add((long long) sizeof(header) + header.storedSize);
+    return true;
+}
+
+/// Writer thread of a recorder: writes the pending records in order until it is stopped and nothing is pending
+void _runRecorder(_Recorder *recorder)
+{
+    std::vector<unsigned char> compressed;
+    std::unique_lock<std::mutex> lock(recorder->mutex);
+    while ( true )
+    {
+        recorder->condition.wait(lock, [recorder]() {
+            return !recorder->pending.empty() || !recorder->running;
+        });
+        if ( recorder->pending.empty())
+        {
+            break;
+        }
+        _PendingRecord *record = recorder->pending.front();
+        recorder->pending.pop_front();
+        lock.unlock();
+        bool written = _writeRecord(recorder, record, compressed);
+        lock.lock();
+        if ( !written )
+        {
+            recorder->failed = true;
+            recorder->droppedFrames.fetch_add(1);
+        }
+        recorder->pendingBytes -= record->payload.size();
+        if ( recorder->unused.size() < _MAX_UNUSED_RECORDS )
+        {
+            recorder->unused.push_back(record);
+        } else
+        {
+            delete record;
+        }
+    }
+}
+
+/// Returns a record for a payload of [bytes] bytes, or 0 if the frame has to be dropped
+inline _PendingRecord *_reserveRecord(_Recorder *recorder, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(recorder->mutex);
+    if ( recorder->failed || ( !recorder->pending.empty() && recorder->pendingBytes + bytes > _MAX_PENDING_BYTES ))
+    {
+        return 0;
+    }
+    recorder->pendingBytes += bytes;
+    _PendingRecord *record;
+    if ( recorder->unused.empty())
+    {
+        record = new _PendingRecord();
+    } else
+    {
+        record = recorder->unused.back();
+        recorder->unused.pop_back();
+    }
+    record->payload.resize(bytes);
+    return record;
+}
+
+/// Copies the tiles of the BGRA [data] that changed since the last record into the delta [payload]
+inline void _copyChangedTiles(const _Recorder *recorder, const unsigned char *data, int width, int height,
+                              const std::vector<uint64_t> &tileHashes, uint32_t tiles, unsigned char *payload)
+{
+    int columns = _tileCount(width);
+    unsigned char *pixels = payload + (size_t) tiles * sizeof(uint32_t);
+    for ( size_t i = 0; i < tileHashes.size(); ++i )
+    {
+        if ( tileHashes[i] == recorder->recordedHashes[i] )
+        {
+            continue;
+        }
+        uint32_t index = (uint32_t) i;
+        memcpy(payload, &index, sizeof(index));
+        payload += sizeof(index);
+        int left = (int) (i % columns) * _TILE_SIZE;
+        int top = (int) (i / columns) * _TILE_SIZE;
+        size_t rowBytes = (size_t) (width - left < _TILE_SIZE ? width - left : _TILE_SIZE) * 4;
+        int bottom = height - top < _TILE_SIZE ? height : top + _TILE_SIZE;
+        for ( int y = top; y < bottom; ++y )
+        {
+            memcpy(pixels, data + ((size_t) y * width + left) * 4, rowBytes);
+            pixels += rowBytes;
+        }
+    }
+}
+
+void _recordFrame(int windowID, const unsigned char *data, int width, int height, long long frameNumber,
+                  const RECT &bounds, const std::vector<uint64_t> &tileHashes)
+{
+    if ( _activeRecorders.load(std::memory_order_acquire) == 0 || windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_recorderMutex);
+    _Recorder *recorder = _recorders[windowID];
+    if ( recorder == 0 )
+    {
+        return;
+    }
+    long long timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - recorder->start).count();
+    bool keyframe = width != recorder->recordedWidth || height != recorder->recordedHeight ||
+                    tileHashes.size() != recorder->recordedHashes.size() ||
+                    ( recorder->keyframeInterval > 0 && recorder->sinceKeyframe >= recorder->keyframeInterval );
+    size_t bytes = (size_t) width * height * 4;
+    uint32_t tiles = 0;
+    if ( !keyframe )
+    {
+        bytes = 0;
+        int columns = _tileCount(width);
+        for ( size_t i = 0; i < tileHashes.size(); ++i )
+        {
+            if ( tileHashes[i] != recorder->recordedHashes[i] )
+            {
+                int left = (int) (i % columns) * _TILE_SIZE;
+                int top = (int) (i / columns) * _TILE_SIZE;
+                int tileWidth = width - left < _TILE_SIZE ? width - left : _TILE_SIZE;
+                int tileHeight = height - top < _TILE_SIZE ? height - top : _TILE_SIZE;
+                bytes += sizeof(uint32_t) + (size_t) tileWidth * tileHeight * 4;
+                ++tiles;
+            }
+        }
+    }
+    _PendingRecord *record = _reserveRecord(recorder, bytes);
+    if ( record == 0 )
+    {
+        recorder->droppedFrames.fetch_add(1); // the next record is a delta to the last recorded frame
+        return;
+    }
+    if ( keyframe )
+    {
+        memcpy(record->payload.data(), data, bytes);
+    } else if ( tiles > 0 )
+    {
+        _copyChangedTiles(recorder, data, width, height, tileHashes, tiles, record->payload.data());
+    }
+    _RecordHeader &header = record->header;
+    memset(&header, 0, sizeof(header));
+    header.magic = _RECORD_MAGIC;
+    header.type = keyframe ? _RECORD_KEYFRAME : _RECORD_DELTA;
+    header.timestamp = timestamp;
+    header.frameNumber = frameNumber;
+    header.left = bounds.left;
+    header.top = bounds.top;
+    header.right = bounds.right;
+    header.bottom = bounds.bottom;
+    header.width = width;
+    header.height = height;
+    header.tiles = tiles;
+    header.rawSize = (uint32_t) bytes;
+    recorder->recordedHashes = tileHashes;
+    recorder->recordedWidth = width;
+    recorder->recordedHeight = height;
+    recorder->sinceKeyframe = keyframe ? 1 : recorder->sinceKeyframe + 1;
+    {
+        std::lock_guard<std::mutex> pendingLock(recorder->mutex);
+        recorder->pending.push_back(record);
+    }
+    recorder->condition.notify_one();
+}
+
+EXPORT bool startRecording(int windowID, const char *path, int keyframeInterval)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || path == 0 || keyframeInterval < 0 )
+    {
+        return false;
+    }
+    stopRecording(windowID);
+    FILE *file = _openRecordingFile(path, true);
+    if ( file == 0 )
+    {
+        return false;
+    }
+    _RecordingHeader header;
+    memcpy(header.magic, _RECORDING_MAGIC, sizeof(header.magic));
+    header.version = _RECORDING_VERSION;
+    header.tileSize = _TILE_SIZE;
+    header.startTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    if ( fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0 )
+    {
+        fclose(file);
+        return false;
+    }
+    _Recorder *recorder = new _Recorder();
+    recorder->file = file;
+    recorder->keyframeInterval = keyframeInterval;
+    recorder->start = std::chrono::steady_clock::now();
+    recorder->writtenBytes.store(sizeof(header));
+    recorder->thread = std::thread(_runRecorder, recorder);
+    std::lock_guard<std::mutex> lock(_recorderMutex);
+    _recorders[windowID] = recorder;
+    _activeRecorders.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+EXPORT RecordingStats stopRecording(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return RecordingStats{0, 0, 0, 0, 0};
+    }
+    _Recorder *recorder;
+    {
+        std::lock_guard<std::mutex> lock(_recorderMutex);
+        recorder = _recorders[windowID];
+        if ( recorder == 0 )
+        {
+            return RecordingStats{0, 0, 0, 0, 0};
+        }
+        _recorders[windowID] = 0;
+        _activeRecorders.fetch_sub(1, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        recorder->running = false;
+    }
+    recorder->condition.notify_all();
+    recorder->thread.join(); // writes everything that is still pending
+    fclose(recorder->file);
+    RecordingStats stats = _recorderStats(recorder);
+    for ( _PendingRecord *record : recorder->unused )
+    {
+        delete record;
+    }
+    delete recorder;
+    return stats;
+}
+
+EXPORT RecordingStats getRecordingStats(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return RecordingStats{0, 0, 0, 0, 0};
+    }
+    std::lock_guard<std::mutex> lock(_recorderMutex);
+    _Recorder *recorder = _recorders[windowID];
+    return recorder != 0 ? _recorderStats(recorder) : RecordingStats{0, 0, 0, 0, 0};
+}
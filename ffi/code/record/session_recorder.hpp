@@ -0,0 +1,48 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+#include <stdint.h>
+#include <vector>
+
+#ifndef SESSION_RECORDER_H
+#define SESSION_RECORDER_H
+
+/// Statistics of a recording returned by getRecordingStats and stopRecording
+struct RecordingStats
+{
+    /// Records that were written into the file (keyframes and deltas)
+    long long records;
+    long long keyframes;
+    /// Frames that were not recorded, because the writer thread could not keep up (the next record is a delta to the
+    /// last recorded frame, so nothing is lost apart from those frames)
+    long long droppedFrames;
+    /// Size of the payloads of the written records before the compression and the size of the whole file
+    long long rawBytes;
+    long long writtenBytes;
+};
+
+/// Records every frame of the capture thread of the window (0 to 99, see startCaptureThread) into a new file at the
+/// utf8 [path] until stopRecording is called (only frames of the capture thread are recorded, so nothing is written
+/// while it is not running). The first frame, every frame with a new size and every [keyframeInterval] recorded
+/// frame (if it is not 0) is stored completely as a keyframe. All other frames only store the tiles of 32 x 32
+/// pixels that changed since the previous record (detected with the tile hashes of the capture thread). Every record
+/// also stores the time since the start in microseconds and the window bounds.
+/// The capture thread only copies the changed tiles and the records are compressed with lz4 and written by another
+/// background thread, so recording does not slow down the capture thread. Frames are dropped if more than 128 MB are
+/// waiting to be written.
+/// Restarts the recording if it was already running. Returns false for invalid arguments, or if the file could not
+/// be created. The recordings can be read with openRecording.
+EXPORT bool startRecording(int windowID, const char *path, int keyframeInterval);
+
+/// Stops the recording of the window after all frames that were already captured are written and closes its file.
+/// Returns the final statistics of the recording (all 0 if there was no recording)
+EXPORT RecordingStats stopRecording(int windowID);
+
+/// Returns the current statistics of the recording of the window (all 0 if it is not recording)
+EXPORT RecordingStats getRecordingStats(int windowID);
+
+/// Internal: called from the capture thread of the window for every captured frame with its BGRA [data], the window
+/// [bounds] and the [tileHashes] of the frame. Returns immediately if the window is not recording.
+void _recordFrame(int windowID, const unsigned char *data, int width, int height, long long frameNumber,
+                  const RECT &bounds, const std::vector<uint64_t> &tileHashes);
+
+#endif //SESSION_RECORDER_H
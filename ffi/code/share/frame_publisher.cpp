@@ -0,0 +1,144 @@
+#include "frame_publisher.hpp"
+#include "shared_frame_reader.hpp"
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+/// Biggest width and height of the published frames (so that the slot sizes always fit)
+#define _MAX_PUBLISHED_SIZE 16384
+#define _MAX_PUBLISHED_SLOTS 64
+
+/// Shared memory of one window that publishes its frames
+struct _FramePublisher
+{
+    _SharedMemory memory;
+    _SharedFramesHeader *header = 0;
+    uint64_t published = 0;
+};
+
+/// Publishers for every window id (0 if not publishing), only used while holding the _publisherMutex. The frames are
+/// copied into the shared memory while holding it, so stopFramePublishing never unmaps memory that is written
+std::mutex _publisherMutex;
+_FramePublisher *_publishers[_MAX_WINDOWS]{};
+
+/// Amount of publishing windows, so that the capture threads don't lock the mutex if nothing is published
+std::atomic<int> _activePublishers{0};
+
+void _publishFrame(int windowID, const unsigned char *data, int width, int height, long long frameNumber,
+                   const RECT &bounds)
+{
+    if ( _activePublishers.load(std::memory_order_acquire) == 0 || windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_publisherMutex);
+    _FramePublisher *publisher = _publishers[windowID];
+    size_t bytes = (size_t) width * height * 4;
+    if ( publisher == 0 || bytes > publisher->header->slotCapacity )
+    {
+        return;
+    }
+    uint64_t next = publisher->published + 1;
+    _SharedFrameSlot *slot = _sharedFrameSlot(publisher->header, (next - 1) % publisher->header->slotCount);
+    // seqlock: the sequence is odd while the slot is written
+    uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->frameNumber = frameNumber;
+    slot->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    slot->width = width;
+    slot->height = height;
+    slot->left = bounds.left;
+    slot->top = bounds.top;
+    slot->right = bounds.right;
+    slot->bottom = bounds.bottom;
+    memcpy((unsigned char *) slot + _SHARED_FRAME_HEADER_SIZE, data, bytes);
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    publisher->header->latest.store(next, std::memory_order_release);
+    publisher->published = next;
+}
+
+/// Returns true if another window than [windowID] publishes with the [name] (must hold the _publisherMutex)
+inline bool _isPublishedName(int windowID, const char *name)
+{
+    for ( int other = 0; other < _MAX_WINDOWS; ++other )
+    {
+        if ( other != windowID && _publishers[other] != 0 && _publishers[other]->memory.name == name )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+EXPORT bool startFramePublishing(int windowID, const char *name, int slotCount, int maxWidth, int maxHeight)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS || !_isSharedMemoryName(name) || slotCount < 2 ||
+         slotCount > _MAX_PUBLISHED_SLOTS || maxWidth < 0 || maxHeight < 0 || maxWidth > _MAX_PUBLISHED_SIZE ||
+         maxHeight > _MAX_PUBLISHED_SIZE )
+    {
+        return false;
+    }
+    stopFramePublishing(windowID);
+    if ( maxWidth == 0 || maxHeight == 0 )
+    {
+        maxWidth = (int) _platformGetDisplayWidth();
+        maxHeight = (int) _platformGetDisplayHeight();
+        if ( maxWidth <= 0 || maxHeight <= 0 || maxWidth > _MAX_PUBLISHED_SIZE || maxHeight > _MAX_PUBLISHED_SIZE )
+        {
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_publisherMutex);
+    if ( _isPublishedName(windowID, name))
+    {
+        return false;
+    }
+    uint64_t capacity = (uint64_t) maxWidth * maxHeight * 4;
+    // every slot starts at a multiple of the header size, so the pixels of all slots are aligned the same way
+    uint64_t stride = _SHARED_FRAME_HEADER_SIZE + (capacity + _SHARED_FRAME_HEADER_SIZE - 1) /
+                                                  _SHARED_FRAME_HEADER_SIZE * _SHARED_FRAME_HEADER_SIZE;
+    _FramePublisher *publisher = new _FramePublisher();
+    if ( !_createSharedMemory(name, (size_t) (sizeof(_SharedFramesHeader) + stride * slotCount), &publisher->memory))
+    {
+        delete publisher;
+        return false;
+    }
+    // the memory is zeroed, so every slot starts with the sequence 0 and there is no frame yet
+    _SharedFramesHeader *header = (_SharedFramesHeader *) publisher->memory.data;
+    header->version = _SHARED_FRAMES_VERSION;
+    header->slotCount = (uint32_t) slotCount;
+    header->slotCapacity = capacity;
+    header->slotStride = stride;
+    header->windowID = (uint32_t) windowID;
+    memcpy(header->magic, _SHARED_FRAMES_MAGIC, sizeof(header->magic));
+    header->state.store(_SHARED_FRAMES_OPEN, std::memory_order_release);
+    publisher->header = header;
+    _publishers[windowID] = publisher;
+    _activePublishers.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+EXPORT long long stopFramePublishing(int windowID)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(_publisherMutex);
+    _FramePublisher *publisher = _publishers[windowID];
+    if ( publisher == 0 )
+    {
+        return 0;
+    }
+    _publishers[windowID] = 0;
+    _activePublishers.fetch_sub(1, std::memory_order_release);
+    // readers that still have the memory mapped see that they have to open the name again
+    publisher->header->state.store(_SHARED_FRAMES_CLOSED, std::memory_order_release);
+    long long published = (long long) publisher->published;
+    _closeSharedMemory(&publisher->memory, true);
+    delete publisher;
+    return published;
+}
@@ -0,0 +1,28 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+
+#ifndef FRAME_PUBLISHER_H
+#define FRAME_PUBLISHER_H
+
+/// Publishes every frame of the capture thread of the window (0 to 99, see startCaptureThread) into a new named
+/// shared memory, so that other processes (and other instances of this library) can read the newest frame with
+/// openSharedFrames instead of capturing the screen on their own. The memory is a ring of [slotCount] (2 to 64) frames
+/// of at most [maxWidth] x [maxHeight] pixels (0 for the size of the main display). Bigger frames are skipped.
+/// Every slot is a seqlock and the publisher never waits for the readers, so the readers can read the frames directly
+/// inside of the shared memory (see shared_frames_format.hpp for the layout).
+/// The [name] may only contain letters, digits, '_', '-' and '.' and another memory with the same name is replaced
+/// on linux (for example of a publisher that crashed), but can not be created on windows.
+/// Restarts the publishing if it was already running. Returns false for invalid arguments, if another window of this
+/// process already publishes with the [name], or if the memory could not be created.
+EXPORT bool startFramePublishing(int windowID, const char *name, int slotCount, int maxWidth, int maxHeight);
+
+/// Stops publishing the frames of the window and removes the name of the shared memory (readers that still have it
+/// open see that the publisher stopped). Returns the amount of published frames (0 if it was not publishing)
+EXPORT long long stopFramePublishing(int windowID);
+
+/// Internal: called from the capture thread of the window for every captured frame with its BGRA [data] and the
+/// window [bounds]. Returns immediately if the window is not publishing.
+void _publishFrame(int windowID, const unsigned char *data, int width, int height, long long frameNumber,
+                   const RECT &bounds);
+
+#endif //FRAME_PUBLISHER_H
@@ -0,0 +1,339 @@
+#include "shared_frame_reader.hpp"
+#include "../memory/buffer_pool.hpp"
+#include <string.h>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // #ifndef _WIN32
+
+/// How often a frame is read again by readSharedFrame if the publisher overwrote it while it was copied
+#define _SHARED_FRAME_RETRIES 100
+
+/// Readers for every reader id (0 after they were closed, the ids are never reused)
+std::mutex _sharedReaderMutex;
+std::vector<_SharedMemory *> _sharedReaders;
+
+bool _isSharedMemoryName(const char *name)
+{
+    size_t length = name != 0 ? strlen(name) : 0;
+    if ( length == 0 || length > 200 )
+    {
+        return false;
+    }
+    for ( size_t i = 0; i < length; ++i )
+    {
+        char c = name[i];
+        if ( !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' ||
+               c == '.'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+/// Converts the [name] into the name of a file mapping of the current session
+inline bool _sharedMappingName(const char *name, wchar_t *outName)
+{
+    std::string fullName = std::string("Local\\") + name;
+    return MultiByteToWideChar(CP_UTF8, 0, fullName.c_str(), -1, outName, MAX_PATH) != 0;
+}
+
+bool _createSharedMemory(const char *name, size_t size, _SharedMemory *outMemory)
+{
+    wchar_t mappingName[MAX_PATH];
+    if ( !_isSharedMemoryName(name) || !_sharedMappingName(name, mappingName))
+    {
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, (DWORD) ((uint64_t) size >> 32),
+                                        (DWORD) (size & 0xFFFFFFFFull), mappingName);
+    if ( mapping != 0 && GetLastError() == ERROR_ALREADY_EXISTS )
+    {
+        CloseHandle(mapping); // another publisher uses the name
+        return false;
+    }
+    void *data = mapping != 0 ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : 0;
+    if ( data == 0 )
+    {
+        if ( mapping != 0 )
+        {
+            CloseHandle(mapping);
+        }
+        return false;
+    }
+    outMemory->data = (unsigned char *) data;
+    outMemory->size = size;
+    outMemory->name = name;
+    outMemory->mapping = mapping;
+    return true;
+}
+
+bool _openSharedMemory(const char *name, _SharedMemory *outMemory)
+{
+    wchar_t mappingName[MAX_PATH];
+    if ( !_isSharedMemoryName(name) || !_sharedMappingName(name, mappingName))
+    {
+        return false;
+    }
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, mappingName);
+    void *data = mapping != 0 ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+    MEMORY_BASIC_INFORMATION info;
+    if ( data == 0 || VirtualQuery(data, &info, sizeof(info)) == 0 )
+    {
+        if ( data != 0 )
+        {
+            UnmapViewOfFile(data);
+        }
+        if ( mapping != 0 )
+        {
+            CloseHandle(mapping);
+        }
+        return false;
+    }
+    outMemory->data = (unsigned char *) data;
+    outMemory->size = info.RegionSize; // rounded up to whole pages
+    outMemory->name = name;
+    outMemory->mapping = mapping;
+    return true;
+}
+
+void _closeSharedMemory(_SharedMemory *memory, bool remove)
+{
+    // the file mapping is removed by windows after the last handle was closed
+    UnmapViewOfFile(memory->data);
+    CloseHandle(memory->mapping);
+    memory->data = 0;
+    memory->mapping = 0;
+}
+
+#else
+
+bool _createSharedMemory(const char *name, size_t size, _SharedMemory *outMemory)
+{
+    if ( !_isSharedMemoryName(name))
+    {
+        return false;
+    }
+    std::string fullName = std::string("/") + name;
+    shm_unlink(fullName.c_str()); // replaces the memory of a publisher that crashed
+    int file = shm_open(fullName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if ( file < 0 )
+    {
+        return false;
+    }
+    void *data = ftruncate(file, (off_t) size) == 0 ? mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) :
+                 MAP_FAILED;
+    close(file);
+    if ( data == MAP_FAILED )
+    {
+        shm_unlink(fullName.c_str());
+        return false;
+    }
+    outMemory->data = (unsigned char *) data;
+    outMemory->size = size;
+    outMemory->name = name;
+    return true;
+}
+
+bool _openSharedMemory(const char *name, _SharedMemory *outMemory)
+{
+    if ( !_isSharedMemoryName(name))
+    {
+        return false;
+    }
+    int file = shm_open((std::string("/") + name).c_str(), O_RDONLY, 0);
+    if ( file < 0 )
+    {
+        return false;
+    }
+    struct stat info;
+    void *data = fstat(file, &info) == 0 && info.st_size > 0 ?
+                 mmap(0, (size_t) info.st_size, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+    close(file);
+    if ( data == MAP_FAILED )
+    {
+        return false;
+    }
+    outMemory->data = (unsigned char *) data;
+    outMemory->size = (size_t) info.st_size;
+    outMemory->name = name;
+    return true;
+}
+
+void _closeSharedMemory(_SharedMemory *memory, bool remove)
+{
+    munmap(memory->data, memory->size);
+    if ( remove )
+    {
+        shm_unlink((std::string("/") + memory->name).c_str());
+    }
+    memory->data = 0;
+}
+
+#endif // #ifdef _WIN32
+
+/// Returns true if the mapped [memory] contains complete shared frames of a running publisher
+inline bool _isValidSharedFrames(const _SharedMemory *memory)
+{
+    const _SharedFramesHeader *header = (const _SharedFramesHeader *) memory->data;
+    if ( memory->size < sizeof(_SharedFramesHeader) ||
+         header->state.load(std::memory_order_acquire) != _SHARED_FRAMES_OPEN ||
+         memcmp(header->magic, _SHARED_FRAMES_MAGIC, sizeof(header->magic)) != 0 ||
+         header->version != _SHARED_FRAMES_VERSION || header->slotCount == 0 ||
+         header->slotStride < _SHARED_FRAME_HEADER_SIZE + header->slotCapacity )
+    {
+        return false;
+    }
+    return (memory->size - sizeof(_SharedFramesHeader)) / header->slotStride >= header->slotCount;
+}
+
+/// Returns the reader with the id (or 0). Only while holding the _sharedReaderMutex
+inline _SharedMemory *_getSharedReader(int readerID)
+{
+    return readerID >= 0 && readerID < (int) _sharedReaders.size() ? _sharedReaders[readerID] : 0;
+}
+
+/// Same as acquireSharedFrame for the [memory] of a reader
+bool _acquireSharedFrame(const _SharedMemory *memory, SharedFrame *outFrame)
+{
+    const _SharedFramesHeader *header = (const _SharedFramesHeader *) memory->data;
+    for ( int attempt = 0; attempt < _SHARED_FRAME_RETRIES; ++attempt )
+    {
+        if ( header->state.load(std::memory_order_acquire) != _SHARED_FRAMES_OPEN )
+        {
+            return false;
+        }
+        uint64_t latest = header->latest.load(std::memory_order_acquire);
+        if ( latest == 0 )
+        {
+            return false;
+        }
+        uint64_t index = (latest - 1) % header->slotCount;
+        const _SharedFrameSlot *slot = _sharedFrameSlot(header, index);
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (( sequence & 1) != 0 )
+        {
+            continue; // the publisher wrapped around and currently writes this slot again
+        }
+        outFrame->data = (const unsigned char *) slot + _SHARED_FRAME_HEADER_SIZE;
+        outFrame->width = slot->width;
+        outFrame->height = slot->height;
+        outFrame->bounds = RECT{slot->left, slot->top, slot->right, slot->bottom};
+        outFrame->frameNumber = slot->frameNumber;
+        outFrame->timestamp = slot->timestamp;
+        outFrame->slot = (int) index;
+        outFrame->sequence = sequence;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ( slot->sequence.load(std::memory_order_relaxed) == sequence && outFrame->width > 0 &&
+             outFrame->height > 0 && (uint64_t) outFrame->width * outFrame->height * 4 <= header->slotCapacity )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Same as isSharedFrameValid for the [memory] of a reader
+inline bool _isSharedFrameValid(const _SharedMemory *memory, const SharedFrame *frame)
+{
+    const _SharedFramesHeader *header = (const _SharedFramesHeader *) memory->data;
+    if ( frame->slot < 0 || (uint32_t) frame->slot >= header->slotCount )
+    {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return _sharedFrameSlot(header, (uint64_t) frame->slot)->sequence.load(std::memory_order_relaxed) ==
+           frame->sequence;
+}
+
+EXPORT int openSharedFrames(const char *name)
+{
+    _SharedMemory *memory = new _SharedMemory();
+    if ( !_openSharedMemory(name, memory))
+    {
+        delete memory;
+        return -1;
+    }
+    if ( !_isValidSharedFrames(memory))
+    {
+        _closeSharedMemory(memory, false);
+        delete memory;
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(_sharedReaderMutex);
+    _sharedReaders.push_back(memory);
+    return (int) _sharedReaders.size() - 1;
+}
+
+EXPORT bool acquireSharedFrame(int readerID, SharedFrame *outFrame)
+{
+    std::lock_guard<std::mutex> lock(_sharedReaderMutex);
+    _SharedMemory *memory = _getSharedReader(readerID);
+    return memory != 0 && outFrame != 0 && _acquireSharedFrame(memory, outFrame);
+}
+
+EXPORT bool isSharedFrameValid(int readerID, const SharedFrame *frame)
+{
+    std::lock_guard<std::mutex> lock(_sharedReaderMutex);
+    _SharedMemory *memory = _getSharedReader(readerID);
+    return memory != 0 && frame != 0 && _isSharedFrameValid(memory, frame);
+}
+
+EXPORT unsigned char *readSharedFrame(int readerID, SharedFrame *outFrame)
+{
+    std::lock_guard<std::mutex> lock(_sharedReaderMutex);
+    _SharedMemory *memory = _getSharedReader(readerID);
+    SharedFrame frame;
+    unsigned char *data = 0;
+    size_t capacity = 0;
+    for ( int attempt = 0; memory != 0 && attempt < _SHARED_FRAME_RETRIES; ++attempt )
+    {
+        if ( !_acquireSharedFrame(memory, &frame))
+        {
+            break;
+        }
+        size_t bytes = (size_t) frame.width * frame.height * 4;
+        if ( bytes > capacity )
+        {
+            _releaseBuffer(data);
+            data = _allocateBuffer(bytes);
+            capacity = data != 0 ? bytes : 0;
+            if ( data == 0 )
+            {
+                return 0;
+            }
+        }
+        memcpy(data, frame.data, bytes);
+        if ( _isSharedFrameValid(memory, &frame))
+        {
+            if ( outFrame != 0 )
+            {
+                *outFrame = frame;
+                outFrame->data = 0;
+            }
+            return data;
+        }
+    }
+    _releaseBuffer(data);
+    return 0;
+}
+
+EXPORT void closeSharedFrames(int readerID)
+{
+    std::lock_guard<std::mutex> lock(_sharedReaderMutex);
+    _SharedMemory *memory = _getSharedReader(readerID);
+    if ( memory != 0 )
+    {
+        _closeSharedMemory(memory, false);
+        delete memory;
+        _sharedReaders[readerID] = 0;
+    }
+}
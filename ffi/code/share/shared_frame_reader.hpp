@@ -0,0 +1,82 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+#include "shared_frames_format.hpp"
+#include <stddef.h>
+#include <string>
+
+#ifndef SHARED_FRAME_READER_H
+#define SHARED_FRAME_READER_H
+
+/// Details of a frame returned by acquireSharedFrame and readSharedFrame
+struct SharedFrame
+{
+    /// BGRA pixels (rows of width * 4 bytes) inside of the read only shared memory (only set by acquireSharedFrame)
+    const unsigned char *data;
+    int width;
+    int height;
+    /// Window bounds in screen coordinates when the frame was captured
+    RECT bounds;
+    /// Frame number of the capture thread and unix time in microseconds when the frame was published
+    long long frameNumber;
+    long long timestamp;
+    /// Position in the ring and its sequence, so that isSharedFrameValid can check if the frame was overwritten
+    int slot;
+    unsigned long long sequence;
+};
+
+/// Maps the shared memory that the window of startFramePublishing (also of another process) publishes its frames into
+/// with the [name] read only. Returns the id of the reader for the other functions, or -1 if there is no publisher
+/// with the name.
+EXPORT int openSharedFrames(const char *name);
+
+/// Writes the newest published frame into [outFrame] without copying anything: the data points into the shared
+/// memory and stays valid until the publisher wrote slotCount - 1 newer frames. Read the pixels directly and then call
+/// isSharedFrameValid to check that the publisher did not overwrite them in the meantime.
+/// Returns false if there is no frame yet, if the reader does not exist, or if the publisher stopped (then the name
+/// has to be opened again after it was restarted).
+EXPORT bool acquireSharedFrame(int readerID, SharedFrame *outFrame);
+
+/// Returns true if the pixels of the [frame] of acquireSharedFrame were not overwritten by the publisher since then,
+/// so everything that was read from them before this call is complete
+EXPORT bool isSharedFrameValid(int readerID, const SharedFrame *frame);
+
+/// Returns a copy of the newest published frame (BGRA with width * 4 bytes per row) that was checked to be complete
+/// and writes its details into [outFrame] if it is not 0 (with data = 0). The memory must be freed with
+/// cleanupMemory! Returns 0 in the same cases as acquireSharedFrame.
+EXPORT unsigned char *readSharedFrame(int readerID, SharedFrame *outFrame);
+
+/// Unmaps the shared memory of the reader (does nothing if it does not exist)
+EXPORT void closeSharedFrames(int readerID);
+
+/// Internal: a mapped shared memory with the platform name of the [name]
+struct _SharedMemory
+{
+    unsigned char *data = 0;
+    size_t size = 0;
+    std::string name;
+#ifdef _WIN32
+    HANDLE mapping = 0;
+#endif // #ifdef _WIN32
+};
+
+/// Internal: returns true if the [name] only contains letters, digits, '_', '-' and '.' (and is not too long)
+bool _isSharedMemoryName(const char *name);
+
+/// Internal: creates a new zeroed shared memory with the [name] and [size] and maps it writable. Returns false if it
+/// failed
+bool _createSharedMemory(const char *name, size_t size, _SharedMemory *outMemory);
+
+/// Internal: maps the existing shared memory with the [name] read only. Returns false if it does not exist
+bool _openSharedMemory(const char *name, _SharedMemory *outMemory);
+
+/// Internal: unmaps the [memory] and also removes its name if it was created by this process ([remove])
+void _closeSharedMemory(_SharedMemory *memory, bool remove);
+
+/// Internal: returns the slot [index] of the shared frames that start with the [header]
+inline _SharedFrameSlot *_sharedFrameSlot(const _SharedFramesHeader *header, uint64_t index)
+{
+    return (_SharedFrameSlot *) ((const unsigned char *) header + sizeof(_SharedFramesHeader) +
+                                 index * header->slotStride);
+}
+
+#endif //SHARED_FRAME_READER_H
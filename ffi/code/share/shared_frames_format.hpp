@@ -0,0 +1,71 @@
+#ifndef SHARED_FRAMES_FORMAT_H
+#define SHARED_FRAMES_FORMAT_H
+
+#include <stdint.h>
+#include <atomic>
+
+/// Internal: layout of the shared memory of startFramePublishing, so that it can also be read without this library
+/// (for example with mmap in python). The memory is named "/<name>" on linux (shm_open) and "Local\<name>" on
+/// windows (file mapping). All values are little endian and the memory contains:
+///
+/// _SharedFramesHeader (64 bytes)
+/// slotCount times: _SharedFrameSlot (64 bytes) followed by slotCapacity bytes of BGRA pixels (width * 4 bytes per
+/// row), so slot i starts at 64 + i * slotStride
+///
+/// Every slot is a seqlock: its sequence is odd while the publisher writes into it. A reader reads the sequence, then
+/// the slot and then the sequence again. The slot was read completely if both sequences are the same even number.
+/// The newest frame is in the slot (latest - 1) % slotCount and the publisher always writes the next slot of the
+/// ring, so a slot is only overwritten after slotCount - 1 newer frames were published.
+# define _SHARED_FRAMES_MAGIC "GTFRAMES"
+# define _SHARED_FRAMES_VERSION 1
+/// Offset of the pixels in each slot and alignment of the slots
+# define _SHARED_FRAME_HEADER_SIZE 64
+
+/// Set in the state of the header when the publisher stopped (the readers have to open the name again)
+# define _SHARED_FRAMES_OPEN 1
+# define _SHARED_FRAMES_CLOSED 2
+
+/// The atomics are read and written by different processes, so they must not use any locks
+#if ATOMIC_LLONG_LOCK_FREE != 2 || ATOMIC_INT_LOCK_FREE != 2
+#error "shared frames need lock free 32 and 64 bit atomics"
+#endif
+
+/// Start of the shared memory
+struct _SharedFramesHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t slotCount;
+    uint64_t slotCapacity;
+    uint64_t slotStride;
+    /// Amount of published frames (0 if there is no frame yet)
+    std::atomic<uint64_t> latest;
+    /// _SHARED_FRAMES_OPEN after the header was written completely, then _SHARED_FRAMES_CLOSED after the publisher
+    /// stopped
+    std::atomic<uint32_t> state;
+    uint32_t windowID;
+    char reserved[16];
+};
+
+/// Header of one slot of the ring
+struct _SharedFrameSlot
+{
+    /// Seqlock sequence (odd while the slot is written)
+    std::atomic<uint64_t> sequence;
+    /// Frame number of the capture thread and unix time in microseconds when the frame was published
+    int64_t frameNumber;
+    int64_t timestamp;
+    int32_t width;
+    int32_t height;
+    /// Window bounds in screen coordinates when the frame was captured
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+    char reserved[16];
+};
+
+static_assert(sizeof(_SharedFramesHeader) == 64, "the shared frames header is read by other processes");
+static_assert(sizeof(_SharedFrameSlot) == _SHARED_FRAME_HEADER_SIZE, "the slot header is read by other processes");
+
+#endif //SHARED_FRAMES_FORMAT_H
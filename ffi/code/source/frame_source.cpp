@@ -0,0 +1,974 @@
+#include "frame_source.hpp"
+#include "../platform/platform_screen.hpp"
+#include "../capture/frame_grabber.hpp"
+#include "../record/recording_reader.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <share.h>
+#else
+#include <dirent.h>
+#endif // #ifdef _WIN32
+
+/// Handle of the synthetic window (only valid while a synthetic source is active)
+# define _SYNTHETIC_WINDOW ((WindowHandle) 0x5F0001)
+
+/// Biggest width and height of a synthetic source (so that the frame size always fits into an int)
+# define _MAX_SOURCE_SIZE 16384
+
+/// Side length of the moving square of the procedural frames
+# define _PROCEDURAL_SQUARE 64
+
+/// Flags of _notifySourceChange for the window events that are posted
+# define _SOURCE_OPEN_CHANGED 1
+# define _SOURCE_BOUNDS_CHANGED 2
+
+/// Frames are never changed after they were created, so captures can keep using a frame while the source changes
+typedef std::shared_ptr<const std::vector<unsigned char>> _SourceFrame;
+
+/// State of the synthetic source (only used while holding the _sourceMutex)
+struct _SyntheticSource
+{
+    int type = FRAME_SOURCE_SCREEN;
+    std::string title;
+    int width = 0;
+    int height = 0;
+    /// All BGRA frames of a file source
+    std::vector<_SourceFrame> files;
+    long long frameNumber = 0;
+    /// Frame of the frameNumber that is returned by all captures (0 if a file source has no frames yet)
+    _SourceFrame current;
+    /// Outer bounds and the position of the inner window in screen coordinates, the size of the main display and if
+    /// the window is open (only a replay source changes these)
+    RECT bounds = RECT{0, 0, 0, 0};
+    POINT origin = POINT{0, 0};
+    int displayWidth = 0;
+    int displayHeight = 0;
+    bool open = true;
+    /// Recording of a replay source (its reader is only used while holding the _replayDecodeMutex)
+    std::shared_ptr<_RecordingReader> recording;
+    /// Index of the record that is shown (the record count after the end of the replay) and the one that was requested
+    /// last, so a record that was decoded after another one was requested is not shown anymore
+    long long replayIndex = -1;
+    long long replayTarget = -1;
+    double replaySpeed = 1.0;
+    /// The recorded timestamp replayOffset is shown at replayStart and the window is closed at replayEnd
+    std::chrono::steady_clock::time_point replayStart;
+    long long replayOffset = 0;
+    long long replayEnd = 0;
+};
+
+std::mutex _sourceMutex;
+
+_SyntheticSource _source;
+
+/// Held while the reader of a replay source decodes a record. The records are decoded without holding the
+/// _sourceMutex, so captures of the current frame do not wait for it
+std::mutex _replayDecodeMutex;
+
+/// Only false while the live screen is used, so that the screen functions are called without locking
+std::atomic<bool> _sourceActive{false};
+
+/// Incremented for every source change, so that _platformWindowListVersion always changes with it
+std::atomic<uint64_t> _sourceVersion{0};
+
+/// Callback of _platformSetWindowEventCallback, which also gets an open event when the source changes
+std::atomic<WindowEventCallback> _sourceEventCallback{0};
+
+/// Copy of the state and the current frame of the synthetic source for one platform call
+struct _SourceView
+{
+    int width = 0;
+    int height = 0;
+    _SourceFrame frame;
+    RECT bounds;
+    POINT origin;
+    int displayWidth = 0;
+    int displayHeight = 0;
+    bool open = false;
+};
+
+/// Posts the open and bounds events of the [changes] flags for the synthetic window to the window event callback
+/// (called after the source changed without holding the _sourceMutex)
+void _notifySourceChange(int changes)
+{
+    WindowEventCallback callback = _sourceEventCallback.load(std::memory_order_acquire);
+    if ( callback != 0 && (changes & _SOURCE_OPEN_CHANGED) != 0 )
+    {
+        callback(_SYNTHETIC_WINDOW, _WINDOW_EVENT_OPEN);
+    }
+    if ( callback != 0 && (changes & _SOURCE_BOUNDS_CHANGED) != 0 )
+    {
+        callback(_SYNTHETIC_WINDOW, _WINDOW_EVENT_BOUNDS);
+    }
+}
+
+/// Reconstructs the record at [index] of the [recording] into a new frame. Returns 0 if the recording is corrupted
+/// (called without holding the _sourceMutex)
+_SourceFrame _decodeReplayRecord(_RecordingReader *recording, long long index)
+{
+    std::lock_guard<std::mutex> lock(_replayDecodeMutex);
+    if ( !_seekRecord(recording, index))
+    {
+        return _SourceFrame();
+    }
+    // the reader reuses its frame for the next record, but captures may keep using this one
+    return _SourceFrame(new std::vector<unsigned char>(recording->frame));
+}
+
+/// Shows the decoded [frame] of the record at [index] of the replay source, or closes the window for the record count
+/// (or if the frame is 0 because the recording is corrupted). Returns the _SOURCE_ flags of the changes (must hold the
+/// _sourceMutex)
+int _applyReplayRecord(long long index, const _SourceFrame &frame)
+{
+    const std::vector<_RecordIndex> &records = _source.recording->records;
+    bool wasOpen = _source.open;
+    RECT previous = _source.bounds;
+    _source.replayIndex = index;
+    _source.replayTarget = index;
+    if ( index == (long long) records.size() || !frame )
+    {
+        _source.replayIndex = _source.replayTarget = (long long) records.size();
+        _source.open = false;
+        _source.current.reset();
+    } else
+    {
+        const _RecordHeader &header = records[(size_t) index].header;
+        _source.width = header.width;
+        _source.height = header.height;
+        _source.bounds = RECT{header.left, header.top, header.right, header.bottom};
+        _source.origin = _innerWindowPos(_source.bounds, POINT{header.width, header.height});
+        _source.open = true;
+        _source.current = frame;
+    }
+    int changes = 0;
+    if ( wasOpen != _source.open )
+    {
+        changes |= _SOURCE_OPEN_CHANGED;
+        _sourceVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+    if ( _source.open && memcmp(&previous, &_source.bounds, sizeof(RECT)) != 0 )
+    {
+        changes |= _SOURCE_BOUNDS_CHANGED;
+    }
+    return changes;
+}
+
+/// Shows the record at [index] of the replay source, or closes the window after the last record. The [lock] must hold
+/// the _sourceMutex, which is released while the record is decoded, so the source may have changed when this returns
+/// (then nothing is shown). Returns the _SOURCE_ flags of the changes
+int _showReplayRecord(std::unique_lock<std::mutex> &lock, long long index)
+{
+    std::shared_ptr<_RecordingReader> recording = _source.recording;
+    long long count = (long long) recording->records.size();
+    index = index < count ? index : count;
+    _source.replayTarget = index; // a record that another thread is still decoding is not shown anymore
+    if ( index == _source.replayIndex )
+    {
+        return 0;
+    }
+    _SourceFrame frame;
+    if ( index < count )
+    {
+        lock.unlock();
+        frame = _decodeReplayRecord(recording.get(), index);
+        lock.lock();
+        if ( _source.recording != recording || _source.replayTarget != index || _source.replayIndex == index )
+        {
+            return 0; // the source changed, another record was requested, or another thread already showed it
+        }
+    }
+    return _applyReplayRecord(index, frame);
+}
+
+/// Returns the recorded timestamp that is shown now by a replay source with a speed (must hold the _sourceMutex)
+inline long long _replayTimestamp()
+{
+    double elapsed = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - _source.replayStart).count();
+    return _source.replayOffset + (long long) (elapsed * _source.replaySpeed);
+}
+
+/// Moves a replay source with a speed to the record of the current time (see _showReplayRecord for the [lock]).
+/// Returns the _SOURCE_ flags of the changes
+int _updateReplay(std::unique_lock<std::mutex> &lock)
+{
+    if ( _source.type != FRAME_SOURCE_REPLAY || _source.replaySpeed <= 0 )
+    {
+        return 0;
+    }
+    long long timestamp = _replayTimestamp();
+    if ( timestamp >= _source.replayEnd )
+    {
+        return _showReplayRecord(lock, (long long) _source.recording->records.size());
+    }
+    return _showReplayRecord(lock, _findRecord(_source.recording.get(), timestamp));
+}
+
+/// Restarts the clock of a replay source at the record of the replayIndex (must hold the _sourceMutex)
+inline void _restartReplayClock()
+{
+    const std::vector<_RecordIndex> &records = _source.recording->records;
+    _source.replayStart = std::chrono::steady_clock::now();
+    _source.replayOffset = _source.replayIndex < (long long) records.size() ?
+                           records[(size_t) _source.replayIndex].header.timestamp : _source.replayEnd;
+}
+
+/// Starts the replay of the [recording] at its decoded [firstFrame] (must hold the _sourceMutex)
+void _startReplay(const std::shared_ptr<_RecordingReader> &recording, const _SourceFrame &firstFrame)
+{
+    const std::vector<_RecordIndex> &records = recording->records;
+    // the main display contains the inner window of every record
+    for ( const _RecordIndex &record : records )
+    {
+        const _RecordHeader &header = record.header;
+        POINT origin = _innerWindowPos(RECT{header.left, header.top, header.right, header.bottom},
+                                       POINT{header.width, header.height});
+        int right = origin.x + header.width > header.right ? origin.x + header.width : header.right;
+        int bottom = origin.y + header.height > header.bottom ? origin.y + header.height : header.bottom;
+        _source.displayWidth = right > _source.displayWidth ? right : _source.displayWidth;
+        _source.displayHeight = bottom > _source.displayHeight ? bottom : _source.displayHeight;
+    }
+    // the last frame is shown as long as the average frame before the window closes
+    long long first = records.front().header.timestamp;
+    long long last = records.back().header.timestamp;
+    _source.replayEnd = last + (records.size() > 1 ? (last - first) / (long long) (records.size() - 1) : 0) + 1;
+    _source.recording = recording;
+    _source.open = false;
+    _applyReplayRecord(0, firstFrame);
+    _restartReplayClock();
+}
+
+/// Returns false if the live screen is used. Otherwise the [view] and the [title] (if not 0) are filled (a replay
+/// source is moved to the current time first)
+bool _viewSource(_SourceView *view, std::string *title)
+{
+    if ( !_sourceActive.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    int changes;
+    {
+        std::unique_lock<std::mutex> lock(_sourceMutex);
+        if ( _source.type == FRAME_SOURCE_SCREEN )
+        {
+            return false;
+        }
+        changes = _updateReplay(lock);
+        if ( _source.type == FRAME_SOURCE_SCREEN )
+        {
+            return false; // the screen was selected while the record was decoded
+        }
+        view->width = _source.width;
+        view->height = _source.height;
+        view->frame = _source.current;
+        view->bounds = _source.bounds;
+        view->origin = _source.origin;
+        view->displayWidth = _source.displayWidth;
+        view->displayHeight = _source.displayHeight;
+        view->open = _source.open;
+        if ( title != 0 )
+        {
+            *title = _source.title;
+        }
+    }
+    _notifySourceChange(changes);
+    return true;
+}
+
+/// Gradient that moves with the [frameNumber] and a white square that moves over the frame
+_SourceFrame _generateFrame(int width, int height, long long frameNumber)
+{
+    std::vector<unsigned char> *pixels = new std::vector<unsigned char>((size_t) width * height * 4);
+    int shift = (int) (frameNumber % 256);
+    int squareX = width > _PROCEDURAL_SQUARE ? (int) (frameNumber * 8 % (width - _PROCEDURAL_SQUARE)) : 0;
+    int squareY = height > _PROCEDURAL_SQUARE ? (int) (frameNumber * 5 % (height - _PROCEDURAL_SQUARE)) : 0;
+    unsigned char *pixel = pixels->data();
+    for ( int y = 0; y < height; ++y )
+    {
+        bool squareRow = y >= squareY && y < squareY + _PROCEDURAL_SQUARE;
+        for ( int x = 0; x < width; ++x, pixel += 4 )
+        {
+            if ( squareRow && x >= squareX && x < squareX + _PROCEDURAL_SQUARE )
+            {
+                pixel[0] = pixel[1] = pixel[2] = 255;
+            } else
+            {
+                pixel[0] = (unsigned char) (x + shift);
+                pixel[1] = (unsigned char) (y + shift);
+                pixel[2] = (unsigned char) (x ^ y);
+            }
+            pixel[3] = 255;
+        }
+    }
+    return _SourceFrame(pixels);
+}
+
+/// Sets the current frame of the _source for its frameNumber (must hold the _sourceMutex)
+void _selectSourceFrame()
+{
+    if ( _source.type == FRAME_SOURCE_PROCEDURAL )
+    {
+        _source.current = _generateFrame(_source.width, _source.height, _source.frameNumber);
+    } else if ( _source.type == FRAME_SOURCE_FILES && !_source.files.empty())
+    {
+        _source.current = _source.files[(size_t) (_source.frameNumber % (long long) _source.files.size())];
+    } else
+    {
+        _source.current.reset();
+    }
+}
+
+/// Reads the whole file at the utf8 [path] into [data]
+bool _readSourceFile(const std::string &path, std::vector<unsigned char> *data)
+{
+#ifdef _WIN32
+    wchar_t widePath[MAX_PATH];
+    if ( MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath, MAX_PATH) == 0 )
+    {
+        return false;
+    }
+    FILE *file = _wfsopen(widePath, L"rb", _SH_DENYNO);
+#else
+    FILE *file = fopen(path.c_str(), "rb");
+#endif // #ifdef _WIN32
+    if ( file == 0 )
+    {
+        return false;
+    }
+    data->clear();
+    unsigned char chunk[65536];
+    size_t read;
+    while (( read = fread(chunk, 1, sizeof(chunk), file)) > 0 )
+    {
+        data->insert(data->end(), chunk, chunk + read);
+    }
+    fclose(file);
+    return true;
+}
+
+/// Appends the utf8 names of all files in the [directory]. Returns false if it can not be read
+bool _listSourceFiles(const std::string &directory, std::vector<std::string> *names)
+{
+#ifdef _WIN32
+    wchar_t pattern[MAX_PATH];
+    if ( MultiByteToWideChar(CP_UTF8, 0, (directory + "\\*").c_str(), -1, pattern, MAX_PATH) == 0 )
+    {
+        return false;
+    }
+    WIN32_FIND_DATAW entry;
+    HANDLE find = FindFirstFileW(pattern, &entry);
+    if ( find == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+    do
+    {
+        char name[MAX_PATH * 3];
+        if (( entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 &&
+            WideCharToMultiByte(CP_UTF8, 0, entry.cFileName, -1, name, sizeof(name), 0, 0) > 0 )
+        {
+            names->push_back(name);
+        }
+    } while ( FindNextFileW(find, &entry));
+    FindClose(find);
+#else
+    DIR *dir = opendir(directory.c_str());
+    if ( dir == 0 )
+    {
+        return false;
+    }
+    while ( struct dirent *entry = readdir(dir))
+    {
+        if ( entry->d_type != DT_DIR )
+        {
+            names->push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+#endif // #ifdef _WIN32
+    return true;
+}
+
+/// Reads the next number of a ppm header at [position] (skips whitespace and comments)
+bool _readPpmNumber(const std::vector<unsigned char> &data, size_t *position, int *value)
+{
+    size_t i = *position;
+    while ( i < data.size() && (data[i] == '#' || data[i] == ' ' || data[i] == '\t' || data[i] == '\r' ||
+                                data[i] == '\n'))
+    {
+        if ( data[i] == '#' )
+        {
+            while ( i < data.size() && data[i] != '\n' )
+            {
+                ++i;
+            }
+        } else
+        {
+            ++i;
+        }
+    }
+    long long number = 0;
+    size_t start = i;
+    while ( i < data.size() && data[i] >= '0' && data[i] <= '9' && number <= _MAX_SOURCE_SIZE )
+    {
+        number = number * 10 + (data[i++] - '0');
+    }
+    *position = i;
+    *value = (int) number;
+    return i > start && number <= _MAX_SOURCE_SIZE;
+}
+
+/// Converts a binary ppm file (P6 with a max value of 255) into a BGRA frame. Returns 0 for other formats
+_SourceFrame _decodePpm(const std::vector<unsigned char> &data, int *width, int *height)
+{
+    size_t position = 2;
+    int maxValue;
+    if ( data.size() < 2 || data[0] != 'P' || data[1] != '6' || !_readPpmNumber(data, &position, width) ||
+         !_readPpmNumber(data, &position, height) || !_readPpmNumber(data, &position, &maxValue) || maxValue != 255 )
+    {
+        return _SourceFrame();
+    }
+    size_t pixelCount = (size_t) *width * *height;
+    ++position; // single whitespace after the max value
+    if ( pixelCount == 0 || position + pixelCount * 3 > data.size())
+    {
+        return _SourceFrame();
+    }
+    std::vector<unsigned char> *pixels = new std::vector<unsigned char>(pixelCount * 4);
+    const unsigned char *rgb = data.data() + position;
+    unsigned char *bgra = pixels->data();
+    for ( size_t i = 0; i < pixelCount; ++i, rgb += 3, bgra += 4 )
+    {
+        bgra[0] = rgb[2];
+        bgra[1] = rgb[1];
+        bgra[2] = rgb[0];
+        bgra[3] = 255;
+    }
+    return _SourceFrame(pixels);
+}
+
+inline bool _hasExtension(const std::string &name, const char *extension)
+{
+    size_t length = strlen(extension);
+    return name.size() > length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+/// Loads all .bgra and .ppm files of the [directory] sorted by name into [frames]. Raw files need a known size, so
+/// [width] and [height] are set by the first ppm file if they are 0. Frames with a different size are skipped
+bool _loadSourceFiles(const std::string &directory, int *width, int *height, std::vector<_SourceFrame> *frames)
+{
+    std::vector<std::string> names;
+    if ( !_listSourceFiles(directory, &names))
+    {
+        return false;
+    }
+    std::sort(names.begin(), names.end());
+    std::vector<unsigned char> data;
+    for ( const std::string &name : names )
+    {
+        bool raw = _hasExtension(name, ".bgra");
+        if ( !raw && !_hasExtension(name, ".ppm"))
+        {
+            continue;
+        }
+        if ( !_readSourceFile(directory + "/" + name, &data))
+        {
+            continue;
+        }
+        if ( raw )
+        {
+            if ( *width > 0 && *height > 0 && data.size() == (size_t) *width * *height * 4 )
+            {
+                frames->push_back(_SourceFrame(new std::vector<unsigned char>(data)));
+            }
+            continue;
+        }
+        int frameWidth, frameHeight;
+        _SourceFrame frame = _decodePpm(data, &frameWidth, &frameHeight);
+        if ( frame && (*width == 0 || *height == 0))
+        {
+            *width = frameWidth;
+            *height = frameHeight;
+        }
+        if ( frame && frameWidth == *width && frameHeight == *height )
+        {
+            frames->push_back(frame);
+        }
+    }
+    return true;
+}
+
+/// Same as _platformCaptureConverted, but reads the area from the frame of the [view] (everything outside of it is 0)
+bool _captureSource(const _SourceView &view, int x, int y, int width, int height, unsigned char *target,
+                    int targetStride, CaptureRowConverter convert, int targetChannels)
+{
+    if ( width <= 0 || height <= 0 || target == 0 || targetChannels <= 0 || targetStride < width * targetChannels )
+    {
+        return false;
+    }
+    int left = x < 0 ? 0 : x;
+    int right = x + width > view.width ? view.width : x + width;
+    const unsigned char *frame = view.frame ? view.frame->data() : 0;
+    for ( int row = 0; row < height; ++row )
+    {
+        unsigned char *out = target + (size_t) row * targetStride;
+        int sourceY = y + row;
+        if ( frame == 0 || sourceY < 0 || sourceY >= view.height || left >= right )
+        {
+            memset(out, 0, (size_t) width * targetChannels);
+            continue;
+        }
+        memset(out, 0, (size_t) (left - x) * targetChannels);
+        const unsigned char *in = frame + ((size_t) sourceY * view.width + left) * 4;
+        if ( convert != 0 )
+        {
+            convert(in, right - left, out + (size_t) (left - x) * targetChannels);
+        } else
+        {
+            memcpy(out + (size_t) (left - x) * 4, in, (size_t) (right - left) * 4);
+        }
+        memset(out + (size_t) (right - x) * targetChannels, 0, (size_t) (x + width - right) * targetChannels);
+    }
+    return true;
+}
+
+EXPORT bool setFrameSource(int type, const char *windowTitle, int width, int height, const char *path)
+{
+    if ( type == FRAME_SOURCE_SCREEN )
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sourceMutex);
+            _source = _SyntheticSource();
+            _sourceActive.store(false, std::memory_order_release);
+            _sourceVersion.fetch_add(1, std::memory_order_relaxed);
+        }
+        _notifySourceChange(_SOURCE_OPEN_CHANGED | _SOURCE_BOUNDS_CHANGED);
+        return true;
+    }
+    if ( type == FRAME_SOURCE_REPLAY )
+    {
+        width = 0; // the size of the recorded frames is used
+        height = 0;
+    }
+    if (( type != FRAME_SOURCE_FILES && type != FRAME_SOURCE_PROCEDURAL && type != FRAME_SOURCE_REPLAY) ||
+        windowTitle == 0 || width < 0 || height < 0 || width > _MAX_SOURCE_SIZE || height > _MAX_SOURCE_SIZE ||
+        (type == FRAME_SOURCE_PROCEDURAL && (width == 0 || height == 0)))
+    {
+        return false;
+    }
+    std::vector<_SourceFrame> files;
+    if ( type == FRAME_SOURCE_FILES && path != 0 && path[0] != 0 && !_loadSourceFiles(path, &width, &height, &files))
+    {
+        return false;
+    }
+    std::shared_ptr<_RecordingReader> recording;
+    _SourceFrame firstRecord;
+    if ( type == FRAME_SOURCE_REPLAY )
+    {
+        _RecordingReader *reader = _openReader(path);
+        if ( reader != 0 && reader->records.empty())
+        {
+            _closeReader(reader);
+            reader = 0;
+        }
+        if ( reader == 0 )
+        {
+            return false;
+        }
+        recording.reset(reader, _closeReader);
+        firstRecord = _decodeReplayRecord(reader, 0);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sourceMutex);
+        _source = _SyntheticSource();
+        _source.type = type;
+        _source.title = windowTitle;
+        _source.width = width;
+        _source.height = height;
+        _source.bounds = RECT{0, 0, width, height};
+        _source.displayWidth = width;
+        _source.displayHeight = height;
+        _source.files.swap(files);
+        if ( type == FRAME_SOURCE_REPLAY )
+        {
+            _startReplay(recording, firstRecord);
+        } else
+        {
+            _selectSourceFrame();
+        }
+        _sourceActive.store(true, std::memory_order_release);
+        _sourceVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+    _notifySourceChange(_SOURCE_OPEN_CHANGED | _SOURCE_BOUNDS_CHANGED);
+    return true;
+}
+
+EXPORT int getFrameSource()
+{
+    std::lock_guard<std::mutex> lock(_sourceMutex);
+    return _source.type;
+}
+
+EXPORT bool addSourceFrame(const unsigned char *bgra, int width, int height)
+{
+    if ( bgra == 0 || width <= 0 || height <= 0 || width > _MAX_SOURCE_SIZE || height > _MAX_SOURCE_SIZE )
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_sourceMutex);
+    if ( _source.type != FRAME_SOURCE_FILES )
+    {
+        return false;
+    }
+    if ( _source.width == 0 || _source.height == 0 )
+    {
+        _source.width = width;
+        _source.height = height;
+        _source.bounds = RECT{0, 0, width, height};
+        _source.displayWidth = width;
+        _source.displayHeight = height;
+    } else if ( _source.width != width || _source.height != height )
+    {
+        return false;
+    }
+    _source.files.push_back(_SourceFrame(new std::vector<unsigned char>(bgra, bgra + (size_t) width * height * 4)));
+    _selectSourceFrame();
+    return true;
+}
+
+EXPORT int getSourceFrameCount()
+{
+    std::lock_guard<std::mutex> lock(_sourceMutex);
+    if ( _source.type == FRAME_SOURCE_REPLAY )
+    {
+        return (int) _source.recording->records.size();
+    }
+    return _source.type == FRAME_SOURCE_FILES ? (int) _source.files.size() : 0;
+}
+
+EXPORT bool setSourceFrame(long long frameNumber)
+{
+    if ( frameNumber < 0 )
+    {
+        return false;
+    }
+    int changes = 0;
+    {
+        std::unique_lock<std::mutex> lock(_sourceMutex);
+        if ( _source.type == FRAME_SOURCE_SCREEN )
+        {
+            return false;
+        }
+        if ( _source.type == FRAME_SOURCE_REPLAY )
+        {
+            std::shared_ptr<_RecordingReader> recording = _source.recording;
+            changes = _showReplayRecord(lock, frameNumber);
+            if ( _source.recording == recording )
+            {
+                _restartReplayClock();
+            }
+        } else if ( _source.frameNumber != frameNumber || !_source.current )
+        {
+            _source.frameNumber = frameNumber;
+            _selectSourceFrame();
+        }
+    }
+    _notifySourceChange(changes);
+    return true;
+}
+
+EXPORT long long getSourceFrame()
+{
+    long long frameNumber;
+    int changes = 0;
+    {
+        std::unique_lock<std::mutex> lock(_sourceMutex);
+        if ( _source.type == FRAME_SOURCE_SCREEN )
+        {
+            return -1;
+        }
+        if ( _source.type == FRAME_SOURCE_REPLAY )
+        {
+            changes = _updateReplay(lock);
+        }
+        frameNumber = _source.type == FRAME_SOURCE_REPLAY ? _source.replayIndex : _source.frameNumber;
+    }
+    _notifySourceChange(changes);
+    return frameNumber;
+}
+
+EXPORT bool setReplaySpeed(double speed)
+{
+    if ( !(speed >= 0))
+    {
+        return false; // also NaN
+    }
+    int changes;
+    {
+        std::unique_lock<std::mutex> lock(_sourceMutex);
+        if ( _source.type != FRAME_SOURCE_REPLAY )
+        {
+            return false;
+        }
+        changes = _updateReplay(lock);
+        if ( _source.type != FRAME_SOURCE_REPLAY )
+        {
+            return false; // another source was selected while the record was decoded
+        }
+        // continues exactly at the current time of the old speed (or at the shown frame without a speed)
+        long long timestamp = _source.replaySpeed > 0 ? _replayTimestamp() : -1;
+        _restartReplayClock();
+        if ( timestamp >= 0 && timestamp < _source.replayEnd )
+        {
+            _source.replayOffset = timestamp;
+        }
+        _source.replaySpeed = speed;
+    }
+    _notifySourceChange(changes);
+    return true;
+}
+
+void _platformEnumWindows(WindowEnumCallback callback, void *userData)
+{
+    _SourceView view;
+    std::string title;
+    if ( _viewSource(&view, &title))
+    {
+        if ( view.open )
+        {
+            callback(_SYNTHETIC_WINDOW, title.c_str(), userData);
+        }
+        return;
+    }
+    _screenEnumWindows(callback, userData);
+}
+
+uint64_t _platformWindowListVersion()
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0)) // a replay source may have closed its window
+    {
+        return (1ull << 63) | _sourceVersion.load(std::memory_order_relaxed);
+    }
+    return _screenWindowListVersion();
+}
+
+bool _platformSetWindowEventCallback(WindowEventCallback callback)
+{
+    _sourceEventCallback.store(callback, std::memory_order_release);
+    bool screenEvents = _screenSetWindowEventCallback(callback);
+    return screenEvents || (callback != 0 && _sourceActive.load(std::memory_order_acquire));
+}
+
+bool _platformIsWindow(WindowHandle handle)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return view.open && handle == _SYNTHETIC_WINDOW;
+    }
+    return _screenIsWindow(handle);
+}
+
+void _platformOnWindowLost()
+{
+    _SourceView view;
+    if ( !_viewSource(&view, 0))
+    {
+        _screenOnWindowLost();
+    }
+}
+
+int _platformGetWindowAffinity(WindowHandle handle)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return 0;
+    }
+    return _screenGetWindowAffinity(handle);
+}
+
+WindowHandle _platformGetForegroundWindow()
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return view.open ? _SYNTHETIC_WINDOW : 0;
+    }
+    return _screenGetForegroundWindow();
+}
+
+bool _platformSetForegroundWindow(WindowHandle handle)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return view.open && handle == _SYNTHETIC_WINDOW;
+    }
+    return _screenSetForegroundWindow(handle);
+}
+
+bool _platformGetWindowRect(WindowHandle handle, RECT *bounds)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        if ( !view.open || handle != _SYNTHETIC_WINDOW )
+        {
+            return false;
+        }
+        *bounds = view.bounds;
+        return true;
+    }
+    return _screenGetWindowRect(handle, bounds);
+}
+
+bool _platformGetClientSize(WindowHandle handle, POINT *size)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        if ( !view.open || handle != _SYNTHETIC_WINDOW )
+        {
+            return false;
+        }
+        size->x = view.width;
+        size->y = view.height;
+        return true;
+    }
+    return _screenGetClientSize(handle, size);
+}
+
+bool _platformScreenToClient(WindowHandle handle, POINT *point)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        if ( !view.open || handle != _SYNTHETIC_WINDOW )
+        {
+            return false;
+        }
+        point->x -= view.origin.x;
+        point->y -= view.origin.y;
+        return true;
+    }
+    return _screenScreenToClient(handle, point);
+}
+
+bool _platformClientToScreen(WindowHandle handle, POINT *point)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        if ( !view.open || handle != _SYNTHETIC_WINDOW )
+        {
+            return false;
+        }
+        point->x += view.origin.x;
+        point->y += view.origin.y;
+        return true;
+    }
+    return _screenClientToScreen(handle, point);
+}
+
+bool _platformCloseWindow(WindowHandle handle)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return false; // only setFrameSource removes the synthetic window
+    }
+    return _screenCloseWindow(handle);
+}
+
+unsigned int _platformGetDisplayWidth()
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return (unsigned int) view.displayWidth;
+    }
+    return _screenGetDisplayWidth();
+}
+
+unsigned int _platformGetDisplayHeight()
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return (unsigned int) view.displayHeight;
+    }
+    return _screenGetDisplayHeight();
+}
+
+bool _platformCaptureScreen(int x, int y, int width, int height, unsigned char *target)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return _captureSource(view, x - view.origin.x, y - view.origin.y, width, height, target, width * 4, 0, 4);
+    }
+    return _screenCaptureScreen(x, y, width, height, target);
+}
+
+bool _platformCaptureWith(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                          int targetStride)
+{
+    return _platformCaptureConverted(capture, x, y, width, height, target, targetStride, 0, 4);
+}
+
+bool _platformCaptureConverted(PlatformCapture *capture, int x, int y, int width, int height, unsigned char *target,
+                               int targetStride, CaptureRowConverter convert, int targetChannels)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        return _captureSource(view, x - view.origin.x, y - view.origin.y, width, height, target, targetStride, convert,
+                              targetChannels);
+    }
+    return _screenCaptureConverted(capture, x, y, width, height, target, targetStride, convert, targetChannels);
+}
+
+bool _platformGetCaptureWindowArea(PlatformCapture *capture, WindowHandle handle, RECT *bounds, POINT *innerSize)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        if ( !view.open || handle != _SYNTHETIC_WINDOW )
+        {
+            return false;
+        }
+        *bounds = view.bounds; // from the same view, so the size always matches the frame
+        innerSize->x = view.width;
+        innerSize->y = view.height;
+        return true;
+    }
+    return _screenGetCaptureWindowArea(capture, handle, bounds, innerSize);
+}
+
+unsigned long _platformGetScreenPixel(int x, int y)
+{
+    _SourceView view;
+    if ( _viewSource(&view, 0))
+    {
+        x -= view.origin.x;
+        y -= view.origin.y;
+        if ( !view.frame || x < 0 || y < 0 || x >= view.width || y >= view.height )
+        {
+            return 0xFFFFFFFFul;
+        }
+        const unsigned char *bgra = view.frame->data() + ((size_t) y * view.width + x) * 4;
+        return (unsigned long) bgra[2] | ((unsigned long) bgra[1] << 8) | ((unsigned long) bgra[0] << 16);
+    }
+    return _screenGetScreenPixel(x, y);
+}
@@ -0,0 +1,59 @@
+#include "../exports.h"
+
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+/// Types of setFrameSource
+/// The live screen of the platform (default)
+# define FRAME_SOURCE_SCREEN 0
+/// Frames of a directory (raw .bgra files with width * height * 4 bytes, or binary .ppm files) and frames that are
+/// added with addSourceFrame
+# define FRAME_SOURCE_FILES 1
+/// Generated frames that only depend on the frame number (a gradient with a moving white square)
+# define FRAME_SOURCE_PROCEDURAL 2
+/// Frames of a recording of startRecording that are replayed with the recorded window bounds
+# define FRAME_SOURCE_REPLAY 3
+
+/// Replaces the live screen with a deterministic synthetic source (or switches back to the screen with
+/// FRAME_SOURCE_SCREEN, then the other parameters are ignored). A synthetic source is a single fake window with the
+/// [windowTitle] and an inner size of [width] x [height] that always has the focus and is placed at (0, 0) of a main
+/// display of the same size. All window, display and capture functions transparently use it instead of the screen,
+/// so initWindow, captures, pixel, watches and frame grabbers work without any display (for headless tests and
+/// benchmarks). Input functions still go to the real platform.
+/// For FRAME_SOURCE_FILES all frames of the directory at the [path] are loaded sorted by name. If [width] or [height]
+/// is 0, the size of the first frame is used. Frames of a different size are skipped.
+/// For FRAME_SOURCE_REPLAY the recording at the [path] is replayed at the speed of setReplaySpeed (the [width] and
+/// [height] are ignored). The window has the size and position of each recorded frame on a main display that contains
+/// all of them and it is closed after the last frame (so isWindowOpen gets false at the end of the replay).
+/// Returns false if the parameters are invalid, or if the directory or recording could not be read (then the source is
+/// unchanged). Must not be called at the same time as initWindow, or while captures are running on other threads.
+EXPORT bool setFrameSource(int type, const char *windowTitle, int width, int height, const char *path);
+
+/// Returns the FRAME_SOURCE_ type that is currently active
+EXPORT int getFrameSource();
+
+/// Adds a copy of one BGRA frame (rows of [width] * 4 bytes) to the FRAME_SOURCE_FILES source (for example decoded png
+/// files from dart). The first frame sets the size if none was set. Returns false if no file source is active or if
+/// the size is different
+EXPORT bool addSourceFrame(const unsigned char *bgra, int width, int height);
+
+/// Returns the amount of frames of the file or replay source (0 for the other sources)
+EXPORT int getSourceFrameCount();
+
+/// Shows the frame with the [frameNumber] in all following captures (file sources wrap around the frame count and
+/// the window of a replay source is closed for frame numbers after its last frame). Frames of the file and procedural
+/// sources only change with this, so the same frame number always produces the same captures. A replay source with a
+/// speed continues from this frame. Returns false if no synthetic source is active
+EXPORT bool setSourceFrame(long long frameNumber);
+
+/// Returns the frame number that is currently shown, which is the frame count after the end of a replay (so a replay
+/// at full speed can be stepped with setSourceFrame(getSourceFrame() + 1)). Returns -1 if the screen is used
+EXPORT long long getSourceFrame();
+
+/// Changes the speed of the replay source relative to the recorded timestamps (1 replays at wall clock speed, 2 twice
+/// as fast, etc) and continues from the current position. With a [speed] of 0 the frames are replayed as fast as the
+/// caller wants, because they only change with setSourceFrame. New replay sources start with a speed of 1.
+/// Returns false if no replay source is active, or if the speed is negative
+EXPORT bool setReplaySpeed(double speed);
+
+#endif //FRAME_SOURCE_H
@@ -0,0 +1,63 @@
+#include "task_queue.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/// The tasks mostly wait for the platform capture, so more threads would not make them faster
+#define _MAX_TASK_THREADS 4
+
+struct _TaskQueue
+{
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<std::function<void()>> tasks;
+};
+
+/// Never deleted (see header)
+_TaskQueue *_taskQueue = 0;
+std::once_flag _taskQueueOnce;
+
+void _taskThreadMain(_TaskQueue *queue)
+{
+    while ( true )
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            queue->wakeUp.wait(lock, [&]() { return !queue->tasks.empty(); });
+            task = std::move(queue->tasks.front());
+            queue->tasks.pop_front();
+        }
+        task();
+    }
+}
+
+_TaskQueue *_getTaskQueue()
+{
+    std::call_once(_taskQueueOnce, []() {
+        _TaskQueue *queue = new _TaskQueue();
+        unsigned int cores = std::thread::hardware_concurrency();
+        int threads = cores > 1 ? (int) cores : 1;
+        if ( threads > _MAX_TASK_THREADS )
+        {
+            threads = _MAX_TASK_THREADS;
+        }
+        for ( int i = 0; i < threads; ++i )
+        {
+            std::thread(_taskThreadMain, queue).detach();
+        }
+        _taskQueue = queue;
+    });
+    return _taskQueue;
+}
+
+void _runTask(std::function<void()> task)
+{
+    _TaskQueue *queue = _getTaskQueue();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(std::move(task));
+    }
+    queue->wakeUp.notify_one();
+}
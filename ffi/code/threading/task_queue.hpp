@@ -0,0 +1,15 @@
+#ifndef TASK_QUEUE_H
+#define TASK_QUEUE_H
+
+#include <functional>
+
+/// Internal: a few threads that run independent tasks in the background (for example asynchronous captures whose
+/// results are posted into dart ports). Different from the _parallelFor workers, the caller does not wait for these.
+/// The threads are created on first use and are never stopped (they only wait while the queue is empty), so the
+/// library can be unloaded without joining threads.
+
+/// Queues the [task] which will be called on one of the task threads in the order that they were queued (but multiple
+/// tasks can run at the same time on different threads)
+void _runTask(std::function<void()> task);
+
+#endif //TASK_QUEUE_H
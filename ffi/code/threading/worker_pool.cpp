@@ -0,0 +1,120 @@
+#include "worker_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// The workers are capped, because the tasks are mostly memory bound anyway
+#define _MAX_WORKERS 15
+
+/// Current loop of the workers. [generation] is incremented for every new loop so that sleeping workers know that
+/// they have something to do.
+struct _WorkerPool
+{
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable done;
+    /// Only held by the thread that currently runs a _parallelFor
+    std::mutex loopMutex;
+
+    const std::function<void(int)> *task = 0;
+    int count = 0;
+    long long generation = 0;
+    std::atomic<int> nextIndex{0};
+    /// Workers that are currently inside of the loop of [generation]. The loop is only finished if this is 0, because
+    /// otherwise a slow worker could take an index of the next loop for the old task
+    int activeWorkers = 0;
+    int workerCount = 0;
+};
+
+/// Never deleted (see header)
+_WorkerPool *_pool = 0;
+std::once_flag _poolOnce;
+
+/// Takes the next indices of the current loop until there are none left
+inline void _runIndices(_WorkerPool *pool, const std::function<void(int)> &task, int count)
+{
+    for ( int index = pool->nextIndex.fetch_add(1); index < count; index = pool->nextIndex.fetch_add(1))
+    {
+        task(index);
+    }
+}
+
+void _workerMain(_WorkerPool *pool)
+{
+    long long seenGeneration = 0;
+    while ( true )
+    {
+        const std::function<void(int)> *task;
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wakeUp.wait(lock, [&]() { return pool->generation != seenGeneration && pool->task != 0; });
+            seenGeneration = pool->generation;
+            task = pool->task;
+            count = pool->count;
+            ++pool->activeWorkers;
+        }
+        _runIndices(pool, *task, count);
+        {
+            std::lock_guard<std::mutex> lock(pool->mutex);
+            --pool->activeWorkers;
+        }
+        pool->done.notify_one();
+    }
+}
+
+_WorkerPool *_getPool()
+{
+    std::call_once(_poolOnce, []() {
+        _WorkerPool *pool = new _WorkerPool();
+        unsigned int cores = std::thread::hardware_concurrency();
+        pool->workerCount = cores > 1 ? (int) cores - 1 : 0;
+        if ( pool->workerCount > _MAX_WORKERS )
+        {
+            pool->workerCount = _MAX_WORKERS;
+        }
+        for ( int i = 0; i < pool->workerCount; ++i )
+        {
+            std::thread(_workerMain, pool).detach();
+        }
+        _pool = pool;
+    });
+    return _pool;
+}
+
+int _workerThreadCount()
+{
+    return _getPool()->workerCount + 1;
+}
+
+void _parallelFor(int count, const std::function<void(int index)> &task)
+{
+    _WorkerPool *pool = count > 1 ? _getPool() : 0;
+    std::unique_lock<std::mutex> loopLock;
+    if ( pool != 0 && pool->workerCount > 0 )
+    {
+        loopLock = std::unique_lock<std::mutex>(pool->loopMutex, std::try_to_lock);
+    }
+    if ( !loopLock.owns_lock())
+    {
+        for ( int index = 0; index < count; ++index )
+        {
+            task(index);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->task = &task;
+        pool->count = count;
+        pool->nextIndex.store(0);
+        ++pool->generation;
+    }
+    pool->wakeUp.notify_all();
+    _runIndices(pool, task, count);
+    std::unique_lock<std::mutex> lock(pool->mutex);
+    // all indices are taken at this point, so only the workers that are still inside of a task are waited for
+    pool->done.wait(lock, [&]() { return pool->activeWorkers == 0; });
+    pool->task = 0;
+}
@@ -0,0 +1,19 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+
+/// Internal: one worker thread per additional cpu core that is shared by all functions that split their work.
+/// The threads are created on first use and are never stopped (they only wait while there is nothing to do), so the
+/// library can be unloaded without joining threads.
+
+/// Amount of threads that work on a _parallelFor (the workers and the calling thread)
+int _workerThreadCount();
+
+/// Calls [task] for every index from 0 to [count] - 1 on the worker threads and the calling thread and returns after
+/// all of them are done. The order is not defined and every index is only called once.
+/// Only one parallel loop runs at a time, so if the workers are already busy (or this is nested inside of a task),
+/// all indices are just called on the calling thread.
+void _parallelFor(int count, const std::function<void(int index)> &task);
+
+#endif //WORKER_POOL_H
@@ -0,0 +1,128 @@
+#include "dart_port.hpp"
+#include <string.h>
+#include <atomic>
+
+/// Same layout as the DartApi / DartApiEntry structs in dart_api_dl.c of the dart sdk
+struct _DartApiEntry
+{
+    const char *name;
+    void (*function)();
+};
+
+struct _DartApi
+{
+    int major;
+    int minor;
+    const _DartApiEntry *functions;
+};
+
+/// DART_API_DL_MAJOR_VERSION of the dart sdk that this layout is compatible with
+#define _DART_API_DL_MAJOR_VERSION 2
+
+/// Dart_CObject_kBool of the Dart_CObject_Type enum in dart_native_api.h
+#define _DART_COBJECT_BOOL 1
+
+/// Dart_CObject_kInt64 of the Dart_CObject_Type enum in dart_native_api.h
+#define _DART_COBJECT_INT64 3
+
+/// Dart_CObject_kArray of the Dart_CObject_Type enum in dart_native_api.h
+#define _DART_COBJECT_ARRAY 6
+
+/// Longest array of _postInt64ArrayToDart (the elements are created on the stack)
+#define _MAX_DART_ARRAY 16
+
+/// Same layout as Dart_CObject in dart_native_api.h. Only the bool, int64 and array values are used here, but the union has the size
+/// of the biggest member (external typed data)
+struct _DartCObject
+{
+    int type;
+    union
+    {
+        bool asBool;
+        int64_t asInt64;
+        struct
+        {
+            intptr_t length;
+            _DartCObject **values;
+        } asArray;
+        void *padding[5];
+    } value;
+};
+
+typedef bool (*_DartPostCObject)(DartPort port, _DartCObject *message);
+
+std::atomic<_DartPostCObject> _postCObject{0};
+
+EXPORT bool initDartApi(void *initializeApiDLData)
+{
+    if ( _postCObject.load() != 0 )
+    {
+        return true;
+    }
+    const _DartApi *api = (const _DartApi *) initializeApiDLData;
+    if ( api == 0 || api->major != _DART_API_DL_MAJOR_VERSION )
+    {
+        return false;
+    }
+    for ( const _DartApiEntry *entry = api->functions; entry->name != 0; ++entry )
+    {
+        if ( strcmp(entry->name, "Dart_PostCObject") == 0 )
+        {
+            _postCObject.store((_DartPostCObject) entry->function);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool _postBoolToDart(DartPort port, bool value)
+{
+    _DartPostCObject post = _postCObject.load();
+    if ( post == 0 )
+    {
+        return false;
+    }
+    _DartCObject message;
+    memset(&message, 0, sizeof(message));
+    message.type = _DART_COBJECT_BOOL;
+    message.value.asBool = value;
+    return post(port, &message);
+}
+
+bool _postInt64ToDart(DartPort port, int64_t value)
+{
+    _DartPostCObject post = _postCObject.load();
+    if ( post == 0 )
+    {
+        return false;
+    }
+    _DartCObject message;
+    memset(&message, 0, sizeof(message));
+    message.type = _DART_COBJECT_INT64;
+    message.value.asInt64 = value;
+    return post(port, &message);
+}
+
+bool _postInt64ArrayToDart(DartPort port, const int64_t *values, int count)
+{
+    _DartPostCObject post = _postCObject.load();
+    if ( post == 0 || count < 0 || count > _MAX_DART_ARRAY )
+    {
+        return false;
+    }
+    _DartCObject elements[_MAX_DART_ARRAY];
+    _DartCObject *elementPointers[_MAX_DART_ARRAY];
+    for ( int i = 0; i < count; ++i )
+    {
+        memset(&elements[i], 0, sizeof(_DartCObject));
+        elements[i].type = _DART_COBJECT_INT64;
+        elements[i].value.asInt64 = values[i];
+        elementPointers[i] = &elements[i];
+    }
+    _DartCObject message;
+    memset(&message, 0, sizeof(message));
+    message.type = _DART_COBJECT_ARRAY;
+    message.value.asArray.length = count;
+    message.value.asArray.values = elementPointers;
+    return post(port, &message); // the message is copied, so the stack memory can be used
+}
@@ -0,0 +1,26 @@
+#include "../exports.h"
+#include <stdint.h>
+
+#ifndef DART_PORT_H
+#define DART_PORT_H
+
+/// Native port of a dart ReceivePort (ReceivePort.sendPort.nativePort in dart)
+typedef int64_t DartPort;
+
+/// Has to be called with NativeApi.initializeApiDLData from dart before anything can be posted into dart ports.
+/// Only the dynamically linked part of the dart api that is needed here is looked up from it (the same as
+/// Dart_InitializeApiDL of the dart sdk does), so no dart sdk headers or libraries are needed to build this.
+/// Returns false if the api version is not supported. Multiple calls have no effect.
+EXPORT bool initDartApi(void *initializeApiDLData);
+
+/// Internal: posts the [value] into the dart [port] (can be called from any thread). Returns false if initDartApi was
+/// not called yet, or the port was already closed.
+bool _postBoolToDart(DartPort port, bool value);
+
+/// Internal: same as _postBoolToDart for an int [value] (received as int in dart)
+bool _postInt64ToDart(DartPort port, int64_t value);
+
+/// Internal: posts the [count] [values] into the dart [port] as one message (received as List<dynamic> of int in dart)
+bool _postInt64ArrayToDart(DartPort port, const int64_t *values, int count);
+
+#endif //DART_PORT_H
@@ -0,0 +1,413 @@
+#include "pixel_watcher.hpp"
+#include "../capture/capture_session.hpp"
+#include "../capture/frame_grabber.hpp"
+#include "../image/image_compare.hpp"
+#include "../native_window/native_window.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// State of a watch before it was checked the first time
+#define _UNKNOWN_STATE -1
+
+/// The watcher thread wakes up at least this often, even if no watch is due
+#define _MAX_WATCHER_SLEEP std::chrono::milliseconds(1000)
+
+struct _Watch
+{
+    int id = 0;
+    int windowID = 0;
+    DartPort port = 0;
+    std::chrono::milliseconds interval{0};
+    std::chrono::steady_clock::time_point nextCheck;
+    /// Last state that was posted to the port (or _UNKNOWN_STATE)
+    int state = _UNKNOWN_STATE;
+
+    /// Pixel watch: points relative to the inner window with their expected colors
+    std::vector<POINT> points;
+    std::vector<unsigned long> colors;
+    int tolerance = 0;
+
+    /// Region watch if the area is not empty (the reference is taken from the first capture if it is empty)
+    RECT area{0, 0, 0, 0};
+    std::vector<unsigned char> reference;
+    int referenceChannels = 4;
+    int threshold = 0;
+    int maxBad = 0;
+};
+
+/// One thread checks all watches, so that only one set of capture resources is needed. The [mutex] is held while
+/// the watches are checked (also by the capture threads in _watchFrame), so that removeWatch can guarantee that
+/// nothing is posted for a removed watch anymore
+struct _Watcher
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+    /// If a thread of the current [generation] is running. Every started thread gets a new generation and stops as
+    /// soon as it is not the current one anymore, so a thread that is stopping never continues because a new one was
+    /// started before it woke up
+    bool running = false;
+    int generation = 0;
+    std::vector<_Watch *> watches;
+    int nextID = 1;
+};
+
+_Watcher _watcher;
+
+/// Amount of watches, so that the capture threads don't lock the mutex if nothing is watched
+std::atomic<int> _activeWatches{0};
+
+/// Time (steady clock microseconds) of the newest frame of the capture thread of every window. Watches of a window
+/// that got a frame within their interval are only checked against the frames in _watchFrame
+std::atomic<long long> _watchedFrameTimes[_MAX_WINDOWS]{};
+
+inline long long _steadyMicroseconds(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+/// Buffers of the watcher thread that are reused for every check
+struct _WatcherBuffers
+{
+    _CaptureSession *session = 0;
+    std::vector<POINT> screenPoints;
+    std::vector<unsigned long> colors;
+    std::vector<unsigned char> area;
+};
+
+/// Same as ColorExtension.equals in dart for two colors in the format 0x00bbggrr
+inline bool _colorMatches(unsigned long first, unsigned long second, int tolerance)
+{
+    int change = 0;
+    for ( int shift = 0; shift < 24; shift += 8 )
+    {
+        change += abs((int) ((first >> shift) & 0xFF) - (int) ((second >> shift) & 0xFF));
+    }
+    return change <= tolerance;
+}
+
+/// Returns 1 if all [colors] (at the indices of the points) match the ones of the [watch], 0 if not
+inline int _matchPixels(const _Watch *watch, const unsigned long *colors)
+{
+    for ( size_t i = 0; i < watch->points.size(); ++i )
+    {
+        if ( colors[i] == _INVALID_PIXEL || !_colorMatches(colors[i], watch->colors[i], watch->tolerance))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// Returns 1 if the [area] (with [stride] bytes per row and 4 channels) matches the reference of the [watch], 0 if
+/// not. Without a reference the area becomes the reference
+inline int _matchRegion(_Watch *watch, const unsigned char *area, int stride)
+{
+    int width = watch->area.right - watch->area.left;
+    int height = watch->area.bottom - watch->area.top;
+    if ( watch->reference.empty())
+    {
+        watch->reference.resize((size_t) width * height * 4);
+        for ( int row = 0; row < height; ++row )
+        {
+            memcpy(watch->reference.data() + (size_t) row * width * 4, area + (size_t) row * stride,
+                   (size_t) width * 4);
+        }
+        watch->referenceChannels = 4;
+        return 1;
+    }
+    int bad = compareTolerance(area, stride, 4, watch->reference.data(), width * watch->referenceChannels,
+                               watch->referenceChannels, width, height, watch->threshold, watch->maxBad, true);
+    return bad >= 0 && bad <= watch->maxBad ? 1 : 0;
+}
+
+/// Posts the [state] of the [watch] to dart if it changed
+inline void _updateState(_Watch *watch, int state)
+{
+    if ( state != _UNKNOWN_STATE && state != watch->state )
+    {
+        watch->state = state;
+        _postBoolToDart(watch->port, state == 1);
+    }
+}
+
+/// Returns 1 if all pixels of the [watch] match, 0 if not
+inline int _checkPixels(const _Watch *watch, const POINT &innerPos, const POINT &innerSize, _WatcherBuffers &buffers)
+{
+    size_t count = watch->points.size();
+    buffers.screenPoints.resize(count);
+    buffers.colors.resize(count);
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const POINT &point = watch->points[i];
+        if ( point.x < 0 || point.y < 0 || point.x >= innerSize.x || point.y >= innerSize.y )
+        {
+            return 0; // outside of the window like in GameWindow.getPixelsOfWindow
+        }
+        buffers.screenPoints[i] = POINT{watch->points[i].x + innerPos.x, watch->points[i].y + innerPos.y};
+    }
+    _capturePixelsWith(buffers.session, buffers.screenPoints.data(), (int) count, buffers.colors.data());
+    return _matchPixels(watch, buffers.colors.data());
+}
+
+/// Returns 1 if the area of the [watch] matches its reference, 0 if not and _UNKNOWN_STATE if it could not be checked
+inline int _checkRegion(_Watch *watch, const POINT &innerPos, const POINT &innerSize, _WatcherBuffers &buffers)
+{
+    const RECT &area = watch->area;
+    if ( area.right > innerSize.x || area.bottom > innerSize.y )
+    {
+        return _UNKNOWN_STATE; // the window is currently too small (may be resized)
+    }
+    int width = area.right - area.left;
+    int height = area.bottom - area.top;
+    buffers.area.resize((size_t) width * height * 4);
+    if ( !_platformCaptureWith(buffers.session->capture, innerPos.x + area.left, innerPos.y + area.top, width, height,
+                               buffers.area.data(), width * 4))
+    {
+        return _UNKNOWN_STATE;
+    }
+    return _matchRegion(watch, buffers.area.data(), width * 4);
+}
+
+/// Captures the window of the [watch] on the watcher thread, checks it and posts its state to dart if it changed
+inline void _checkWatch(_Watch *watch, _WatcherBuffers &buffers)
+{
+    WindowHandle handle = _getPublishedWindowHandle(watch->windowID);
+    RECT bounds;
+    POINT innerSize;
+    if ( handle == 0 || !_platformGetCaptureWindowArea(buffers.session->capture, handle, &bounds, &innerSize) ||
+         innerSize.x <= 0 || innerSize.y <= 0 )
+    {
+        return; // closed or minimized
+    }
+    POINT innerPos = _innerWindowPos(bounds, innerSize);
+    int state = watch->points.empty() ? _checkRegion(watch, innerPos, innerSize, buffers)
+                                      : _checkPixels(watch, innerPos, innerSize, buffers);
+    _updateState(watch, state);
+}
+
+/// Checks the [watch] against the BGRA [frame] of the inner window of the capture thread (must hold the mutex)
+inline void _checkWatchOnFrame(_Watch *watch, const unsigned char *frame, int width, int height)
+{
+    int stride = width * 4;
+    if ( !watch->points.empty())
+    {
+        int state = 1;
+        for ( const POINT &point : watch->points )
+        {
+            if ( point.x < 0 || point.y < 0 || point.x >= width || point.y >= height )
+            {
+                state = 0; // outside of the window like in GameWindow.getPixelsOfWindow
+                break;
+            }
+        }
+        for ( size_t i = 0; state == 1 && i < watch->points.size(); ++i )
+        {
+            const unsigned char *bgra = frame + (size_t) watch->points[i].y * stride + (size_t) watch->points[i].x * 4;
+            unsigned long color = (unsigned long) bgra[2] | ((unsigned long) bgra[1] << 8) |
+                                  ((unsigned long) bgra[0] << 16);
+            state = _colorMatches(color, watch->colors[i], watch->tolerance) ? 1 : 0;
+        }
+        _updateState(watch, state);
+        return;
+    }
+    const RECT &area = watch->area;
+    if ( area.right > width || area.bottom > height )
+    {
+        return; // the window is currently too small (may be resized)
+    }
+    _updateState(watch, _matchRegion(watch, frame + (size_t) area.top * stride + (size_t) area.left * 4, stride));
+}
+
+void _watchFrame(int windowID, const unsigned char *data, int width, int height)
+{
+    if ( windowID < 0 || windowID >= _MAX_WINDOWS )
+    {
+        return;
+    }
+    // also stored without watches, so that a new watch is checked against the frames right away
+    auto now = std::chrono::steady_clock::now();
+    _watchedFrameTimes[windowID].store(_steadyMicroseconds(now), std::memory_order_release);
+    if ( _activeWatches.load(std::memory_order_acquire) == 0 )
+    {
+        return;
+    }
+    // the capture thread never waits for the watcher thread: if it is checking, the watches wait for the next frame
+    std::unique_lock<std::mutex> lock(_watcher.mutex, std::try_to_lock);
+    if ( !lock.owns_lock())
+    {
+        return;
+    }
+    for ( _Watch *watch : _watcher.watches )
+    {
+        if ( watch->windowID == windowID && watch->nextCheck <= now )
+        {
+            _checkWatchOnFrame(watch, data, width, height);
+            watch->nextCheck = now + watch->interval;
+        }
+    }
+}
+
+void _runWatcher(int generation)
+{
+    _WatcherBuffers buffers;
+    buffers.session = _createCaptureSession();
+    std::unique_lock<std::mutex> lock(_watcher.mutex);
+    while ( _watcher.generation == generation )
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto wakeUp = now + _MAX_WATCHER_SLEEP;
+        for ( _Watch *watch : _watcher.watches )
+        {
+            auto frameTime = std::chrono::steady_clock::time_point(std::chrono::microseconds(
+                    _watchedFrameTimes[watch->windowID].load(std::memory_order_acquire)));
+            if ( watch->nextCheck <= now && frameTime + watch->interval > now )
+            {
+                // the capture thread of the window checks it with its next frame, this only checks it again if
+                // the frames stop
+                wakeUp = std::min(wakeUp, frameTime + watch->interval);
+                continue;
+            }
+            if ( watch->nextCheck <= now )
+            {
+                _checkWatch(watch, buffers);
+                // no catch up after slow checks, the next check is always a full interval later
+                watch->nextCheck = std::chrono::steady_clock::now() + watch->interval;
+            }
+            wakeUp = std::min(wakeUp, watch->nextCheck);
+        }
+        _watcher.condition.wait_until(lock, wakeUp);
+    }
+    lock.unlock();
+    _destroyCaptureSession(buffers.session);
+}
+
+/// Adds the [watch] and starts the watcher thread if it is not running. Returns the id of the watch
+int _addWatch(_Watch *watch)
+{
+    _getWindowHandle(watch->windowID); // looks up the window and updates the handle for the watcher thread
+    std::lock_guard<std::mutex> lock(_watcher.mutex);
+    watch->id = _watcher.nextID++;
+    watch->nextCheck = std::chrono::steady_clock::now();
+    _watcher.watches.push_back(watch);
+    _activeWatches.fetch_add(1, std::memory_order_release);
+    if ( !_watcher.running )
+    {
+        _watcher.running = true;
+        _watcher.thread = std::thread(_runWatcher, ++_watcher.generation);
+    } else
+    {
+        _watcher.condition.notify_all();
+    }
+    return watch->id;
+}
+
+/// Validates the arguments that are the same for every watch
+inline bool _isValidWatch(int windowID, int intervalMs, DartPort port)
+{
+    return windowID >= 0 && windowID < _MAX_WINDOWS && intervalMs > 0 && port != 0;
+}
+
+EXPORT int addPixelWatch(int windowID, const POINT *points, const unsigned long *colors, int count, int tolerance,
+                         int intervalMs, DartPort port)
+{
+    if ( !_isValidWatch(windowID, intervalMs, port) || points == 0 || colors == 0 || count <= 0 || tolerance < 0 )
+    {
+        return -1;
+    }
+    _Watch *watch = new _Watch();
+    watch->windowID = windowID;
+    watch->port = port;
+    watch->interval = std::chrono::milliseconds(intervalMs);
+    watch->points.assign(points, points + count);
+    watch->colors.assign(colors, colors + count);
+    watch->tolerance = tolerance;
+    return _addWatch(watch);
+}
+
+EXPORT int addRegionWatch(int windowID, const RECT *area, const unsigned char *reference, int referenceChannels,
+                          int threshold, int maxBad, int intervalMs, DartPort port)
+{
+    if ( !_isValidWatch(windowID, intervalMs, port) || area == 0 || area->left < 0 || area->top < 0 ||
+         area->left >= area->right || area->top >= area->bottom || threshold < 0 || maxBad < 0 ||
+         (reference != 0 && referenceChannels != 3 && referenceChannels != 4))
+    {
+        return -1;
+    }
+    _Watch *watch = new _Watch();
+    watch->windowID = windowID;
+    watch->port = port;
+    watch->interval = std::chrono::milliseconds(intervalMs);
+    watch->area = *area;
+    watch->threshold = threshold;
+    watch->maxBad = maxBad;
+    if ( reference != 0 )
+    {
+        size_t bytes = (size_t) (area->right - area->left) * (area->bottom - area->top) * referenceChannels;
+        watch->reference.assign(reference, reference + bytes);
+        watch->referenceChannels = referenceChannels;
+    }
+    return _addWatch(watch);
+}
+
+/// Must be called with the locked mutex: signals the watcher thread to stop if there are no watches left and moves
+/// it into [stopped], so that it can be joined after the mutex was unlocked
+inline void _stopUnusedWatcher(std::thread &stopped)
+{
+    if ( _watcher.watches.empty() && _watcher.running )
+    {
+        _watcher.running = false;
+        ++_watcher.generation;
+        _watcher.condition.notify_all(); // a thread of an older generation may also still wait
+        stopped.swap(_watcher.thread);
+    }
+}
+
+EXPORT bool removeWatch(int watchID)
+{
+    std::thread stopped;
+    {
+        std::lock_guard<std::mutex> lock(_watcher.mutex);
+        auto found = std::find_if(_watcher.watches.begin(), _watcher.watches.end(),
+                                  [watchID](const _Watch *watch) { return watch->id == watchID; });
+        if ( found == _watcher.watches.end())
+        {
+            return false;
+        }
+        delete *found;
+        _watcher.watches.erase(found);
+        _activeWatches.fetch_sub(1, std::memory_order_release);
+        _stopUnusedWatcher(stopped);
+    }
+    if ( stopped.joinable())
+    {
+        stopped.join();
+    }
+    return true;
+}
+
+EXPORT void removeAllWatches()
+{
+    std::thread stopped;
+    {
+        std::lock_guard<std::mutex> lock(_watcher.mutex);
+        for ( _Watch *watch : _watcher.watches )
+        {
+            delete watch;
+        }
+        _activeWatches.fetch_sub((int) _watcher.watches.size(), std::memory_order_release);
+        _watcher.watches.clear();
+        _stopUnusedWatcher(stopped);
+    }
+    if ( stopped.joinable())
+    {
+        stopped.join();
+    }
+}
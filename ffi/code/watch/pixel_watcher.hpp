@@ -0,0 +1,42 @@
+#include "../platform/platform.hpp"
+#include "../exports.h"
+#include "dart_port.hpp"
+
+#ifndef PIXEL_WATCHER_H
+#define PIXEL_WATCHER_H
+
+/// Watches pixels of the window (0 to 99) on a native background thread every [intervalMs] milliseconds without any
+/// calls from dart. The [points] are relative to the top left corner of the inner window (same as the overlay area in
+/// dart) and the watch matches if all of them have the expected [colors] (format 0x00bbggrr at the same index) with
+/// the same semantics as ColorExtension.equals in dart (the sum of the absolute differences of red, green and blue is
+/// not higher than [tolerance]).
+/// The dart [port] receives true / false once the first time the pixels were checked and afterwards only when that
+/// state flips. Nothing is checked while the window is closed, or minimized. While a capture thread of the window
+/// (startCaptureThread) delivers frames at least as often as [intervalMs], the watch is checked against its newest
+/// frame instead of capturing the window a second time.
+/// initDartApi and initWindow must be called first (the window does not have to be open yet). The points and colors
+/// are copied. Returns the id of the watch for removeWatch, or -1 for invalid arguments.
+EXPORT int addPixelWatch(int windowID, const POINT *points, const unsigned long *colors, int count, int tolerance,
+                         int intervalMs, DartPort port);
+
+/// Same as addPixelWatch, but the watch matches if the [area] of the inner window (right and bottom are exclusive)
+/// is equal to the [reference] image (tightly packed with [referenceChannels] 3 for BGR or 4 for BGRA) with the same
+/// semantics as compareTolerance with [threshold] and [maxBad] (alpha is ignored).
+/// If [reference] is 0, then the first capture of the area is used as the reference (so the port first receives
+/// true and then false once the area changed). The reference is copied.
+EXPORT int addRegionWatch(int windowID, const RECT *area, const unsigned char *reference, int referenceChannels,
+                          int threshold, int maxBad, int intervalMs, DartPort port);
+
+/// Stops the watch (the dart port receives nothing anymore after this returns). Returns false if it did not exist
+EXPORT bool removeWatch(int watchID);
+
+/// Stops all watches and joins the watcher thread
+EXPORT void removeAllWatches();
+
+/// Internal: called from the capture thread of the window for every captured frame with its BGRA [data] of the inner
+/// window. The due watches of the window are checked against it instead of capturing the window again on the
+/// watcher thread (which only captures watched windows without recent frames). Returns immediately if nothing is
+/// watched and never waits for the watcher thread.
+void _watchFrame(int windowID, const unsigned char *data, int width, int height);
+
+#endif //PIXEL_WATCHER_H
@@ -3,7 +3,9 @@ import 'dart:ui' show Locale;
 
 import 'package:game_tools_lib/core/config/mutable_config.dart';
 import 'package:game_tools_lib/core/enums/log_level.dart';
+import 'package:game_tools_lib/core/enums/native_frame_source.dart';
 import 'package:game_tools_lib/core/utils/locale_extension.dart';
+import 'package:game_tools_lib/domain/game/game_window.dart';
 import 'package:game_tools_lib/game_tools_lib.dart';
 import 'package:game_tools_lib/presentation/overlay/ui_elements/overlay_element.dart';
 
@@ -74,6 +76,17 @@ base class FixedConfig {
   /// UI (other logs can be accessed dynamically as well in the ui tho)
   LogLevel get defaultUiLogLevel => LogLevel.DEBUG;
 
+  /// If this is not null, then the recording of [GameWindow.startRecording] at this path is replayed as the
+  /// [GameToolsLib.mainGameWindow] instead of using the screen (see [NativeFrameSource.REPLAY]). All captures, pixels,
+  /// window bounds and the open state of it are then answered from the recording and the window closes after the last
+  /// frame. This is used to run and benchmark the [GameManager] and its [Module]s without the game running.
+  String? get replayRecording => null;
+
+  /// Speed of the [replayRecording] relative to the recorded time (1 is the wall clock speed). With 0 exactly one
+  /// recorded frame is shown for each [GameManager.onUpdate] and the update loop runs as fast as possible, which
+  /// measures how many frames per second the modules can analyse (see [GameToolsLib.replayFramesPerSecond]).
+  double get replaySpeed => 1.0;
+
   /// The path to the root dir github project of the pubspec.yaml file of the project that contains the "version" which
   /// is used for the version update checker. Important: the first part of the list is just the base github repository
   /// url and the second path might be a sub folder of the root project where the pubspec.yaml (with the version) and
@@ -20,11 +20,11 @@ enum MouseEvent implements Comparable<MouseEvent> {
 
   /// Returns the platform specific virtual keycode from this
   int convertToPlatformCode() {
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       // todo: might have to change for different platforms
       throw UnimplementedError("This platform is currently not supported yet");
     } else {
-      return value; // windows: default values
+      return value; // windows: default values (the linux native code maps them internally)
     }
   }
 
@@ -47,11 +47,11 @@ enum MouseKey implements Comparable<MouseKey> {
 
   /// Returns the platform specific virtual keycode from this
   int convertToPlatformCode() {
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       // todo: might have to change for different platforms
       throw UnimplementedError("This platform is currently not supported yet");
     } else {
-      return value; // windows: default values
+      return value; // windows: default values (the linux native code maps them internally)
     }
   }
 
@@ -72,7 +72,7 @@ extension LogicalKeyboardKeyExtension on LogicalKeyboardKey {
   /// specific keycode was found!
   int convertToPlatformCode() {
     int? key;
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       // todo: might have to change for different platforms
       throw UnimplementedError("This platform is currently not supported yet");
     } else {
@@ -112,7 +112,7 @@ extension LogicalKeyboardKeyExtension on LogicalKeyboardKey {
   /// specific keycode was found! (for example special language/region specific characters like ÖÄÜ)
   static LogicalKeyboardKey fromPlatformCode(int keyCode) {
     LogicalKeyboardKey? key;
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       // todo: might have to change for different platforms
       throw UnimplementedError("This platform is currently not supported yet");
     } else {
@@ -128,7 +128,7 @@ extension LogicalKeyboardKeyExtension on LogicalKeyboardKey {
   /// logical key was found! (for example special language/region specific characters like ÖÄÜ)
   static LogicalKeyboardKey fromString(String writtenCharacter) {
     LogicalKeyboardKey? key;
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       // todo: might have to change for different platforms
       throw UnimplementedError("This platform is currently not supported yet");
     } else {
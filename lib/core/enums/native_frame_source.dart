@@ -0,0 +1,30 @@
+import 'package:game_tools_lib/data/native/native_window.dart';
+import 'package:game_tools_lib/domain/game/game_window.dart';
+
+/// Contains the sources of all window, display and capture functions of the native code that can be set with
+/// [NativeWindow.setFrameSource]. The synthetic sources replace the screen with a single window that always has the
+/// focus, so tests and benchmarks can run without any display and always get the same images for the same frame
+/// number. Input functions always go to the real platform!
+/// The values have the same order as the FRAME_SOURCE_ defines of the native code.
+enum NativeFrameSource {
+  /// The live screen with all open windows (default)
+  SCREEN,
+
+  /// Frames from the png, ppm and raw .bgra files of a directory (a raw file contains only the BGRA pixel of one
+  /// frame of the window size)
+  FILES,
+
+  /// Generated frames that only depend on the frame number (a moving gradient with a moving white square)
+  PROCEDURAL,
+
+  /// Frames of a recording of [GameWindow.startRecording] with the recorded window bounds, replayed at the speed of
+  /// [NativeWindow.setReplaySpeed] (the window is closed after the last frame)
+  REPLAY;
+
+  @override
+  String toString() => name;
+
+  factory NativeFrameSource.fromString(String data) {
+    return values.firstWhere((NativeFrameSource element) => element.name == data);
+  }
+}
@@ -23,8 +23,8 @@ enum NativeImageType {
   RGB,
 
   /// Default with 4 Channels, stores the most information. Remember internally the pixel are stored as BGRA instead!
-  /// This has the best performance of getting native images (from screen/window), because no internal copies will be
-  /// made in the related [NativeImage.nativeAsync] constructor (loaded native images always have an alpha channel)!
+  /// Native images (from screen/window) are captured in this format. The other types are converted by the native code
+  /// while capturing, so they need no extra copy in the related [NativeImage.nativeAsync] constructor!
   RGBA,
 
   /// Only used so that the different types have the same value as the channels they represent!
@@ -11,14 +11,36 @@ mixin _GameToolsLibEventLoop on _GameToolsLibHelper {
   static Future<void>? _eventUpdates;
   static final SpamIdentifier _eventLog = SpamIdentifier();
 
+  /// Receives the native window events while the loop is running (null if the platform has none, then the window
+  /// states are polled in every tick)
+  static ReceivePort? _windowEventPort;
+
+  /// Set by the window events and cleared when [_processWindowUpdates] starts the next update
+  static bool _pendingWindowUpdate = false;
+  static bool _pendingSizeUpdate = false;
+
+  /// The running [_processWindowUpdates] (not awaited)
+  static Future<void>? _windowUpdate;
+
   // ignore: unused_field
   static final SpamIdentifier _loopLog = SpamIdentifier();
 
+  /// True if the frames of the [FixedConfig.replayRecording] are stepped with the manager updates (replay speed 0)
+  static bool _steppedReplay = false;
+
+  /// Amount of stepped replay frames that were analysed completely and the time since the first one was shown
+  static int _replayedFrames = 0;
+  static Stopwatch? _replayWatch;
+
   /// is awaited in [GameToolsLib.runLoop]
   static Future<void> _startLoop(int updatesPerSecond) async {
     if (_loopRunning == false) {
       _loopRunning = true;
+      _steppedReplay = FixedConfig.fixedConfig.replayRecording != null && FixedConfig.fixedConfig.replaySpeed == 0;
+      _replayedFrames = 0;
+      _replayWatch = null;
       Logger.spam("Started GameToolsLib event loop");
+      _startWindowEvents();
       _loopResult = _loopInternal(updatesPerSecond);
       await _loopResult;
     } else {
@@ -33,6 +55,7 @@ mixin _GameToolsLibEventLoop on _GameToolsLibHelper {
       _loopRunning = false;
       Logger.spam("Stopping GameToolsLib event loop...");
       await _loopResult;
+      await _stopWindowEvents();
       await _GameToolsLibEventLoop._runForAllEventsAsync((GameEvent event) async {
         await event.onStop();
       });
@@ -44,7 +67,7 @@ mixin _GameToolsLibEventLoop on _GameToolsLibHelper {
   }
 
   static Future<bool> _loopInternal(int updatesPerSecond) async {
-    final int timePerLoopInMs = (1000.0 / updatesPerSecond).round();
+    final int timePerLoopInMs = _steppedReplay ? 0 : (1000.0 / updatesPerSecond).round(); // replay as fast as possible
     int loopStartTime = DateTime.now().millisecondsSinceEpoch;
     while (_loopRunning) {
       try {
@@ -163,9 +186,62 @@ mixin _GameToolsLibEventLoop on _GameToolsLibHelper {
   /// late cached counter used below for resize
   static int _currentResizeTick = _maxResizeTicks;
 
-  static Future<void> _loopStep() async {
-    for (final GameWindow window in GameToolsLib.gameWindows) {
-      final int openStatus = window.updateOpen();
+  /// Window events are posted from native code, so the window states only have to be queried after one of them
+  static void _startWindowEvents() {
+    final ReceivePort port = ReceivePort();
+    final int nativePort = port.sendPort.nativePort;
+    if (NativeWindow.hasInstance == false || NativeWindow.instance.startWindowEvents(nativePort) == false) {
+      port.close();
+      Logger.verbose("No native window events, so the window states are polled");
+      return;
+    }
+    port.listen((dynamic message) {
+      if (message is int) {
+        _requestWindowUpdate(checkSize: message == NativeWindow.windowEventBounds);
+      }
+    });
+    _windowEventPort = port;
+    _requestWindowUpdate(checkSize: true); // initial states
+  }
+
+  static Future<void> _stopWindowEvents() async {
+    if (_windowEventPort != null) {
+      NativeWindow.instance.stopWindowEvents();
+      _windowEventPort!.close();
+      _windowEventPort = null;
+    }
+    await _windowUpdate;
+  }
+
+  /// Multiple events that arrive while the windows are updated are combined into one more update afterwards
+  static void _requestWindowUpdate({required bool checkSize}) {
+    _pendingWindowUpdate = true;
+    _pendingSizeUpdate = _pendingSizeUpdate || checkSize;
+    _windowUpdate ??= _processWindowUpdates().whenComplete(() => _windowUpdate = null); // not awaited
+  }
+
+  /// This is not awaited
+  static Future<void> _processWindowUpdates() async {
+    while (_pendingWindowUpdate && _loopRunning) {
+      final bool checkSize = _pendingSizeUpdate;
+      _pendingWindowUpdate = false;
+      _pendingSizeUpdate = false;
+      try {
+        await _updateWindows(checkSize: checkSize);
+      } catch (e, s) {
+        Logger.error("GameToolsLib.Windows", e, s);
+      }
+    }
+  }
+
+  /// Queries the states of all windows and calls the listeners for the changed ones. The size is only compared if
+  /// [checkSize] is true
+  static Future<void> _updateWindows({required bool checkSize}) async {
+    final List<GameWindow> windows = GameToolsLib.gameWindows;
+    final List<NativeWindowState> states = GameWindow.queryStates(windows); // one native call for all windows
+    for (int i = 0; i < windows.length; ++i) {
+      final GameWindow window = windows[i];
+      final int openStatus = window.updateOpenFrom(states[i]);
       if (openStatus > 0) {
         Logger.verbose("${window.name} ${window.isOpen ? "opened" : "closed"}");
         await _updateOpen(window);
@@ -176,26 +252,70 @@ mixin _GameToolsLibEventLoop on _GameToolsLibHelper {
         Logger.verbose("${window.name} lost focus because it closed");
         await _updateFocus(window);
       } else {
-        if (window.updateFocus()) {
+        if (window.updateFocusFrom(states[i])) {
           Logger.verbose("${window.hasFocus ? "Focused" : "Unfocused"} ${window.name}");
           await _updateFocus(window);
         }
       }
 
-      if (_currentResizeTick++ >= _maxResizeTicks) {
-        _currentResizeTick = 0;
-        if (window.updateSize()) {
-          Logger.verbose("${window.name} resized to ${window.size}");
-          await OverlayManager._instance!.onWindowResize(window); // resize only needs to affect overlay manager and
-          // may be slower
-        }
+      if (checkSize && window.updateSizeFrom(states[i])) {
+        Logger.verbose("${window.name} resized to ${window.size}");
+        await OverlayManager._instance!.onWindowResize(window); // resize only needs to affect overlay manager and
+        // may be slower
+      }
+    }
+  }
+
+  static Future<void> _loopStep() async {
+    final bool checkSize = _currentResizeTick++ >= _maxResizeTicks;
+    if (checkSize) {
+      _currentResizeTick = 0;
+    }
+    if (_windowEventPort == null) {
+      await _updateWindows(checkSize: checkSize);
+    } else if (checkSize) {
+      _requestWindowUpdate(checkSize: true); // still polled rarely in case a native event was missed
+    }
+    if (_managerUpdate == null) {
+      if (_steppedReplay) {
+        _stepReplay();
       }
+      _managerUpdate = _updateManagerAndState().whenComplete(() => _managerUpdate = null); // not awaited
     }
-    _managerUpdate ??= _updateManagerAndState().whenComplete(() => _managerUpdate = null); // not awaited
     _eventUpdates ??= _updateEvents().whenComplete(() => _eventUpdates = null); // not awaited
     await _updateListeners(); // is awaited
   }
 
+  /// Shows the next frame of the replay after the manager update of the previous one completed, so every recorded frame
+  /// is analysed exactly once. Logs the frames per second after the last frame (then the window is closed)
+  static void _stepReplay() {
+    final NativeWindow native = NativeWindow.instance;
+    final int frame = native.getSourceFrame();
+    final int frames = native.getSourceFrameCount();
+    if (frame < 0 || frame >= frames) {
+      return; // replay already ended
+    }
+    if (_replayWatch == null) {
+      _replayWatch = Stopwatch()..start(); // the first frame was shown since the start
+      return;
+    }
+    ++_replayedFrames;
+    native.setSourceFrame(frame + 1);
+    if (frame + 1 == frames) {
+      _replayWatch!.stop();
+      Logger.info(
+        "Replay analysed $_replayedFrames frames in ${_replayWatch!.elapsedMilliseconds} ms "
+        "(${_replayFramesPerSecond.toStringAsFixed(1)} frames per second)",
+      );
+    }
+  }
+
+  /// See [GameToolsLib.replayFramesPerSecond]
+  static double get _replayFramesPerSecond {
+    final int microseconds = _replayWatch?.elapsedMicroseconds ?? 0;
+    return microseconds > 0 ? _replayedFrames * 1000000.0 / microseconds : 0.0;
+  }
+
   static void _addEventInternal(GameEvent event) {
     switch (event.priority) {
       case GameEventPriority.INSTANT:
@@ -64,6 +64,9 @@ sealed class _GameToolsLibHelper extends GameToolsLibPlatform {
         Logger.error("Error, copy new Native C/C++ library file to ${FileUtils.absolutePath(FFILoader.apiPath)}");
         return false;
       }
+      if (await _initReplay() == false) {
+        return false;
+      }
       for (final GameWindow gameWindow in GameToolsLib.gameWindows) {
         gameWindow.init(); // now init all game windows once
       }
@@ -133,6 +136,30 @@ sealed class _GameToolsLibHelper extends GameToolsLibPlatform {
     }
   }
 
+  /// Called from [_initNativeCode] before the game windows are initialized to replace the screen with the
+  /// [FixedConfig.replayRecording] as the main game window (if it is set)
+  static Future<bool> _initReplay() async {
+    final String? recording = FixedConfig.fixedConfig.replayRecording;
+    if (recording == null) {
+      return true;
+    }
+    final NativeWindow native = NativeWindow.instance;
+    final bool loaded = await native.setFrameSource(
+      NativeFrameSource.REPLAY,
+      windowTitle: GameToolsLib.mainGameWindow.name,
+      recording: recording,
+    );
+    if (loaded == false || native.setReplaySpeed(FixedConfig.fixedConfig.replaySpeed) == false) {
+      Logger.error("Could not replay the recording ${FileUtils.absolutePath(recording)}");
+      return false;
+    }
+    Logger.info(
+      "Replaying ${native.getSourceFrameCount()} frames of $recording as ${GameToolsLib.mainGameWindow.name} with "
+      "speed ${FixedConfig.fixedConfig.replaySpeed}",
+    );
+    return true;
+  }
+
   /// native lib dependencies of opencv
   static String get _openCvDeps =>
       "avcodec-61, avdevice-61, avfilter-10, avformat-61, avutil-59, swresample-5, swscale-8";
@@ -137,6 +137,27 @@ sealed class BaseNativeImage {
     return NativeImage._mat(await _data!.cloneAsync(), typeOverride: type);
   }
 
+  /// Returns the native memory of this if a new screenshot with [width] and [height] for the [targetType] can be
+  /// written directly into it. Otherwise returns null if this was not created from native data, or the size, or type
+  /// changed. Only [NativeImageType.RGBA] images can be reused, because other types already need a new converted copy!
+  ///
+  /// This is only used for images that were explicitly passed as a scratch buffer (the reuseImage of
+  /// [NativeWindow.getImageOfWindow] and [GameWindow.getImage]), so the caller must be the only owner of this: every
+  /// other holder of it and every reference to it (see [clone] and [NativeImage.getSubImage] with onlyReference)
+  /// would see its pixels change when the memory is reused.
+  Pointer<UnsignedChar>? reusableNativeData(int width, int height, NativeImageType targetType) {
+    if (_nativeData == null ||
+        _isReference ||
+        targetType != NativeImageType.RGBA ||
+        type != NativeImageType.RGBA ||
+        this.width != width ||
+        this.height != height) {
+      return null;
+    }
+    Logger.spamPeriodic(_createLog, "Reusing native data of ", this);
+    return _nativeData;
+  }
+
   /// If you want to modify, or access the internal opencv mat directly (should rarely be needed)
   cv.Mat? getRawData() => _data;
 
@@ -192,11 +213,24 @@ sealed class BaseNativeImage {
       _type = typeOverride ?? NativeImageType.fromChannels(mat.channels),
       _isReference = false;
 
-  /// Will be [NativeImageType.RGBA] per default with internal native data
-  static NativeImage _loadNative(int width, int height, Pointer<UnsignedChar> data, int? logXPos, int? logYPos) {
+  /// Will be the [dataType] (with 1, 3, or 4 channels) with internal native data
+  static NativeImage _loadNative(
+    int width,
+    int height,
+    Pointer<UnsignedChar> data,
+    NativeImageType dataType,
+    int? logXPos,
+    int? logYPos,
+  ) {
+    final cv.MatType matType = switch (dataType.channels) {
+      1 => cv.MatType.CV_8UC1,
+      3 => cv.MatType.CV_8UC3,
+      _ => cv.MatType.CV_8UC4,
+    };
     final NativeImage img = NativeImage._mat(
-      cv.Mat.fromBuffer(height, width, cv.MatType.CV_8UC4, data as Pointer<Void>),
+      cv.Mat.fromBuffer(height, width, matType, data as Pointer<Void>),
       nativeData: data,
+      typeOverride: dataType,
     );
     Logger.spamPeriodic(_createLog, "Loaded ", img, " from native data at winPos (", logXPos, ", ", logYPos, ")");
     return img;
@@ -320,6 +354,9 @@ sealed class BaseNativeImage {
   /// If that counter reaches higher than [maxAmountOfPixelsNotEqual], then this returns false.
   ///
   /// Otherwise this returns true after calling the callback for each value.
+  ///
+  /// If [nativeCompare] is not null, it is used instead of the [compareCallback] to count the changed pixels of the
+  /// whole overlap at once (see [_nativePixChange]).
   static bool _compareValsOfMats({
     required int width1,
     required int height1,
@@ -328,6 +365,7 @@ sealed class BaseNativeImage {
     required int pixelValueThreshold,
     required int maxAmountOfPixelsNotEqual,
     required int Function(int r, int c) compareCallback,
+    int Function(int width, int height, int pixelValueThreshold, int maxAmountOfPixelsNotEqual)? nativeCompare,
   }) {
     if (width1 < 0 || width2 <= 0 || height1 <= 0 || height2 <= 0) {
       // one side is empty and the other is not
@@ -335,6 +373,12 @@ sealed class BaseNativeImage {
     }
     final int rMin = min(height1, height2); // height = row = access first
     final int cMin = min(width1, width2); // width = col = last
+    if (nativeCompare != null) {
+      final int changed = nativeCompare.call(cMin, rMin, pixelValueThreshold, maxAmountOfPixelsNotEqual);
+      if (changed >= 0) {
+        return changed == 0 || changed <= maxAmountOfPixelsNotEqual; // same as the loop below
+      }
+    }
     int pixelsChanged = 0;
     for (int r = 0; r < rMin; ++r) {
       for (int c = 0; c < cMin; ++c) {
@@ -407,6 +451,163 @@ sealed class BaseNativeImage {
     };
   }
 
+  /// Same as [_minPixChange], but returns a function that counts the changed pixels of the top left [width] x [height]
+  /// area of both images at once with the native simd kernel [NativeWindow.compareTolerance].
+  /// Returns null if it can not be used, because the native code is not loaded yet, or if the data of one image is
+  /// not continuous (like sub image references). Then the dart loop is used instead.
+  static int Function(int width, int height, int pixelValueThreshold, int maxAmountOfPixelsNotEqual)?
+  _nativePixChange({required NativeImage i1, required NativeImage i2, required bool ignoreAlpha}) {
+    final _NativeRows? rows1 = _nativeRows(i1);
+    final _NativeRows? rows2 = _nativeRows(i2);
+    if (rows1 == null || rows2 == null) {
+      return null;
+    }
+    return (int width, int height, int pixelValueThreshold, int maxAmountOfPixelsNotEqual) =>
+        _nativeWindow.compareTolerance(
+          rows1.data,
+          rows1.stride,
+          rows1.channels,
+          rows2.data,
+          rows2.stride,
+          rows2.channels,
+          width,
+          height,
+          pixelValueThreshold,
+          maxAmountOfPixelsNotEqual,
+          ignoreAlpha: ignoreAlpha,
+        );
+  }
+
+  /// Native version of the dart loop in [NativeImage.shiftedEquals] that compares all offsets in a single pass with
+  /// [NativeWindow.shiftedCompare]. Returns null if it can not be used (see [_nativePixChange]).
+  static bool? _nativeShiftedEquals({
+    required NativeImage i1,
+    required NativeImage i2,
+    required int pixelValueThreshold,
+    required int maxAmountOfPixelsNotEqual,
+    required bool ignoreAlpha,
+    required int imagePixelShift,
+  }) {
+    final _NativeRows? rows1 = _nativeRows(i1);
+    final _NativeRows? rows2 = _nativeRows(i2);
+    if (rows1 == null || rows2 == null) {
+      return null;
+    }
+    final int result = _nativeWindow.shiftedCompare(
+      rows1.data,
+      rows1.stride,
+      rows1.channels,
+      rows2.data,
+      rows2.stride,
+      rows2.channels,
+      min(i1.width, i2.width),
+      min(i1.height, i2.height),
+      imagePixelShift,
+      pixelValueThreshold,
+      maxAmountOfPixelsNotEqual,
+      ignoreAlpha: ignoreAlpha,
+    );
+    return result == 1; // -1 for channels that can not be compared is also not equal
+  }
+
+  /// Native version of the dart loop in [NativeImage.shiftedEqualsBatch] that compares all [images] in parallel with
+  /// [NativeWindow.compareBatch]. Returns null if it can not be used for any of the images (see [_nativePixChange]).
+  static List<bool>? _nativeShiftedEqualsBatch({
+    required NativeImage frame,
+    required List<(Bounds<int>, NativeImage)> images,
+    required int pixelValueThreshold,
+    required int maxAmountOfPixelsNotEqual,
+    required bool ignoreAlpha,
+    required int imagePixelShift,
+  }) {
+    final _NativeRows? frameRows = _nativeRows(frame);
+    if (frameRows == null) {
+      return null;
+    }
+    final List<({Pointer<UnsignedChar> data, int stride, int channels, int width, int height, int x, int y})> jobs =
+        <({Pointer<UnsignedChar> data, int stride, int channels, int width, int height, int x, int y})>[];
+    for (final (Bounds<int> bounds, NativeImage image) in images) {
+      final _NativeRows? rows = _nativeRows(image);
+      if (rows == null) {
+        return null;
+      }
+      jobs.add((
+        data: rows.data,
+        stride: rows.stride,
+        channels: rows.channels,
+        width: min(bounds.width, image.width),
+        height: min(bounds.height, image.height),
+        x: bounds.x,
+        y: bounds.y,
+      ));
+    }
+    return _nativeWindow.compareBatch(
+      frameRows.data,
+      frameRows.stride,
+      frameRows.channels,
+      frame.width,
+      frame.height,
+      jobs,
+      threshold: pixelValueThreshold,
+      maxBad: maxAmountOfPixelsNotEqual,
+      maxShift: imagePixelShift,
+      ignoreAlpha: ignoreAlpha,
+    );
+  }
+
+  /// Native coarse to fine search of the [template] in the [image] with [NativeWindow.findTemplate] (see
+  /// [NativeImage.findTemplate]). Not continuous data (like sub image references) is copied first.
+  static Future<(Bounds<int>, double)?> _nativeFindTemplate({
+    required NativeImage image,
+    required NativeImage template,
+    required Bounds<int>? searchArea,
+  }) async {
+    if (image._data == null || template._data == null || image.isEmpty || template.isEmpty) {
+      throw ImageException(message: "cant search template $template in image $image");
+    }
+    final NativeImage continuousImage = image._data!.isContinuous ? image : await image.clone();
+    final NativeImage continuousTemplate = template._data!.isContinuous ? template : await template.clone();
+    final int imageChannels = continuousImage.type.channels;
+    final int templateChannels = continuousTemplate.type.channels;
+    final (int, int, double)? match = _nativeWindow.findTemplate(
+      continuousImage._data!.dataPtr.cast<UnsignedChar>(),
+      continuousImage.width * imageChannels,
+      imageChannels,
+      continuousImage.width,
+      continuousImage.height,
+      continuousTemplate._data!.dataPtr.cast<UnsignedChar>(),
+      continuousTemplate.width * templateChannels,
+      templateChannels,
+      continuousTemplate.width,
+      continuousTemplate.height,
+      searchArea,
+    );
+    if (continuousImage != image) {
+      continuousImage.cleanupMemory();
+    }
+    if (continuousTemplate != template) {
+      continuousTemplate.cleanupMemory();
+    }
+    if (match == null) {
+      return null;
+    }
+    return (Bounds<int>(x: match.$1, y: match.$2, width: template.width, height: template.height), match.$3);
+  }
+
+  /// Returns the data of the [image] for native compare functions, or null if the native code is not loaded yet, or
+  /// if the data is not continuous (like sub image references), or if [NativeImage.useNativeCompare] is false
+  static _NativeRows? _nativeRows(NativeImage image) {
+    final cv.Mat? mat = image._data;
+    if (NativeImage.useNativeCompare == false || NativeWindow.hasInstance == false) {
+      return null;
+    }
+    if (mat == null || mat.isContinuous == false) {
+      return null;
+    }
+    final int channels = image.type.channels;
+    return (data: mat.dataPtr.cast<UnsignedChar>(), stride: mat.width * channels, channels: channels);
+  }
+
   /// This will return a pair of matrices of the same size.
   /// This may return references to [a] and [b], or clone and resize them!
   static Future<(NativeImage, NativeImage)> makeSameSize(NativeImage a, NativeImage b) async {
@@ -456,6 +657,9 @@ sealed class BaseNativeImage {
   static NativeWindow get _nativeWindow => NativeWindow.instance;
 }
 
+/// Data pointer, bytes per row and channels of an image for the native compare functions
+typedef _NativeRows = ({Pointer<UnsignedChar> data, int stride, int channels});
+
 class TestMockNativeImageWrapper {
   final NativeImage img;
 
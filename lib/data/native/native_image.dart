@@ -2,7 +2,7 @@ import 'dart:ffi' show Pointer, UnsignedChar, Void;
 import 'dart:math' show min, max;
 import 'dart:ui' show Color, Image, PixelFormat, decodeImageFromPixels;
 import 'package:flutter/material.dart'
-    show showDialog, BuildContext, AlertDialog, Text, Widget, RawImage, Navigator, TextButton;
+    show showDialog, BuildContext, AlertDialog, Text, Widget, RawImage, Navigator, TextButton, visibleForTesting;
 import 'package:game_tools_lib/core/enums/native_image_type.dart';
 import 'package:game_tools_lib/core/exceptions/exceptions.dart';
 import 'package:game_tools_lib/core/utils/bounds.dart';
@@ -40,13 +40,19 @@ final class NativeImage extends BaseNativeImage {
   /// Used for pixel comparison as the shift between images in each direction (top, left, right, bot)
   static int defaultShiftedEqualsPixels = 1;
 
+  /// If [equals] should use the native simd kernel [NativeWindow.compareTolerance] when possible instead of
+  /// accessing every pixel from dart (only disabled for tests and benchmarks)
+  @visibleForTesting
+  static bool useNativeCompare = true;
+
   /// Only takes [mat] reference and optionally [nativeData]. Used in other constructors
   /// If [typeOverride] is not null, then the type will be derived from the [mat.channels] (but this is not possible
   /// for [clone])
   NativeImage._mat(super.mat, {super.nativeData, super.typeOverride}) : super._base();
 
   /// Creates an image from [data] as a buffer allocated in native c/c++ code with [width] and [height].
-  /// For [targetType], look at [NativeImageType] docs!
+  /// For [targetType], look at [NativeImageType] docs! [dataType] is the format of the native [data] (BGRA per default)
+  /// and no conversion is needed if it is the same as the [targetType].
   /// [logXPos] and [logYPos] are used for logging and are the pos inside of the window (0, 0) for full win, and null
   /// for full display.
   factory NativeImage.nativeSync({
@@ -54,17 +60,19 @@ final class NativeImage extends BaseNativeImage {
     required int height,
     required Pointer<UnsignedChar> data,
     required NativeImageType targetType,
+    NativeImageType dataType = NativeImageType.RGBA,
     int? logXPos,
     int? logYPos,
   }) {
-    final NativeImage img = BaseNativeImage._loadNative(width, height, data, logXPos, logYPos);
+    final NativeImage img = BaseNativeImage._loadNative(width, height, data, dataType, logXPos, logYPos);
     img.changeTypeSync(targetType);
     BaseNativeImage._attachToFinalizer(img);
     return img;
   }
 
   /// Creates an image from [data] as a buffer allocated in native c/c++ code with [width] and [height].
-  /// For [targetType], look at [NativeImageType] docs!
+  /// For [targetType], look at [NativeImageType] docs! [dataType] is the format of the native [data] (BGRA per default)
+  /// and no conversion is needed if it is the same as the [targetType] (see [NativeWindow.captureAsync]).
   /// [logXPos] and [logYPos] are used for logging and are the pos inside of the window (0, 0) for full win, and null
   /// for full display.
   static Future<NativeImage> nativeAsync({
@@ -72,15 +80,32 @@ final class NativeImage extends BaseNativeImage {
     required int height,
     required Pointer<UnsignedChar> data,
     required NativeImageType targetType,
+    NativeImageType dataType = NativeImageType.RGBA,
     int? logXPos,
     int? logYPos,
   }) async {
-    final NativeImage img = BaseNativeImage._loadNative(width, height, data, logXPos, logYPos);
+    final NativeImage img = BaseNativeImage._loadNative(width, height, data, dataType, logXPos, logYPos);
     await img.changeTypeAsync(targetType);
     BaseNativeImage._attachToFinalizer(img);
     return img;
   }
 
+  /// Creates an [NativeImageType.RGBA] image that only references the [data] with [width] and [height] which is
+  /// owned and cleaned up by native code (for example a frame of [GameWindow.getLatestFrame]). No memory is cleaned
+  /// up from this, so use [clone] or [getSubImage] (without onlyReference) to keep the data after native code reused
+  /// the memory! Changing the type will also create a copy.
+  factory NativeImage.nativeReference({
+    required int width,
+    required int height,
+    required Pointer<UnsignedChar> data,
+  }) {
+    final NativeImage img = NativeImage._mat(
+      cv.Mat.fromBuffer(height, width, cv.MatType.CV_8UC4, data as Pointer<Void>),
+    );
+    img._isReference = true;
+    return img;
+  }
+
   /// Creates an image by reading it from a [path] and otherwise throws a [ImageException] exception.
   /// For [type], look at [NativeImageType] docs! Default is [NativeImageType.RGB] here.
   /// A copy is only made here with [changeTypeSync] if the [type] should be [NativeImageType.RGBA], but the file has
@@ -159,6 +184,7 @@ final class NativeImage extends BaseNativeImage {
       pixelValueThreshold: pixelValueThreshold,
       maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
       compareCallback: compareFunc,
+      nativeCompare: BaseNativeImage._nativePixChange(i1: this, i2: other, ignoreAlpha: ignoreAlpha),
     );
   }
 
@@ -174,6 +200,8 @@ final class NativeImage extends BaseNativeImage {
   /// This also means that at least [imagePixelShift] pixels are cut off when comparing pixels, so you might need
   /// stricter pixel threshold values!
   ///
+  /// If possible all offsets are compared natively in a single pass over both images (see [useNativeCompare]).
+  ///
   /// Look at doc comments of [equals] for the meaning of the base parameter!
   bool shiftedEquals(
     NativeImage other, {
@@ -183,40 +211,110 @@ final class NativeImage extends BaseNativeImage {
     int? imagePixelShift,
   }) {
     imagePixelShift ??= defaultShiftedEqualsPixels;
+    pixelValueThreshold ??= defaultPixelValueThreshold;
+    maxAmountOfPixelsNotEqual ??= defaultMaxAmountOfPixelsNotEqual;
+    final bool? nativeResult = BaseNativeImage._nativeShiftedEquals(
+      i1: this,
+      i2: other,
+      pixelValueThreshold: pixelValueThreshold,
+      maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
+      ignoreAlpha: ignoreAlpha,
+      imagePixelShift: imagePixelShift,
+    );
+    if (nativeResult != null) {
+      return nativeResult;
+    }
     final int minWidth = width < other.width ? width : other.width;
     final int minHeight = height < other.height ? height : other.height;
-    // now compare row by row with both images being shifted once!
-    for (int y1 = 0; y1 <= imagePixelShift; ++y1) {
-      final int shiftHeight = minHeight - y1;
-      for (int x1 = 0; x1 <= imagePixelShift; ++x1) {
-        final int shiftWidth = minWidth - x1;
-        final NativeImage firstMine = getSubImage(x1, y1, shiftWidth, shiftHeight, onlyReference: true);
-        final NativeImage firstOther = other.getSubImage(0, 0, shiftWidth, shiftHeight, onlyReference: true);
-        if (firstMine.equals(
-          firstOther,
+    // now compare the overlap for every offset (positive offsets shift this image and negative ones the other image)
+    for (int y = -imagePixelShift; y <= imagePixelShift; ++y) {
+      final int shiftHeight = minHeight - y.abs();
+      for (int x = -imagePixelShift; x <= imagePixelShift; ++x) {
+        final int shiftWidth = minWidth - x.abs();
+        if (shiftWidth <= 0 || shiftHeight <= 0) {
+          continue;
+        }
+        final NativeImage mine = getSubImage(max(x, 0), max(y, 0), shiftWidth, shiftHeight, onlyReference: true);
+        final NativeImage others = other.getSubImage(
+          max(-x, 0),
+          max(-y, 0),
+          shiftWidth,
+          shiftHeight,
+          onlyReference: true,
+        );
+        if (mine.equals(
+          others,
           pixelValueThreshold: pixelValueThreshold,
           maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
           ignoreAlpha: ignoreAlpha,
         )) {
           return true;
         }
-        if (x1 != 0) {
-          final NativeImage secondMine = getSubImage(0, 0, shiftWidth, shiftHeight, onlyReference: true);
-          final NativeImage secondOther = other.getSubImage(x1, y1, shiftWidth, shiftHeight, onlyReference: true);
-          if (secondMine.equals(
-            secondOther,
-            pixelValueThreshold: pixelValueThreshold,
-            maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
-            ignoreAlpha: ignoreAlpha,
-          )) {
-            return true;
-          }
-        }
       }
     }
     return false;
   }
 
+  /// Same as calling [shiftedEquals] on the sub image of this at the bounds of every entry of [images] with its image
+  /// (like CompareImage.isShown for many compare images of one window image). Returns one result per entry.
+  ///
+  /// The bounds are clipped to this image and an entry without any area inside of this is not equal. If possible
+  /// all entries are compared natively at once and in parallel (see [useNativeCompare]).
+  ///
+  /// Look at doc comments of [equals] for the meaning of the base parameter!
+  List<bool> shiftedEqualsBatch(
+    List<(Bounds<int>, NativeImage)> images, {
+    int? pixelValueThreshold,
+    int? maxAmountOfPixelsNotEqual,
+    bool ignoreAlpha = false,
+    int? imagePixelShift,
+  }) {
+    imagePixelShift ??= defaultShiftedEqualsPixels;
+    pixelValueThreshold ??= defaultPixelValueThreshold;
+    maxAmountOfPixelsNotEqual ??= defaultMaxAmountOfPixelsNotEqual;
+    final List<bool>? nativeResults = BaseNativeImage._nativeShiftedEqualsBatch(
+      frame: this,
+      images: images,
+      pixelValueThreshold: pixelValueThreshold,
+      maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
+      ignoreAlpha: ignoreAlpha,
+      imagePixelShift: imagePixelShift,
+    );
+    if (nativeResults != null) {
+      return nativeResults;
+    }
+    final List<bool> results = <bool>[];
+    for (final (Bounds<int> bounds, NativeImage image) in images) {
+      // cut both at the same side, so that they still start at the same pixel (same as the native clipping)
+      final int left = max(bounds.x, 0);
+      final int top = max(bounds.y, 0);
+      final int areaWidth = min(bounds.x + min(bounds.width, image.width), width) - left;
+      final int areaHeight = min(bounds.y + min(bounds.height, image.height), height) - top;
+      if (areaWidth <= 0 || areaHeight <= 0) {
+        results.add(false);
+        continue;
+      }
+      final NativeImage area = getSubImage(left, top, areaWidth, areaHeight, onlyReference: true);
+      final NativeImage other = image.getSubImage(
+        left - bounds.x,
+        top - bounds.y,
+        areaWidth,
+        areaHeight,
+        onlyReference: true,
+      );
+      results.add(
+        area.shiftedEquals(
+          other,
+          pixelValueThreshold: pixelValueThreshold,
+          maxAmountOfPixelsNotEqual: maxAmountOfPixelsNotEqual,
+          ignoreAlpha: ignoreAlpha,
+          imagePixelShift: imagePixelShift,
+        ),
+      );
+    }
+    return results;
+  }
+
   /// Similar to [equals] this also compares the difference between the pixels of both matrices, but here instead it
   /// returns a value up to "1.0" (for 100%) on how similar the matrices are.
   ///
@@ -242,6 +340,19 @@ final class NativeImage extends BaseNativeImage {
     }
   }
 
+  /// Searches the [template] inside of this image (or only inside of the [searchArea] of this) and returns the bounds
+  /// of the best match together with its confidence from -1 to 1. The confidence is the normalized cross correlation
+  /// of the colors at the match, so 1 is a perfect match and values below about 0.8 are usually something else.
+  /// Returns null if the template is bigger than the searched area.
+  ///
+  /// This is a native coarse to fine search over an image pyramid, so it only takes a few milliseconds even for a
+  /// full window image, but it can miss templates without any structure (like single colored areas).
+  /// Sub image references are copied first, because the native search needs continuous data.
+  ///
+  /// Throws an [ImageException] if one of the images is empty.
+  Future<(Bounds<int>, double)?> findTemplate(NativeImage template, {Bounds<int>? searchArea}) =>
+      BaseNativeImage._nativeFindTemplate(image: this, template: template, searchArea: searchArea);
+
   /// Sets the image bounds to [newWidth], [newHeight] (reassigns internal data and clears old memory)
   Future<void> resize(int newWidth, int newHeight) async {
     if (_data != null) {
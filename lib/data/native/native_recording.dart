@@ -0,0 +1,87 @@
+import 'package:game_tools_lib/core/enums/native_image_type.dart';
+import 'package:game_tools_lib/core/exceptions/exceptions.dart';
+import 'package:game_tools_lib/data/native/native_image.dart';
+import 'package:game_tools_lib/data/native/native_window.dart';
+import 'package:game_tools_lib/domain/game/game_window.dart';
+import 'package:game_tools_lib/game_tools_lib.dart';
+
+/// Reads a recording of [GameWindow.startRecording] frame by frame, so that recorded sessions can be inspected (for
+/// example when a compare check did not work as expected) or used as input for offline benchmarks.
+///
+/// The frames are found by their timestamp since the start of the recording. A recording that is still written, or
+/// was not stopped cleanly can be read up to its last complete frame (only the frames that existed when it was opened
+/// are read). Has to be closed with [close] when it is not needed anymore (all recordings are closed automatically in
+/// [GameToolsLib.close]).
+final class NativeRecording {
+  final String path;
+
+  late final int _readerID;
+
+  late final NativeRecordingInfo _info;
+
+  /// All recordings that were not closed yet
+  static final Set<NativeRecording> _active = <NativeRecording>{};
+
+  /// Opens the recording at [path] and indexes its frames. Throws a [FileNotFoundException] if the file could not be
+  /// read, or is not a recording
+  NativeRecording(this.path) {
+    _readerID = NativeWindow.instance.openRecording(path);
+    if (_readerID < 0) {
+      throw FileNotFoundException(message: "NativeRecording: $path is not a recording");
+    }
+    _info = NativeWindow.instance.getRecordingInfo(_readerID);
+    _active.add(this);
+    Logger.verbose("Opened recording $path with ${_info.frames} frames");
+  }
+
+  /// Amount of frames, timestamps of the first and last frame and when the recording was started
+  NativeRecordingInfo get info => _info;
+
+  /// If [close] was not called yet
+  bool get isOpen => _active.contains(this);
+
+  /// Returns the frame that was shown at the [timestamp] since the start of the recording (the first frame for
+  /// earlier timestamps) as a new [NativeImageType.RGBA] image of the inner window and its details (like the window
+  /// bounds). Returns null if the recording has no frames, was closed, or is corrupted at that frame.
+  (NativeImage, NativeRecordedFrame)? frameAt(Duration timestamp) {
+    if (isOpen == false) {
+      return null;
+    }
+    return NativeWindow.instance.readRecordedFrame(_readerID, timestamp);
+  }
+
+  /// Yields all frames in the order in which they were recorded, starting with the frame that was shown at [from].
+  /// Only the changed tiles are applied between the frames, so this is faster than calling [frameAt] in a random
+  /// order. Stops early if the recording is closed, or corrupted.
+  Iterable<(NativeImage, NativeRecordedFrame)> frames({Duration from = Duration.zero}) sync* {
+    Duration? timestamp = from;
+    while (timestamp != null) {
+      final (NativeImage, NativeRecordedFrame)? frame = frameAt(timestamp);
+      if (frame == null) {
+        return;
+      }
+      yield frame;
+      timestamp = frame.$2.nextTimestamp;
+    }
+  }
+
+  /// Closes the native reader (afterwards no frames can be read anymore). Multiple calls have no effect
+  void close() {
+    if (_active.remove(this)) {
+      if (NativeWindow.hasInstance) {
+        NativeWindow.instance.closeRecording(_readerID);
+      }
+      Logger.verbose("Closed recording $path");
+    }
+  }
+
+  /// Closes all recordings that were not closed yet. Called automatically in [GameToolsLib.close]
+  static void closeAll() {
+    for (final NativeRecording recording in _active.toList()) {
+      recording.close();
+    }
+  }
+
+  @override
+  String toString() => "NativeRecording(path: $path, frames: ${_info.frames})";
+}
@@ -0,0 +1,67 @@
+import 'package:game_tools_lib/core/enums/native_image_type.dart';
+import 'package:game_tools_lib/core/exceptions/exceptions.dart';
+import 'package:game_tools_lib/data/native/native_image.dart';
+import 'package:game_tools_lib/data/native/native_window.dart';
+import 'package:game_tools_lib/domain/game/game_window.dart';
+import 'package:game_tools_lib/game_tools_lib.dart';
+
+/// Reads the frames that a [GameWindow.startFramePublishing] of this, or another process publishes into named shared
+/// memory, so that multiple tools can use the frames of one capture thread instead of all capturing the screen on
+/// their own.
+///
+/// The publisher never waits for its readers: [latest] copies the newest frame and checks that it was not overwritten
+/// while it was copied. If the publisher stops, no frames can be read anymore until the name is opened again with a
+/// new [NativeSharedFrames]. Has to be closed with [close] when it is not needed anymore (all readers are closed
+/// automatically in [GameToolsLib.close]).
+final class NativeSharedFrames {
+  final String name;
+
+  late final int _readerID;
+
+  /// All readers that were not closed yet
+  static final Set<NativeSharedFrames> _active = <NativeSharedFrames>{};
+
+  /// Opens the shared frames of the publisher with the [name]. Throws a [FileNotFoundException] if there is no
+  /// publisher with that name
+  NativeSharedFrames(this.name) {
+    _readerID = NativeWindow.instance.openSharedFrames(name);
+    if (_readerID < 0) {
+      throw FileNotFoundException(message: "NativeSharedFrames: there are no published frames with the name $name");
+    }
+    _active.add(this);
+    Logger.verbose("Opened shared frames $name");
+  }
+
+  /// If [close] was not called yet
+  bool get isOpen => _active.contains(this);
+
+  /// Returns a copy of the newest published frame as a new [NativeImageType.RGBA] image of the inner window and its
+  /// details (like the window bounds and the frame number of the publisher, which can be used to skip frames that
+  /// were already seen). Returns null if there is no frame yet, if the publisher stopped, or if this was closed.
+  (NativeImage, NativeSharedFrame)? latest() {
+    if (isOpen == false) {
+      return null;
+    }
+    return NativeWindow.instance.readSharedFrame(_readerID);
+  }
+
+  /// Unmaps the shared memory (afterwards no frames can be read anymore). Multiple calls have no effect
+  void close() {
+    if (_active.remove(this)) {
+      if (NativeWindow.hasInstance) {
+        NativeWindow.instance.closeSharedFrames(_readerID);
+      }
+      Logger.verbose("Closed shared frames $name");
+    }
+  }
+
+  /// Closes all readers that were not closed yet. Called automatically in [GameToolsLib.close]
+  static void closeAll() {
+    for (final NativeSharedFrames frames in _active.toList()) {
+      frames.close();
+    }
+  }
+
+  @override
+  String toString() => "NativeSharedFrames(name: $name)";
+}
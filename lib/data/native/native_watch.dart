@@ -0,0 +1,89 @@
+import 'dart:async';
+import 'dart:isolate';
+
+import 'package:game_tools_lib/core/exceptions/exceptions.dart';
+import 'package:game_tools_lib/data/native/native_window.dart';
+import 'package:game_tools_lib/domain/game/game_window.dart';
+import 'package:game_tools_lib/game_tools_lib.dart';
+
+/// A pixel or region watch that is checked on a native background thread (created with [GameWindow.watchPixels], or
+/// [GameWindow.watchRegion]). The native thread only sends a message into the [ReceivePort] of this when the watched
+/// state flips, so nothing has to be captured or compared from dart in every tick.
+///
+/// Nothing is checked while the window is closed or minimized. Has to be stopped with [cancel] when it is not needed
+/// anymore (all watches are stopped automatically in [GameToolsLib.close]).
+final class NativeWatch {
+  final ReceivePort _port = ReceivePort();
+
+  final StreamController<bool> _changes = StreamController<bool>.broadcast();
+
+  late final int _watchID;
+
+  bool? _matches;
+
+  /// All watches that were not cancelled yet
+  static final Set<NativeWatch> _active = <NativeWatch>{};
+
+  /// Internal: only used from [GameWindow]. [register] starts the native watch with the native port and returns its id
+  /// (or -1 for invalid arguments which throws a [ConfigException])
+  NativeWatch(int Function(int nativePort) register, String description) {
+    _watchID = register(_port.sendPort.nativePort);
+    if (_watchID < 0) {
+      _port.close();
+      _changes.close();
+      throw ConfigException(message: "NativeWatch: could not start $description");
+    }
+    _port.listen((dynamic message) {
+      if (message is bool) {
+        _matches = message;
+        _changes.add(message);
+      }
+    });
+    _active.add(this);
+    Logger.verbose("Started native watch $_watchID for $description");
+  }
+
+  /// The last state that was received from native code (null if the watch was not checked yet)
+  bool? get matches => _matches;
+
+  /// Receives the first state once the watch was checked and afterwards only the flipped states
+  Stream<bool> get changes => _changes.stream;
+
+  /// If [cancel] was not called yet
+  bool get isActive => _active.contains(this);
+
+  /// Completes directly if [matches] is already [state], or otherwise as soon as it changes to [state]. Throws a
+  /// [TimeoutException] after the optional [timeout]
+  Future<void> waitFor({required bool state, Duration? timeout}) async {
+    if (_matches == state) {
+      return;
+    }
+    final Future<bool> changed = changes.firstWhere((bool matches) => matches == state);
+    await (timeout != null ? changed.timeout(timeout) : changed);
+  }
+
+  /// Stops the native watch (afterwards nothing is received anymore). Multiple calls have no effect
+  void cancel() {
+    if (_active.remove(this)) {
+      if (NativeWindow.hasInstance) {
+        NativeWindow.instance.removeWatch(_watchID);
+      }
+      _port.close();
+      _changes.close();
+      Logger.verbose("Stopped native watch $_watchID");
+    }
+  }
+
+  /// Stops all watches that were not cancelled yet. Called automatically in [GameToolsLib.close]
+  static void cancelAll() {
+    for (final NativeWatch watch in _active.toList()) {
+      watch.cancel();
+    }
+    if (NativeWindow.hasInstance) {
+      NativeWindow.instance.removeAllWatches(); // also joins the native thread
+    }
+  }
+
+  @override
+  String toString() => "NativeWatch(id: $_watchID, matches: $_matches)";
+}
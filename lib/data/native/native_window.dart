@@ -1,15 +1,22 @@
+import 'dart:async';
 import 'dart:ffi';
+import 'dart:isolate' show ReceivePort;
 import 'dart:math' show Point;
 import 'dart:ui' show Color;
 import 'package:ffi/ffi.dart';
 import 'package:flutter/services.dart' show LogicalKeyboardKey;
 import 'package:game_tools_lib/core/config/mutable_config.dart';
 import 'package:game_tools_lib/core/enums/input/input_enums.dart';
+import 'package:game_tools_lib/core/enums/native_frame_source.dart';
 import 'package:game_tools_lib/core/enums/native_image_type.dart';
 import 'package:game_tools_lib/core/exceptions/exceptions.dart';
 import 'package:game_tools_lib/core/utils/bounds.dart';
+import 'package:game_tools_lib/core/utils/file_utils.dart';
+import 'package:game_tools_lib/core/utils/utils.dart' show ColorExtension;
 import 'package:game_tools_lib/data/native/ffi_loader.dart';
 import 'package:game_tools_lib/data/native/native_image.dart';
+import 'package:game_tools_lib/data/native/native_recording.dart' show NativeRecording;
+import 'package:game_tools_lib/data/native/native_shared_frames.dart' show NativeSharedFrames;
 import 'package:game_tools_lib/domain/game/game_window.dart' show GameWindow;
 import 'package:game_tools_lib/game_tools_lib.dart';
 import 'package:opencv_dart/opencv.dart' as cv;
@@ -19,7 +26,7 @@ import 'package:opencv_dart/opencv.dart' as cv;
 
 /// Simple integer to detect dll library mismatches. Has to be incremented when native code is modified!
 /// Also Modify the version in native_window.h
-const int _nativeCodeVersion = 9;
+const int _nativeCodeVersion = 34;
 
 /// First local conversions of classes/structs from c code that are used in the functions below
 final class _Rect extends Struct {
@@ -44,6 +51,173 @@ final class _Point extends Struct {
   external int y;
 }
 
+final class _WindowState extends Struct {
+  @Int()
+  external int open;
+
+  @Int()
+  external int focus;
+
+  external _Point size;
+
+  external _Rect bounds;
+}
+
+final class _LatestFrame extends Struct {
+  external Pointer<UnsignedChar> data;
+
+  @Int()
+  external int width;
+
+  @Int()
+  external int height;
+
+  @LongLong()
+  external int frameNumber;
+}
+
+final class _RecordingStats extends Struct {
+  @LongLong()
+  external int records;
+
+  @LongLong()
+  external int keyframes;
+
+  @LongLong()
+  external int droppedFrames;
+
+  @LongLong()
+  external int rawBytes;
+
+  @LongLong()
+  external int writtenBytes;
+}
+
+final class _RecordingInfo extends Struct {
+  @LongLong()
+  external int frames;
+
+  @LongLong()
+  external int keyframes;
+
+  @LongLong()
+  external int firstTimestamp;
+
+  @LongLong()
+  external int lastTimestamp;
+
+  @LongLong()
+  external int startTime;
+}
+
+final class _RecordedFrame extends Struct {
+  @Int()
+  external int width;
+
+  @Int()
+  external int height;
+
+  external _Rect bounds;
+
+  @LongLong()
+  external int timestamp;
+
+  @LongLong()
+  external int frameNumber;
+
+  @LongLong()
+  external int nextTimestamp;
+}
+
+final class _SharedFrame extends Struct {
+  external Pointer<UnsignedChar> data;
+
+  @Int()
+  external int width;
+
+  @Int()
+  external int height;
+
+  external _Rect bounds;
+
+  @LongLong()
+  external int frameNumber;
+
+  @LongLong()
+  external int timestamp;
+
+  @Int()
+  external int slot;
+
+  @UnsignedLongLong()
+  external int sequence;
+}
+
+final class _TemplateMatch extends Struct {
+  @Int()
+  external int x;
+
+  @Int()
+  external int y;
+
+  @Double()
+  external double confidence;
+}
+
+final class _CompareJob extends Struct {
+  external Pointer<UnsignedChar> data;
+
+  @Int()
+  external int stride;
+
+  @Int()
+  external int channels;
+
+  @Int()
+  external int width;
+
+  @Int()
+  external int height;
+
+  @Int()
+  external int x;
+
+  @Int()
+  external int y;
+
+  @Int()
+  external int threshold;
+
+  @Int()
+  external int maxBad;
+
+  @Int()
+  external int maxShift;
+
+  @Bool()
+  external bool ignoreAlpha;
+}
+
+final class _BufferPoolStats extends Struct {
+  @LongLong()
+  external int liveBuffers;
+
+  @LongLong()
+  external int liveBytes;
+
+  @LongLong()
+  external int pooledBuffers;
+
+  @LongLong()
+  external int pooledBytes;
+
+  @LongLong()
+  external int hits;
+
+  @LongLong()
+  external int misses;
+}
+
 /// Then Typedefs in pairs of native function syntax, then dart function syntax
 typedef versionFuncN = Int Function();
 typedef versionFuncD = int Function();
@@ -70,6 +244,9 @@ typedef getWindowBoundsD = _Rect Function(int);
 typedef getWindowSizeN = _Point Function(Int);
 typedef getWindowSizeD = _Point Function(int);
 
+typedef queryWindowStatesN = Int Function(Pointer<Int>, Int, Pointer<_WindowState>);
+typedef queryWindowStatesD = int Function(Pointer<Int>, int, Pointer<_WindowState>);
+
 typedef getMainDisplayWidthN = UnsignedInt Function();
 typedef getMainDisplayWidthD = int Function();
 
@@ -82,17 +259,191 @@ typedef closeWindowD = bool Function(int);
 typedef cleanupMemoryN = Void Function(Pointer<UnsignedChar>);
 typedef cleanupMemoryD = void Function(Pointer<UnsignedChar>);
 
-typedef getFullMainDisplayN = Pointer<UnsignedChar> Function();
+typedef getBufferPoolStatsN = _BufferPoolStats Function();
+typedef getBufferPoolStatsD = _BufferPoolStats Function();
+
+typedef trimBufferPoolN = Void Function();
+typedef trimBufferPoolD = void Function();
+
+typedef setFrameSourceN = Bool Function(Int, Pointer<Utf8>, Int, Int, Pointer<Utf8>);
+typedef setFrameSourceD = bool Function(int, Pointer<Utf8>, int, int, Pointer<Utf8>);
+
+typedef getFrameSourceN = Int Function();
+typedef getFrameSourceD = int Function();
+
+typedef addSourceFrameN = Bool Function(Pointer<UnsignedChar>, Int, Int);
+typedef addSourceFrameD = bool Function(Pointer<UnsignedChar>, int, int);
+
+typedef getSourceFrameCountN = Int Function();
+typedef getSourceFrameCountD = int Function();
+
+typedef setSourceFrameN = Bool Function(LongLong);
+typedef setSourceFrameD = bool Function(int);
+
+typedef getSourceFrameN = LongLong Function();
+typedef getSourceFrameD = int Function();
+
+typedef setReplaySpeedN = Bool Function(Double);
+typedef setReplaySpeedD = bool Function(double);
+
+typedef captureAsyncN = Bool Function(Int, Int, Int, Int, Int, Int, Int, Int64, Int64);
+typedef captureAsyncD = bool Function(int, int, int, int, int, int, int, int, int);
+
+typedef captureIntoN = Bool Function(Int, Int, Int, Int, Int, Pointer<UnsignedChar>, Int);
+typedef captureIntoD = bool Function(int, int, int, int, int, Pointer<UnsignedChar>, int);
+
+typedef captureRegionsN = Int Function(Int, Pointer<_Rect>, Int, Pointer<Pointer<UnsignedChar>>);
+typedef captureRegionsD = int Function(int, Pointer<_Rect>, int, Pointer<Pointer<UnsignedChar>>);
 
-typedef getFullWindowN = Pointer<UnsignedChar> Function(Int);
-typedef getFullWindowD = Pointer<UnsignedChar> Function(int);
+typedef changedTilesN = Int Function(Int, _Rect, LongLong);
+typedef changedTilesD = int Function(int, _Rect, int);
 
-typedef getImageOfWindowN = Pointer<UnsignedChar> Function(Int, Int, Int, Int, Int);
-typedef getImageOfWindowD = Pointer<UnsignedChar> Function(int, int, int, int, int);
+typedef startCaptureThreadN = Bool Function(Int, Int);
+typedef startCaptureThreadD = bool Function(int, int);
+
+typedef stopCaptureThreadN = Void Function(Int);
+typedef stopCaptureThreadD = void Function(int);
+
+typedef acquireLatestFrameN = _LatestFrame Function(Int);
+typedef acquireLatestFrameD = _LatestFrame Function(int);
+
+typedef startRecordingN = Bool Function(Int, Pointer<Utf8>, Int);
+typedef startRecordingD = bool Function(int, Pointer<Utf8>, int);
+
+typedef stopRecordingN = _RecordingStats Function(Int);
+typedef stopRecordingD = _RecordingStats Function(int);
+
+typedef getRecordingStatsN = _RecordingStats Function(Int);
+typedef getRecordingStatsD = _RecordingStats Function(int);
+
+typedef openRecordingN = Int Function(Pointer<Utf8>);
+typedef openRecordingD = int Function(Pointer<Utf8>);
+
+typedef getRecordingInfoN = _RecordingInfo Function(Int);
+typedef getRecordingInfoD = _RecordingInfo Function(int);
+
+typedef readRecordedFrameN = Pointer<UnsignedChar> Function(Int, LongLong, Pointer<_RecordedFrame>);
+typedef readRecordedFrameD = Pointer<UnsignedChar> Function(int, int, Pointer<_RecordedFrame>);
+
+typedef closeRecordingN = Void Function(Int);
+typedef closeRecordingD = void Function(int);
+
+typedef startFramePublishingN = Bool Function(Int, Pointer<Utf8>, Int, Int, Int);
+typedef startFramePublishingD = bool Function(int, Pointer<Utf8>, int, int, int);
+
+typedef stopFramePublishingN = LongLong Function(Int);
+typedef stopFramePublishingD = int Function(int);
+
+typedef openSharedFramesN = Int Function(Pointer<Utf8>);
+typedef openSharedFramesD = int Function(Pointer<Utf8>);
+
+typedef readSharedFrameN = Pointer<UnsignedChar> Function(Int, Pointer<_SharedFrame>);
+typedef readSharedFrameD = Pointer<UnsignedChar> Function(int, Pointer<_SharedFrame>);
+
+typedef closeSharedFramesN = Void Function(Int);
+typedef closeSharedFramesD = void Function(int);
+
+typedef compareToleranceN =
+    Int Function(Pointer<UnsignedChar>, Int, Int, Pointer<UnsignedChar>, Int, Int, Int, Int, Int, Int, Bool);
+typedef compareToleranceD =
+    int Function(Pointer<UnsignedChar>, int, int, Pointer<UnsignedChar>, int, int, int, int, int, int, bool);
+
+typedef shiftedCompareN =
+    Int Function(
+      Pointer<UnsignedChar>,
+      Int,
+      Int,
+      Pointer<UnsignedChar>,
+      Int,
+      Int,
+      Int,
+      Int,
+      Int,
+      Int,
+      Int,
+      Bool,
+      Pointer<Int>,
+      Pointer<Int>,
+    );
+typedef shiftedCompareD =
+    int Function(
+      Pointer<UnsignedChar>,
+      int,
+      int,
+      Pointer<UnsignedChar>,
+      int,
+      int,
+      int,
+      int,
+      int,
+      int,
+      int,
+      bool,
+      Pointer<Int>,
+      Pointer<Int>,
+    );
+
+typedef findTemplateN =
+    _TemplateMatch Function(
+      Pointer<UnsignedChar>,
+      Int,
+      Int,
+      Int,
+      Int,
+      Pointer<UnsignedChar>,
+      Int,
+      Int,
+      Int,
+      Int,
+      Pointer<_Rect>,
+    );
+typedef findTemplateD =
+    _TemplateMatch Function(
+      Pointer<UnsignedChar>,
+      int,
+      int,
+      int,
+      int,
+      Pointer<UnsignedChar>,
+      int,
+      int,
+      int,
+      int,
+      Pointer<_Rect>,
+    );
+
+typedef compareBatchN =
+    Int Function(Pointer<UnsignedChar>, Int, Int, Int, Int, Pointer<_CompareJob>, Int, Pointer<UnsignedChar>);
+typedef compareBatchD =
+    int Function(Pointer<UnsignedChar>, int, int, int, int, Pointer<_CompareJob>, int, Pointer<UnsignedChar>);
 
 typedef getPixelOfWindowN = UnsignedLong Function(Int, Int);
 typedef getPixelOfWindowD = int Function(int, int);
 
+typedef getPixelsOfWindowN = Int Function(Int, Pointer<_Point>, Int, Pointer<UnsignedLong>);
+typedef getPixelsOfWindowD = int Function(int, Pointer<_Point>, int, Pointer<UnsignedLong>);
+
+typedef initDartApiN = Bool Function(Pointer<Void>);
+typedef initDartApiD = bool Function(Pointer<Void>);
+
+typedef addPixelWatchN = Int Function(Int, Pointer<_Point>, Pointer<UnsignedLong>, Int, Int, Int, Int64);
+typedef addPixelWatchD = int Function(int, Pointer<_Point>, Pointer<UnsignedLong>, int, int, int, int);
+
+typedef addRegionWatchN = Int Function(Int, Pointer<_Rect>, Pointer<UnsignedChar>, Int, Int, Int, Int, Int64);
+typedef addRegionWatchD = int Function(int, Pointer<_Rect>, Pointer<UnsignedChar>, int, int, int, int, int);
+
+typedef removeWatchN = Bool Function(Int);
+typedef removeWatchD = bool Function(int);
+
+typedef removeAllWatchesN = Void Function();
+typedef removeAllWatchesD = void Function();
+
+typedef startWindowEventsN = Bool Function(Int64);
+typedef startWindowEventsD = bool Function(int);
+
+typedef stopWindowEventsN = Void Function();
+typedef stopWindowEventsD = void Function();
+
 typedef getDisplayMousePosN = _Point Function();
 
 typedef getWindowMousePosN = _Point Function(Int);
@@ -125,6 +476,47 @@ typedef isKeyDownD = bool Function(int);
 typedef isKeyToggledN = Bool Function(UnsignedShort);
 typedef isKeyToggledD = bool Function(int);
 
+/// State of a window returned by [NativeWindow.queryWindowStates] (see [GameWindow.updateStates])
+typedef NativeWindowState = ({bool open, bool focus, Point<int>? size, Bounds<int>? bounds});
+
+/// Usage of the native image buffer pool returned by [NativeWindow.getBufferPoolStats]. [liveBuffers] are still
+/// owned by dart (or a frame grabber), [pooledBuffers] were freed with [NativeWindow.cleanupMemory] and wait to be
+/// reused. [hitRate] is the part of all allocations that could reuse a pooled buffer (0 to 1)
+typedef NativeBufferPoolStats = ({
+  int liveBuffers,
+  int liveBytes,
+  int pooledBuffers,
+  int pooledBytes,
+  int hits,
+  int misses,
+  double hitRate,
+});
+
+/// Statistics of a recording of [NativeWindow.startRecording]. [records] were written into the file ([keyframes] of
+/// them are full frames, the others only contain the changed tiles) and [droppedFrames] were skipped, because the
+/// writer thread could not keep up. [rawBytes] is the size of the records before the compression and [writtenBytes]
+/// the size of the file
+typedef NativeRecordingStats = ({int records, int keyframes, int droppedFrames, int rawBytes, int writtenBytes});
+
+/// Summary of a recording returned by [NativeWindow.getRecordingInfo]. The timestamps are relative to the [startTime]
+/// of the recording
+typedef NativeRecordingInfo = ({
+  int frames,
+  int keyframes,
+  Duration firstTimestamp,
+  Duration lastTimestamp,
+  DateTime startTime,
+});
+
+/// Details of a frame returned by [NativeWindow.readRecordedFrame]: the window [bounds] when it was captured, its
+/// [timestamp] since the start of the recording, the frame number of the capture thread and the [nextTimestamp] of
+/// the following frame (null for the last frame)
+typedef NativeRecordedFrame = ({Bounds<int> bounds, Duration timestamp, int frameNumber, Duration? nextTimestamp});
+
+/// Details of a frame returned by [NativeWindow.readSharedFrame]: the window [bounds] when it was captured by the
+/// publisher, the frame number of its capture thread and when it was published
+typedef NativeSharedFrame = ({Bounds<int> bounds, int frameNumber, DateTime published});
+
 /// Wrapper class for native c/c++ functions to interact with a game window, or the screen.
 ///
 /// Before using any methods that need a window id, [initWindow] has to be called once! And also [initConfig] will be
@@ -139,14 +531,52 @@ final class NativeWindow {
   late setWindowFocusD _setWindowFocus;
   late getWindowBoundsD _getWindowBounds;
   late getWindowSizeD _getWindowSize;
+  late queryWindowStatesD _queryWindowStates;
   late getMainDisplayWidthD _getMainDisplayWidth;
   late getMainDisplayHeightD _getMainDisplayHeight;
   late closeWindowD _closeWindow;
   late cleanupMemoryD _cleanupMemory;
-  late getFullMainDisplayN _getFullMainDisplay;
-  late getFullWindowD _getFullWindow;
-  late getImageOfWindowD _getImageOfWindow;
+  late getBufferPoolStatsD _getBufferPoolStats;
+  late trimBufferPoolD _trimBufferPool;
+  late setFrameSourceD _setFrameSource;
+  late getFrameSourceD _getFrameSource;
+  late addSourceFrameD _addSourceFrame;
+  late getSourceFrameCountD _getSourceFrameCount;
+  late setSourceFrameD _setSourceFrame;
+  late getSourceFrameD _getSourceFrame;
+  late setReplaySpeedD _setReplaySpeed;
+  late captureAsyncD _captureAsync;
+  late captureIntoD _captureInto;
+  late captureRegionsD _captureRegions;
+  late startCaptureThreadD _startCaptureThread;
+  late stopCaptureThreadD _stopCaptureThread;
+  late changedTilesD _changedTiles;
+  late acquireLatestFrameD _acquireLatestFrame;
+  late startRecordingD _startRecording;
+  late stopRecordingD _stopRecording;
+  late getRecordingStatsD _getRecordingStats;
+  late openRecordingD _openRecording;
+  late getRecordingInfoD _getRecordingInfo;
+  late readRecordedFrameD _readRecordedFrame;
+  late closeRecordingD _closeRecording;
+  late startFramePublishingD _startFramePublishing;
+  late stopFramePublishingD _stopFramePublishing;
+  late openSharedFramesD _openSharedFrames;
+  late readSharedFrameD _readSharedFrame;
+  late closeSharedFramesD _closeSharedFrames;
+  late compareToleranceD _compareTolerance;
+  late shiftedCompareD _shiftedCompare;
+  late findTemplateD _findTemplate;
+  late compareBatchD _compareBatch;
   late getPixelOfWindowD _getPixelOfWindow;
+  late getPixelsOfWindowD _getPixelsOfWindow;
+  late initDartApiD _initDartApi;
+  late addPixelWatchD _addPixelWatch;
+  late addRegionWatchD _addRegionWatch;
+  late removeWatchD _removeWatch;
+  late removeAllWatchesD _removeAllWatches;
+  late startWindowEventsD _startWindowEvents;
+  late stopWindowEventsD _stopWindowEvents;
   late getDisplayMousePosN _getDisplayMousePos;
   late getWindowMousePosD _getWindowMousePos;
   late setDisplayMousePosD _setDisplayMousePos;
@@ -174,14 +604,52 @@ final class NativeWindow {
     _setWindowFocus = _api!.lookupFunction<setWindowFocusN, setWindowFocusD>("setWindowFocus");
     _getWindowBounds = _api!.lookupFunction<getWindowBoundsN, getWindowBoundsD>("getWindowBounds");
     _getWindowSize = _api!.lookupFunction<getWindowSizeN, getWindowSizeD>("getWindowSize");
+    _queryWindowStates = _api!.lookupFunction<queryWindowStatesN, queryWindowStatesD>("queryWindowStates");
     _getMainDisplayWidth = _api!.lookupFunction<getMainDisplayWidthN, getMainDisplayWidthD>("getMainDisplayWidth");
     _getMainDisplayHeight = _api!.lookupFunction<getMainDisplayHeightN, getMainDisplayHeightD>("getMainDisplayHeight");
     _closeWindow = _api!.lookupFunction<closeWindowN, closeWindowD>("closeWindow");
     _cleanupMemory = _api!.lookupFunction<cleanupMemoryN, cleanupMemoryD>("cleanupMemory");
-    _getFullMainDisplay = _api!.lookupFunction<getFullMainDisplayN, getFullMainDisplayN>("getFullMainDisplay");
-    _getFullWindow = _api!.lookupFunction<getFullWindowN, getFullWindowD>("getFullWindow");
-    _getImageOfWindow = _api!.lookupFunction<getImageOfWindowN, getImageOfWindowD>("getImageOfWindow");
+    _getBufferPoolStats = _api!.lookupFunction<getBufferPoolStatsN, getBufferPoolStatsD>("getBufferPoolStats");
+    _trimBufferPool = _api!.lookupFunction<trimBufferPoolN, trimBufferPoolD>("trimBufferPool");
+    _setFrameSource = _api!.lookupFunction<setFrameSourceN, setFrameSourceD>("setFrameSource");
+    _getFrameSource = _api!.lookupFunction<getFrameSourceN, getFrameSourceD>("getFrameSource");
+    _addSourceFrame = _api!.lookupFunction<addSourceFrameN, addSourceFrameD>("addSourceFrame");
+    _getSourceFrameCount = _api!.lookupFunction<getSourceFrameCountN, getSourceFrameCountD>("getSourceFrameCount");
+    _setSourceFrame = _api!.lookupFunction<setSourceFrameN, setSourceFrameD>("setSourceFrame");
+    _getSourceFrame = _api!.lookupFunction<getSourceFrameN, getSourceFrameD>("getSourceFrame");
+    _setReplaySpeed = _api!.lookupFunction<setReplaySpeedN, setReplaySpeedD>("setReplaySpeed");
+    _captureAsync = _api!.lookupFunction<captureAsyncN, captureAsyncD>("captureAsync");
+    _captureInto = _api!.lookupFunction<captureIntoN, captureIntoD>("captureInto");
+    _captureRegions = _api!.lookupFunction<captureRegionsN, captureRegionsD>("captureRegions");
+    _startCaptureThread = _api!.lookupFunction<startCaptureThreadN, startCaptureThreadD>("startCaptureThread");
+    _stopCaptureThread = _api!.lookupFunction<stopCaptureThreadN, stopCaptureThreadD>("stopCaptureThread");
+    _changedTiles = _api!.lookupFunction<changedTilesN, changedTilesD>("changedTiles");
+    _acquireLatestFrame = _api!.lookupFunction<acquireLatestFrameN, acquireLatestFrameD>("acquireLatestFrame");
+    _startRecording = _api!.lookupFunction<startRecordingN, startRecordingD>("startRecording");
+    _stopRecording = _api!.lookupFunction<stopRecordingN, stopRecordingD>("stopRecording");
+    _getRecordingStats = _api!.lookupFunction<getRecordingStatsN, getRecordingStatsD>("getRecordingStats");
+    _openRecording = _api!.lookupFunction<openRecordingN, openRecordingD>("openRecording");
+    _getRecordingInfo = _api!.lookupFunction<getRecordingInfoN, getRecordingInfoD>("getRecordingInfo");
+    _readRecordedFrame = _api!.lookupFunction<readRecordedFrameN, readRecordedFrameD>("readRecordedFrame");
+    _closeRecording = _api!.lookupFunction<closeRecordingN, closeRecordingD>("closeRecording");
+    _startFramePublishing = _api!.lookupFunction<startFramePublishingN, startFramePublishingD>("startFramePublishing");
+    _stopFramePublishing = _api!.lookupFunction<stopFramePublishingN, stopFramePublishingD>("stopFramePublishing");
+    _openSharedFrames = _api!.lookupFunction<openSharedFramesN, openSharedFramesD>("openSharedFrames");
+    _readSharedFrame = _api!.lookupFunction<readSharedFrameN, readSharedFrameD>("readSharedFrame");
+    _closeSharedFrames = _api!.lookupFunction<closeSharedFramesN, closeSharedFramesD>("closeSharedFrames");
+    _compareTolerance = _api!.lookupFunction<compareToleranceN, compareToleranceD>("compareTolerance");
+    _shiftedCompare = _api!.lookupFunction<shiftedCompareN, shiftedCompareD>("shiftedCompare");
+    _findTemplate = _api!.lookupFunction<findTemplateN, findTemplateD>("findTemplate");
+    _compareBatch = _api!.lookupFunction<compareBatchN, compareBatchD>("compareBatch");
     _getPixelOfWindow = _api!.lookupFunction<getPixelOfWindowN, getPixelOfWindowD>("getPixelOfWindow");
+    _getPixelsOfWindow = _api!.lookupFunction<getPixelsOfWindowN, getPixelsOfWindowD>("getPixelsOfWindow");
+    _initDartApi = _api!.lookupFunction<initDartApiN, initDartApiD>("initDartApi");
+    _addPixelWatch = _api!.lookupFunction<addPixelWatchN, addPixelWatchD>("addPixelWatch");
+    _addRegionWatch = _api!.lookupFunction<addRegionWatchN, addRegionWatchD>("addRegionWatch");
+    _removeWatch = _api!.lookupFunction<removeWatchN, removeWatchD>("removeWatch");
+    _removeAllWatches = _api!.lookupFunction<removeAllWatchesN, removeAllWatchesD>("removeAllWatches");
+    _startWindowEvents = _api!.lookupFunction<startWindowEventsN, startWindowEventsD>("startWindowEvents");
+    _stopWindowEvents = _api!.lookupFunction<stopWindowEventsN, stopWindowEventsD>("stopWindowEvents");
     _getDisplayMousePos = _api!.lookupFunction<getDisplayMousePosN, getDisplayMousePosN>("getDisplayMousePos");
     _getWindowMousePos = _api!.lookupFunction<getWindowMousePosN, getWindowMousePosD>("getWindowMousePos");
     _setDisplayMousePos = _api!.lookupFunction<setDisplayMousePosN, setDisplayMousePosD>("setDisplayMousePos");
@@ -276,6 +744,18 @@ final class NativeWindow {
     return true;
   }
 
+  /// Initializes the [instance] inside of a background isolate (for example in [Isolate.run]) after
+  /// [initNativeWindow] was done on the main isolate. The windows and the config are shared by all isolates in native
+  /// code, so only the functions are looked up again. Background isolates should only use the window query, capture,
+  /// pixel, compare and input functions and never init windows, or start and stop native threads (see the threading
+  /// contract in native_window.hpp). Multiple calls have no effect.
+  static void initForBackgroundIsolate() {
+    if (_nativeWindowInstance == null) {
+      _api ??= FFILoader.api;
+      _nativeWindowInstance = NativeWindow._();
+    }
+  }
+
   /// Searches a window with the [name] and returns if it was found
   bool isWindowOpen(int windowID) {
     return _isWindowOpen.call(windowID);
@@ -316,6 +796,42 @@ final class NativeWindow {
     return Point<int>(size.x, size.y);
   }
 
+  /// Same as [isWindowOpen], [hasWindowFocus], [getWindowSize] and [getWindowBounds] for all [windowIDs] together
+  /// with a single FFI call. The states have the same order as the [windowIDs] (size and bounds are null if the
+  /// window is not open)
+  List<NativeWindowState> queryWindowStates(List<int> windowIDs) {
+    if (windowIDs.isEmpty) {
+      return <NativeWindowState>[];
+    }
+    final Pointer<Int> ids = calloc<Int>(windowIDs.length);
+    final Pointer<_WindowState> states = calloc<_WindowState>(windowIDs.length);
+    for (int i = 0; i < windowIDs.length; ++i) {
+      ids[i] = windowIDs[i];
+    }
+    _queryWindowStates.call(ids, windowIDs.length, states);
+    final List<NativeWindowState> result = List<NativeWindowState>.generate(windowIDs.length, (int i) {
+      final _WindowState state = states[i];
+      final bool invalidSize = state.size.x == _INVALID_VALUE || state.size.y == _INVALID_VALUE;
+      final bool invalidBounds = state.bounds.left == _INVALID_VALUE && state.bounds.top == _INVALID_VALUE;
+      return (
+        open: state.open == 1,
+        focus: state.focus == 1,
+        size: invalidSize ? null : Point<int>(state.size.x, state.size.y),
+        bounds: invalidBounds
+            ? null
+            : Bounds<int>.sides(
+                left: state.bounds.left,
+                top: state.bounds.top,
+                right: state.bounds.right,
+                bottom: state.bounds.bottom,
+              ),
+      );
+    });
+    calloc.free(ids);
+    calloc.free(states);
+    return result;
+  }
+
   /// Full size of the whole screen
   int getMainDisplayWidth() {
     return _getMainDisplayWidth.call();
@@ -331,18 +847,127 @@ final class NativeWindow {
     return _closeWindow.call(windowID);
   }
 
-  /// Only use this to free [data] allocated by native c/c++ code!
+  /// Only use this to free [data] allocated by native c/c++ code! Image data is returned into the native buffer pool
+  /// so that the next capture of a similar size can reuse it (see [getBufferPoolStats])
   void cleanupMemory(Pointer<UnsignedChar> data) {
     _cleanupMemory.call(data);
   }
 
+  /// Current usage of the native image buffer pool (only for debugging and tests)
+  NativeBufferPoolStats getBufferPoolStats() {
+    final _BufferPoolStats stats = _getBufferPoolStats.call();
+    final int allocations = stats.hits + stats.misses;
+    return (
+      liveBuffers: stats.liveBuffers,
+      liveBytes: stats.liveBytes,
+      pooledBuffers: stats.pooledBuffers,
+      pooledBytes: stats.pooledBytes,
+      hits: stats.hits,
+      misses: stats.misses,
+      hitRate: allocations > 0 ? stats.hits / allocations : 0.0,
+    );
+  }
+
+  /// Frees all pooled image buffers that are currently not used (buffers that are still owned by dart stay valid)
+  void trimBufferPool() {
+    _trimBufferPool.call();
+  }
+
+  /// Replaces the screen with the synthetic [source] for all window, display and capture functions, or switches back
+  /// to the screen with [NativeFrameSource.SCREEN] (then the other parameters are ignored). The synthetic window is
+  /// found by [initWindow] with its [windowTitle] like a real window and is placed at (0, 0) of a main display with
+  /// its inner size [width] x [height] (without borders). Frames only change with [setSourceFrame].
+  ///
+  /// For [NativeFrameSource.FILES] the native code loads the raw .bgra and .ppm files of the [directory] and then the
+  /// png files are decoded with opencv and added after them (both sorted by name). If [width] or [height] is 0, then
+  /// the size of the first frame is used. Frames of a different size are skipped.
+  ///
+  /// For [NativeFrameSource.REPLAY] the [recording] file of [GameWindow.startRecording] is replayed with the recorded
+  /// window bounds and sizes (so [width] and [height] are ignored) at the speed of [setReplaySpeed]. The window is
+  /// closed after the last frame.
+  ///
+  /// Returns false if the source could not be set (for example if the directory does not exist).
+  Future<bool> setFrameSource(
+    NativeFrameSource source, {
+    String windowTitle = "Synthetic Window",
+    int width = 0,
+    int height = 0,
+    String? directory,
+    String? recording,
+  }) async {
+    final Pointer<Utf8> title = windowTitle.toNativeUtf8();
+    final Pointer<Utf8> path = ((source == NativeFrameSource.REPLAY ? recording : directory) ?? "").toNativeUtf8();
+    final bool success = _setFrameSource.call(source.index, title, width, height, path);
+    malloc.free(title);
+    malloc.free(path);
+    if (success == false || source != NativeFrameSource.FILES || directory == null) {
+      return success;
+    }
+    final List<String> files = await FileUtils.getFilesInDirectory(directory, skipDirectories: true);
+    final List<String> pngFiles = <String>[
+      for (final String file in files)
+        if (FileUtils.getExtension(file).toLowerCase() == ".png") file,
+    ];
+    pngFiles.sort();
+    for (final String file in pngFiles) {
+      final cv.Mat bgr = await cv.imreadAsync(file, flags: cv.IMREAD_COLOR);
+      final cv.Mat bgra = await cv.cvtColorAsync(bgr, cv.COLOR_BGR2BGRA);
+      if (_addSourceFrame.call(bgra.dataPtr.cast<UnsignedChar>(), bgra.width, bgra.height) == false) {
+        Logger.warn("Skipped frame $file with a different size than the synthetic window");
+      }
+      bgr.dispose();
+      bgra.dispose();
+    }
+    return true;
+  }
+
+  /// Returns the source that is currently used for all window, display and capture functions
+  NativeFrameSource getFrameSource() {
+    return NativeFrameSource.values[_getFrameSource.call()];
+  }
+
+  /// Amount of frames of a [NativeFrameSource.FILES] or [NativeFrameSource.REPLAY] source (0 for the other sources)
+  int getSourceFrameCount() {
+    return _getSourceFrameCount.call();
+  }
+
+  /// Shows the frame with the [frameNumber] (starting at 0) in all following captures of a synthetic source. The
+  /// frames of a [NativeFrameSource.FILES] source wrap around and the window of a [NativeFrameSource.REPLAY] source is
+  /// closed after its last frame (a replay with a speed continues from the frame). Returns false if the screen is used
+  bool setSourceFrame(int frameNumber) {
+    return _setSourceFrame.call(frameNumber);
+  }
+
+  /// Frame number that is currently shown by a synthetic source (the [getSourceFrameCount] after the end of a
+  /// [NativeFrameSource.REPLAY]), or -1 if the screen is used
+  int getSourceFrame() {
+    return _getSourceFrame.call();
+  }
+
+  /// Changes the speed of a [NativeFrameSource.REPLAY] source relative to the recorded time (1 is the wall clock speed
+  /// and 2 twice as fast) and continues from the current frame. With a [speed] of 0 the frames only change with
+  /// [setSourceFrame], so they can be replayed as fast as they are analysed. Returns false if no replay is active
+  bool setReplaySpeed(double speed) {
+    return _setReplaySpeed.call(speed);
+  }
+
   /// Returns an Image displaying the whole main display
   /// For [imageType], look at [NativeImageType] docs!
   Future<NativeImage> getFullMainDisplay(NativeImageType imageType) async {
     final int width = getMainDisplayWidth();
     final int height = getMainDisplayHeight();
-    final Pointer<UnsignedChar> data = _getFullMainDisplay.call();
-    return NativeImage.nativeAsync(width: width, height: height, data: data, targetType: imageType);
+    final NativeImageType captureType = _captureType(imageType);
+    final Pointer<UnsignedChar> data = await captureAsync(_mainDisplaySession, 0, 0, width, height, captureType);
+    if (data.address == 0) {
+      throw ImageException(message: "Could not capture the main display");
+    }
+    return NativeImage.nativeAsync(
+      width: width,
+      height: height,
+      data: data,
+      dataType: captureType,
+      targetType: imageType,
+    );
   }
 
   /// Returns an image displaying the whole outer window within the [getWindowBounds] with top bar, etc. Also look at
@@ -350,8 +975,19 @@ final class NativeWindow {
   /// For [imageType], look at [NativeImageType] docs!
   Future<NativeImage?> getFullOuterWindow(int windowID, NativeImageType imageType) async {
     final Bounds<int>? bounds = getWindowBounds(windowID);
-    final Pointer<UnsignedChar> data = _getFullWindow.call(windowID);
-    if (bounds == null || data.address == 0) {
+    if (bounds == null) {
+      return null;
+    }
+    final NativeImageType captureType = _captureType(imageType);
+    final Pointer<UnsignedChar> data = await captureAsync(
+      windowID,
+      bounds.x,
+      bounds.y,
+      bounds.width,
+      bounds.height,
+      captureType,
+    );
+    if (data.address == 0) {
       return null;
     }
     return NativeImage.nativeAsync(
@@ -360,6 +996,7 @@ final class NativeWindow {
       data: data,
       logXPos: 0,
       logYPos: 0,
+      dataType: captureType,
       targetType: imageType,
     );
   }
@@ -367,28 +1004,525 @@ final class NativeWindow {
   /// Returns an image, or screenshot in screen coordinates [x], [y], [width], [height] which does not check if the
   /// window is open first. But this is used to retrieve the inner game window without top bar and bounds! Also look
   /// at [getFullOuterWindow]. For [imageType], look at [NativeImageType] docs!
+  ///
+  /// If [reuseImage] is not null and its [NativeImage.reusableNativeData] matches the size and [imageType], then the
+  /// screenshot will be written directly into its memory with [captureInto] and the same [reuseImage] is returned
+  /// instead of allocating a new image. Otherwise a new image is returned. The [reuseImage] is a scratch buffer that
+  /// must only be owned by the caller (its pixels change for every holder of it).
+  ///
+  /// With a [downscale] factor bigger than 1 the returned image is averaged down natively while capturing (see
+  /// [captureAsync]) and only has [width] ~/ downscale x [height] ~/ downscale pixel ([reuseImage] is then ignored).
   Future<NativeImage?> getImageOfWindow(
     int windowID,
     int x,
     int y,
     int width,
     int height,
-    NativeImageType imageType,
-  ) async {
-    final Pointer<UnsignedChar> data = _getImageOfWindow.call(windowID, x, y, width, height);
+    NativeImageType imageType, [
+    NativeImage? reuseImage,
+    int downscale = 1,
+  ]) async {
+    final Pointer<UnsignedChar>? reusable = downscale == 1
+        ? reuseImage?.reusableNativeData(width, height, imageType)
+        : null;
+    if (reusable != null) {
+      if (captureInto(windowID, x, y, width, height, reusable, width * 4)) {
+        return reuseImage;
+      }
+      return null;
+    }
+    final NativeImageType captureType = _captureType(imageType);
+    final Pointer<UnsignedChar> data = await captureAsync(windowID, x, y, width, height, captureType, downscale);
     if (data.address == 0) {
       return null;
     }
     return NativeImage.nativeAsync(
-      width: width,
-      height: height,
+      width: width ~/ downscale,
+      height: height ~/ downscale,
       data: data,
       logXPos: x,
       logYPos: y,
+      dataType: captureType,
       targetType: imageType,
     );
   }
 
+  /// Captures are directly converted into the [imageType], but [NativeImageType.NONE] keeps the default BGRA (the
+  /// same as [NativeImage.changeTypeAsync] which does not change anything for it)
+  static NativeImageType _captureType(NativeImageType imageType) =>
+      imageType == NativeImageType.NONE ? NativeImageType.RGBA : imageType;
+
+  /// _MAIN_DISPLAY_SESSION of capture_session.hpp (captures that are not related to a window)
+  static const int _mainDisplaySession = -1;
+
+  /// Receives the results of [captureAsync] (only open while captures are pending, so it does not keep the isolate
+  /// alive)
+  ReceivePort? _capturePort;
+
+  final Map<int, Completer<Pointer<UnsignedChar>>> _pendingCaptures = <int, Completer<Pointer<UnsignedChar>>>{};
+
+  int _nextCaptureRequest = 0;
+
+  /// Captures the screen coordinates [x], [y], [width], [height] on a native task thread, so this isolate is not
+  /// blocked while the capture runs (the same as the native getImageOfWindow otherwise). Completes with nullptr if
+  /// the capture failed, or otherwise with new native memory that has to be freed with [cleanupMemory] (which
+  /// [NativeImage.nativeAsync] does automatically). Used for [getImageOfWindow].
+  ///
+  /// The memory contains the pixel in the format of the [imageType] (so 1, 3, or 4 channels with the same layout as
+  /// opencv and BGRA per default). The native code converts the pixel while it copies them out of the capture, so
+  /// this is faster than converting a BGRA image afterwards.
+  ///
+  /// If [downscale] is bigger than 1 (up to 16), then every block of downscale x downscale pixel is averaged into one
+  /// pixel, so the memory only contains [width] ~/ downscale x [height] ~/ downscale pixel (the remaining pixel at the
+  /// right and bottom are cut off). This is a lot faster for everything that reads the image afterwards.
+  Future<Pointer<UnsignedChar>> captureAsync(
+    int windowID,
+    int x,
+    int y,
+    int width,
+    int height, [
+    NativeImageType imageType = NativeImageType.RGBA,
+    int downscale = 1,
+  ]) {
+    _initDartApiOnce();
+    if (_capturePort == null) {
+      _capturePort = ReceivePort();
+      _capturePort!.listen(_onCaptureDone);
+    }
+    final int requestID = _nextCaptureRequest++;
+    final Completer<Pointer<UnsignedChar>> completer = Completer<Pointer<UnsignedChar>>();
+    _pendingCaptures[requestID] = completer;
+    final int nativePort = _capturePort!.sendPort.nativePort;
+    // the native PIXEL_FORMAT_ values are the same as the indexes of the image types
+    if (_captureAsync.call(windowID, x, y, width, height, imageType.index, downscale, requestID, nativePort) ==
+        false) {
+      _pendingCaptures.remove(requestID);
+      _closeIdleCapturePort();
+      return Future<Pointer<UnsignedChar>>.value(nullptr);
+    }
+    return completer.future;
+  }
+
+  /// Native code posts [requestID, address] for every capture of [captureAsync]
+  void _onCaptureDone(dynamic message) {
+    if (message is List<dynamic> && message.length == 2) {
+      final Completer<Pointer<UnsignedChar>>? completer = _pendingCaptures.remove(message[0] as int);
+      completer?.complete(Pointer<UnsignedChar>.fromAddress(message[1] as int));
+      _closeIdleCapturePort();
+    }
+  }
+
+  void _closeIdleCapturePort() {
+    if (_pendingCaptures.isEmpty) {
+      _capturePort?.close();
+      _capturePort = null;
+    }
+  }
+
+  /// Writes a screenshot in screen coordinates [x], [y], [width], [height] as BGRA into the memory of [target] which is
+  /// owned by the caller and must contain at least [height] rows of [stride] bytes (at least [width] * 4).
+  /// Returns false if nothing could be captured. Used for [getImageOfWindow] to reuse images.
+  bool captureInto(int windowID, int x, int y, int width, int height, Pointer<UnsignedChar> target, int stride) {
+    return _captureInto.call(windowID, x, y, width, height, target, stride);
+  }
+
+  /// Captures all [regions] in screen coordinates at once (the native code captures their bounding box only once and
+  /// copies the regions out of it) and returns the images in the same order. An image is null if its region was
+  /// empty, or if the capture failed.
+  /// This is faster than multiple [getImageOfWindow] calls if the regions are close to each other!
+  Future<List<NativeImage?>> getImagesOfWindow(
+    int windowID,
+    List<Bounds<int>> regions,
+    NativeImageType imageType,
+  ) async {
+    if (regions.isEmpty) {
+      return <NativeImage?>[];
+    }
+    final Pointer<_Rect> rects = calloc<_Rect>(regions.length);
+    final Pointer<Pointer<UnsignedChar>> buffers = calloc<Pointer<UnsignedChar>>(regions.length); // filled by native
+    for (int i = 0; i < regions.length; ++i) {
+      rects[i].left = regions[i].left;
+      rects[i].top = regions[i].top;
+      rects[i].right = regions[i].right;
+      rects[i].bottom = regions[i].bottom;
+    }
+    final int captured = _captureRegions.call(windowID, rects, regions.length, buffers);
+    final List<NativeImage?> images = <NativeImage?>[];
+    for (int i = 0; i < regions.length; ++i) {
+      final Pointer<UnsignedChar> data = buffers[i];
+      if (data.address == 0) {
+        images.add(null);
+      } else if (captured == 0) {
+        _cleanupMemory.call(data); // should not happen, but never leak
+        images.add(null);
+      } else {
+        images.add(
+          await NativeImage.nativeAsync(
+            width: regions[i].width,
+            height: regions[i].height,
+            data: data,
+            logXPos: regions[i].x,
+            logYPos: regions[i].y,
+            targetType: imageType,
+          ),
+        );
+      }
+    }
+    calloc.free(rects);
+    calloc.free(buffers);
+    return images;
+  }
+
+  /// Starts (or restarts) a native background thread that captures the whole inner window [framesPerSecond] times per
+  /// second into a triple buffer which can then be read with [acquireLatestFrame]. Returns false for invalid args.
+  bool startCaptureThread(int windowID, int framesPerSecond) {
+    return _startCaptureThread.call(windowID, framesPerSecond);
+  }
+
+  /// Stops the thread of [startCaptureThread] and frees its memory (also invalidates all frames)
+  void stopCaptureThread(int windowID) {
+    _stopCaptureThread.call(windowID);
+  }
+
+  /// Returns how many tiles of the [area] (relative to the inner window) changed in the frames of the
+  /// [startCaptureThread] after [sinceFrame] (see [GameWindow.changedTiles]), or -1 if it can not be detected
+  int changedTiles(int windowID, Bounds<int> area, int sinceFrame) {
+    final Pointer<_Rect> rect = calloc<_Rect>();
+    rect.ref.left = area.left;
+    rect.ref.top = area.top;
+    rect.ref.right = area.right;
+    rect.ref.bottom = area.bottom;
+    final int changed = _changedTiles.call(windowID, rect.ref, sinceFrame);
+    calloc.free(rect);
+    return changed;
+  }
+
+  /// Returns the newest frame of the [startCaptureThread] without waiting for a capture and the frame number which
+  /// is incremented for every new frame. Returns null if there is no frame yet.
+  ///
+  /// Important: the returned image only references native memory (see [NativeImage.nativeReference]) which is only
+  /// valid until the next call of this, or [stopCaptureThread]. So it has to be copied if it should be kept!
+  (NativeImage, int)? acquireLatestFrame(int windowID) {
+    final _LatestFrame frame = _acquireLatestFrame.call(windowID);
+    if (frame.data.address == 0 || frame.width <= 0 || frame.height <= 0) {
+      return null;
+    }
+    return (
+      NativeImage.nativeReference(width: frame.width, height: frame.height, data: frame.data),
+      frame.frameNumber,
+    );
+  }
+
+  /// Records every frame of the [startCaptureThread] of the window into a new file at [path] until [stopRecording]
+  /// (see [GameWindow.startRecording]). Every [keyframeInterval] recorded frame is stored completely (0 for only the
+  /// first frame and frames with a new size). Returns false for invalid args, or if the file could not be created.
+  bool startRecording(int windowID, String path, int keyframeInterval) {
+    final Pointer<Utf8> nativePath = path.toNativeUtf8();
+    final bool success = _startRecording.call(windowID, nativePath, keyframeInterval);
+    malloc.free(nativePath);
+    return success;
+  }
+
+  /// Stops the recording of [startRecording] after all captured frames are written and returns its final statistics
+  NativeRecordingStats stopRecording(int windowID) => _convertRecordingStats(_stopRecording.call(windowID));
+
+  /// Current statistics of the recording of [startRecording] (all 0 if the window is not recorded)
+  NativeRecordingStats getRecordingStats(int windowID) => _convertRecordingStats(_getRecordingStats.call(windowID));
+
+  NativeRecordingStats _convertRecordingStats(_RecordingStats stats) => (
+    records: stats.records,
+    keyframes: stats.keyframes,
+    droppedFrames: stats.droppedFrames,
+    rawBytes: stats.rawBytes,
+    writtenBytes: stats.writtenBytes,
+  );
+
+  /// Opens and indexes a recording of [startRecording] at [path] and returns the id of the reader for the other
+  /// recording functions, or -1 if it is not a recording (see [NativeRecording])
+  int openRecording(String path) {
+    final Pointer<Utf8> nativePath = path.toNativeUtf8();
+    final int readerID = _openRecording.call(nativePath);
+    malloc.free(nativePath);
+    return readerID;
+  }
+
+  /// Summary of the recording of the reader of [openRecording]
+  NativeRecordingInfo getRecordingInfo(int readerID) {
+    final _RecordingInfo info = _getRecordingInfo.call(readerID);
+    return (
+      frames: info.frames,
+      keyframes: info.keyframes,
+      firstTimestamp: Duration(microseconds: info.firstTimestamp),
+      lastTimestamp: Duration(microseconds: info.lastTimestamp),
+      startTime: DateTime.fromMicrosecondsSinceEpoch(info.startTime),
+    );
+  }
+
+  /// Returns the recorded frame that was shown at the [timestamp] (since the start of the recording, or the first
+  /// frame for earlier timestamps) as a new [NativeImageType.RGBA] image of the inner window with its details.
+  /// Reading the frames in order is faster than jumping around. Returns null if the reader does not exist, or the
+  /// file is corrupted.
+  (NativeImage, NativeRecordedFrame)? readRecordedFrame(int readerID, Duration timestamp) {
+    final Pointer<_RecordedFrame> frame = calloc<_RecordedFrame>();
+    final Pointer<UnsignedChar> data = _readRecordedFrame.call(readerID, timestamp.inMicroseconds, frame);
+    (NativeImage, NativeRecordedFrame)? result;
+    if (data.address != 0) {
+      final _RecordedFrame details = frame.ref;
+      result = (
+        NativeImage.nativeSync(
+          width: details.width,
+          height: details.height,
+          data: data,
+          targetType: NativeImageType.RGBA,
+        ),
+        (
+          bounds: Bounds<int>.sides(
+            left: details.bounds.left,
+            top: details.bounds.top,
+            right: details.bounds.right,
+            bottom: details.bounds.bottom,
+          ),
+          timestamp: Duration(microseconds: details.timestamp),
+          frameNumber: details.frameNumber,
+          nextTimestamp: details.nextTimestamp >= 0 ? Duration(microseconds: details.nextTimestamp) : null,
+        ),
+      );
+    }
+    calloc.free(frame);
+    return result;
+  }
+
+  /// Closes the reader of [openRecording]
+  void closeRecording(int readerID) {
+    _closeRecording.call(readerID);
+  }
+
+  /// Publishes every frame of the [startCaptureThread] of the window into a named shared memory ring of [slotCount]
+  /// frames of at most [maxWidth] x [maxHeight] pixels (0 for the main display size), so that other processes can read
+  /// them (see [GameWindow.startFramePublishing]). Returns false for invalid args, or if the memory was not created
+  bool startFramePublishing(int windowID, String name, int slotCount, int maxWidth, int maxHeight) {
+    final Pointer<Utf8> nativeName = name.toNativeUtf8();
+    final bool success = _startFramePublishing.call(windowID, nativeName, slotCount, maxWidth, maxHeight);
+    malloc.free(nativeName);
+    return success;
+  }
+
+  /// Stops the publishing of [startFramePublishing] and returns the amount of published frames
+  int stopFramePublishing(int windowID) => _stopFramePublishing.call(windowID);
+
+  /// Maps the shared memory of a publisher of [startFramePublishing] (also of another process) with the [name] and
+  /// returns the id of the reader for the other shared frame functions, or -1 if there is no publisher (see
+  /// [NativeSharedFrames])
+  int openSharedFrames(String name) {
+    final Pointer<Utf8> nativeName = name.toNativeUtf8();
+    final int readerID = _openSharedFrames.call(nativeName);
+    malloc.free(nativeName);
+    return readerID;
+  }
+
+  /// Returns a copy of the newest published frame of the reader of [openSharedFrames] as a new [NativeImageType.RGBA]
+  /// image with its details. The copy is checked to be complete, so the publisher never has to wait. Returns null if
+  /// there is no frame yet, or if the publisher stopped.
+  (NativeImage, NativeSharedFrame)? readSharedFrame(int readerID) {
+    final Pointer<_SharedFrame> frame = calloc<_SharedFrame>();
+    final Pointer<UnsignedChar> data = _readSharedFrame.call(readerID, frame);
+    (NativeImage, NativeSharedFrame)? result;
+    if (data.address != 0) {
+      final _SharedFrame details = frame.ref;
+      result = (
+        NativeImage.nativeSync(
+          width: details.width,
+          height: details.height,
+          data: data,
+          targetType: NativeImageType.RGBA,
+        ),
+        (
+          bounds: Bounds<int>.sides(
+            left: details.bounds.left,
+            top: details.bounds.top,
+            right: details.bounds.right,
+            bottom: details.bounds.bottom,
+          ),
+          frameNumber: details.frameNumber,
+          published: DateTime.fromMicrosecondsSinceEpoch(details.timestamp),
+        ),
+      );
+    }
+    calloc.free(frame);
+    return result;
+  }
+
+  /// Closes the reader of [openSharedFrames]
+  void closeSharedFrames(int readerID) {
+    _closeSharedFrames.call(readerID);
+  }
+
+  /// Native pixel per pixel comparison of the area [width] x [height] of two images [a] and [b] with rows of
+  /// [strideA] / [strideB] bytes and [channelsA] / [channelsB] channels (same semantics as [NativeImage.equals]).
+  /// Returns how many pixels have a change higher than [threshold], but stops counting after the row in which more
+  /// than [maxBad] pixels were found. Returns -1 if the channels can not be compared.
+  int compareTolerance(
+    Pointer<UnsignedChar> a,
+    int strideA,
+    int channelsA,
+    Pointer<UnsignedChar> b,
+    int strideB,
+    int channelsB,
+    int width,
+    int height,
+    int threshold,
+    int maxBad, {
+    required bool ignoreAlpha,
+  }) {
+    return _compareTolerance.call(
+      a,
+      strideA,
+      channelsA,
+      b,
+      strideB,
+      channelsB,
+      width,
+      height,
+      threshold,
+      maxBad,
+      ignoreAlpha,
+    );
+  }
+
+  /// Same as [compareTolerance], but for all relative offsets up to [maxShift] pixels in each direction at once in a
+  /// single pass over both images (see [NativeImage.shiftedEquals]). [width] and [height] must be the minimum size of
+  /// both images. Returns 1 if any offset was equal, 0 if not and -1 if the channels can not be compared.
+  int shiftedCompare(
+    Pointer<UnsignedChar> a,
+    int strideA,
+    int channelsA,
+    Pointer<UnsignedChar> b,
+    int strideB,
+    int channelsB,
+    int width,
+    int height,
+    int maxShift,
+    int threshold,
+    int maxBad, {
+    required bool ignoreAlpha,
+  }) {
+    return _shiftedCompare.call(
+      a,
+      strideA,
+      channelsA,
+      b,
+      strideB,
+      channelsB,
+      width,
+      height,
+      maxShift,
+      threshold,
+      maxBad,
+      ignoreAlpha,
+      nullptr,
+      nullptr,
+    );
+  }
+
+  /// Searches the [template] (with rows of [templateStride] bytes) inside of the [image] (only inside of the
+  /// [searchArea] of it if not null) with a native coarse to fine search (see [NativeImage.findTemplate]).
+  /// Returns the top left corner of the best match and its confidence from -1 to 1, or null if nothing was found.
+  (int, int, double)? findTemplate(
+    Pointer<UnsignedChar> image,
+    int imageStride,
+    int imageChannels,
+    int imageWidth,
+    int imageHeight,
+    Pointer<UnsignedChar> template,
+    int templateStride,
+    int templateChannels,
+    int templateWidth,
+    int templateHeight,
+    Bounds<int>? searchArea,
+  ) {
+    Pointer<_Rect> area = nullptr;
+    if (searchArea != null) {
+      area = calloc<_Rect>();
+      area.ref.left = searchArea.left;
+      area.ref.top = searchArea.top;
+      area.ref.right = searchArea.right;
+      area.ref.bottom = searchArea.bottom;
+    }
+    final _TemplateMatch match = _findTemplate.call(
+      image,
+      imageStride,
+      imageChannels,
+      imageWidth,
+      imageHeight,
+      template,
+      templateStride,
+      templateChannels,
+      templateWidth,
+      templateHeight,
+      area,
+    );
+    if (area != nullptr) {
+      calloc.free(area);
+    }
+    if (match.x < 0 || match.y < 0) {
+      return null;
+    }
+    return (match.x, match.y, match.confidence);
+  }
+
+  /// Same as [shiftedCompare] of every image in [images] against the area of the [frame] at its [x], [y] position,
+  /// but all at once in parallel on native worker threads (see [NativeImage.shiftedEqualsBatch]). Areas are clipped
+  /// to the frame. Returns one result per image (true if it was equal).
+  List<bool> compareBatch(
+    Pointer<UnsignedChar> frame,
+    int frameStride,
+    int frameChannels,
+    int frameWidth,
+    int frameHeight,
+    List<({Pointer<UnsignedChar> data, int stride, int channels, int width, int height, int x, int y})> images, {
+    required int threshold,
+    required int maxBad,
+    required int maxShift,
+    required bool ignoreAlpha,
+  }) {
+    if (images.isEmpty) {
+      return <bool>[];
+    }
+    final Pointer<_CompareJob> jobs = calloc<_CompareJob>(images.length);
+    final Pointer<UnsignedChar> results = calloc<UnsignedChar>((images.length + 7) ~/ 8);
+    for (int i = 0; i < images.length; ++i) {
+      final _CompareJob job = jobs[i];
+      job.data = images[i].data;
+      job.stride = images[i].stride;
+      job.channels = images[i].channels;
+      job.width = images[i].width;
+      job.height = images[i].height;
+      job.x = images[i].x;
+      job.y = images[i].y;
+      job.threshold = threshold;
+      job.maxBad = maxBad;
+      job.maxShift = maxShift;
+      job.ignoreAlpha = ignoreAlpha;
+    }
+    final int equal = _compareBatch.call(
+      frame,
+      frameStride,
+      frameChannels,
+      frameWidth,
+      frameHeight,
+      jobs,
+      images.length,
+      results,
+    );
+    final List<bool> shown = List<bool>.generate(
+      images.length,
+      (int i) => equal > 0 && (results[i ~/ 8] & (1 << (i % 8))) != 0,
+    );
+    calloc.free(jobs);
+    calloc.free(results);
+    return shown;
+  }
+
   /// Returns a pixel in screen coordinates [x], [y] (needs to be matched to window position)
   Color? getPixelOfWindow(int x, int y) {
     final int pixel = _getPixelOfWindow(x, y);
@@ -398,6 +1532,139 @@ final class NativeWindow {
     return Color.fromARGB(255, pixel, pixel >> 8, pixel >> 16);
   }
 
+  /// Same as [getPixelOfWindow] for all [points] in screen coordinates, but they are captured together with one FFI
+  /// call (close points with a single capture of their bounding box). The colors have the same order as the [points]
+  /// and are null for points outside of the display
+  List<Color?> getPixelsOfWindow(int windowID, List<Point<int>> points) {
+    if (points.isEmpty) {
+      return <Color?>[];
+    }
+    final Pointer<_Point> nativePoints = calloc<_Point>(points.length);
+    final Pointer<UnsignedLong> colors = calloc<UnsignedLong>(points.length);
+    for (int i = 0; i < points.length; ++i) {
+      nativePoints[i].x = points[i].x;
+      nativePoints[i].y = points[i].y;
+    }
+    _getPixelsOfWindow.call(windowID, nativePoints, points.length, colors);
+    final List<Color?> result = List<Color?>.generate(points.length, (int i) {
+      final int pixel = colors[i];
+      if (pixel == _INVALID_PIXEL) {
+        return null;
+      }
+      return Color.fromARGB(255, pixel, pixel >> 8, pixel >> 16);
+    });
+    calloc.free(nativePoints);
+    calloc.free(colors);
+    return result;
+  }
+
+  bool _dartApiInitialized = false;
+
+  /// The native watches post into dart ports, so the dart api has to be initialized once in native code first
+  void _initDartApiOnce() {
+    if (_dartApiInitialized == false) {
+      _dartApiInitialized = _initDartApi.call(NativeApi.initializeApiDLData);
+      if (_dartApiInitialized == false) {
+        throw const ConfigException(message: "NativeWindow: the dart api version is not supported by native code");
+      }
+    }
+  }
+
+  /// Starts a native watch of the [points] (relative to the top left corner of the inner window) which posts true
+  /// into the [nativePort] if all of them have the expected [colors] (with the sum of the absolute differences of the
+  /// color channels not higher than [tolerance]) and false otherwise. It is checked every [interval] on a native
+  /// thread, but only posts the first state and then only when it flips.
+  /// Returns the id for [removeWatch], or -1 for invalid arguments.
+  int addPixelWatch(
+    int windowID,
+    List<Point<int>> points,
+    List<Color> colors,
+    int tolerance,
+    Duration interval,
+    int nativePort,
+  ) {
+    if (points.isEmpty || points.length != colors.length) {
+      return -1;
+    }
+    _initDartApiOnce();
+    final Pointer<_Point> nativePoints = calloc<_Point>(points.length);
+    final Pointer<UnsignedLong> nativeColors = calloc<UnsignedLong>(points.length);
+    for (int i = 0; i < points.length; ++i) {
+      nativePoints[i].x = points[i].x;
+      nativePoints[i].y = points[i].y;
+      nativeColors[i] = colors[i].redI | (colors[i].greenI << 8) | (colors[i].blueI << 16);
+    }
+    final int watchID = _addPixelWatch.call(
+      windowID,
+      nativePoints,
+      nativeColors,
+      points.length,
+      tolerance,
+      interval.inMilliseconds,
+      nativePort,
+    );
+    calloc.free(nativePoints);
+    calloc.free(nativeColors);
+    return watchID;
+  }
+
+  /// Same as [addPixelWatch], but the watch posts true while the [area] (relative to the top left corner of the
+  /// inner window) is still equal to its first capture (with the same semantics as [compareTolerance] with
+  /// [threshold] and [maxBad]) and false once it changed.
+  int addRegionWatch(
+    int windowID,
+    Bounds<int> area,
+    int threshold,
+    int maxBad,
+    Duration interval,
+    int nativePort,
+  ) {
+    _initDartApiOnce();
+    final Pointer<_Rect> nativeArea = calloc<_Rect>();
+    nativeArea.ref.left = area.left;
+    nativeArea.ref.top = area.top;
+    nativeArea.ref.right = area.right;
+    nativeArea.ref.bottom = area.bottom;
+    final int watchID = _addRegionWatch.call(
+      windowID,
+      nativeArea,
+      nullptr,
+      0,
+      threshold,
+      maxBad,
+      interval.inMilliseconds,
+      nativePort,
+    );
+    calloc.free(nativeArea);
+    return watchID;
+  }
+
+  /// Stops a watch of [addPixelWatch] or [addRegionWatch] (nothing is posted for it anymore after this returns)
+  bool removeWatch(int watchID) => _removeWatch.call(watchID);
+
+  /// Stops all watches and their native thread
+  void removeAllWatches() => _removeAllWatches.call();
+
+  /// Window event of [startWindowEvents]: the foreground window changed
+  static const int windowEventFocus = 1;
+
+  /// Window event of [startWindowEvents]: a window was opened, closed, shown, hidden, or renamed
+  static const int windowEventOpen = 2;
+
+  /// Window event of [startWindowEvents]: one of the initialized windows was moved, resized, minimized, or restored
+  static const int windowEventBounds = 3;
+
+  /// Posts the window events of the platform as int ([windowEventFocus], [windowEventOpen], [windowEventBounds]) into
+  /// the [nativePort] from a native thread, so the window states only have to be queried after something changed.
+  /// Replaces a previous port. Returns false if the platform has no window events (then they have to be polled).
+  bool startWindowEvents(int nativePort) {
+    _initDartApiOnce();
+    return _startWindowEvents.call(nativePort);
+  }
+
+  /// Stops the events of [startWindowEvents] (nothing is posted anymore after this returns)
+  void stopWindowEvents() => _stopWindowEvents.call();
+
   /// can be on any display
   Point<int> getDisplayMousePos() {
     final _Point point = _getDisplayMousePos.call();
@@ -480,8 +1747,14 @@ final class NativeWindow {
   /// Returns [_nativeWindowInstance] not nullable (only works after [initNativeWindow])
   static NativeWindow get instance => _nativeWindowInstance!;
 
+  /// If [instance] can be used
+  static bool get hasInstance => _nativeWindowInstance != null;
+
   static const int _INVALID_VALUE = 999999999;
 
+  /// Color of [getPixelsOfWindow] for points that could not be captured
+  static const int _INVALID_PIXEL = 0xFFFFFFFF;
+
   /// removes the internal [instance] reference, so mostly used for testing
   static void clearNativeWindowInstance() {
     _nativeWindowInstance = null;
@@ -8,9 +8,13 @@ import 'package:game_tools_lib/core/enums/input/input_enums.dart';
 import 'package:game_tools_lib/core/enums/native_image_type.dart';
 import 'package:game_tools_lib/core/exceptions/exceptions.dart';
 import 'package:game_tools_lib/core/utils/bounds.dart';
+import 'package:game_tools_lib/core/utils/num_utils.dart' show PointExtension;
 import 'package:game_tools_lib/core/utils/utils.dart' show Utils;
 import 'package:game_tools_lib/data/native/native_image.dart';
 import 'package:game_tools_lib/data/native/native_overlay_window.dart';
+import 'package:game_tools_lib/data/native/native_recording.dart';
+import 'package:game_tools_lib/data/native/native_shared_frames.dart';
+import 'package:game_tools_lib/data/native/native_watch.dart';
 import 'package:game_tools_lib/data/native/native_window.dart';
 import 'package:game_tools_lib/domain/entities/base/model.dart';
 import 'package:game_tools_lib/game_tools_lib.dart';
@@ -100,10 +104,39 @@ final class GameWindow with ChangeNotifier {
     return size!.y;
   }
 
+  bool _captureThreadRunning = false;
+
+  /// If the opt-in native capture thread was started with [startCaptureThread]
+  bool get isCaptureThreadRunning => _captureThreadRunning;
+
+  bool _recording = false;
+
+  /// If the frames of the capture thread are recorded with [startRecording]
+  bool get isRecording => _recording;
+
+  bool _publishing = false;
+
+  /// If the frames of the capture thread are published with [startFramePublishing]
+  bool get isPublishingFrames => _publishing;
+
+  int _latestFrameNumber = 0;
+
+  /// Number of the frame that was last returned from [getLatestFrame] (0 if there was none yet). This can be used to
+  /// skip work if the frame did not change since the last time
+  int get latestFrameNumber => _latestFrameNumber;
+
+  int _imageFrameNumber = 0;
+
+  /// Number of the frame of the [startCaptureThread] that the last [getImage] was copied from (0 if it was captured
+  /// directly instead). Can be used with [changedTiles] to detect if that area changed since then
+  int get imageFrameNumber => _imageFrameNumber;
+
   /// Used to keep track of multiple windows
   late final int _windowID;
   static int _counterForWindowID = 0;
-  static const int _maxWindowID = 999;
+
+  /// Same as _MAX_WINDOWS of the native code (the native functions reject higher ids)
+  static const int _maxWindowID = 100;
 
   /// Returns [NativeWindow.instance]
   static NativeWindow get _nativeWindow => NativeWindow.instance;
@@ -150,9 +183,11 @@ final class GameWindow with ChangeNotifier {
   /// and has changed. Otherwise if nothing changed, this returns 0. This is called periodically in the internal event
   /// loop!
   /// If the window had focus and is closed, then this will also update [_hasFocus] and return 2 instead!
-  int updateOpen() {
+  int updateOpen() => _setOpen(_nativeWindow.isWindowOpen(_windowID));
+
+  int _setOpen(bool isOpen) {
     final bool oldOpen = _isOpen;
-    _isOpen = _nativeWindow.isWindowOpen(_windowID);
+    _isOpen = isOpen;
     final bool wasChanged = oldOpen != _isOpen;
     if (wasChanged) {
       if (_isOpen == false && _hasFocus) {
@@ -166,9 +201,11 @@ final class GameWindow with ChangeNotifier {
 
   /// Updates the [hasFocus] (needs to search the window handle for it) and returns if the focus was different before
   /// and has changed. This is called periodically in the internal event loop!
-  bool updateFocus() {
+  bool updateFocus() => _setFocus(_nativeWindow.hasWindowFocus(_windowID));
+
+  bool _setFocus(bool hasFocus) {
     final bool oldFocus = _hasFocus;
-    _hasFocus = _nativeWindow.hasWindowFocus(_windowID);
+    _hasFocus = hasFocus;
     final bool wasChanged = oldFocus != _hasFocus;
     if (wasChanged) {
       notifyListeners();
@@ -202,9 +239,11 @@ final class GameWindow with ChangeNotifier {
 
   /// Updates the [size] (needs to search the window handle for it) and returns if the size was different before
   /// and has changed. This is called periodically in the internal event loop!
-  bool updateSize() {
+  bool updateSize() => _setSize(_nativeWindow.getWindowSize(_windowID));
+
+  bool _setSize(Point<int>? size) {
     final Point<int>? oldSize = _size;
-    _size = _nativeWindow.getWindowSize(_windowID);
+    _size = size;
     final bool wasChanged = oldSize != _size;
     if (wasChanged) {
       notifyListeners();
@@ -212,6 +251,21 @@ final class GameWindow with ChangeNotifier {
     return wasChanged;
   }
 
+  /// Returns the open, focus, size and bounds state of all [windows] (same order) with a single native call. This is
+  /// used in the internal event loop once per tick with [updateOpenFrom], [updateFocusFrom] and [updateSizeFrom]
+  /// instead of calling [updateOpen], [updateFocus] and [updateSize] for each window.
+  static List<NativeWindowState> queryStates(List<GameWindow> windows) =>
+      _nativeWindow.queryWindowStates(windows.map((GameWindow window) => window._windowID).toList());
+
+  /// Same as [updateOpen], but with the [state] of this window from [queryStates]
+  int updateOpenFrom(NativeWindowState state) => _setOpen(state.open);
+
+  /// Same as [updateFocus], but with the [state] of this window from [queryStates]
+  bool updateFocusFrom(NativeWindowState state) => _setFocus(state.focus);
+
+  /// Same as [updateSize], but with the [state] of this window from [queryStates]
+  bool updateSizeFrom(NativeWindowState state) => _setSize(state.size);
+
   /// Mainly used for testing, combines [updateSize] and [size]
   Point<int>? updateAndGetSize() {
     updateSize();
@@ -259,16 +313,49 @@ final class GameWindow with ChangeNotifier {
   ///
   /// Remember that this image might be obscured by your overlay, as an alternative you can use flickering and delayed
   /// [OverlayManager.getWindowImageWithoutOverlay] (should not be used often!)!
+  ///
+  /// If you capture the same area often (like every tick), you can pass the last returned image as [reuseImage], so
+  /// that the new screenshot is written into its memory instead of allocating a new image (then the same object is
+  /// returned if the size and [type] still match, see [NativeImage.reusableNativeData]). Only pass images that you own
+  /// exclusively as scratch buffers: nothing else may still hold, or reference them, because their pixels change!
+  ///
+  /// For checks that don't need every pixel (like histograms, or coarse change detection) you can set [downscale] to 2
+  /// or 4 (up to 16). Then every block of downscale x downscale pixel is averaged into one pixel natively while
+  /// capturing, so the returned image only has the size [width] ~/ downscale x [height] ~/ downscale and everything
+  /// that reads it afterwards is a lot faster (a quarter of the resolution is only 1/16 of the pixel). Downscaled
+  /// images are always captured directly (also while the [startCaptureThread] is running) and never reuse memory.
+  /// Other factors throw a [ConfigException].
   Future<NativeImage> getImage(
     int x,
     int y,
     int? width,
     int? height, [
     NativeImageType type = NativeImageType.RGBA,
+    NativeImage? reuseImage,
+    int downscale = 1,
   ]) async {
+    if (downscale < 1 || downscale > 16) {
+      throw ConfigException(message: "GameWindow.getImage: invalid downscale $downscale for $this");
+    }
     final Bounds<int> innerBounds = NativeOverlayWindow.getInnerOverlayAreaForWindow(this);
     final int finalWidth = width ?? (innerBounds.width - x);
     final int finalHeight = height ?? (innerBounds.height - y);
+    if (_captureThreadRunning && downscale == 1) {
+      final NativeImage? frame = getLatestFrame();
+      if (frame != null &&
+          frame.width == innerBounds.width &&
+          frame.height == innerBounds.height &&
+          x >= 0 &&
+          y >= 0 &&
+          x + finalWidth <= frame.width &&
+          y + finalHeight <= frame.height) {
+        final NativeImage image = frame.getSubImage(x, y, finalWidth, finalHeight); // copy, because frame is reused
+        await image.changeTypeAsync(type);
+        _imageFrameNumber = _latestFrameNumber;
+        return image;
+      }
+    }
+    _imageFrameNumber = 0;
 
     final NativeImage? image = await _nativeWindow.getImageOfWindow(
       _windowID,
@@ -277,6 +364,8 @@ final class GameWindow with ChangeNotifier {
       finalWidth,
       finalHeight,
       type,
+      reuseImage,
+      downscale,
     );
     if (image == null) {
       throw WindowClosedException(message: "Cant get image of window $this: $x, $y, $width, $height");
@@ -284,9 +373,170 @@ final class GameWindow with ChangeNotifier {
     return image;
   }
 
+  /// Starts an opt-in native background thread that captures the whole inner window [framesPerSecond] times per
+  /// second. While it is running, [getImage] (and so also CompareImage.isShown) copies the area out of the newest
+  /// frame instead of capturing the screen every time, so the image may be up to one frame old! The window does not
+  /// have to be open yet and the thread keeps running when it is closed and opened again.
+  ///
+  /// This costs a full window capture per frame, so only use it if many images are requested per tick. Stop it with
+  /// [stopCaptureThread] (done automatically in [GameToolsLib.close]).
+  void startCaptureThread({int framesPerSecond = 30}) {
+    _captureThreadRunning = _nativeWindow.startCaptureThread(_windowID, framesPerSecond);
+    if (_captureThreadRunning == false) {
+      Logger.warn("Could not start capture thread for $this with $framesPerSecond fps");
+    } else {
+      Logger.verbose("Started capture thread for $this with $framesPerSecond fps");
+    }
+  }
+
+  /// Stops the thread of [startCaptureThread] (does nothing if it is not running)
+  void stopCaptureThread() {
+    if (_captureThreadRunning) {
+      _captureThreadRunning = false;
+      _latestFrameNumber = 0;
+      _imageFrameNumber = 0;
+      _nativeWindow.stopCaptureThread(_windowID);
+      Logger.verbose("Stopped capture thread for $this");
+    }
+  }
+
+  /// Returns the newest full inner window frame of the [startCaptureThread] without waiting for a capture (or null if
+  /// it is not running, or has no frame yet). Also updates [latestFrameNumber].
+  ///
+  /// Important: the returned image only references the native memory of the frame which is reused after the next
+  /// call of this (or [getImage]), so it should only be used directly and has to be copied with [NativeImage.clone]
+  /// to keep it!
+  NativeImage? getLatestFrame() {
+    if (_captureThreadRunning == false) {
+      return null;
+    }
+    final (NativeImage, int)? frame = _nativeWindow.acquireLatestFrame(_windowID);
+    if (frame == null) {
+      return null;
+    }
+    _latestFrameNumber = frame.$2;
+    return frame.$1;
+  }
+
+  /// Returns how many tiles of 32x32 pixels that overlap the [area] (relative to the top left corner of the window)
+  /// changed in any frame of the [startCaptureThread] after the frame [sinceFrame] (like [imageFrameNumber]). So 0
+  /// means that the area still has exactly the same pixels. The capture thread hashes every tile of each frame for
+  /// this, so nothing is compared here.
+  /// Returns null if the capture thread is not running, or if it can not be detected (for example if the frame of
+  /// [sinceFrame] is unknown, or the [area] is not inside of the window).
+  int? changedTiles(Bounds<int> area, int sinceFrame) {
+    if (_captureThreadRunning == false) {
+      return null;
+    }
+    final int changed = _nativeWindow.changedTiles(_windowID, area, sinceFrame);
+    return changed < 0 ? null : changed;
+  }
+
+  /// Records every frame of the [startCaptureThread] into a new file at [path] until [stopRecording] is called, so that
+  /// it can later be read frame by frame with a [NativeRecording] (for example to see what the game showed when a
+  /// compare check did not work as expected, or to benchmark modules offline). Only frames of the capture thread are
+  /// recorded, so nothing is written while it is not running.
+  ///
+  /// Every [keyframeInterval] recorded frame (and the first one, or one with a new size) is stored completely and all
+  /// other frames only store the tiles of 32x32 pixels that changed with the time and the window bounds. The records
+  /// are compressed and written on a native background thread, so the capture thread is not slowed down (frames are
+  /// dropped instead if the disk can not keep up). Restarts the recording if it was already running. Returns false if
+  /// the file could not be created.
+  bool startRecording(String path, {int keyframeInterval = 300}) {
+    _recording = _nativeWindow.startRecording(_windowID, path, keyframeInterval);
+    if (_recording == false) {
+      Logger.warn("Could not start recording $this into $path");
+    } else {
+      Logger.verbose("Started recording $this into $path");
+    }
+    return _recording;
+  }
+
+  /// Stops the recording of [startRecording] after all captured frames are written and returns its statistics (or
+  /// null if it was not recording). Done automatically in [GameToolsLib.close]
+  NativeRecordingStats? stopRecording() {
+    if (_recording == false) {
+      return null;
+    }
+    _recording = false;
+    final NativeRecordingStats stats = _nativeWindow.stopRecording(_windowID);
+    Logger.verbose("Stopped recording $this with ${stats.records} frames (${stats.droppedFrames} dropped)");
+    return stats;
+  }
+
+  /// Current statistics of the recording of [startRecording] (or null if it is not recording)
+  NativeRecordingStats? get recordingStats => _recording ? _nativeWindow.getRecordingStats(_windowID) : null;
+
+  /// Publishes every frame of the [startCaptureThread] into a named shared memory until [stopFramePublishing] is
+  /// called, so that other tools (also in other processes) can read them with a [NativeSharedFrames] of the same
+  /// [name] instead of capturing the screen again. The [name] may only contain letters, digits, '_', '-' and '.'.
+  ///
+  /// The memory is a ring of [slotCount] frames of at most [maxWidth] x [maxHeight] pixels (0 for the size of the
+  /// main display, bigger frames are skipped). Each frame is copied once by the capture thread and the readers check
+  /// if it was overwritten while they read it, so the capture thread never waits for them. Restarts the publishing if
+  /// it was already running. Returns false if the memory could not be created.
+  bool startFramePublishing(String name, {int slotCount = 3, int maxWidth = 0, int maxHeight = 0}) {
+    _publishing = _nativeWindow.startFramePublishing(_windowID, name, slotCount, maxWidth, maxHeight);
+    if (_publishing == false) {
+      Logger.warn("Could not start publishing the frames of $this as $name");
+    } else {
+      Logger.verbose("Started publishing the frames of $this as $name");
+    }
+    return _publishing;
+  }
+
+  /// Stops the publishing of [startFramePublishing] and returns the amount of published frames (or null if it was not
+  /// publishing). Done automatically in [GameToolsLib.close]
+  int? stopFramePublishing() {
+    if (_publishing == false) {
+      return null;
+    }
+    _publishing = false;
+    final int published = _nativeWindow.stopFramePublishing(_windowID);
+    Logger.verbose("Stopped publishing the frames of $this after $published frames");
+    return published;
+  }
+
   /// Same as [getImage], but with [Bounds]
-  Future<NativeImage> getImageB(Bounds<int> b, [NativeImageType type = NativeImageType.RGBA]) async =>
-      getImage(b.x, b.y, b.width, b.height, type);
+  Future<NativeImage> getImageB(
+    Bounds<int> b, [
+    NativeImageType type = NativeImageType.RGBA,
+    NativeImage? reuseImage,
+    int downscale = 1,
+  ]) async => getImage(b.x, b.y, b.width, b.height, type, reuseImage, downscale);
+
+  /// Same as [getImageB] for each of the [regions] (relative to the top left corner of the inner window), but all
+  /// regions are captured together at once (only their bounding box is captured a single time), so this is faster
+  /// than calling [getImage] multiple times in the same tick if the regions are close to each other. The returned
+  /// images have the same order as the [regions].
+  /// May throw a [WindowClosedException] if the window was not open, or a region was empty.
+  ///
+  /// While the [startCaptureThread] is running, the regions are copied out of the newest frame instead.
+  Future<List<NativeImage>> getImages(
+    List<Bounds<int>> regions, [
+    NativeImageType type = NativeImageType.RGBA,
+  ]) async {
+    if (_captureThreadRunning) {
+      final List<NativeImage> images = <NativeImage>[];
+      for (final Bounds<int> region in regions) {
+        images.add(await getImageB(region, type)); // each one uses the latest frame
+      }
+      return images;
+    }
+    final Bounds<int> innerBounds = NativeOverlayWindow.getInnerOverlayAreaForWindow(this);
+    final List<NativeImage?> images = await _nativeWindow.getImagesOfWindow(
+      _windowID,
+      regions.map((Bounds<int> region) => region.move(innerBounds.x, innerBounds.y)).toList(),
+      type,
+    );
+    for (int i = 0; i < images.length; ++i) {
+      if (images[i] == null) {
+        images.whereType<NativeImage>().forEach((NativeImage image) => image.cleanupMemory());
+        throw WindowClosedException(message: "Cant get image of window $this for region ${regions[i]}");
+      }
+    }
+    return images.cast<NativeImage>();
+  }
 
   /// Image or screenshot of the whole full inner window window (as a future!) per default if [includeBorders] is
   /// false, so the area from 0, 0 to [size] that is also used for the overlay window, etc. In that case [getImage]
@@ -337,6 +587,70 @@ final class GameWindow with ChangeNotifier {
   /// Same as [getPixelOfWindow], but with [Point]
   Color? getPixelOfWindowP(Point<int> p) => getPixelOfWindow(p.x, p.y);
 
+  /// Same as [getPixelOfWindow] for all [points] (relative to the top left corner of the window), but much faster
+  /// than calling it for each point, because all points are read with a single call (close points are captured
+  /// together with one capture of their bounding box). The colors have the same order as the [points] and are null
+  /// for points outside of the window.
+  /// May throw a [WindowClosedException] if the window was not open.
+  ///
+  /// While the [startCaptureThread] is running, the colors are read from the newest frame instead.
+  List<Color?> getPixelsOfWindow(List<Point<int>> points) {
+    final List<bool> inside = points.map((Point<int> point) => isWithinInnerWindow(point.x, point.y)).toList();
+    final Bounds<int> innerBounds = NativeOverlayWindow.getInnerOverlayAreaForWindow(this);
+    final NativeImage? frame = getLatestFrame();
+    if (frame != null && frame.width == innerBounds.width && frame.height == innerBounds.height) {
+      return List<Color?>.generate(points.length, (int i) {
+        return inside[i] ? frame.colorAtPixel(points[i].x, points[i].y) : null;
+      });
+    }
+    final List<Color?> colors = _nativeWindow.getPixelsOfWindow(
+      _windowID,
+      points.map((Point<int> point) => point.move(innerBounds.x, innerBounds.y)).toList(),
+    );
+    for (int i = 0; i < colors.length; ++i) {
+      if (inside[i] == false) {
+        colors[i] = null;
+      }
+    }
+    return colors;
+  }
+
+  /// Starts a [NativeWatch] that checks the [points] (relative to the top left corner of the window) every [interval]
+  /// on a native background thread and reports if all of them have the expected [colors] (same order as the points)
+  /// with the same semantics as ColorExtension.equals with [pixelValueThreshold]. It only sends a message when that
+  /// state flips, so this is cheaper than reading the pixels in every tick to wait for something to appear.
+  /// May throw a [ConfigException] for invalid arguments. The window does not have to be open yet.
+  NativeWatch watchPixels(
+    List<Point<int>> points,
+    List<Color> colors, {
+    int pixelValueThreshold = 1,
+    Duration interval = const Duration(milliseconds: 50),
+  }) => NativeWatch(
+    (int nativePort) =>
+        _nativeWindow.addPixelWatch(_windowID, points, colors, pixelValueThreshold, interval, nativePort),
+    "${points.length} pixels of $this",
+  );
+
+  /// Same as [watchPixels], but the watch reports true while the [area] (relative to the top left corner of the
+  /// window) still looks the same as when it was checked the first time and false once it changed (with the same
+  /// semantics as [NativeImage.equals] with [pixelValueThreshold] and [maxAmountOfPixelsNotEqual]).
+  NativeWatch watchRegion(
+    Bounds<int> area, {
+    int pixelValueThreshold = 1,
+    int maxAmountOfPixelsNotEqual = 0,
+    Duration interval = const Duration(milliseconds: 100),
+  }) => NativeWatch(
+    (int nativePort) => _nativeWindow.addRegionWatch(
+      _windowID,
+      area,
+      pixelValueThreshold,
+      maxAmountOfPixelsNotEqual,
+      interval,
+      nativePort,
+    ),
+    "$area of $this",
+  );
+
   /// Returns if the [point] is inside of the whole space of the window (also border at the top) in relation to
   /// screen space.
   /// IMPORTANT: don't use this with a [point] that is relational to window screen space and use [isWithinInnerWindow]!
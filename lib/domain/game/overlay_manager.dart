@@ -185,6 +185,61 @@ base class OverlayManager<OverlayStateType extends GTOverlayState> with DelayedO
     }
   }
 
+  /// Checks if the [compareImages] (per default all [OverlayElementsList.compareImages]) are currently shown with one
+  /// window image for all instead of capturing and comparing each one separately in [CompareImage.isShown] and
+  /// returns the result for each of them (false for all if the window was closed).
+  ///
+  /// Every [CompareImage] with [CompareImage.supportsBatchComparison] of the [windowToTrack] is compared natively
+  /// in parallel against either one full window image, or the [getWindowImageWithoutOverlay] if the overlay obscures
+  /// it (see [CompareImage.needsImageWithoutOverlay]). All other compare images just use [CompareImage.isShown].
+  ///
+  /// Can be called periodically (for example in [onUpdate]) to check all compare images per tick.
+  Future<Map<CompareImage, bool>> checkCompareImages([Iterable<CompareImage>? compareImages]) async {
+    final Map<CompareImage, bool> results = <CompareImage, bool>{};
+    final List<CompareImage> withOverlay = <CompareImage>[];
+    final List<CompareImage> withoutOverlay = <CompareImage>[];
+    for (final CompareImage compareImage in compareImages ?? overlayElements.compareImages) {
+      if (compareImage.attachedWindow != windowToTrack || compareImage.supportsBatchComparison == false) {
+        results[compareImage] = await compareImage.isShown();
+      } else if (compareImage.needsImageWithoutOverlay(compareImage.bounds.scaledBounds)) {
+        withoutOverlay.add(compareImage);
+      } else {
+        withOverlay.add(compareImage);
+      }
+    }
+    if (!windowToTrack.isOpen) {
+      for (final CompareImage compareImage in <CompareImage>[...withOverlay, ...withoutOverlay]) {
+        results[compareImage] = false;
+      }
+      return results;
+    }
+    if (withOverlay.isNotEmpty) {
+      final NativeImage windowImage = await windowToTrack.getFullImage();
+      await _checkCompareImagesIn(windowImage, withOverlay, results);
+      windowImage.cleanupMemory();
+    }
+    if (withoutOverlay.isNotEmpty) {
+      await _checkCompareImagesIn(await getWindowImageWithoutOverlay(), withoutOverlay, results);
+    }
+    return results;
+  }
+
+  /// Used in [checkCompareImages] to compare all [compareImages] against the same [windowImage]
+  Future<void> _checkCompareImagesIn(
+    NativeImage windowImage,
+    List<CompareImage> compareImages,
+    Map<CompareImage, bool> results,
+  ) async {
+    final List<(Bounds<int>, NativeImage)> images = <(Bounds<int>, NativeImage)>[];
+    for (final CompareImage compareImage in compareImages) {
+      images.add((compareImage.bounds.scaledBounds, await compareImage.scaledImage));
+    }
+    final List<bool> shown = windowImage.shiftedEqualsBatch(images);
+    for (int i = 0; i < compareImages.length; ++i) {
+      results[compareImages[i]] = shown[i];
+    }
+  }
+
   /// Is called after the [overlayMode] was changed with the old value being [lastMode] (null the first time!).
   ///
   /// Important: if [changedBetweenHiddenAndVisible] is true, then a change happened exactly between
@@ -1,6 +1,7 @@
 import 'dart:async';
 import 'dart:convert';
 import 'dart:io';
+import 'dart:isolate' show ReceivePort;
 import 'dart:math';
 import 'package:collection/collection.dart';
 import 'package:flutter/foundation.dart';
@@ -15,6 +16,7 @@ import 'package:game_tools_lib/core/enums/event/game_event_priority.dart';
 import 'package:game_tools_lib/core/enums/event/game_event_status.dart';
 import 'package:game_tools_lib/core/enums/input/input_enums.dart';
 import 'package:game_tools_lib/core/enums/log_level.dart';
+import 'package:game_tools_lib/core/enums/native_frame_source.dart';
 import 'package:game_tools_lib/core/enums/overlay_mode.dart';
 import 'package:game_tools_lib/core/exceptions/exceptions.dart';
 import 'package:game_tools_lib/core/logger/custom_logger.dart';
@@ -27,7 +29,10 @@ import 'package:game_tools_lib/data/assets/gt_asset.dart';
 import 'package:game_tools_lib/data/native/ffi_loader.dart';
 import 'package:game_tools_lib/data/native/native_image.dart';
 import 'package:game_tools_lib/data/native/native_overlay_window.dart';
-import 'package:game_tools_lib/data/native/native_window.dart' show NativeWindow;
+import 'package:game_tools_lib/data/native/native_recording.dart';
+import 'package:game_tools_lib/data/native/native_shared_frames.dart';
+import 'package:game_tools_lib/data/native/native_watch.dart';
+import 'package:game_tools_lib/data/native/native_window.dart' show NativeWindow, NativeWindowState;
 import 'package:game_tools_lib/domain/entities/base/model.dart';
 import 'package:game_tools_lib/domain/game/game_window.dart';
 import 'package:game_tools_lib/domain/game/helper/delayed_overlay_checks.dart';
@@ -192,7 +197,7 @@ final class GameToolsLib extends _GameToolsLibHelper with _GameToolsLibEventLoop
     OverlayManager._instance = overlayManager ?? OverlayManagerBaseType(); // also already set overlay manager at top
     _GameToolsLibHelper._initConfigAndLogger(config, logger, isCalledFromTesting: isCalledFromTesting); // first logger
     Logger.verbose("GameToolsLib.initGameToolsLib... (remember to call GameToolsLib.runLoop afterwards!)");
-    if (Platform.isWindows == false) {
+    if (Platform.isWindows == false && Platform.isLinux == false) {
       throw UnimplementedError("This platform is currently not supported yet"); // then check platform support
     }
     if (gameWindows.isEmpty) {
@@ -298,6 +303,14 @@ final class GameToolsLib extends _GameToolsLibHelper with _GameToolsLibEventLoop
         // logger might not be initialized yet. also dont clean up logger itself!
         await StartupLogger().log("HiveDatabase was null while closing GameToolsLib", LogLevel.WARN, null, null);
       }
+      NativeWatch.cancelAll(); // native threads have to be stopped before the native window is cleared
+      NativeRecording.closeAll();
+      NativeSharedFrames.closeAll();
+      for (final GameWindow window in _gameWindows ?? <GameWindow>[]) {
+        window.stopRecording();
+        window.stopFramePublishing();
+        window.stopCaptureThread();
+      }
       NativeWindow.clearNativeWindowInstance();
       GameToolsConfig._instance = null;
       _gameWindows = null;
@@ -445,6 +458,11 @@ final class GameToolsLib extends _GameToolsLibHelper with _GameToolsLibEventLoop
   /// Returns the current active state
   static GameState get currentState => _GameToolsLibEventLoop._currentState!;
 
+  /// Frames of the [FixedConfig.replayRecording] that were analysed per second by the [GameManager] and its modules
+  /// if the [FixedConfig.replaySpeed] is 0 (otherwise, or before the second frame it is 0). The final value is also
+  /// logged after the last frame was analysed.
+  static double get replayFramesPerSecond => _GameToolsLibEventLoop._replayFramesPerSecond;
+
   /// Adds a new [listener] to the internal list of log input listeners
   static void addLogInputListener(LogInputListener listener) => GameLogWatcher._instance!.addListener(listener);
 
@@ -44,6 +44,10 @@ base class CompareImage extends OverlayElement {
   /// Used for [scaledImage]
   NativeImage? _scaledImageCache;
 
+  /// Result of the last [isShown] together with the [GameWindow.imageFrameNumber] and bounds of the window image it
+  /// was compared against (only if it was copied out of a frame of the [GameWindow.startCaptureThread])
+  ({bool shown, int frameNumber, Bounds<int> bounds})? _shownCache;
+
   /// If this is true (which it is per default, but may be toggled off for performance), then if any visible
   /// [OverlayElement], [DynamicOverlayElement], or [CanvasOverlayElement] are colliding with this (or overlaying),
   /// then the image comparison will be delayed and flickering, because the overlay has to be turned off and on again
@@ -189,17 +193,12 @@ base class CompareImage extends OverlayElement {
   /// Used in [isShown] with current bounds and in [findPos] optionally with either target bounds, or null!
   @protected
   Future<NativeImage> windowImageToCompareAgainst(Bounds<int>? bounds) async {
-    if (overlayAwareComparison) {
-      final OverlayManagerBaseType overlayManager = OverlayManager.overlayManager();
-      if (overlayManager.overlayMode != OverlayMode.HIDDEN && overlayManager.overlayMode != OverlayMode.APP_OPEN) {
-        if (bounds == null || overlayManager.overlayElements.isObscured(bounds)) {
-          final NativeImage img = await overlayManager.getWindowImageWithoutOverlay();
-          if (bounds != null) {
-            return img.getSubImage(bounds.x, bounds.y, bounds.width, bounds.height, onlyReference: true);
-          } else {
-            return img;
-          }
-        }
+    if (needsImageWithoutOverlay(bounds)) {
+      final NativeImage img = await OverlayManager.overlayManager().getWindowImageWithoutOverlay();
+      if (bounds != null) {
+        return img.getSubImage(bounds.x, bounds.y, bounds.width, bounds.height, onlyReference: true);
+      } else {
+        return img;
       }
     }
 
@@ -210,6 +209,24 @@ base class CompareImage extends OverlayElement {
     }
   }
 
+  /// Returns true if [overlayAwareComparison] is true and the visible overlay is obscuring the [bounds] (or the whole
+  /// window for null), so that [windowImageToCompareAgainst] has to use [OverlayManager.getWindowImageWithoutOverlay]
+  bool needsImageWithoutOverlay(Bounds<int>? bounds) {
+    if (overlayAwareComparison) {
+      final OverlayManagerBaseType overlayManager = OverlayManager.overlayManager();
+      if (overlayManager.overlayMode != OverlayMode.HIDDEN && overlayManager.overlayMode != OverlayMode.APP_OPEN) {
+        return bounds == null || overlayManager.overlayElements.isObscured(bounds);
+      }
+    }
+    return false;
+  }
+
+  /// If this can be checked together with other compare images in [OverlayManager.checkCompareImages] by the
+  /// native batch comparison of [NativeImage.shiftedEqualsBatch] (the same as the default [compareImages]).
+  /// Sub classes that override [compareImages] must also override this to return false, so that [isShown] is used
+  /// for them instead!
+  bool get supportsBatchComparison => true;
+
   /// Returns if [myImage] is equal to [gameWindowImage] by using [NativeImage.shiftedEquals] per default.
   /// May be overridden in sub classes for different comparison methods! Used in [isShown]
   @protected
@@ -222,29 +239,61 @@ base class CompareImage extends OverlayElement {
   ///
   /// by using [compareImages]!
   ///
+  /// While the [GameWindow.startCaptureThread] is running, the last result is returned without comparing anything if
+  /// none of the pixels at the bounds changed since then (see [GameWindow.changedTiles]).
+  ///
   /// Just returns false if the window was closed!
   Future<bool> isShown() async {
     if (!attachedWindow.isOpen) {
       return false;
     }
     final Bounds<int> myBounds = bounds.scaledBounds;
+    final ({bool shown, int frameNumber, Bounds<int> bounds})? cache = _shownCache;
+    final bool fromFrame = attachedWindow.isCaptureThreadRunning && !needsImageWithoutOverlay(myBounds);
+    if (fromFrame && cache != null && cache.bounds == myBounds) {
+      if (attachedWindow.changedTiles(myBounds, cache.frameNumber) == 0) {
+        return cache.shown;
+      }
+    }
     final NativeImage windowImage = await windowImageToCompareAgainst(myBounds);
+    final int frameNumber = attachedWindow.imageFrameNumber;
     final NativeImage myImage = await scaledImage;
-    return compareImages(myImage, windowImage);
+    final bool shown = await compareImages(myImage, windowImage);
+    _shownCache = fromFrame && frameNumber > 0 ? (shown: shown, frameNumber: frameNumber, bounds: myBounds) : null;
+    return shown;
   }
 
   /// This is used to search the [unscaledImage] in the [targetBounds] area and return the dimensions if it was found
   /// and otherwise null! If [targetBounds] are null, then this will search the whole window image from top left to
   /// bot right corner (worse performance). Its best to always choose a target area even if its big
   ///
+  /// The [scaledImage] counts as found if the [NativeImage.findTemplate] confidence is at least [minConfidence]
+  /// (from -1 to 1). Use [findBestMatch] to get the confidence as well.
+  ///
   /// Just returns null if the window was closed
-  Future<Bounds<int>?> findPos(Bounds<int>? targetBounds) async {
+  Future<Bounds<int>?> findPos(Bounds<int>? targetBounds, {double minConfidence = 0.9}) async {
+    final (Bounds<int>, double)? match = await findBestMatch(targetBounds);
+    if (match == null || match.$2 < minConfidence) {
+      return null;
+    }
+    return match.$1;
+  }
+
+  /// Used in [findPos] to return the window bounds of the best match of the [scaledImage] inside of the
+  /// [targetBounds] (or the whole window) together with its confidence from [NativeImage.findTemplate].
+  ///
+  /// Just returns null if the window was closed, or if the [targetBounds] are smaller than the [scaledImage]
+  Future<(Bounds<int>, double)?> findBestMatch(Bounds<int>? targetBounds) async {
     if (!attachedWindow.isOpen) {
       return null;
     }
     final NativeImage windowImage = await windowImageToCompareAgainst(targetBounds);
     final NativeImage myImage = await scaledImage;
-    throw UnimplementedError("todo: implement"); // todo: implement with template matching from native image
+    final (Bounds<int>, double)? match = await windowImage.findTemplate(myImage);
+    if (match == null || targetBounds == null) {
+      return match;
+    }
+    return (match.$1.move(targetBounds.x, targetBounds.y), match.$2);
   }
 
   /// This will take a new screenshot of the current [displayDimension] and then save the [unscaledImage] with the
@@ -262,6 +311,7 @@ base class CompareImage extends OverlayElement {
       if (_scaledImageCache != null) {
         _scaledImageCache!.cleanupMemory();
       }
+      _shownCache = null;
       _scaledImageCache = await newImage.clone();
       bounds.move(scaledBounds);
       unscaledImage.saveToFile(replaceWith: newImage);